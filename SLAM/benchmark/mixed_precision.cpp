@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <Eigen/Geometry>
+
+#include "utils/block_least_squares.h"
+
+/*
+混合精度块最小二乘的 benchmark（utils/block_least_squares）：
+    1. 合成位姿图（默认 2 万个位姿、2 万条回环）上完整求解一次：组装 JᵀJ、稀疏 Cholesky、回代 + 迭代修正，
+       比较 double / float 存储 J 的字节数、各阶段耗时和解的精度；其中组装和迭代修正是读 J 的阶段；
+    2. 更大的同类问题（默认 25 万个位姿、25 万条回环，J 放不进末级缓存）上只做 J x、Jᵀ y，
+       给出两种精度读 J 的有效带宽，也就是 float 存储在迭代求解器里能省下的部分。
+用法：mixed_precision [求解的位姿数 回环数 [乘法的位姿数 回环数]]
+ */
+
+namespace slam {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+// 一种精度在合成问题上的测量结果（各阶段取多次重复的中位数）
+struct MixedPrecisionBenchmarkResult {
+    JacobianPrecision precision = JacobianPrecision::kDouble;
+    std::size_t jacobian_bytes = 0;
+    double assemble_ms = 0.0;
+    double factorize_ms = 0.0;
+    double solve_ms = 0.0;
+    double total_ms = 0.0;
+    double assemble_bandwidth_gbs = 0.0;  // 组装时读 J 的有效带宽
+    double refine_ms = 0.0;               // 迭代修正里读 J 的部分（全部修正步）
+    double refine_bandwidth_gbs = 0.0;    // 迭代修正读 J 的有效带宽（每步读一遍 J 和 r）
+    int refinement_steps = 0;
+    double first_correction = 0.0;        // 迭代修正前直接求解的相对误差估计
+    double last_correction = 0.0;
+    double error_vs_double = 0.0;         // 解相对于 double 问题参考解（充分修正）的相对误差
+    double cost_increase = 0.0;           // 在 double 问题上 ‖Jδ + r‖² 比参考解大多少（相对值）
+};
+
+// 只读 J 的迭代乘法（CGLS / LSQR 的内层）在一种精度下的测量结果
+struct JacobianProductBenchmarkResult {
+    JacobianPrecision precision = JacobianPrecision::kDouble;
+    std::size_t matrix_bytes = 0;         // BlockSparseMatrix 的数值 + 下标
+    double product_ms = 0.0;              // 一次 y = J x 加一次 z = Jᵀ y（多次重复的中位数）
+    double bandwidth_gbs = 0.0;           // 2 * matrix_bytes / product_ms
+};
+
+// 合成的位姿图线性化：每条边 r = J_i δ_i + J_j δ_j + r0，J ≈ 信息矩阵平方根 × (−Ad, I)
+struct SyntheticProblem {
+    std::vector<std::pair<int, int>> edges;  // 第 0 个是先验 (0, 0)
+    std::vector<Eigen::Matrix<double, 6, 6>> J_i;
+    std::vector<Eigen::Matrix<double, 6, 6>> J_j;
+    std::vector<Eigen::Matrix<double, 6, 1>> r;
+};
+
+SyntheticProblem makeProblem(int num_poses, int num_loops) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_int_distribution<int> pose(0, num_poses - 2);
+    std::uniform_int_distribution<int> gap(2, 20);
+    std::uniform_real_distribution<double> scale(1.0, 100.0);
+
+    SyntheticProblem p;
+    p.edges.emplace_back(0, 0);
+    for (int i = 0; i + 1 < num_poses; ++i) p.edges.emplace_back(i, i + 1);
+    for (int l = 0; l < num_loops; ++l) {
+        // 回环只连到最近 20 个位姿以内（局部重访），完全随机的回环会让 Cholesky 的填充变成稠密
+        const int a = pose(rng);
+        p.edges.emplace_back(a, std::min(a + gap(rng), num_poses - 1));
+    }
+
+    auto randomMatrix = [&](double sigma) {
+        Eigen::Matrix<double, 6, 6> m;
+        for (int j = 0; j < 36; ++j) m.data()[j] = sigma * normal(rng);
+        return m;
+    };
+    for (const auto& e : p.edges) {
+        // 旋转 / 平移两部分的信息差 1~100 倍，模拟真实问题的尺度差异
+        Eigen::Matrix<double, 6, 6> W = Eigen::Matrix<double, 6, 6>::Zero();
+        W.topLeftCorner<3, 3>().diagonal().setConstant(scale(rng));
+        W.bottomRightCorner<3, 3>().diagonal().setConstant(scale(rng));
+        Eigen::Matrix<double, 6, 6> Ad = Eigen::Matrix<double, 6, 6>::Zero();
+        const Eigen::Matrix3d R = Eigen::Quaterniond::UnitRandom().toRotationMatrix();
+        Ad.topLeftCorner<3, 3>() = R;
+        Ad.bottomRightCorner<3, 3>() = R;
+        Ad.topRightCorner<3, 3>() = randomMatrix(0.3).topLeftCorner<3, 3>();
+        if (e.first == e.second) {
+            p.J_i.push_back(W * 1e3);
+            p.J_j.push_back(Eigen::Matrix<double, 6, 6>::Zero());
+        } else {
+            p.J_i.push_back(-W * (Ad + randomMatrix(0.01)));
+            p.J_j.push_back(W * (Eigen::Matrix<double, 6, 6>::Identity() + randomMatrix(0.01)));
+        }
+        Eigen::Matrix<double, 6, 1> r;
+        for (int j = 0; j < 6; ++j) r[j] = normal(rng);
+        p.r.push_back(r);
+    }
+    return p;
+}
+
+void fill(const SyntheticProblem& p, int num_poses, BlockLeastSquares<6, 6>& ls) {
+    std::vector<std::pair<int, int>> pattern;
+    for (int k = 0; k < static_cast<int>(p.edges.size()); ++k) {
+        pattern.emplace_back(k, p.edges[k].first);
+        if (p.edges[k].second != p.edges[k].first) pattern.emplace_back(k, p.edges[k].second);
+    }
+    ls.setPattern(static_cast<int>(p.edges.size()), num_poses, std::move(pattern));
+    for (int k = 0; k < static_cast<int>(p.edges.size()); ++k) {
+        ls.setJacobian(k, p.edges[k].first, p.J_i[k]);
+        if (p.edges[k].second != p.edges[k].first) ls.setJacobian(k, p.edges[k].second, p.J_j[k]);
+        ls.setResidual(k, p.r[k]);
+    }
+}
+
+// 未舍入的 double 问题上的 ‖Jδ + r‖²
+double cost(const SyntheticProblem& p, const Eigen::VectorXd& delta) {
+    double sum = 0.0;
+    for (std::size_t k = 0; k < p.edges.size(); ++k) {
+        Eigen::Matrix<double, 6, 1> e = p.r[k] + p.J_i[k] * delta.segment<6>(p.edges[k].first * 6);
+        if (p.edges[k].second != p.edges[k].first) e.noalias() += p.J_j[k] * delta.segment<6>(p.edges[k].second * 6);
+        sum += e.squaredNorm();
+    }
+    return sum;
+}
+
+double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v.empty() ? 0.0 : v[v.size() / 2];
+}
+
+// 合成问题分别用 double / float 存储求解；返回 {double, float} 两个结果
+std::vector<MixedPrecisionBenchmarkResult> benchmarkMixedPrecision(int num_poses, int num_loops, int repetitions = 5) {
+    num_poses = std::max(num_poses, 2);
+    num_loops = std::max(num_loops, 0);
+    repetitions = std::max(repetitions, 1);
+    const SyntheticProblem problem = makeProblem(num_poses, num_loops);
+
+    // 参考解：double 存储，修正到收敛
+    BlockLeastSquaresOptions reference_options;
+    reference_options.max_refinement_steps = 10;
+    reference_options.refinement_tolerance = 0.0;
+    Eigen::VectorXd reference;
+    {
+        BlockLeastSquares<6, 6> ls(reference_options);
+        fill(problem, num_poses, ls);
+        ls.solve(0.0, reference);
+    }
+    const double reference_cost = cost(problem, reference);
+
+    std::vector<MixedPrecisionBenchmarkResult> results;
+    for (const JacobianPrecision precision : {JacobianPrecision::kDouble, JacobianPrecision::kFloat}) {
+        BlockLeastSquaresOptions options;
+        options.precision = precision;
+        BlockLeastSquares<6, 6> ls(options);
+        fill(problem, num_poses, ls);
+
+        Eigen::VectorXd delta;
+        BlockLeastSquaresSummary summary;
+        ls.solve(0.0, delta, &summary);  // 预热（含符号分解）
+        std::vector<double> assemble, factorize, solve, refine, total;
+        for (int rep = 0; rep < repetitions; ++rep) {
+            ls.solve(0.0, delta, &summary);
+            assemble.push_back(summary.assemble_ms);
+            factorize.push_back(summary.factorize_ms);
+            solve.push_back(summary.solve_ms);
+            refine.push_back(summary.refine_ms);
+            total.push_back(summary.total_ms);
+        }
+
+        MixedPrecisionBenchmarkResult result;
+        result.precision = precision;
+        result.jacobian_bytes = ls.jacobianBytes();
+        result.assemble_ms = median(assemble);
+        result.factorize_ms = median(factorize);
+        result.solve_ms = median(solve);
+        result.total_ms = median(total);
+        result.assemble_bandwidth_gbs = result.jacobian_bytes / (result.assemble_ms * 1e6);
+        result.refine_ms = median(refine);
+        if (result.refine_ms > 0.0) {
+            result.refine_bandwidth_gbs =
+                double(result.jacobian_bytes) * summary.refinement_steps / (result.refine_ms * 1e6);
+        }
+        result.refinement_steps = summary.refinement_steps;
+        result.first_correction = summary.first_correction;
+        result.last_correction = summary.last_correction;
+        result.error_vs_double = (delta - reference).norm() / reference.norm();
+        result.cost_increase = (cost(problem, delta) - reference_cost) / reference_cost;
+        results.push_back(result);
+    }
+    return results;
+}
+
+template <typename Scalar>
+JacobianProductBenchmarkResult benchmarkProducts(const SyntheticProblem& problem, int num_poses, int repetitions) {
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    const int num_edges = static_cast<int>(problem.edges.size());
+    BlockSparseMatrix<Scalar, 6, 6> J;
+    std::vector<std::pair<int, int>> pattern;
+    for (int k = 0; k < num_edges; ++k) {
+        pattern.emplace_back(k, problem.edges[k].first);
+        if (problem.edges[k].second != problem.edges[k].first) pattern.emplace_back(k, problem.edges[k].second);
+    }
+    J.setPattern(num_edges, num_poses, std::move(pattern));
+    for (int k = 0; k < num_edges; ++k) {
+        J.addBlock(k, problem.edges[k].first, problem.J_i[k].template cast<Scalar>());
+        if (problem.edges[k].second != problem.edges[k].first) {
+            J.addBlock(k, problem.edges[k].second, problem.J_j[k].template cast<Scalar>());
+        }
+    }
+
+    // 幂迭代的形式 x ← JᵀJ x / ‖·‖，数值保持有界，每次都真正读完整个 J
+    Vector x = Vector::Ones(J.cols()), y(J.rows()), z(J.cols());
+    std::vector<double> times;
+    for (int rep = 0; rep <= repetitions; ++rep) {
+        const auto start = Clock::now();
+        J.multiply(x, y);
+        J.multiplyTranspose(y, z);
+        const double ms = elapsedMs(start);
+        x = z / std::max(z.norm(), Scalar(1e-30));
+        if (rep > 0) times.push_back(ms);  // 第一次是预热
+    }
+
+    JacobianProductBenchmarkResult result;
+    result.precision = sizeof(Scalar) == sizeof(float) ? JacobianPrecision::kFloat : JacobianPrecision::kDouble;
+    result.matrix_bytes = J.values().size() * sizeof(Scalar) + J.colIndex().size() * sizeof(int) +
+                          J.rowPtr().size() * sizeof(int);
+    result.product_ms = median(times);
+    result.bandwidth_gbs = 2.0 * result.matrix_bytes / (result.product_ms * 1e6);
+    return result;
+}
+
+// 同样的合成位姿图，J 直接存成 BlockSparseMatrix<float / double, 6, 6>（向量也是同一精度），
+// 反复做 J x、Jᵀ y；默认规模的 J 在 double 下约 290 MB，远大于末级缓存，测的是内存带宽
+std::vector<JacobianProductBenchmarkResult> benchmarkJacobianProducts(int num_poses, int num_loops,
+                                                                      int repetitions = 5) {
+    num_poses = std::max(num_poses, 2);
+    num_loops = std::max(num_loops, 0);
+    repetitions = std::max(repetitions, 1);
+    const SyntheticProblem problem = makeProblem(num_poses, num_loops);
+    return {benchmarkProducts<double>(problem, num_poses, repetitions),
+            benchmarkProducts<float>(problem, num_poses, repetitions)};
+}
+
+}  // namespace
+
+}  // namespace slam
+
+namespace {
+
+const char* name(slam::JacobianPrecision precision) {
+    return precision == slam::JacobianPrecision::kFloat ? "float " : "double";
+}
+
+int argument(int argc, char** argv, int i, int fallback) { return argc > i ? std::atoi(argv[i]) : fallback; }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int solve_poses = argument(argc, argv, 1, 20000);
+    const int solve_loops = argument(argc, argv, 2, 20000);
+    const int product_poses = argument(argc, argv, 3, 250000);
+    const int product_loops = argument(argc, argv, 4, 250000);
+
+    std::printf("solve: %d poses, %d loops (6x6 blocks)\n", solve_poses, solve_loops);
+    for (const slam::MixedPrecisionBenchmarkResult& r :
+         slam::benchmarkMixedPrecision(solve_poses, solve_loops)) {
+        std::printf("  %s  J+r %6.1f MB  assemble %6.2f ms (%5.2f GB/s)  factorize %7.2f ms  "
+                    "solve %6.2f ms  refine %5.2f ms x%d (%5.2f GB/s)  total %7.2f ms\n",
+                    name(r.precision), r.jacobian_bytes / 1e6, r.assemble_ms, r.assemble_bandwidth_gbs,
+                    r.factorize_ms, r.solve_ms, r.refine_ms, r.refinement_steps, r.refine_bandwidth_gbs,
+                    r.total_ms);
+        std::printf("          first correction %.1e  last %.1e  error vs double %.1e  cost increase %.1e\n",
+                    r.first_correction, r.last_correction, r.error_vs_double, r.cost_increase);
+    }
+
+    std::printf("J-only products (y = J x, z = Jᵀ y): %d poses, %d loops\n", product_poses, product_loops);
+    for (const slam::JacobianProductBenchmarkResult& r :
+         slam::benchmarkJacobianProducts(product_poses, product_loops)) {
+        std::printf("  %s  J %7.1f MB  J x + Jᵀ y %7.2f ms  %5.2f GB/s\n", name(r.precision), r.matrix_bytes / 1e6,
+                    r.product_ms, r.bandwidth_gbs);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+namespace slam {
+
+class ThreadPool;
+
+// 带时间戳的轨迹（SoA）：第 i 个位姿是 T_wb = (q[i], p[i])，时间单位秒，按时间升序
+struct Trajectory {
+    std::vector<double> t;
+    std::vector<Eigen::Vector3d> p;
+    std::vector<Eigen::Quaterniond> q;
+
+    int size() const { return static_cast<int>(t.size()); }
+    void clear();
+    void reserve(int n);
+    void add(double time, const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation);
+};
+
+// 对齐变换：gt ≈ s * R * est + t（SE(3) 对齐时 s = 1）
+struct TrajectoryAlignment {
+    Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d t = Eigen::Vector3d::Zero();
+    double s = 1.0;
+};
+
+struct ErrorStats {
+    int count = 0;
+    double rmse = 0.0;
+    double mean = 0.0;
+    double median = 0.0;
+    double std = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// 一个尺度上的 RPE：间隔 delta 帧，或（by_distance）沿真值轨迹走过 delta 米
+struct RpeResult {
+    bool by_distance = false;
+    double delta = 0.0;
+    ErrorStats translation;         // 米
+    ErrorStats rotation;            // 度
+};
+
+struct EvaluationResult {
+    int num_matched = 0;
+    TrajectoryAlignment alignment;
+    ErrorStats ate;                 // 对齐后的位置误差，米
+    std::vector<RpeResult> rpe;
+};
+
+struct TrajectoryEvaluatorOptions {
+    double max_dt = 0.02;                           // 时间戳关联的最大时间差（秒）
+    double time_offset = 0.0;                       // 关联前加到估计轨迹时间戳上
+    bool align = true;                              // 关闭时直接比较（轨迹已在同一坐标系）
+    bool scale = false;                             // Sim(3) 对齐（单目）
+    std::vector<int> rpe_frame_deltas{1, 10, 100};
+    std::vector<double> rpe_distances;              // 按距离的 RPE（米），如 KITTI 的 100, 200, ..., 800
+    int poses_per_task = 65536;
+};
+
+/*
+轨迹精度评估 ATE / RPE（对应 SLAM/readme.md 开头的 SLAM算法精度评估）
+
+夜间回归的轨迹有上百万个位姿，Python 的评估脚本要跑几分钟，这里全部是线性时间、按块并行：
+    1. 读文件：mmap 后按行边界切块，各块在线程池上用 from_chars 原地解析再按顺序拼接；
+       支持 TUM 格式（t x y z qx qy qz qw，空格分隔）和 EuRoC 真值 CSV（ns, p, qw qx qy qz, ...）；
+    2. 关联：两条轨迹都按时间排好序，一次线性归并，每个估计位姿取时间最近且在 max_dt 内的真值，
+       真值单调不重复使用；
+    3. Umeyama 对齐只扫一遍数据：各块累加 Σx、Σy、Σ|x|^2、Σ y x^T（先减去第一个点，避免大坐标下
+       一遍公式的相消误差），合并后 3x3 SVD 得到 R、t（和 s）；
+    4. ATE 和各尺度 RPE 的误差按块并行计算，统计量的和按块归约，中位数用 nth_element（线性时间）。
+ */
+class TrajectoryEvaluator {
+public:
+    explicit TrajectoryEvaluator(const TrajectoryEvaluatorOptions& options = TrajectoryEvaluatorOptions(),
+                                 ThreadPool* pool = nullptr);
+
+    // 读 TUM / EuRoC 格式的轨迹文件，乱序时按时间排序
+    bool load(const std::string& path, Trajectory& trajectory) const;
+
+    // 关联结果按时间升序，返回匹配数
+    int associate(const Trajectory& gt, const Trajectory& est, std::vector<int>& gt_index,
+                  std::vector<int>& est_index) const;
+
+    // 使 dst ≈ s * R * src + t 的最小二乘对齐（scale 为假时 s = 1），点数少于 3 返回 false
+    bool align(const std::vector<Eigen::Vector3d>& src, const std::vector<Eigen::Vector3d>& dst,
+               TrajectoryAlignment& alignment) const;
+
+    // 关联 + 对齐 + ATE + RPE；匹配数少于 3 返回 false
+    bool evaluate(const Trajectory& gt, const Trajectory& est, EvaluationResult& result) const;
+
+    const TrajectoryEvaluatorOptions& options() const { return options_; }
+
+private:
+    TrajectoryEvaluatorOptions options_;
+    ThreadPool* pool_;
+};
+
+}  // namespace slam
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace slam {
+
+// 针孔相机内参（图像已去畸变）
+struct PinholeCamera {
+    float fx = 0.f;
+    float fy = 0.f;
+    float cx = 0.f;
+    float cy = 0.f;
+    int width = 0;
+    int height = 0;
+};
+
+}  // namespace slam
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace slam {
+
+class ThreadPool;
+
+// 五点法（Stewénius 2006 的 Gröbner 基 / 作用矩阵形式）：5 对归一化齐次坐标 q1, q2，
+// 解出满足 q2^T E q1 = 0 的全部本质矩阵（最多 10 个，Frobenius 范数为 1），返回解的个数。
+// 零空间、10x20 约束矩阵、作用矩阵和特征分解全部是定长 Eigen 类型，无堆分配。
+int solveFivePoint(const Eigen::Vector3d q1[5], const Eigen::Vector3d q2[5], Eigen::Matrix3d E[10]);
+
+// 本质矩阵分解为 4 组 (R, t)，x2 ~ R * x1 + t，|t| = 1
+void decomposeEssential(const Eigen::Matrix3d& E, Eigen::Matrix3d R[4], Eigen::Vector3d t[4]);
+
+// 两帧之间的对应点（SoA），x1/y1 是第一帧，x2/y2 是第二帧
+// 本质矩阵使用去畸变后的归一化坐标；使用 PROSAC 时要求按质量从好到坏添加
+struct TwoViewCorrespondences {
+    std::vector<double> x1, y1, x2, y2;
+
+    void reserve(int n);
+    void clear();
+    void add(const Eigen::Vector2d& p1, const Eigen::Vector2d& p2);
+    int size() const { return static_cast<int>(x1.size()); }
+};
+
+struct EssentialRansacOptions {
+    double max_error_px = 2.0;      // Sampson 误差阈值（像素）
+    double focal_length = 500.0;    // 把像素阈值换算到归一化坐标
+    double confidence = 0.99;
+    int max_iterations = 1000;      // 最多采样次数
+    int batch_size = 16;            // 每批采样数，一批里的最小集分给各线程并行求解和打分
+    int min_inliers = 15;
+    bool use_prosac = true;
+    bool use_sprt = true;
+    std::uint32_t seed = 0;
+};
+
+struct EssentialResult {
+    bool success = false;
+    Eigen::Matrix3d E = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d R_21 = Eigen::Matrix3d::Identity();   // x2 ~ R_21 * x1 + t_21
+    Eigen::Vector3d t_21 = Eigen::Vector3d::Zero();       // 单位长度
+    std::vector<char> inlier_mask;
+    int num_inliers = 0;
+    int num_in_front = 0;           // 分解时两帧深度都为正的内点数
+    int iterations = 0;
+    int hypotheses = 0;
+    int rejected_by_sprt = 0;
+};
+
+/*
+五点法本质矩阵 RANSAC（对应 SLAM/readme.md 2.5 位姿估计中的本质矩阵，用于单目初始化）
+
+    1. 采样在调用线程上按 PROSAC 顺序生成，保证结果与线程数无关；
+    2. 一批最小集分给线程池，每个任务求解一个最小集（最多 10 个解）并立即打分；
+    3. 打分时对应点按 kChunk 个一组的 SoA 块遍历，每块只加载一次，同一最小集的所有解
+       一起计算 Sampson 误差（定长 Eigen 数组，编译成 SIMD），每块后做 SPRT 检验；
+    4. 一批结束后在调用线程上合并：更新最优模型、SPRT 的 ε/δ 和所需迭代次数；
+    5. 最优 E 分解为 4 组 (R, t)，按内点三角化后两帧深度都为正的个数选出正确的一组。
+ */
+class EssentialRansac {
+public:
+    explicit EssentialRansac(const EssentialRansacOptions& options = EssentialRansacOptions(),
+                             ThreadPool* pool = nullptr);
+
+    bool estimate(const TwoViewCorrespondences& data, EssentialResult& result);
+
+    // 在内点上从 E 的 4 组分解中选出正确的 (R, t)，返回两帧深度都为正的点数
+    static int recoverPose(const TwoViewCorrespondences& data, const std::vector<char>& inlier_mask,
+                           const Eigen::Matrix3d& E, Eigen::Matrix3d& R_21, Eigen::Vector3d& t_21);
+
+    const EssentialRansacOptions& options() const { return options_; }
+
+private:
+    // 判定内点并返回个数
+    int countInliers(const TwoViewCorrespondences& data, const Eigen::Matrix3d& E, double threshold2,
+                     std::vector<char>* mask) const;
+
+    EssentialRansacOptions options_;
+    ThreadPool* pool_;
+};
+
+}  // namespace slam
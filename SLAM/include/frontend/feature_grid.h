@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "frontend/feature_types.h"
+
+namespace slam {
+
+/*
+当前帧特征点的网格索引（CSR 布局）
+
+ORB-SLAM 的 mGrid 是 vector<vector<vector<size_t>>>，每个格子一个小 vector，
+建一次要几千次分配，查询时也在堆上跳来跳去。这里改成压缩行存储：
+
+    cell_offsets_[c] ~ cell_offsets_[c + 1]   第 c 个格子的特征点在排序后数组里的区间
+    order_[k]                                 排序后第 k 个点在原始 keypoints 中的下标
+
+建立时一次计数 + 前缀和 + 散射（计数排序），点坐标、层号、描述子也按同样的顺序复制一份，
+于是一个半径窗口在每一行格子上都是一段连续内存，距离计算可以直接对连续描述子做 SIMD。
+ */
+class FeatureGrid {
+public:
+    FeatureGrid(int grid_cols = 64, int grid_rows = 48);
+
+    // 区域 [min_x, max_x) x [min_y, max_y) 外的点不进入网格
+    void build(const std::vector<KeyPoint>& keypoints, const std::vector<Descriptor>& descriptors,
+               float min_x, float max_x, float min_y, float max_y);
+
+    // 半径窗口覆盖的每一行格子对应一段连续区间 [begin, end)（排序后的下标），返回区间个数
+    // runs 至少要能容纳 gridRows() 个区间
+    int windowRuns(float x, float y, float radius, int* run_begin, int* run_end) const;
+
+    // ORB-SLAM 风格的接口：半径窗口内、层号在 [min_level, max_level] 内的点（原始下标）
+    // max_level < 0 表示不限制层号
+    void featuresInArea(float x, float y, float radius, int min_level, int max_level,
+                        std::vector<int>& indices) const;
+
+    int size() const { return static_cast<int>(order_.size()); }
+    int numKeypoints() const { return n_keypoints_; }    // 建立时输入的点数（含区域外的点）
+    int gridRows() const { return grid_rows_; }
+
+    // 以下按排序后的下标访问
+    float x(int k) const { return xs_[k]; }
+    float y(int k) const { return ys_[k]; }
+    int octave(int k) const { return octaves_[k]; }
+    int originalIndex(int k) const { return order_[k]; }
+    const Descriptor* descriptors() const { return descriptors_.data(); }
+
+private:
+    int grid_cols_;
+    int grid_rows_;
+    int n_keypoints_ = 0;
+    float min_x_ = 0.f, min_y_ = 0.f;
+    float inv_cell_w_ = 0.f, inv_cell_h_ = 0.f;
+
+    std::vector<int> cell_offsets_;     // grid_cols * grid_rows + 1
+    std::vector<int> order_;
+    std::vector<int> cell_of_;          // 建立时的临时数组：每个点所在格子，-1 表示区域外
+    std::vector<int> cursor_;           // 建立时的散射游标
+    std::vector<float> xs_, ys_;
+    std::vector<int> octaves_;
+    std::vector<Descriptor> descriptors_;
+};
+
+}  // namespace slam
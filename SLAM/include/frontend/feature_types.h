@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace slam {
+
+// 前端特征点
+// x, y 为所在金字塔层上的像素坐标，response 为 Harris/FAST 响应值，octave 为金字塔层号
+struct KeyPoint {
+    float x = 0.f;
+    float y = 0.f;
+    float response = 0.f;
+    float angle = 0.f;      // 灰度质心法计算的方向（弧度）
+    int octave = 0;
+};
+
+// 256 位 ORB（Steered BRIEF）二进制描述子，32 字节对齐以便整块装入一个 ymm 寄存器
+struct alignas(32) Descriptor {
+    std::uint64_t words[4] = {0, 0, 0, 0};
+};
+
+inline int hammingDistance(const Descriptor& a, const Descriptor& b) {
+    return __builtin_popcountll(a.words[0] ^ b.words[0]) + __builtin_popcountll(a.words[1] ^ b.words[1]) +
+           __builtin_popcountll(a.words[2] ^ b.words[2]) + __builtin_popcountll(a.words[3] ^ b.words[3]);
+}
+
+// 描述子匹配结果：query 为当前帧特征下标，train 为参考帧（或地图点）下标
+struct Match {
+    int query = -1;
+    int train = -1;
+    int distance = 0;
+};
+
+}  // namespace slam
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "frontend/feature_types.h"
+
+namespace slam {
+
+class ThreadPool;
+
+// 一个 query 与一段连续存放的描述子 train[0, n) 的距离，写入 out[0, n)
+// 用于投影匹配、词袋树等候选集合很小但在内存中连续的场合：AVX-512 下 8 个一组，
+// 尾部用掩码加载，不读越界；AVX2 下 4 个一组，尾部和其余情况使用硬件 popcnt
+void hammingDistances(const Descriptor& query, const Descriptor* train, int n, int* out);
+
+/*
+256 位二进制描述子的暴力 Hamming 匹配（对应 SLAM/readme.md 2.4 快速匹配）
+
+ORB 描述子是二进制的，几千个点的规模下暴力匹配 + popcount 比 FLANN（LSH）更快也更准。
+
+    1. train 描述子先转置成 8 个一组的分块布局：块内第 k 个 64 位字连续存放 8 个描述子的
+       第 k 个字，一个 zmm（或两个 ymm）一次算出 8 个距离，不需要水平求和；
+    2. popcount 使用 AVX-512 VPOPCNTDQ，没有时退回 AVX2 的 pshufb 查表 + sad_epu8，
+       再没有时退回标量 __builtin_popcountll；在编译期通过 -march 选择；
+    3. 距离和下标打包成 64 位键 (distance << 32 | index)，最优/次优用无分支的
+       min/max 维护在寄存器里，扫描结束再做一次 8 路归约；
+    4. 同一次扫描顺便更新每个 train 的最优 query，交叉验证不需要反向再匹配一遍；
+    5. query 按块分给线程池，train 按 tile 分块保证在 L2 内，每个线程维护自己的
+       列最优数组，最后合并。
+ */
+struct HammingMatcherOptions {
+    int max_distance = 64;      // 最优距离上限（ORB-SLAM 的 TH_HIGH 为 100，TH_LOW 为 50）
+    float ratio = 0.8f;         // Lowe 比值检验 best < ratio * second，<= 0 表示不做
+    bool cross_check = true;    // 互为最近邻才保留
+    int query_block = 64;       // 每个任务处理的 query 数
+    int train_tile = 4096;      // 每个 tile 的 train 数，4096 * 32B = 128KB
+};
+
+class HammingMatcher {
+public:
+    explicit HammingMatcher(const HammingMatcherOptions& options = HammingMatcherOptions(),
+                            ThreadPool* pool = nullptr);
+
+    // 设置 train 集合，内部转置成分块布局；同一组 train 匹配多次时只需设置一次
+    void setTrain(const Descriptor* train, int n_train);
+    void setTrain(const std::vector<Descriptor>& train) {
+        setTrain(train.data(), static_cast<int>(train.size()));
+    }
+
+    // 每个 query 最多输出一个匹配，按 query 下标升序
+    void match(const Descriptor* query, int n_query, std::vector<Match>& matches);
+    void match(const std::vector<Descriptor>& query, std::vector<Match>& matches) {
+        match(query.data(), static_cast<int>(query.size()), matches);
+    }
+
+    const HammingMatcherOptions& options() const { return options_; }
+
+private:
+    HammingMatcherOptions options_;
+    ThreadPool* pool_;
+
+    int n_train_ = 0;
+    int n_train_blocks_ = 0;
+    std::vector<std::uint64_t> train_blocks_;            // [block][word][lane]
+    std::vector<std::uint64_t> row_best_;                // 每个 query 的最优、次优键
+    std::vector<std::vector<std::uint64_t>> col_best_;   // 每个线程的列最优键
+};
+
+}  // namespace slam
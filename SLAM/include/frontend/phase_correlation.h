@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "utils/fft.h"
+
+namespace slam {
+
+struct PhaseCorrelationOptions {
+    bool window = true;             // 减去均值后乘 Hann 窗，抑制图像边界在频谱里造成的十字条纹
+    float min_response = 0.05f;     // 归一化相关峰（两图完全一致时为 1）低于它认为配准失败
+    int downsample = 2;             // 2：先 2x2 平均成 W/2 x H/2 再配准（要求 W % 4 == 0、H % 2 == 0，否则按 1），
+                                    // 结果仍按原图像素；1：全分辨率，慢约 4 倍，只在严格整体平移时更准（见第 5 条）
+    bool half_band = false;         // 平移相关只用 |f| < 1/4 周 / 像素的频率，在 W/2 x H/2 上逆变换；
+                                    // 更快，但精度随图像内容变化，需要按场景实测后再打开（见下面第 3 条）
+    bool log_polar = false;         // 准备对数极坐标模式（旋转 + 尺度），setReference 额外算一份对数极坐标谱
+    int log_polar_angles = 256;     // 对数极坐标图的角度采样数，覆盖 [0, π)
+    int log_polar_radii = 128;      // 对数半径采样数，覆盖 [2 / min(W', H'), 0.5] 周 / 像素（W'、H' 是网格尺寸）
+};
+
+// 当前图 I 和参考图 I_ref 的关系：I(x') = I_ref(x)，x' = scale R(rotation) (x - c) + c + shift，
+// c = (W / 2, H / 2)，R 按图像坐标（x 向右、y 向下）；纯平移模式下 rotation = 0、scale = 1
+struct PhaseCorrelationResult {
+    bool success = false;
+    Eigen::Vector2d shift = Eigen::Vector2d::Zero();
+    double rotation = 0.0;          // 弧度
+    double scale = 1.0;
+    double response = 0.0;          // 平移相关峰的高度
+    double log_polar_response = 0.0;
+};
+
+/*
+FFT 相位相关全局配准（对应 Eigen/code05.cpp demo03 的复数矩阵：real()、imag()、conjugate()），
+用于重定位时和候选关键帧整体对齐，以及特征跟踪前的平移初值
+    0. downsample = 2 时输入图先 2x2 平均成 W/2 x H/2 的网格，下面各步都在网格上做，
+       平移最后乘 2 换回原图像素，反向变换的中心取原图中心在网格上的位置；
+    1. 图像减均值、乘 Hann 窗后做实数二维 FFT（utils/fft.h，只算一半频谱）；参考图的谱在 setReference 时
+       归一化成单位幅值 R / |R| 缓存下来，之后每帧只做一次正变换；
+    2. 互功率谱 C = F · conj(R) / |F|：只保留相位差，逆变换后在平移量处是一个尖峰；
+    3. 峰值在整像素上取最大，每个方向用两侧较大的邻点按 Foroosh 的 sinc 公式 d = c1 / (c1 + c0)
+       插值到亚像素；峰高就是相关系数，作为配准的置信度；half_band 时只取低频一半（每个方向）的互功率谱
+       做 W/2 x H/2 的逆变换，得到的正好是平移量一半处的 Dirichlet 峰，亚像素公式照样成立，结果乘 2：
+       逆变换和找峰的开销降到 1/4，但精度和内容有关：双线性重采样过的图高频相位多是插值噪声，去掉后略好，
+       严格整体平移的平滑纹理则丢了有用的高频相位、误差变大，所以默认关闭；
+    4. 对数极坐标模式（log_polar）：幅度谱与平移无关，旋转 θ、缩放 s 在对数极坐标 (log ρ, φ) 下变成平移
+       (-log s, θ)；对两幅图的高通加权幅度谱做对数极坐标重采样后再相位相关，得到 θ 和 s；
+       幅度谱关于原点对称，θ 和 θ + π 分不开：把当前图按 θ、s 反向变换回来后和参考图做平移相关，
+       θ + π 的候选的谱正好是 θ 候选谱的共轭（关于中心转 π 等于坐标取反），不需要再做一次正变换，
+       两个候选先在网格 1/4 尺寸的低频上比峰高（错误候选只有噪声峰），选中的再做完整的平移相关；
+       共轭是关于网格 (N/2, N/2) 的点反射，中心不在那里时选中 θ + π 的平移要补上两个中心之差的 2 倍；
+    5. 耗时和精度（512 x 512，单核，模糊噪声纹理）：
+       默认（downsample = 2）：setReference 约 0.4 ms（log_polar 约 0.7 ms），纯平移约 0.8 ms，
+       旋转 + 缩放约 1.9 ms；平移误差在双线性重采样的图上 0.03 ~ 0.35 像素，严格整像素平移时 0.01 ~ 0.06 像素，
+       旋转 + 缩放模式下平移误差 0.2 ~ 0.4 像素、角度误差约 0.005 弧度、尺度误差约 0.3%；
+       downsample = 1：纯平移约 3 ms、旋转 + 缩放约 8 ms，严格整像素平移时误差降到 0.002 像素，
+       双线性重采样的图上并不更准（0.13 ~ 0.33 像素）。
+宽度必须是偶数；单线程，计划和缓冲区在构造时分配。
+ */
+class PhaseCorrelator {
+public:
+    PhaseCorrelator(int width, int height, const PhaseCorrelationOptions& options = PhaseCorrelationOptions());
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    // 调整后的参数（downsample 按图像尺寸取实际使用的值）
+    const PhaseCorrelationOptions& options() const { return options_; }
+
+    // image 是 8 位灰度图，行跨度 stride 字节；尺寸不合法时返回 false
+    bool setReference(const std::uint8_t* image, int stride);
+    bool hasReference() const { return has_reference_; }
+
+    // 纯平移；没有参考图或相关峰低于 min_response 时返回 false（result 仍然填好）
+    bool estimateTranslation(const std::uint8_t* image, int stride, PhaseCorrelationResult& result);
+    // 旋转 + 缩放 + 平移，需要 options.log_polar
+    bool estimateSimilarity(const std::uint8_t* image, int stride, PhaseCorrelationResult& result);
+
+private:
+    // 输入图按 downsample 缩小（写到 small_）后 prepare
+    void load(const std::uint8_t* image, int stride);
+    // 减均值、加窗，写到 input_；Pixel 是 uint8_t（输入图）或 float（缩小或反向变换后的图）
+    template <typename Pixel>
+    void prepare(const Pixel* image, int stride);
+    // 原图中心 (W / 2, H / 2) 在网格上的坐标 c
+    Eigen::Vector2d gridCenter() const;
+    // warped_(x) = image(c + scale R(rotation) (x - c))，网格尺寸，双线性插值，图外填均值
+    template <typename Pixel>
+    void warp(const Pixel* image, int stride, double rotation, double scale);
+    // 高通加权的幅度谱重采样到对数极坐标，再减均值、沿半径加窗，写到 log_polar_input_
+    void logPolar(const HalfSpectrum& spectrum);
+    // spectrum 和归一化的参考谱做互功率谱，裁到 fft 的尺寸（低频部分）逆变换、找峰，平移按裁剪比例放大；
+    // conjugate 时先对 spectrum 取共轭
+    double correlate(RealFft2D& fft, const HalfSpectrum& spectrum, const HalfSpectrum& reference, bool conjugate,
+                     std::vector<float>& surface, Eigen::Vector2d& shift);
+
+    int width_;
+    int height_;
+    PhaseCorrelationOptions options_;
+    bool has_reference_ = false;
+    int downsample_;                      // 实际使用的缩小倍数（1 或 2）
+    int grid_width_, grid_height_;        // 配准用的网格尺寸 W / downsample_ x H / downsample_
+
+    RealFft2D fft_;
+    std::vector<float> window_x_, window_y_;
+    std::vector<float> small_;            // 缩小后的输入图
+    std::vector<float> input_;
+    RealFft2D band_fft_;                  // half_band 时 W/2 x H/2，否则与 fft_ 同尺寸
+    std::vector<float> surface_;          // band_fft_ 尺寸的相关面
+    HalfSpectrum spectrum_, cross_;
+    HalfSpectrum reference_;              // R / |R|
+
+    // 对数极坐标模式
+    RealFft2D log_polar_fft_;             // 宽 = 半径采样数，高 = 角度采样数
+    std::vector<float> highpass_;         // 与半谱同布局
+    std::vector<float> magnitude_;
+    struct LogPolarSample {
+        int offset0, offset1;             // (u0, v0)、(u0 + 1, v0) 在半谱里的下标
+        float du, dv;
+    };
+    std::vector<LogPolarSample> log_polar_samples_;  // 按 (角度, 半径) 行优先
+    std::vector<float> radius_window_;
+    double log_step_ = 0.0;               // 相邻半径采样的 log ρ 之差
+    std::vector<float> log_polar_input_, log_polar_surface_;
+    HalfSpectrum log_polar_spectrum_, log_polar_reference_;
+    std::vector<float> warped_;
+    RealFft2D candidate_fft_;             // W/4 x H/4（尺寸不能整除时与 fft_ 同尺寸），区分 θ 和 θ + π
+    std::vector<float> candidate_surface_;
+};
+
+}  // namespace slam
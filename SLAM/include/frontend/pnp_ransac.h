@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace slam {
+
+// P3P（Grunert 解法，Haralick 1994 综述中的形式）：3 个单位方向向量 f 和对应的世界点 P，
+// 解出最多 4 组 R_cw, t_cw（P_c = R_cw * P_w + t_cw），返回解的个数。全部定长类型，无堆分配。
+int solveP3P(const Eigen::Vector3d f[3], const Eigen::Vector3d P[3], Eigen::Matrix3d R[4], Eigen::Vector3d t[4]);
+
+// 3 个及以上点的绝对定向（Horn / Umeyama，无尺度）：求 R, t 使 Q_i ≈ R * P_i + t
+void absoluteOrientation(const Eigen::Vector3d* P, const Eigen::Vector3d* Q, int n,
+                         Eigen::Matrix3d& R, Eigen::Vector3d& t);
+
+// 2D-3D 对应点（SoA），图像点为去畸变后的归一化坐标 ((u - cx) / fx, (v - cy) / fy)
+// 使用 PROSAC 时要求按质量从好到坏添加（例如按描述子距离升序）
+struct PnPCorrespondences {
+    std::vector<double> X, Y, Z;    // 世界坐标
+    std::vector<double> x, y;       // 归一化图像坐标
+
+    void reserve(int n);
+    void clear();
+    void add(const Eigen::Vector3d& Pw, const Eigen::Vector2d& xn);
+    int size() const { return static_cast<int>(x.size()); }
+};
+
+struct PnPRansacOptions {
+    double max_error_px = 2.0;      // 重投影误差阈值（像素）
+    double focal_length = 500.0;    // 把像素阈值换算到归一化坐标
+    double confidence = 0.99;
+    int max_iterations = 1000;      // 最多采样次数
+    int batch_size = 8;             // 每批采样数，一批最多 4 * batch_size 个假设一起打分
+    int min_inliers = 10;
+    bool use_prosac = true;
+    bool use_sprt = true;
+    int refine_iterations = 10;     // 内点上的 Gauss-Newton 迭代次数，0 表示不优化
+    std::uint32_t seed = 0;
+};
+
+struct PnPResult {
+    bool success = false;
+    Eigen::Matrix3d R_cw = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d t_cw = Eigen::Vector3d::Zero();
+    std::vector<char> inlier_mask;
+    int num_inliers = 0;
+    int iterations = 0;             // 实际采样次数
+    int hypotheses = 0;             // 生成的假设数
+    int rejected_by_sprt = 0;
+};
+
+/*
+PnP RANSAC（对应 SLAM/readme.md 2.5 位姿估计中的 PnP）
+
+逐个假设对全部对应点打分是原来的瓶颈，这里：
+    1. 一批采样 batch_size 个最小集，每个最小集 P3P 最多 4 个解，一批假设一起打分；
+    2. 对应点按 kChunk 个一组的 SoA 块遍历，每个块只加载一次，对所有存活的假设计算
+       重投影误差（定长 Eigen 数组，编译成 SIMD）；
+    3. 每个块结束后做 SPRT 检验，坏假设通常几十个点后就被拒绝，不再参与后续块；
+    4. 采样顺序使用 PROSAC；
+    5. 最后在内点上做 SE(3) 上的 Gauss-Newton 优化，并用优化后的位姿重新判定内点。
+ */
+class PnPRansac {
+public:
+    explicit PnPRansac(const PnPRansacOptions& options = PnPRansacOptions());
+
+    bool estimate(const PnPCorrespondences& data, PnPResult& result);
+
+    // 在给定内点上优化位姿（最小化归一化平面上的重投影误差）
+    static void refine(const PnPCorrespondences& data, const std::vector<char>& inlier_mask, int iterations,
+                       Eigen::Matrix3d& R_cw, Eigen::Vector3d& t_cw);
+
+    const PnPRansacOptions& options() const { return options_; }
+
+private:
+    // 判定内点并返回个数
+    int countInliers(const PnPCorrespondences& data, const Eigen::Matrix3d& R, const Eigen::Vector3d& t,
+                     double threshold2, std::vector<char>* mask) const;
+
+    PnPRansacOptions options_;
+};
+
+}  // namespace slam
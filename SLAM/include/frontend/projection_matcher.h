@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "frontend/camera.h"
+#include "frontend/feature_grid.h"
+#include "frontend/feature_types.h"
+
+namespace slam {
+
+class ThreadPool;
+
+// 局部地图点（SoA 布局），投影时 x/y/z 三个数组可以直接按 Eigen 数组向量化
+struct MapPointBatch {
+    std::vector<float> x, y, z;                 // 世界坐标
+    std::vector<Descriptor> descriptors;        // 代表描述子
+    std::vector<int> predicted_level;           // 预测的金字塔层，为空表示不做尺度检查
+
+    int size() const { return static_cast<int>(x.size()); }
+};
+
+struct ProjectionMatcherOptions {
+    float radius = 15.f;        // 第 0 层的搜索半径（像素），第 l 层乘以 scale_factor^l
+    float scale_factor = 1.2f;
+    int max_distance = 100;     // ORB-SLAM TH_HIGH
+    float ratio = 0.8f;         // 最优 < ratio * 次优，<= 0 表示不做
+    float min_depth = 0.1f;     // 相机坐标系下的最小深度
+    int points_per_task = 512;
+};
+
+/*
+投影匹配（对应 SLAM/readme.md 2.4 投影匹配）
+
+已知位姿初值（运动模型或上一帧）和地图点深度时，把局部地图点投影到当前帧，
+只在投影位置附近的窗口里比较描述子。
+
+批量接口分三步，全部按任务块并行：
+    1. 用 Eigen 数组一次把一个块的地图点变换、投影，得到像素坐标和有效掩码；
+    2. 在 FeatureGrid 上查半径窗口，窗口在每行格子上是一段连续描述子，
+       直接用 hammingDistances 做 SIMD 距离计算，再按半径和层号筛选；
+    3. 每个地图点只写自己的结果槽位，最后串行地解决多个地图点抢同一个特征点的冲突，
+       保留距离最小的那个。
+ */
+class ProjectionMatcher {
+public:
+    explicit ProjectionMatcher(const ProjectionMatcherOptions& options = ProjectionMatcherOptions(),
+                               ThreadPool* pool = nullptr);
+
+    // R_cw, t_cw：世界到相机；输出 Match 的 query 为地图点下标，train 为特征点原始下标
+    // 返回匹配数
+    int match(const FeatureGrid& grid, const MapPointBatch& points,
+              const Eigen::Matrix3f& R_cw, const Eigen::Vector3f& t_cw, const PinholeCamera& camera,
+              std::vector<Match>& matches);
+
+    const ProjectionMatcherOptions& options() const { return options_; }
+
+private:
+    ProjectionMatcherOptions options_;
+    ThreadPool* pool_;
+
+    std::vector<int> best_train_;       // 每个地图点的最优特征点（原始下标），-1 表示没有
+    std::vector<int> best_distance_;
+    std::vector<long long> claimed_;    // 每个特征点被占用时的 (distance << 32 | point)
+};
+
+}  // namespace slam
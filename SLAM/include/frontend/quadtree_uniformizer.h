@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+#include "frontend/feature_types.h"
+
+namespace slam {
+
+/*
+四叉树特征均匀化（对应 SLAM/readme.md 2.3 关键点筛选）
+
+ORB-SLAM 的 DistributeOctTree 用 std::list 保存节点，每次分裂都要 new/delete，
+20k 个原始角点时节点链表的分配和遍历成为瓶颈，而且重复坐标的点会让节点无限细分。
+
+这里的做法：
+    1. 所有节点放在一块预分配的 arena（std::vector<Node>）里，节点只记录
+       点数组 entries_ 上的区间 [begin, end)；entries_ 是 16 字节的 {x, y, response, index}，
+       划分时顺序访问，不再随机访问原始 KeyPoint；
+    2. 分裂时对该区间做三次 std::partition（先按 x 再按 y），原地得到 4 个子区间，
+       不拷贝、不分配；
+    3. 节点边长小于 min_cell_size 时不再分裂，深度最多 log2(图像尺寸 / min_cell_size)，
+       每一层是 O(N) 的划分，总代价 O(N log N)，最坏延迟可预期；
+    4. 每个叶子节点保留响应值最大的点（即极大抑制），叶子多于目标数时按响应值截断，
+       少于目标数时用剩余点按响应值补齐，保证输出恰好 min(target, N) 个点。
+ */
+class QuadtreeUniformizer {
+public:
+    // max_keypoints: 单帧（单层）预期的最大角点数，用于预分配 arena 和索引数组
+    explicit QuadtreeUniformizer(int max_keypoints = 20000, float min_cell_size = 4.f);
+
+    // 在 [min_x, max_x) x [min_y, max_y) 区域内均匀选出 target 个点
+    // selected 输出被选中点在 keypoints 中的下标（按响应值降序）
+    void distribute(const std::vector<KeyPoint>& keypoints,
+                    float min_x, float max_x, float min_y, float max_y,
+                    int target, std::vector<int>& selected);
+
+    // 按金字塔层分别均匀化，每层的目标数由 level_targets 给出，
+    // 每层的边界为 [0, level_widths[i]) x [0, level_heights[i])
+    void distributePerLevel(const std::vector<KeyPoint>& keypoints,
+                            const std::vector<int>& level_targets,
+                            const std::vector<float>& level_widths,
+                            const std::vector<float>& level_heights,
+                            std::vector<int>& selected);
+
+    // ORB 的每层特征点数分配：按尺度因子的等比数列分配 total 个点，和恰好为 total；
+    // scale_factor <= 1 时各层平均分配
+    static std::vector<int> computeLevelTargets(int total, int n_levels, float scale_factor);
+
+private:
+    struct Node {
+        float x0, y0, x1, y1;   // 节点边界
+        int begin, end;         // entries_ 上的区间
+    };
+
+    struct Entry {
+        float x, y, response;
+        int index;              // 在输入 keypoints 中的下标
+    };
+
+    void runOnRange(int begin, int end, float min_x, float max_x, float min_y, float max_y,
+                    int target, std::vector<int>& selected);
+    // 原地分裂节点，把非空子节点的 arena 下标追加到 out
+    void split(const Node& node, std::vector<int>& out);
+    bool splittable(const Node& node) const;
+
+    float min_cell_size_;
+    std::vector<Node> arena_;
+    std::vector<Entry> entries_;
+    std::vector<int> leaves_;       // 当前叶子节点（arena 下标）
+    std::vector<int> next_leaves_;
+    std::vector<int> expand_;       // 本轮待分裂节点
+    std::vector<int> level_begin_;  // 按层计数排序后的区间起点
+    std::vector<Entry> spare_;      // 补齐阶段的候选点
+};
+
+}  // namespace slam
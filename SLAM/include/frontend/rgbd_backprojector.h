@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "frontend/camera.h"
+
+namespace slam {
+
+class ThreadPool;
+
+struct RgbdOptions {
+    float depth_scale = 1.0f / 5000.0f;     // 深度值 -> 米（TUM 数据集为 5000，Kinect / RealSense 常为 1000）
+    float min_depth = 0.1f;                 // 范围外（包括深度 0，即无测量）的像素输出 NaN
+    float max_depth = 10.0f;
+    int band_rows = 16;                     // 每个行带的行数，也是一个线程任务的大小
+};
+
+// 一个行带的点（SoA，相机坐标系）：像素 (u, v) 的下标为 (v - row_begin) * width + u，
+// 无效深度的点 x、y、z 都是 NaN；指针只在回调内有效
+struct PointBand {
+    int row_begin = 0;
+    int row_end = 0;
+    int width = 0;
+    int num_valid = 0;
+    const float* x = nullptr;
+    const float* y = nullptr;
+    const float* z = nullptr;
+    const std::uint8_t* r = nullptr;        // 没有彩色输入时为空
+    const std::uint8_t* g = nullptr;
+    const std::uint8_t* b = nullptr;
+
+    int size() const { return (row_end - row_begin) * width; }
+};
+
+// 整帧点云（SoA），与深度图逐像素对应
+struct PointCloudSoA {
+    int width = 0;
+    int height = 0;
+    int num_valid = 0;
+    std::vector<float> x, y, z;
+    std::vector<std::uint8_t> r, g, b;
+};
+
+/*
+RGB-D 深度图反投影成点云（对应 SLAM/readme.md 中的 RGB-D 数据：RGB 图像和深度图的结合）
+
+    1. 每个像素在 z = 1 平面上的射线 (ray_x, ray_y) 在构造时算好，之后每帧只剩 x = z * ray_x、y = z * ray_y；
+       也可以直接传入射线表（例如带畸变相机的去畸变查找表）；
+    2. 深度图和彩色图按行跨度就地读取（Eigen::Map 包装原始缓冲区，参考 Eigen/code04.cpp demo05），不拷贝；
+       AVX2 下一次处理 8 个像素（16 位深度 -> 浮点 -> 范围检查），彩色 RGB 交错格式用 pshufb 一次拆 16 个像素；
+    3. 图像按行带分给线程池，每个行带写进线程自己的缓冲区后立刻交给下游回调，整帧不需要先生成再拷贝一遍；
+       需要整帧点云时，行带直接写进 PointCloudSoA 的对应位置。
+深度图需已配准到彩色图（同分辨率、逐像素对应）。
+ */
+class RgbdBackProjector {
+public:
+    // 回调在线程池的各个线程上并发调用，thread_id 属于 [0, pool->size())，行带顺序不确定
+    using BandConsumer = std::function<void(const PointBand& band, int thread_id)>;
+
+    RgbdBackProjector(const PinholeCamera& camera, const RgbdOptions& options = RgbdOptions(),
+                      ThreadPool* pool = nullptr);
+    // ray_x、ray_y 各 width * height 个，行优先
+    RgbdBackProjector(int width, int height, std::vector<float> ray_x, std::vector<float> ray_y,
+                      const RgbdOptions& options = RgbdOptions(), ThreadPool* pool = nullptr);
+
+    // depth：16 位深度图；rgb：8 位 3 通道交错（R、G、B 顺序，OpenCV 的 BGR 只是 r、b 对调），可为空；
+    // 行跨度都以字节计
+    void process(const std::uint16_t* depth, int depth_stride, const std::uint8_t* rgb, int rgb_stride,
+                 const BandConsumer& consumer);
+    // 整帧输出，返回有效点数
+    int process(const std::uint16_t* depth, int depth_stride, const std::uint8_t* rgb, int rgb_stride,
+                PointCloudSoA& cloud);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const RgbdOptions& options() const { return options_; }
+
+private:
+    struct Workspace {
+        std::vector<float> x, y, z;
+        std::vector<std::uint8_t> r, g, b;
+    };
+
+    void allocateWorkspaces();
+    // 行 [row_begin, row_end) 写进以 x、y、z（和 r、g、b）为起点的连续缓冲区，返回有效点数
+    int processBand(const std::uint16_t* depth, int depth_stride, const std::uint8_t* rgb, int rgb_stride,
+                    int row_begin, int row_end, float* x, float* y, float* z,
+                    std::uint8_t* r, std::uint8_t* g, std::uint8_t* b) const;
+
+    int width_;
+    int height_;
+    RgbdOptions options_;
+    ThreadPool* pool_;
+    std::vector<float> ray_x_, ray_y_;
+    std::vector<Workspace> workspaces_;     // 每个线程一份，避免每帧分配
+};
+
+}  // namespace slam
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace slam {
+
+class ThreadPool;
+
+struct SgmOptions {
+    int max_disparity = 128;        // 视差范围 [0, max_disparity)；构造时向上取整到 32 的倍数（至少 32），
+                                    // 实际使用的值见 SgmStereo::options().max_disparity
+    int P1 = 10;                    // 视差变化 1 的惩罚（census 代价范围 [0, 31]）
+    int P2 = 120;                   // 视差跳变的惩罚
+    bool lr_check = true;           // 左右一致性检验
+    int lr_max_diff = 1;            // 左右视差之差的容许值
+    bool subpixel = true;           // 抛物线拟合亚像素视差
+    int band_rows = 0;              // 每个任务处理的行数，<= 0 时按线程数均分
+    int band_overlap = 16;          // 行带上下额外聚合的行数，用于近似带外传入的路径代价
+};
+
+/*
+半全局匹配（SGM，Hirschmüller 2008）稠密视差（对应 SLAM/readme.md 中双目相机通过视差计算深度）
+
+    1. 代价：9x7 中心对称 census（31 位），代价为 Hamming 距离，AVX2 下 pshufb 查表一次算 8 个视差，
+       右图 census 逆序存放，使同一像素的全部视差在内存中连续；
+    2. 聚合：8 个方向，代价 8 位、路径值和总和 16 位，AVX2 一次处理 16 个视差，饱和加法避免溢出；
+       前向一遍（左、左上、上、右上）+ 后向一遍（右、右下、下、左下），只保留上一行的路径值，
+       同一遍的 4 个方向在一个循环里更新，共用一次代价加载，总和只读写一次；
+    3. 并行：图像按行带分给线程池，每个行带向上、向下各多聚合 band_overlap 行作为预热，
+       近似从带外传入的竖直和斜向路径（P2 使路径代价很快忘记起点，十几行的预热就足够）；
+       线程池只有一个线程时整幅图像是一个行带，结果与标准 SGM 完全一致；
+    4. 视差选择：胜者为王，右图视差由同一份聚合代价沿对角线取最小得到（不需要再聚合一次），
+       做左右一致性检验和抛物线亚像素拟合。
+无效视差（census 边界、左右不一致）输出 kInvalidDisparity。
+ */
+class SgmStereo {
+public:
+    static constexpr float kInvalidDisparity = -1.0f;
+
+    SgmStereo(int width, int height, const SgmOptions& options = SgmOptions(), ThreadPool* pool = nullptr);
+    ~SgmStereo();
+
+    // left、right 是校正后的 8 位灰度图，行跨度 stride 字节；disparity 输出 width * height 个浮点视差（左图）
+    void compute(const std::uint8_t* left, const std::uint8_t* right, int stride, float* disparity);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    // 调整后的参数（max_disparity 取整、band_overlap 截到非负）
+    const SgmOptions& options() const { return options_; }
+
+private:
+    struct Workspace;
+
+    void processBand(int row_begin, int row_end, Workspace& ws, float* disparity) const;
+
+    int width_;
+    int height_;
+    SgmOptions options_;
+    ThreadPool* pool_;
+    int band_rows_;
+    std::vector<std::uint32_t> census_left_, census_right_;
+    std::vector<Workspace> workspaces_;     // 每个线程一份，避免每帧分配
+};
+
+}  // namespace slam
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "frontend/essential_ransac.h"
+
+namespace slam {
+
+class ThreadPool;
+
+struct TwoViewModelOptions {
+    double sigma = 1.0;             // 特征点位置的标准差（像素）
+    int max_iterations = 200;       // 两个模型共用的最小集个数
+    double confidence = 0.99;       // 各自按内点率提前结束
+    double homography_ratio = 0.40; // R_H = S_H / (S_H + S_F) 超过它时选单应（ORB-SLAM2 的取值）
+    std::uint32_t seed = 0;
+};
+
+enum class TwoViewModel { kNone, kHomography, kFundamental };
+
+// 各阶段耗时（毫秒）；单应和基础矩阵在不同线程上同时运行，多线程时 total 小于各阶段之和
+struct TwoViewTiming {
+    double normalize_ms = 0.0;
+    double homography_ms = 0.0;
+    double fundamental_ms = 0.0;
+    double select_ms = 0.0;
+    double total_ms = 0.0;
+};
+
+struct TwoViewModelResult {
+    TwoViewModel model = TwoViewModel::kNone;
+    Eigen::Matrix3d H_21 = Eigen::Matrix3d::Identity();   // x2 ~ H_21 * x1（像素坐标）
+    Eigen::Matrix3d F_21 = Eigen::Matrix3d::Zero();       // x2^T F_21 x1 = 0（像素坐标）
+    double score_h = 0.0;
+    double score_f = 0.0;
+    double ratio_h = 0.0;
+    std::vector<char> inliers_h, inliers_f;
+    int num_inliers_h = 0;
+    int num_inliers_f = 0;
+    int iterations_h = 0;
+    int iterations_f = 0;
+    TwoViewTiming timing;
+};
+
+/*
+单应 / 基础矩阵模型选择（对应 SLAM/readme.md 2.5 位姿估计：平面或视差小的场景用单应，否则用基础矩阵）
+
+两个 RANSAC 先后运行会让初始化时间翻倍，这里：
+    1. 两帧的点只做一次 Hartley 归一化，最小集（8 个点）也只生成一次，两个模型共用；
+    2. 单应（归一化 DLT）和基础矩阵（8 点法 + 秩 2 约束）作为两个任务交给线程池同时运行；
+    3. 打分用同一份补齐的 SoA 像素坐标按块计算（定长 Eigen 数组）：单应用双向对称转移误差，
+       基础矩阵用 Sampson 误差，都按 ORB-SLAM 的方式把阈值内的 (阈值 - χ²) 累加为得分；
+    4. R_H = S_H / (S_H + S_F) > homography_ratio 时选单应，否则选基础矩阵。
+对应点使用像素坐标（去畸变后），PROSAC 不适用于这里的固定最小集，采样是均匀的。
+ */
+class TwoViewModelSelector {
+public:
+    explicit TwoViewModelSelector(const TwoViewModelOptions& options = TwoViewModelOptions(),
+                                  ThreadPool* pool = nullptr);
+
+    bool select(const TwoViewCorrespondences& pixels, TwoViewModelResult& result);
+
+    const TwoViewModelOptions& options() const { return options_; }
+
+private:
+    TwoViewModelOptions options_;
+    ThreadPool* pool_;
+};
+
+}  // namespace slam
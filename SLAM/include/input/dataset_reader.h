@@ -0,0 +1,147 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "input/image_decoder.h"
+#include "input/imu_buffer.h"
+#include "utils/mapped_file.h"
+
+namespace slam {
+
+class ThreadPool;
+
+enum class DatasetFormat { kNone, kEuRoC, kTumRgbd, kPack };
+
+// 合并后的传感器事件流中的一项：index 是 IMU 样本下标或图像帧下标
+struct DatasetEvent {
+    enum Type { kImu, kImage };
+    Type type = kImu;
+    std::int64_t t_ns = 0;
+    int index = -1;
+};
+
+// 不持有像素的图像视图（像素在 Image 里或直接在 pack 文件的映射里）
+struct ImageView {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    int bytes_per_channel = 1;
+    const std::uint8_t* data = nullptr;
+
+    int stride() const { return width * channels * bytes_per_channel; }
+    bool empty() const { return data == nullptr; }
+};
+
+// 一帧图像：EuRoC 是 cam0 / cam1，TUM 是 RGB / 深度；单目时只有 images[0]
+struct DatasetFrame {
+    std::int64_t t_ns = 0;
+    int index = -1;
+    int num_images = 0;
+    ImageView images[2];
+    // 解码出来的像素，和预取缓存共享；pack 格式为空（视图直接指向映射，reader 关闭前有效）
+    std::shared_ptr<const std::vector<Image>> storage;
+};
+
+struct DatasetOptions {
+    int prefetch = 16;              // 预取窗口：当前帧之后最多提前解码多少帧，0 关闭预取
+    int decode_threads = 0;         // 自带解码线程池的线程数（pool 为空时使用），<= 0 取 hardware_concurrency
+    bool second_image = true;       // 是否读 cam1 / 深度图
+    double tum_max_dt = 0.02;       // TUM 的 RGB 与深度图关联时允许的最大时间差（秒）
+};
+
+/*
+数据集回放（对应 SLAM/readme.md 1 Input Data：单目 / 双目 / RGB-D / IMU 数据）
+
+回归测试把同一批 EuRoC / TUM 序列回放成千上万次，时间主要花在读文件和解 PNG 上：
+    1. 索引文件（EuRoC 的 cam0/cam1/imu0 data.csv，TUM 的 rgb.txt / depth.txt / accelerometer.txt）
+       直接 mmap 后原地解析，不经过 iostream；EuRoC 的 cam1 按相同纳秒时间戳和 cam0 配对，
+       TUM 的深度图按最小时间差一对一贪心关联（和官方 associate.py 相同的规则）；
+    2. next() 把 IMU 和图像按时间戳归并成一个事件流，时间相同时 IMU 在前，
+       于是处理某帧图像时到该时刻为止的 IMU 都已经给出；
+    3. 图像由后台线程在 [当前帧, 当前帧 + prefetch) 窗口里按批交给线程池解码（图像文件也是 mmap 读），
+       frame(i) 命中时直接取走解码好的像素；窗口外的随机访问在调用线程上同步解码；
+    4. writePack 把整个序列转成一个 pack 文件（IMU 表、帧表、64 字节对齐的原始像素），
+       之后 open 这个文件回放：不用解码，frame() 返回的视图直接指向映射的页面，回放速度只受磁盘 / 页缓存限制。
+输出只取决于数据本身（解码和事件顺序都是确定的），和预取窗口、线程数、调度无关，每次回放完全相同。
+pool 非空时由 reader 的预取线程独占使用（ThreadPool 不能被两个线程同时调用 parallelFor）。
+ */
+class DatasetReader {
+public:
+    explicit DatasetReader(const DatasetOptions& options = DatasetOptions(), ThreadPool* pool = nullptr);
+    ~DatasetReader();
+
+    DatasetReader(const DatasetReader&) = delete;
+    DatasetReader& operator=(const DatasetReader&) = delete;
+
+    // path：EuRoC 序列目录（含 mav0/）或 mav0 本身、TUM 序列目录（含 rgb.txt）、或 pack 文件
+    bool open(const std::string& path);
+    void close();
+
+    DatasetFormat format() const { return format_; }
+    int numFrames() const { return static_cast<int>(frame_times_.size()); }
+    int imagesPerFrame() const { return images_per_frame_; }
+    std::int64_t frameTime(int i) const { return frame_times_[i]; }
+    const std::vector<ImuSample>& imu() const { return imu_; }
+
+    // 合并事件流的下一项，结束时返回 false
+    bool next(DatasetEvent& event);
+    // 回到事件流开头
+    void reset();
+
+    // 第 i 帧的图像；同时把预取窗口移到 i 之后。解码失败返回 false
+    bool frame(int i, DatasetFrame& out);
+
+    // 把 reader 打开的序列写成 pack 文件
+    static bool writePack(DatasetReader& reader, const std::string& path);
+
+private:
+    struct Slot {
+        int index = -1;
+        bool ready = false;
+        bool ok = false;
+        std::shared_ptr<const std::vector<Image>> images;
+    };
+
+    bool openEuRoC(const std::string& root);
+    bool openTum(const std::string& root);
+    bool openPack(const std::string& path);
+
+    bool decodeFrame(int i, std::vector<Image>& images) const;
+    void prefetchLoop();
+    void startPrefetch();
+    void stopPrefetch();
+
+    DatasetOptions options_;
+    ThreadPool* pool_ = nullptr;
+    std::unique_ptr<ThreadPool> owned_pool_;
+
+    DatasetFormat format_ = DatasetFormat::kNone;
+    int images_per_frame_ = 0;
+    std::vector<ImuSample> imu_;
+    std::vector<std::int64_t> frame_times_;
+    std::vector<std::string> image_paths_;      // frame * images_per_frame + k
+    std::vector<ImageView> pack_images_;        // 同上，pack 格式
+    MappedFile pack_file_;
+
+    int next_imu_ = 0;
+    int next_frame_ = 0;
+
+    // 预取：slots_[i % prefetch] 存放窗口里的第 i 帧
+    std::thread prefetch_thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;          // 窗口移动 / 退出 → 预取线程
+    std::condition_variable ready_;         // 一批解码完成 → frame()
+    std::vector<Slot> slots_;
+    int window_begin_ = 0;
+    bool stop_ = false;
+};
+
+}  // namespace slam
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace slam {
+
+// 解码后的图像：行主序、行间无填充；16 位通道按本机字节序存放
+struct Image {
+    int width = 0;
+    int height = 0;
+    int channels = 0;               // 1 灰度（深度图），2 灰度 + alpha，3 RGB，4 RGBA
+    int bytes_per_channel = 1;      // 1 或 2
+    std::vector<std::uint8_t> data;
+
+    int stride() const { return width * channels * bytes_per_channel; }
+    bool empty() const { return data.empty(); }
+};
+
+/*
+数据集图像解码（对应 SLAM/readme.md 1 Input Data）
+
+EuRoC 的灰度图、TUM 的 RGB 图和 16 位深度图都是 PNG，这里自带一个只依赖标准库的解码器：
+    1. inflate：10 位查表解 Huffman 码（更长的码退回逐位规范码解码），64 位位缓冲，
+       输出直接写进按图像大小预分配的缓冲区；
+    2. 支持 8 / 16 位的灰度、灰度 + alpha、RGB、RGBA 和 8 位调色板图（展开成 RGB），不支持隔行扫描；
+    3. 不校验 CRC / Adler-32（回放的是本地数据集，校验的开销比解码本身还大）。
+也支持二进制 PGM / PPM（P5 / P6），方便生成测试数据。
+ */
+bool decodePng(const std::uint8_t* data, std::size_t size, Image& image);
+bool decodePnm(const std::uint8_t* data, std::size_t size, Image& image);
+// 按文件头自动选择格式
+bool decodeImage(const std::uint8_t* data, std::size_t size, Image& image);
+
+}  // namespace slam
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <Eigen/Dense>
+
+namespace slam {
+
+// 时间戳一律用整数纳秒：EuRoC 本来就是纳秒，TUM 的小数秒按十进制精确换算，合并排序时不会因浮点误差乱序
+struct ImuSample {
+    std::int64_t t_ns = 0;
+    Eigen::Vector3d gyro = Eigen::Vector3d::Zero();     // rad/s
+    Eigen::Vector3d acc = Eigen::Vector3d::Zero();      // m/s^2
+
+    double time() const { return t_ns * 1e-9; }
+};
+
+class ImuBuffer;
+
+// 环形缓冲区里一段连续的样本：不拷贝整段，按下标访问时才从环形数组里原子地拷出一个样本
+struct ImuSpan {
+    const ImuBuffer* buffer = nullptr;
+    std::uint64_t begin_seq = 0;        // 第一个样本的序号，ImuBuffer::valid 用
+    int count = 0;
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    inline ImuSample operator[](int i) const;
+
+    template <typename Fn>
+    void forEach(const Fn& fn) const {
+        for (int i = 0; i < count; ++i) fn((*this)[i]);
+    }
+};
+
+// 预积分区间 [t0, t1]：两端是插值出来的样本，中间是缓冲区里的原样本
+struct ImuInterval {
+    ImuSample start;
+    ImuSpan inner;          // t0 < t < t1 的样本
+    ImuSample end;
+};
+
+/*
+按时间戳索引的 IMU 环形缓冲区（对应 SLAM/readme.md 的 IMU 数据：加速度、角速度）
+
+驱动线程写入，前端（帧间预测）和后端（预积分）同时读取：
+    1. 定长环形数组，单写者多读者、无锁：和 seqlock 一样，写者先登记要覆盖的序号，再写数据，再发布，
+       读者从不阻塞写者，写者也从不等读者；样本按 64 位字存成 relaxed 原子量，写者逐字写入，
+       读者逐字拷到局部变量后再用 acquire fence + 序号检查确认没有被覆盖，读写同一个槽不是数据竞争
+       （x86 上 relaxed 原子读写就是普通的 mov，没有额外开销）；
+    2. 查询返回指向环形数组的 ImuSpan，不拷贝整段；读者用完后调用 valid(span) 确认这段没有被
+       写者覆盖（容量按 IMU 频率留出几分钟的余量，正常情况下不会失败，失败就重新查询），
+       在那之前从 span 里读出的样本都可能是覆盖后的值；
+    3. 每个读者持有一个 Cursor，记录上次查到的位置：查询时间单调递增（预积分正是这样）时
+       从游标处向前倍增步长再二分，代价只和前进的样本数的对数有关，不会在整个历史上搜索；
+    4. 区间两端按相邻样本线性插值；interpolate 的批量版本对一组递增的时间戳一次扫过。
+ */
+class ImuBuffer {
+public:
+    // 每个读者一个，初始为空即可；缓冲区绕回覆盖了游标位置时自动从最旧的样本重新开始
+    struct Cursor {
+        std::uint64_t seq = 0;
+    };
+
+    // capacity 向上取 2 的幂
+    explicit ImuBuffer(int capacity = 1 << 16);
+
+    ImuBuffer(const ImuBuffer&) = delete;
+    ImuBuffer& operator=(const ImuBuffer&) = delete;
+
+    // 只能由一个线程调用；时间戳必须严格递增，否则丢弃并返回 false
+    bool push(const ImuSample& sample);
+
+    int capacity() const { return static_cast<int>(mask_ + 1); }
+    // 已写入的样本总数（包括已被覆盖的）
+    std::uint64_t pushed() const { return head_.load(std::memory_order_acquire); }
+    // 缓冲区里最旧 / 最新样本的时间，没有样本时返回 false
+    bool timeRange(std::int64_t& oldest, std::int64_t& latest) const;
+
+    // t 处的插值样本；t 不在 [最旧, 最新] 内返回 false
+    bool interpolate(std::int64_t t, ImuSample& out, Cursor& cursor) const;
+    // times 递增；返回成功插值的个数（遇到第一个不在范围内的时间就停止）
+    int interpolate(const std::int64_t* times, int n, ImuSample* out, Cursor& cursor) const;
+
+    // t0 <= t <= t1 的原样本
+    bool range(std::int64_t t0, std::int64_t t1, ImuSpan& span, Cursor& cursor) const;
+    // 预积分区间，要求 t0 < t1 且都在 [最旧, 最新] 内
+    bool interval(std::int64_t t0, std::int64_t t1, ImuInterval& out, Cursor& cursor) const;
+
+    // 读者用完 span 后检查它是否仍然完整（没有被写者覆盖）
+    bool valid(const ImuSpan& span) const;
+
+private:
+    friend struct ImuSpan;
+
+    // 一个样本占的 64 位字数：t_ns、gyro、acc
+    static constexpr int kSampleWords = 7;
+    struct Slot {
+        std::atomic<std::uint64_t> words[kSampleWords];
+    };
+
+    // 序号 seq 处的样本 / 时间戳，逐字 relaxed 读出；是否被覆盖由调用方随后用 intact 确认
+    ImuSample at(std::uint64_t seq) const;
+    std::int64_t timeAt(std::uint64_t seq) const;
+    // 当前可安全读取的序号范围 [begin, end)
+    void readable(std::uint64_t& begin, std::uint64_t& end) const;
+    bool intact(std::uint64_t seq) const;
+    // [begin, end) 里第一个时间 >= t 的序号，从 hint 出发倍增步长查找
+    std::uint64_t lowerBound(std::int64_t t, std::uint64_t begin, std::uint64_t end, std::uint64_t hint) const;
+    ImuSpan makeSpan(std::uint64_t begin, std::uint64_t end) const;
+    bool interpolateAt(std::int64_t t, std::uint64_t begin, std::uint64_t end, ImuSample& out,
+                       std::uint64_t& seq) const;
+
+    std::unique_ptr<Slot[]> slots_;
+    std::uint64_t mask_;
+    std::int64_t last_t_ = 0;                   // 只有写者访问
+    alignas(64) std::atomic<std::uint64_t> head_{0};        // 已发布的样本数
+    alignas(64) std::atomic<std::uint64_t> reserved_{0};    // 正在写（或已写完）的样本数
+};
+
+ImuSample ImuSpan::operator[](int i) const { return buffer->at(begin_seq + static_cast<std::uint64_t>(i)); }
+
+}  // namespace slam
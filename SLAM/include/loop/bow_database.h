@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "loop/vocabulary.h"
+
+namespace slam {
+
+class ThreadPool;
+
+struct BowQueryResult {
+    int image = -1;
+    float score = 0.f;          // L1 得分 1 - |v - w|_1 / 2，范围 [0, 1]
+    int common_words = 0;       // 共同单词数（ORB-SLAM 用它先筛一遍候选）
+};
+
+/*
+词袋倒排索引（对应 SLAM/readme.md 4 回环检测：词袋模型）
+
+    1. 每个单词一条倒排表，图像 id 只增不减，按差分 + varint 编码，权重量化成 16 位
+       （L1 归一化后的权重在 [0, 1] 内，量化误差 < 1e-5），每项通常只占 3 个字节；
+    2. 对 L1 归一化的向量，L1 得分 1 - |v - w|_1 / 2 等于共同单词上 min(v_i, w_i) 之和，
+       所以只需要遍历查询向量中各单词的倒排表；
+    3. 查询的单词按倒排表字节数均衡分成若干任务交给线程池，每个线程累加到自己的稠密得分数组，
+       最后按图像区间并行归约并取前 max_results 个。
+图像 id 是 add 的返回值，从 0 开始连续编号；只支持追加。
+ */
+class BowDatabase {
+public:
+    explicit BowDatabase(int num_words, ThreadPool* pool = nullptr);
+
+    // 返回图像 id
+    int add(const BowVector& bow);
+
+    // 只考虑 id < max_image 的图像（回环检测时排除最近的关键帧），< 0 表示全部；
+    // 结果按得分降序，得分 <= min_score 的不输出
+    void query(const BowVector& bow, int max_results, std::vector<BowQueryResult>& results,
+               int max_image = -1, float min_score = 0.f);
+
+    int size() const { return num_images_; }
+    int numWords() const { return static_cast<int>(postings_.size()); }
+    // 倒排表占用的字节数
+    std::size_t postingBytes() const;
+
+private:
+    struct PostingList {
+        std::vector<std::uint8_t> bytes;
+        int last_image = -1;
+    };
+
+    ThreadPool* pool_;
+    std::vector<PostingList> postings_;
+    int num_images_ = 0;
+    // 每个线程的稠密得分和共同单词数，避免每次查询分配
+    std::vector<std::vector<float>> scores_;
+    std::vector<std::vector<std::uint16_t>> common_;
+};
+
+}  // namespace slam
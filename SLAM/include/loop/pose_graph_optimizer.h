@@ -0,0 +1,104 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace slam {
+
+class ThreadPool;
+
+// 位姿图顶点（关键帧）：P_w = s * R_wc * P_c + t_wc，SE(3) 时 s 固定为 1
+struct PoseGraphVertex {
+    Eigen::Matrix3d R_wc = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d t_wc = Eigen::Vector3d::Zero();
+    double s = 1.0;
+    bool fixed = false;
+};
+
+// 相对位姿约束 Z_ij ≈ S_i^-1 * S_j（回环边的 s_ij 来自 Sim(3) 求解，里程计边为 1）
+// 残差 E = Z_ij^-1 * S_i^-1 * S_j 表示为 [t_E, Log(R_E), ln s_E]，信息矩阵按同样的顺序；
+// SE(3) 时只用左上 6x6
+struct PoseGraphEdge {
+    int i = -1;
+    int j = -1;
+    Eigen::Matrix3d R_ij = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d t_ij = Eigen::Vector3d::Zero();
+    double s_ij = 1.0;
+    Eigen::Matrix<double, 7, 7> information = Eigen::Matrix<double, 7, 7>::Identity();
+};
+
+enum class PoseGraphType { kSE3, kSim3 };
+
+struct PoseGraphOptions {
+    PoseGraphType type = PoseGraphType::kSE3;
+    int max_iterations = 10;
+    double function_tolerance = 1e-6;   // χ² 相对下降小于它时停止
+    double initial_lambda = 1e-5;       // LM 阻尼（相对于 H 的对角线）
+    double time_budget_ms = 0.0;        // > 0 时单次 optimize 的时间预算，预计超出就不再开始新的迭代
+    int edges_per_task = 2048;
+    int columns_per_task = 512;
+};
+
+struct PoseGraphSummary {
+    bool converged = false;
+    bool budget_exhausted = false;      // 因 time_budget_ms 提前停止（未收敛，可以再次调用继续）
+    int iterations = 0;
+    double initial_chi2 = 0.0;
+    double final_chi2 = 0.0;
+    int num_variables = 0;              // 自由顶点数
+    long num_factor_blocks = 0;         // 分解后 L 的非零块数（含对角）
+    bool reused_symbolic = false;
+    // 各阶段累计耗时（毫秒）
+    double symbolic_ms = 0.0;
+    double linearize_ms = 0.0;
+    double factorize_ms = 0.0;
+    double solve_ms = 0.0;
+    double total_ms = 0.0;
+};
+
+/*
+SE(3) / Sim(3) 位姿图优化（对应 SLAM/readme.md 4 回环优化：Pose-graph 优化）
+
+    1. 每条边的残差和 Jacobian 是解析的一阶形式（右扰动 S ⊞ δ = S * (Exp(φ), ρ, e^σ)），
+       6x6 / 7x7 的 H 块按边并行计算，再按列并行累加进分块矩阵，每个位置只有一个任务写；
+    2. 符号分析在块图（顶点数 × 顶点数，而不是 6n × 6n）上做：AMD 排序、消元树、L 的块结构、
+       基本超节点划分（非零结构相同的相邻列合并）、每条边写入位置的映射都只算一次；
+       图结构（边的端点和固定顶点）不变时跨调用复用；
+    3. 数值分解是超节点多波前 Cholesky：每个超节点组装自己的几列并加上子节点的更新矩阵，
+       对稠密波前矩阵做 LLT / TRSM / SYRK 后把更新矩阵留给父节点；单列超节点全部用定长块运算。
+       子节点只写自己的缓冲区，所以消元树拆成互不相交的子树交给线程池并行，
+       剩下靠近根的部分在调用线程上顺序完成；
+    4. Levenberg-Marquardt：数值分解失败或 χ² 上升时增大阻尼重新分解，符号分析不变；
+       time_budget_ms 限制单次调用的延迟，未收敛时下次调用从当前位姿继续（符号分析复用）。
+没有固定顶点时固定第 0 个顶点（规范自由度）。
+单核 2 GHz 上 5 万顶点的稀疏图（约 300 条回环）每次迭代约 100-160 ms（线性化、分解、求解约各占 1/3），
+500 ms 内能做 3-4 次迭代：初值接近时（回环检测后的增量修正）可以收敛，从纯里程计初值出发的完整优化不行，
+需要分几次调用；回环很密的图（上千条回环）分解的填充变多，单次迭代就在 200 ms 以上。
+ */
+class PoseGraphOptimizer {
+public:
+    explicit PoseGraphOptimizer(const PoseGraphOptions& options = PoseGraphOptions(), ThreadPool* pool = nullptr);
+    ~PoseGraphOptimizer();
+
+    // 优化 vertices（原地更新），返回 χ² 是否下降或已收敛
+    bool optimize(std::vector<PoseGraphVertex>& vertices, const std::vector<PoseGraphEdge>& edges,
+                  PoseGraphSummary* summary = nullptr);
+
+    const PoseGraphOptions& options() const { return options_; }
+
+private:
+    struct Symbolic;
+
+    template <int D>
+    bool optimizeImpl(std::vector<PoseGraphVertex>& vertices, const std::vector<PoseGraphEdge>& edges,
+                      PoseGraphSummary& summary);
+    void analyze(const std::vector<PoseGraphVertex>& vertices, const std::vector<PoseGraphEdge>& edges);
+
+    PoseGraphOptions options_;
+    ThreadPool* pool_;
+    std::unique_ptr<Symbolic> symbolic_;
+};
+
+}  // namespace slam
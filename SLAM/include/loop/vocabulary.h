@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frontend/feature_types.h"
+#include "utils/mapped_file.h"
+
+namespace slam {
+
+class ThreadPool;
+
+// 词袋向量的一项；BowVector 按单词 id 升序，权重为 TF-IDF 并做 L1 归一化
+struct BowEntry {
+    std::uint32_t word = 0;
+    float weight = 0.f;
+};
+using BowVector = std::vector<BowEntry>;
+
+struct VocabularyTrainOptions {
+    int branching = 10;         // k，最大 64
+    int levels = 6;             // L，ORB-SLAM 的词典为 k = 10、L = 6
+    int max_iterations = 10;    // 每个节点 k-majority 聚类的最大迭代次数
+    std::uint32_t seed = 0;
+};
+
+/*
+词袋树词典（对应 SLAM/readme.md 4 回环检测：词袋模型）
+
+DBoW2 的词典是指针连接的节点，每下降一层都可能是一次缓存缺失，文本格式的词典加载要几十秒。这里：
+    1. 节点按层序（BFS）存放在一段连续数组里，同一个节点的子节点连续，第 i 个节点的子节点为
+       [first_child[i], first_child[i] + num_children[i])，没有子节点的就是单词；
+    2. 下降时一次算出当前节点全部子节点的 Hamming 距离（hammingDistances，AVX-512 / AVX2），
+       k 个描述子 k * 32 字节，通常只占几条缓存行；
+    3. 二进制文件各段按 64 字节对齐，load 直接 mmap，描述子、子节点表、IDF 都指向映射的内存，
+       不解析、不拷贝，加载是毫秒级的，页面在第一次访问时才读入；
+    4. 可以从 ORB-SLAM / DBoW2 的文本词典转换（loadText + save），也可以用 k-majority 层次聚类训练，
+       每一层的节点互相独立，交给线程池并行聚类。
+文件按本机字节序（小端）保存。
+ */
+class Vocabulary {
+public:
+    Vocabulary() = default;
+
+    Vocabulary(const Vocabulary&) = delete;
+    Vocabulary& operator=(const Vocabulary&) = delete;
+
+    // images[i] 是第 i 幅训练图像的描述子，用来统计 IDF = log(N / n_i)
+    bool train(const std::vector<std::vector<Descriptor>>& images,
+               const VocabularyTrainOptions& options = VocabularyTrainOptions(), ThreadPool* pool = nullptr);
+
+    // ORB-SLAM / DBoW2 文本格式（第一行 "k L scoring weighting"，之后每行 "parent is_leaf d0 ... d31 weight"）
+    bool loadText(const std::string& path);
+
+    // 二进制格式，load 使用 mmap
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    bool empty() const { return num_nodes_ == 0; }
+    int branching() const { return branching_; }
+    int levels() const { return levels_; }
+    int numNodes() const { return num_nodes_; }
+    int numWords() const { return num_words_; }
+    float idf(std::uint32_t word) const { return idf_[word]; }
+
+    // 从根节点逐层下降到单词
+    std::uint32_t wordId(const Descriptor& descriptor) const;
+
+    // 一幅图像的词袋向量；word_ids 非空时输出每个描述子的单词（用于按单词分组匹配）；
+    // pool 非空时描述子分块并行下降
+    void transform(const Descriptor* descriptors, int n, BowVector& bow, std::uint32_t* word_ids = nullptr,
+                   ThreadPool* pool = nullptr) const;
+    void transform(const std::vector<Descriptor>& descriptors, BowVector& bow) const {
+        transform(descriptors.data(), static_cast<int>(descriptors.size()), bow);
+    }
+
+private:
+    void clear();
+    // 由自有数组设置各段指针
+    void bindOwned();
+
+    int branching_ = 0;
+    int levels_ = 0;
+    int num_nodes_ = 0;     // 包括根节点（根节点的描述子不使用）
+    int num_words_ = 0;
+
+    // 各段数据：指向 owned_* 或映射的文件
+    const Descriptor* descriptors_ = nullptr;
+    const std::uint32_t* first_child_ = nullptr;
+    const std::uint32_t* num_children_ = nullptr;
+    const std::uint32_t* word_of_node_ = nullptr;  // 内部节点为 kNotWord
+    const float* idf_ = nullptr;
+
+    std::vector<Descriptor> owned_descriptors_;
+    std::vector<std::uint32_t> owned_first_child_, owned_num_children_, owned_word_of_node_;
+    std::vector<float> owned_idf_;
+    MappedFile file_;
+};
+
+}  // namespace slam
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "frontend/feature_types.h"
+#include "loop/vocabulary.h"
+#include "utils/epoch_reclaimer.h"
+
+namespace slam {
+
+// 关键帧的不变部分：插入后只读，由数据库统一分配 id
+struct KeyFrame {
+    int id = -1;
+    double timestamp = 0.0;
+    std::vector<KeyPoint> keypoints;
+    std::vector<Descriptor> descriptors;
+    std::vector<int> map_points;        // 每个特征观测到的地图点 id，-1 表示没有
+    BowVector bow;
+};
+
+// 关键帧位姿 T_cw（局部 BA、回环校正会频繁更新，单独存放）
+struct KeyFramePose {
+    Eigen::Matrix3d R_cw = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d t_cw = Eigen::Vector3d::Zero();
+};
+
+// 共视边：weight 为共同观测的地图点数
+struct CovisibilityEdge {
+    int keyframe = -1;
+    int weight = 0;
+};
+
+// 一段连续的共视边（按权重降序），只在读临界区内有效
+struct CovisibilitySpan {
+    const CovisibilityEdge* data = nullptr;
+    int size = 0;
+
+    const CovisibilityEdge* begin() const { return data; }
+    const CovisibilityEdge* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+    const CovisibilityEdge& operator[](int i) const { return data[i]; }
+};
+
+/*
+并发关键帧库 + 共视图（对应 SLAM/readme.md 6 系统管理：关键帧管理）
+
+    1. 跟踪、局部建图、回环线程同时读关键帧和共视图：读者只在进入临界区时登记 epoch，
+       之后全部是原子指针读取，不加锁、不会被写者阻塞；
+    2. 写者（插入、删除、更新位姿、更新共视关系）之间用一把互斥锁串行，采用写时复制：
+       构造新对象后原子替换指针，旧对象交给 EpochReclaimer，确认没有读者还能看到时才释放；
+    3. 关键帧按 id 存放在分块表里，块只增不搬，读者按 id 两次指针跳转即可找到；
+    4. 每个关键帧的共视边存成一段连续数组并按权重降序排好，取前 N 个或权重不低于阈值的邻居
+       都只是返回一个前缀，不需要排序或拷贝。更新一条边时只重建涉及的两个关键帧的数组。
+用法：
+    auto guard = db.read();
+    const KeyFrame* kf = db.keyframe(id);           // guard 析构前有效
+    for (const CovisibilityEdge& e : db.bestCovisibles(id, 10)) ...
+ */
+class KeyFrameDatabase {
+public:
+    static constexpr int kChunkBits = 10;
+    static constexpr int kChunkSize = 1 << kChunkBits;
+    static constexpr int kMaxChunks = 4096;     // 最多约 400 万个关键帧
+
+    KeyFrameDatabase() = default;
+    ~KeyFrameDatabase();
+
+    KeyFrameDatabase(const KeyFrameDatabase&) = delete;
+    KeyFrameDatabase& operator=(const KeyFrameDatabase&) = delete;
+
+    // ---- 读者（任意线程，非阻塞）----
+    EpochReclaimer::Guard read() { return reclaimer_.enter(); }
+
+    // 以下指针 / 区间只在 read() 返回的 guard 存活期间有效；id 不存在或已删除时返回空
+    const KeyFrame* keyframe(int id) const;
+    const KeyFramePose* pose(int id) const;
+    // 全部共视关键帧，按权重降序
+    CovisibilitySpan covisibles(int id) const;
+    // 权重最大的前 n 个
+    CovisibilitySpan bestCovisibles(int id, int n) const;
+    // 权重 >= min_weight 的全部
+    CovisibilitySpan covisiblesAbove(int id, int min_weight) const;
+    // 两个关键帧之间的权重，没有边时为 0
+    int weight(int id, int other) const;
+
+    // 已分配过的 id 都小于 idBound()（其中可能有已删除的）
+    int idBound() const { return next_id_.load(std::memory_order_acquire); }
+    int size() const { return size_.load(std::memory_order_relaxed); }
+
+    // ---- 写者（内部串行）----
+    // 返回分配的 id（同时写入关键帧的 id 字段）
+    int add(KeyFrame keyframe, const KeyFramePose& pose);
+    // 删除关键帧并从所有邻居的共视边中去掉它
+    bool erase(int id);
+    bool setPose(int id, const KeyFramePose& pose);
+    // 批量更新（回环校正后更新所有关键帧），只推进一次回收
+    void setPoses(const std::vector<int>& ids, const std::vector<KeyFramePose>& poses);
+    // 用 edges 替换 id 的全部共视边（weight <= 0 的忽略），邻居一侧的边同步更新
+    bool updateConnections(int id, const std::vector<CovisibilityEdge>& edges);
+
+    // 等待释放的旧对象数（统计用）
+    std::size_t pendingReclaim() const { return reclaimer_.pending(); }
+
+private:
+    using EdgeList = std::vector<CovisibilityEdge>;
+
+    struct Entry {
+        std::atomic<const KeyFrame*> keyframe{nullptr};
+        std::atomic<const KeyFramePose*> pose{nullptr};
+        std::atomic<const EdgeList*> edges{nullptr};
+    };
+    struct Chunk {
+        Entry entries[kChunkSize];
+    };
+
+    const Entry* entry(int id) const;
+    Entry* entryForWrite(int id);
+    // 在 id 的边表中把 other 的权重改为 weight（0 表示删除），保持降序
+    void setEdge(int id, int other, int weight);
+    void publishEdges(Entry* e, EdgeList* edges);
+
+    std::array<std::atomic<Chunk*>, kMaxChunks> chunks_{};
+    std::atomic<int> next_id_{0};
+    std::atomic<int> size_{0};
+    std::mutex write_mutex_;
+    EpochReclaimer reclaimer_;
+};
+
+}  // namespace slam
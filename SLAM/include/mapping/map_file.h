@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "frontend/feature_types.h"
+#include "mapping/keyframe_database.h"
+#include "utils/mapped_file.h"
+#include "utils/rigid_pose.h"
+
+namespace slam {
+
+// 地图点的一次观测：关键帧在文件里的下标和该关键帧的特征下标
+struct MapObservation {
+    std::int32_t keyframe = -1;
+    std::int32_t feature = -1;
+};
+
+// 空间区域（边长 region_size 的立方体网格单元）：区域内的关键帧（按相机中心）和地图点在文件里各是一段连续下标
+struct MapRegion {
+    std::int32_t cell[3] = {0, 0, 0};
+    std::uint32_t first_keyframe = 0;
+    std::uint32_t num_keyframes = 0;
+    std::uint32_t first_point = 0;
+    std::uint32_t num_points = 0;
+};
+
+// id 索引项（文件里按 id 排序）：id → 文件内下标
+struct MapIdIndex {
+    std::int32_t id = -1;
+    std::int32_t index = -1;
+};
+
+// 一个地图点的全部观测（指向映射的内存）
+struct ObservationSpan {
+    const MapObservation* data = nullptr;
+    int size = 0;
+
+    const MapObservation* begin() const { return data; }
+    const MapObservation* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+    const MapObservation& operator[](int i) const { return data[i]; }
+};
+
+/*
+地图保存（对应 SLAM/readme.md 5 地图构建、6 系统管理：全局地图的关键帧和地图点）
+
+收集关键帧（位姿、特征点、描述子、特征对应的地图点、共视边）和地图点（位置、代表描述子），一次写成 map 文件：
+    1. 关键帧按相机中心、地图点按位置所在的区域排序，同一区域的数据在每一段里都连续，
+       文件里不再保存 id 之间的引用，全部换成文件内的下标（特征 → 地图点、观测 → 关键帧、共视边 → 关键帧）；
+    2. 关键帧 id、地图点 id 各有一张按 id 排序的索引，读回时可以按原来的 id 查找；
+    3. 共视边按权重降序保存，和 KeyFrameDatabase 一样取前 N 个邻居只是一个前缀。
+找不到的引用（特征指向没保存的地图点、共视边指向没保存的关键帧）写成 -1 / 丢弃；id 重复时保留先加入的。
+词袋向量不保存，读回后由描述子和词典重新计算。
+ */
+class MapWriter {
+public:
+    explicit MapWriter(double region_size = 50.0);
+
+    // T_cw 是世界到相机的位姿；covisibles 里的 keyframe 是关键帧 id
+    void addKeyFrame(const KeyFrame& keyframe, const RigidPosed& T_cw,
+                     const std::vector<CovisibilityEdge>& covisibles = std::vector<CovisibilityEdge>());
+    // 数据库里现有的全部关键帧（位姿、共视边一起）
+    void addKeyFrames(KeyFrameDatabase& database);
+    void addMapPoint(int id, const Eigen::Vector3d& position, const Descriptor& descriptor);
+
+    int numKeyFrames() const { return static_cast<int>(keyframes_.size()); }
+    int numMapPoints() const { return static_cast<int>(points_.size()); }
+    void clear();
+
+    // 先写 path + ".tmp" 再改名成 path；写失败或计数超过 int 范围时返回 false，原有的 path 不变
+    bool save(const std::string& path) const;
+
+private:
+    struct PendingKeyFrame {
+        int id = -1;
+        double timestamp = 0.0;
+        RigidPosed T_cw;
+        std::vector<KeyPoint> keypoints;
+        std::vector<Descriptor> descriptors;
+        std::vector<int> map_points;
+        std::vector<CovisibilityEdge> covisibles;
+    };
+    struct PendingPoint {
+        int id = -1;
+        Eigen::Vector3d position = Eigen::Vector3d::Zero();
+        Descriptor descriptor;
+    };
+
+    double region_size_;
+    std::vector<PendingKeyFrame> keyframes_;
+    std::vector<PendingPoint> points_;
+};
+
+/*
+map 文件的零拷贝读取（重定位启动时直接加载整张地图）
+
+文件是带版本号的平坦二进制格式：文件头之后是 64 字节对齐的各段（关键帧 id / 时间 / 位姿、
+特征偏移、特征点、描述子、特征对应的地图点、地图点 id / 位置 / 描述子、观测偏移、观测、共视偏移、
+共视边、两张 id 索引、区域表），按本机字节序（小端）保存。
+    1. open 是一次 mmap 加一遍下标校验：检查文件头、各段的对齐和边界，CSR 偏移表单调、
+       特征 → 地图点、观测、共视边、id 索引、区域表里的下标都在范围内（只读这几段，每个特征 4 字节、
+       每次观测 8 字节）；特征点、描述子、位姿、坐标不解析，所有访问函数返回指向映射的指针，不拷贝；
+    2. 映射设为随机访问（关闭预读），页面只在第一次访问时读入：没去过的区域永远不会被读进内存；
+    3. 进入一个区域之前可以用 regionsNear + prefetchRegion 让内核在后台提前读入这些区域在各段里的页面，
+       之后跟踪线程访问时不会阻塞在缺页上。
+所有下标都是文件内下标（0 ~ numKeyFrames() - 1 等），id 通过 keyFrameId / findKeyFrame 互相转换。
+ */
+class MapReader {
+public:
+    MapReader() = default;
+
+    MapReader(const MapReader&) = delete;
+    MapReader& operator=(const MapReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+
+    int numKeyFrames() const { return num_keyframes_; }
+    int numMapPoints() const { return num_points_; }
+    int numRegions() const { return num_regions_; }
+    double regionSize() const { return region_size_; }
+
+    // ---- 关键帧 ----
+    int keyFrameId(int k) const { return keyframe_ids_[k]; }
+    double timestamp(int k) const { return timestamps_[k]; }
+    const RigidPosed& pose(int k) const { return poses_[k]; }
+    int numFeatures(int k) const { return static_cast<int>(feature_offsets_[k + 1] - feature_offsets_[k]); }
+    const KeyPoint* keypoints(int k) const { return keypoints_ + feature_offsets_[k]; }
+    const Descriptor* descriptors(int k) const { return descriptors_ + feature_offsets_[k]; }
+    // 每个特征对应的地图点下标，-1 表示没有
+    const std::int32_t* featurePoints(int k) const { return feature_points_ + feature_offsets_[k]; }
+    // 共视边（keyframe 字段是文件内下标），按权重降序
+    CovisibilitySpan covisibles(int k) const;
+    CovisibilitySpan bestCovisibles(int k, int n) const;
+
+    // ---- 地图点 ----
+    int mapPointId(int p) const { return point_ids_[p]; }
+    const Eigen::Vector3d& position(int p) const { return positions_[p]; }
+    const Descriptor& pointDescriptor(int p) const { return point_descriptors_[p]; }
+    ObservationSpan observations(int p) const;
+
+    // id → 文件内下标，不存在返回 -1
+    int findKeyFrame(int id) const;
+    int findMapPoint(int id) const;
+
+    // ---- 区域 ----
+    const MapRegion& region(int r) const { return regions_[r]; }
+    // 与球 (center, radius) 相交的区域
+    void regionsNear(const Eigen::Vector3d& center, double radius, std::vector<int>& regions) const;
+    // 提示内核在后台读入区域 r 的全部数据（不阻塞）
+    void prefetchRegion(int r) const;
+
+private:
+    static int findId(const MapIdIndex* index, int n, int id);
+    // 提示读入 base 开始的 [first, first + count) 个 size 字节的元素
+    void willNeed(const void* base, std::size_t size, std::uint64_t first, std::uint64_t count) const;
+
+    MappedFile file_;
+    int num_keyframes_ = 0;
+    int num_points_ = 0;
+    int num_regions_ = 0;
+    double region_size_ = 0.0;
+
+    const std::int32_t* keyframe_ids_ = nullptr;
+    const double* timestamps_ = nullptr;
+    const RigidPosed* poses_ = nullptr;
+    const std::uint32_t* feature_offsets_ = nullptr;
+    const KeyPoint* keypoints_ = nullptr;
+    const Descriptor* descriptors_ = nullptr;
+    const std::int32_t* feature_points_ = nullptr;
+    const std::int32_t* point_ids_ = nullptr;
+    const Eigen::Vector3d* positions_ = nullptr;
+    const Descriptor* point_descriptors_ = nullptr;
+    const std::uint32_t* observation_offsets_ = nullptr;
+    const MapObservation* observations_ = nullptr;
+    const std::uint32_t* covisibility_offsets_ = nullptr;
+    const CovisibilityEdge* covisibility_ = nullptr;
+    const MapIdIndex* keyframe_index_ = nullptr;
+    const MapIdIndex* point_index_ = nullptr;
+    const MapRegion* regions_ = nullptr;
+};
+
+}  // namespace slam
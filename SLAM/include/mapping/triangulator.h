@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace slam {
+
+class ThreadPool;
+
+// 参与三角化的一个视角（关键帧）位姿：P_c = R_cw * P_w + t_cw
+struct TriangulationView {
+    Eigen::Matrix3d R_cw = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d t_cw = Eigen::Vector3d::Zero();
+};
+
+// 一批待三角化的轨迹（CSR）：第 i 条轨迹的观测在 [offsets[i], offsets[i + 1]) 内，
+// 每个观测是视角下标和去畸变后的归一化坐标
+struct TrackBatch {
+    std::vector<int> offsets{0};
+    std::vector<int> view;
+    std::vector<double> x, y;
+
+    void reserve(int n_tracks, int n_observations);
+    void clear();
+    // 先 addObservation 若干次，再 endTrack 结束一条轨迹
+    void addObservation(int view_index, const Eigen::Vector2d& xn);
+    void endTrack() { offsets.push_back(static_cast<int>(view.size())); }
+    int size() const { return static_cast<int>(offsets.size()) - 1; }
+};
+
+enum class TriangulationStatus : std::uint8_t {
+    kOk = 0,
+    kTooFewViews,       // 少于 2 个观测
+    kLowParallax,       // 最大视差角小于阈值，线性求解前拒绝
+    kBehindCamera,      // 视差最大的两条射线交在相机后方（求解前），或解在某个视角后方（求解后）
+    kLargeError,        // 重投影误差超过阈值
+    kDegenerate,        // 线性方程组奇异
+};
+
+enum class TriangulationMethod { kDlt, kMidpoint };
+
+struct TriangulatorOptions {
+    TriangulationMethod method = TriangulationMethod::kDlt;
+    double min_parallax_deg = 1.0;
+    double max_error_px = 2.0;      // 每个视角的重投影误差上限
+    double focal_length = 500.0;    // 把像素换算到归一化坐标
+    double sigma_px = 1.0;          // 观测噪声，用于协方差
+    int tracks_per_task = 256;
+};
+
+struct TriangulationResult {
+    std::vector<Eigen::Vector3d> points;            // 世界坐标
+    std::vector<Eigen::Matrix3d> covariances;       // 一阶近似 (J^T Σ^-1 J)^-1
+    std::vector<TriangulationStatus> status;
+    int num_valid = 0;
+};
+
+/*
+批量多视角三角化（对应 SLAM/readme.md 5 地图构建：新关键帧与共视关键帧的新匹配三角化成地图点）
+
+    1. 先把每个观测转成世界系下的单位射线，求任意两条射线的最大夹角，视差太小直接拒绝；
+       视差最大的两条射线用中点法解出两个深度（2x2），有一个不为正就拒绝，都不进入线性求解；
+    2. 线性求解全部是定长 3x3：DLT 用非齐次形式（视差足够时点不会在无穷远处），
+       中点法最小化到各条射线的距离平方和；
+    3. 线性解上做一步 Gauss-Newton（最小化重投影误差），检查每个视角的深度和重投影误差，
+       最后一次的 J^T J 同时给出协方差；
+    4. 轨迹按 tracks_per_task 分块交给线程池，每个任务只写自己那段输出。
+ */
+class Triangulator {
+public:
+    explicit Triangulator(const TriangulatorOptions& options = TriangulatorOptions(), ThreadPool* pool = nullptr);
+
+    // 返回成功的点数
+    int triangulate(const std::vector<TriangulationView>& views, const TrackBatch& tracks,
+                    TriangulationResult& result);
+
+    const TriangulatorOptions& options() const { return options_; }
+
+private:
+    TriangulatorOptions options_;
+    ThreadPool* pool_;
+};
+
+}  // namespace slam
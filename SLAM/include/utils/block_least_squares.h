@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/SparseCholesky>
+
+#include "utils/block_sparse_matrix.h"
+
+namespace slam {
+
+// Jacobian 的存储精度；残差、法方程的累加、分解和迭代修正总是 double
+enum class JacobianPrecision { kDouble, kFloat };
+
+struct BlockLeastSquaresOptions {
+    JacobianPrecision precision = JacobianPrecision::kDouble;
+    int max_refinement_steps = 3;         // 迭代修正次数上限，0 表示只做一次直接求解
+    double refinement_tolerance = 1e-14;  // 修正量 / 解 的范数比低于它时停止
+};
+
+struct BlockLeastSquaresSummary {
+    bool success = false;
+    int refinement_steps = 0;
+    double first_correction = 0.0;        // 第一次修正量 / 解（直接求解的相对误差估计）
+    double last_correction = 0.0;
+    // 各阶段耗时（毫秒）
+    double assemble_ms = 0.0;             // H = JᵀJ、g = Jᵀr
+    double factorize_ms = 0.0;
+    double solve_ms = 0.0;                // 回代 + 迭代修正
+    double refine_ms = 0.0;               // 其中迭代修正读 J 的部分（Jᵀ(r + Jδ)，不含回代）
+    double total_ms = 0.0;
+};
+
+/*
+块稀疏线性最小二乘 min ‖J δ + r‖² + λ δᵀ diag(JᵀJ) δ，Jacobian 可以按 float 存储（混合精度）
+（对应 Eigen/code05.cpp demo03 的 cast<double>()，把精度转换放进求解路径里）
+
+大规模 BA / 位姿图每次迭代要把 Jacobian 读好几遍（组装 JᵀJ、Jᵀr，迭代修正里的 J δ、Jᵀe），
+double 存储时这几遍读内存就是主要开销：
+    1. J 按残差块 × 变量块存成 BlockSparseMatrix（块大小 BR x BC），精度在构造时按问题选择：
+       kFloat 时 J 存 float，读的字节数接近减半；r 只占 J 的 1 / BC，总是存 double；
+    2. 组装 H、g 时每个 float 块先转成 double 再相乘：两个 float 的乘积在 double 里是精确的，
+       所以 H 只有 double 累加的舍入，和直接用（舍入到 float 的）J 在 double 里算完全一样；
+       H 的块模式在 setPattern 时确定，映射到 Eigen 稀疏矩阵的位置只算一次，
+       SimplicialLLT（AMD 排序）的符号分解跨调用复用；
+    3. 直接求解之后做半正规方程迭代修正（CSNE）：e = r + J δ，δ -= H⁻¹ (Jᵀe + λDδ)，
+       残差用存储的 J 和 double 的 r 计算，不经过显式的 H，修正的是法方程 κ(J)² 放大的误差，
+       解对所存储的问题（舍入后的 J、原样的 r）达到 double 精度；
+    4. 迭代修正去不掉 J 本身约 6e-8 的相对舍入：kFloat 的解和全 double 问题的解仍差 O(6e-8 κ(J))
+       （合成位姿图上约 4e-8），只是代价 ‖Jδ + r‖² 几乎不变（约 2e-14），相当于一个不精确的 Gauss-Newton 步，
+       外层迭代每次重新线性化，舍入不会累积；需要和 double 一致的解时用 kDouble。
+单线程实现。两种精度的字节数、各阶段耗时、精度和只读 J 的带宽见 benchmark/mixed_precision.cpp。
+显式实例化了 6x6、3x3、2x6、3x6 块（block_least_squares.cpp）。
+ */
+template <int BR, int BC>
+class BlockLeastSquares {
+public:
+    using JacobianBlock = Eigen::Matrix<double, BR, BC>;
+    using ResidualBlock = Eigen::Matrix<double, BR, 1>;
+
+    explicit BlockLeastSquares(const BlockLeastSquaresOptions& options = BlockLeastSquaresOptions());
+
+    // (残差块, 变量) 的非零模式；数值清零
+    void setPattern(int num_residual_blocks, int num_variables, std::vector<std::pair<int, int>> blocks);
+    void setZero();
+
+    int numResidualBlocks() const { return num_residuals_; }
+    int numVariables() const { return num_variables_; }
+    JacobianPrecision precision() const { return options_.precision; }
+
+    // 按存储精度写入（double 算好的值，kFloat 时在这里舍入）；块不在模式里返回 false
+    bool setJacobian(int residual, int variable, const JacobianBlock& J);
+    void setResidual(int residual, const ResidualBlock& r);
+
+    // delta 的长度是 numVariables() * BC
+    bool solve(double lambda, Eigen::VectorXd& delta, BlockLeastSquaresSummary* summary = nullptr);
+
+    // J 和 r 占用的字节数（数值 + 下标）
+    std::size_t jacobianBytes() const;
+
+private:
+    using ResidualMap = Eigen::Map<const ResidualBlock>;
+
+    template <typename Scalar>
+    void assemble(const BlockSparseMatrix<Scalar, BR, BC>& J, const double* r);
+    // rg = Jᵀ (r + J δ) + λ D δ
+    template <typename Scalar>
+    void normalResidual(const BlockSparseMatrix<Scalar, BR, BC>& J, const double* r, const Eigen::VectorXd& delta,
+                        double lambda);
+
+    BlockLeastSquaresOptions options_;
+    int num_residuals_ = 0;
+    int num_variables_ = 0;
+
+    BlockSparseMatrix<double, BR, BC> J_double_;
+    BlockSparseMatrix<float, BR, BC> J_float_;
+    Eigen::VectorXd r_;                   // 残差总是 double：只占 J 的 1 / BC，迭代修正的残差要用它
+
+    // H 的上三角块（含完整的对角块），pair_block_ 按残差行的顺序给出每对 (k1 <= k2) 写入的 H 块
+    BlockSparseMatrix<double, BC, BC> H_;
+    std::vector<int> pair_block_;
+    std::vector<int> diag_block_;
+    Eigen::SparseMatrix<double> H_sparse_;
+    std::vector<int> sparse_source_;      // H_sparse_ 的第 i 个值来自 H_.values() 的哪个位置
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double>, Eigen::Upper> llt_;
+    bool analyzed_ = false;
+
+    Eigen::VectorXd g_;
+    Eigen::VectorXd damping_;             // λ diag(JᵀJ)
+    Eigen::VectorXd rg_;
+    Eigen::VectorXd correction_;
+};
+
+}  // namespace slam
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+
+namespace slam {
+
+class ThreadPool;
+
+/*
+块压缩稀疏行矩阵（BSR），块大小是编译期常量（对应 Eigen/readme.md 里稠密矩阵之外的稀疏存储）
+
+BA / 位姿图的 Hessian、Jacobian 天然由 6x6、6x3、3x3 的稠密块组成，Eigen::SparseMatrix 按标量存，
+每个非零元都要一个 int 行 / 列下标（6x6 double 块的下标比数值还多一半），SpMV 也是逐标量间接寻址：
+    1. 按块存 CSR：row_ptr 是块行的起始位置，col 是块列号，每个块只有一个下标；块的数值按列主序
+       连续存放（BR * BC 个标量），和 Eigen 定长矩阵的内存布局一致，block(k) 直接 Map 出来；
+    2. SpMV 的内层是编译期定长的块 GEMV（Map<const Block> * Map<const Vector>），Eigen 展开成
+       SIMD 指令，没有标量循环；每个块行的结果先累加在寄存器里，最后写一次 y；
+    3. 多线程按块行划分：按非零块个数把块行切成若干段（二分 row_ptr），各线程只写自己那一段的 y，
+       不需要原子操作或归约；转置乘法（Jᵀr 这类）要散写，只提供单线程版本；
+    4. 和 Eigen::SparseMatrix、稠密矩阵互相转换：转出来的标量矩阵含块内的显式零；转进来时
+       只要块内有一个非零元（|a| > tolerance）就保留整块。
+模式（哪些块非零）由 setPattern 一次确定，之后 setZero / addBlock 只改数值，不重新分配。
+显式实例化了 float / double 的 3x3、6x6、6x3、3x6、2x6、2x3 块（block_sparse_matrix.cpp）。
+ */
+template <typename Scalar, int BR, int BC = BR>
+class BlockSparseMatrix {
+public:
+    static constexpr int kBlockRows = BR;
+    static constexpr int kBlockCols = BC;
+    static constexpr int kBlockSize = BR * BC;
+
+    using Block = Eigen::Matrix<Scalar, BR, BC>;
+    using BlockMap = Eigen::Map<Block>;
+    using ConstBlockMap = Eigen::Map<const Block>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using Dense = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using Sparse = Eigen::SparseMatrix<Scalar>;
+
+    BlockSparseMatrix() = default;
+    BlockSparseMatrix(int block_rows, int block_cols) { resize(block_rows, block_cols); }
+
+    // 清空模式，尺寸以块为单位
+    void resize(int block_rows, int block_cols);
+
+    // 设定非零块的位置 (块行, 块列)，重复的合并；数值清零
+    void setPattern(int block_rows, int block_cols, std::vector<std::pair<int, int>> blocks);
+
+    // 数值清零，模式不变
+    void setZero();
+
+    int blockRows() const { return block_rows_; }
+    int blockCols() const { return block_cols_; }
+    int rows() const { return block_rows_ * BR; }
+    int cols() const { return block_cols_ * BC; }
+    int nonZeroBlocks() const { return static_cast<int>(col_.size()); }
+
+    // 块行 r 的非零块是 [rowBegin(r), rowEnd(r))
+    int rowBegin(int block_row) const { return row_ptr_[block_row]; }
+    int rowEnd(int block_row) const { return row_ptr_[block_row + 1]; }
+    int blockCol(int k) const { return col_[k]; }
+
+    BlockMap block(int k) { return BlockMap(values_.data() + static_cast<std::size_t>(k) * kBlockSize); }
+    ConstBlockMap block(int k) const {
+        return ConstBlockMap(values_.data() + static_cast<std::size_t>(k) * kBlockSize);
+    }
+
+    // (块行, 块列) 在模式里的序号，不存在返回 -1（行内二分）
+    int findBlock(int block_row, int block_col) const;
+
+    // 累加到已有的块上，块不在模式里返回 false
+    template <typename Derived>
+    bool addBlock(int block_row, int block_col, const Eigen::MatrixBase<Derived>& b) {
+        const int k = findBlock(block_row, block_col);
+        if (k < 0) return false;
+        block(k) += b;
+        return true;
+    }
+
+    const std::vector<int>& rowPtr() const { return row_ptr_; }
+    const std::vector<int>& colIndex() const { return col_; }
+    const std::vector<Scalar>& values() const { return values_; }
+
+    // y = A x；pool 为空时用全局线程池，非零块很少时直接在调用线程算
+    void multiply(const Scalar* x, Scalar* y, ThreadPool* pool = nullptr) const;
+    // y += alpha A x
+    void multiplyAdd(const Scalar* x, Scalar* y, Scalar alpha = Scalar(1), ThreadPool* pool = nullptr) const;
+    // y = Aᵀ x（单线程）
+    void multiplyTranspose(const Scalar* x, Scalar* y) const;
+
+    void multiply(const Vector& x, Vector& y, ThreadPool* pool = nullptr) const {
+        y.resize(rows());
+        multiply(x.data(), y.data(), pool);
+    }
+    void multiplyTranspose(const Vector& x, Vector& y) const {
+        y.resize(cols());
+        multiplyTranspose(x.data(), y.data());
+    }
+
+    Dense toDense() const;
+    Sparse toSparse() const;
+
+    // 标量矩阵的行 / 列数必须是块大小的整数倍，否则返回 false
+    bool fromDense(const Dense& dense, Scalar tolerance = Scalar(0));
+    bool fromSparse(const Sparse& sparse, Scalar tolerance = Scalar(0));
+
+private:
+    // 按非零块个数把块行分成 n_parts 段，返回 n_parts + 1 个边界
+    void partitionRows(int n_parts, std::vector<int>& bounds) const;
+    void multiplyRows(int row_begin, int row_end, const Scalar* x, Scalar* y, Scalar alpha, bool accumulate) const;
+    void multiplyImpl(const Scalar* x, Scalar* y, Scalar alpha, bool accumulate, ThreadPool* pool) const;
+
+    int block_rows_ = 0;
+    int block_cols_ = 0;
+    std::vector<int> row_ptr_{0};
+    std::vector<int> col_;
+    std::vector<Scalar> values_;
+};
+
+using BlockSparseMatrix3d = BlockSparseMatrix<double, 3>;
+using BlockSparseMatrix6d = BlockSparseMatrix<double, 6>;
+using BlockSparseMatrix3f = BlockSparseMatrix<float, 3>;
+using BlockSparseMatrix6f = BlockSparseMatrix<float, 6>;
+
+}  // namespace slam
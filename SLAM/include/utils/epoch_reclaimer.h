@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace slam {
+
+// 基于 epoch 的延迟回收（RCU 风格）：
+// 读者进入临界区时把当前 epoch 登记在一个槽位里，只是几次原子读写，不加锁也不等待；
+// 写者先把旧对象从数据结构上摘下来再 retire，对象带着摘下时的 epoch，
+// 等所有登记的读者的 epoch 都比它新（即不可能还持有旧指针）时才真正释放。
+// 读者槽位按缓存行对齐，互不干扰；槽位用完时读者自旋等待空槽（槽位数应大于读线程数）。
+class EpochReclaimer {
+public:
+    static constexpr int kMaxReaders = 128;
+
+    // 读临界区，析构时离开；期间读到的指针保证不会被释放
+    class Guard {
+    public:
+        Guard() = default;
+        ~Guard() { release(); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard(Guard&& other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+        Guard& operator=(Guard&& other) noexcept;
+
+        void release();
+
+    private:
+        friend class EpochReclaimer;
+        explicit Guard(std::atomic<std::uint64_t>* slot) : slot_(slot) {}
+        std::atomic<std::uint64_t>* slot_ = nullptr;
+    };
+
+    EpochReclaimer() = default;
+    ~EpochReclaimer();
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    // 读者：非阻塞，可嵌套（每层占一个槽位）
+    Guard enter();
+
+    // 写者：p 已经不能再从数据结构上读到，之后由 reclaim 或析构释放
+    template <typename T>
+    void retire(const T* p) {
+        if (p) retire(const_cast<T*>(p), [](void* q) { delete static_cast<T*>(q); });
+    }
+    void retire(void* p, void (*deleter)(void*));
+
+    // 写者：释放所有读者都已离开的对象，返回释放的个数
+    int reclaim();
+
+    // 等待回收的对象数
+    std::size_t pending() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{0};    // 0 表示空闲
+    };
+    struct Retired {
+        void* p;
+        void (*deleter)(void*);
+        std::uint64_t epoch;
+    };
+
+    std::atomic<std::uint64_t> epoch_{1};
+    Slot slots_[kMaxReaders];
+    mutable std::mutex retired_mutex_;
+    std::vector<Retired> retired_;
+};
+
+}  // namespace slam
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace slam {
+
+/*
+批量一维复数 FFT 计划（对应 Eigen/code05.cpp demo03 的 MatrixXcd：real()、imag()、conjugate()）
+
+    1. 长度 n 分解成 8、4、2、3 和其余素因子（混合基），每个因子一级 Stockham 自排序蝶形，
+       不需要位反转重排；基 8 一级相当于三级基 2，少读写两遍数据；各级的旋转因子在构造时算好，
+       计划可以反复使用；
+    2. 一次变换 batch 条序列，实部、虚部分开存放（split 格式），第 k 个样本的第 b 条序列在
+       re[k * batch + b]：蝶形的最内层循环沿 batch 连续，按 AVX-512 / AVX2 的一个寄存器宽度成组计算
+       （GCC / Clang 向量类型，剩下不满一组的走标量），没有复数交错存放的 shuffle；
+    3. 正变换 X_k = Σ x_j e^{-2πi jk/n}，逆变换符号相反且不归一化（除以 n 由调用者做）。
+ */
+class FftPlan {
+public:
+    explicit FftPlan(int n = 1);
+
+    int size() const { return n_; }
+
+    // 非原地：src 的第 k 个样本在 src_re / src_im[k * src_pitch + b]，结果写到 dst（行跨度 dst_pitch），
+    // src 不会被修改；各级在 dst 和工作区（行跨度 batch，各 n * batch 个元素）之间交替，最后一级正好写进 dst
+    void forward(const float* src_re, const float* src_im, int src_pitch, float* dst_re, float* dst_im, int dst_pitch,
+                 int batch, float* work_re, float* work_im) const;
+    void inverse(const float* src_re, const float* src_im, int src_pitch, float* dst_re, float* dst_im, int dst_pitch,
+                 int batch, float* work_re, float* work_im) const;
+
+    // 原地（行跨度 batch）：级数为奇数时最后多一次拷贝
+    void forward(float* re, float* im, int batch, float* work_re, float* work_im) const;
+    void inverse(float* re, float* im, int batch, float* work_re, float* work_im) const;
+
+private:
+    struct Stage {
+        int radix;
+        int span;             // 之前各级因子的乘积（Stockham 的 Ns）
+        int twiddle_offset;   // 本级旋转因子在 twiddle_re_ / twiddle_im_ 里的起点，span * (radix - 1) 个
+    };
+
+    void transform(const float* src_re, const float* src_im, int src_pitch, float* dst_re, float* dst_im,
+                   int dst_pitch, int batch, float* work_re, float* work_im, bool inverse) const;
+
+    int n_;
+    std::vector<Stage> stages_;
+    std::vector<float> twiddle_re_, twiddle_im_;
+};
+
+// 二维实数 FFT 的半谱：宽 W、高 H 的图像得到 W x (H / 2 + 1) 个复数，按转置布局存放，
+// 频率 (u, v)（u ∈ [0, W)，v ∈ [0, H / 2]）在 re / im[u * stride + v]；其余一半由共轭对称给出
+struct HalfSpectrum {
+    int width = 0;
+    int height = 0;
+    int stride = 0;           // H / 2 + 1
+    std::vector<float> re, im;
+
+    // 转成 (H / 2 + 1) x W 的复数矩阵，第 v 行第 u 列是频率 (u, v)
+    Eigen::MatrixXcf toMatrix() const;
+};
+
+/*
+二维实数到复数 FFT（R2C / C2R），宽度必须是偶数
+    1. 正变换：左右两半列拼成一个复数序列（第 x 列作实部、第 x + W/2 列作虚部），沿 y 做 W/2 条
+       批量 FFT，再用共轭对称拆开，只保留 v ∈ [0, H/2]，边拆边转置；然后沿 x 做 H/2 + 1 条批量 FFT，
+       计算量约为复数二维 FFT 的一半；拼接不需要拷贝：第一级蝶形直接按行跨度读输入图像的左右两半；
+    2. 逆变换按相反的顺序：沿 u 逆变换、转置时用共轭对称补全 v > H/2 并重新拼成复数（同时乘 1 / (W H)）、
+       沿 y 逆变换，最后一级直接写进输出图像的左右两半，与正变换互逆；
+    3. 计划和工作区在构造时分配，forward / inverse 不再分配内存，也没有整幅的拷贝。
+ */
+class RealFft2D {
+public:
+    RealFft2D(int width, int height);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    bool valid() const { return width_ > 0 && height_ > 0 && width_ % 2 == 0; }
+
+    // input 是 height 行、每行 width 个 float，行跨度 stride 个元素；spectrum 按需调整大小
+    void forward(const float* input, int stride, HalfSpectrum& spectrum);
+    void inverse(const HalfSpectrum& spectrum, float* output, int stride);
+
+private:
+    int width_;
+    int height_;
+    int half_height_;         // H / 2 + 1
+    FftPlan plan_x_, plan_y_;
+    std::vector<float> z_re_, z_im_;        // H x W/2 的拼接序列
+    std::vector<float> work_re_, work_im_;
+};
+
+}  // namespace slam
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace slam {
+
+// 只读内存映射文件（POSIX mmap）：
+// 打开只是一次系统调用，页面在第一次访问时才由内核读入，适合词典、地图这类很大但只读的二进制文件
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 失败（文件不存在、为空、映射失败）返回 false
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // 访问模式提示：顺序读时加大预读，随机访问时关闭预读；willNeed 让内核提前读入一段
+    void adviseSequential() const;
+    void adviseRandom() const;
+    void willNeed(std::size_t offset, std::size_t length) const;
+
+private:
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace slam
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/spsc_queue.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+struct StageStats {
+    std::string name;
+    std::uint64_t steps = 0;        // step() 做了事的次数
+    std::uint64_t idle_waits = 0;   // 没事可做而睡眠的次数
+    double busy_ms = 0.0;           // 花在做事的 step() 上的时间
+};
+
+struct StageOptions {
+    int cpu = -1;                                       // 绑定的 CPU 核，< 0 不绑定（仅 Linux 有效）
+    std::chrono::microseconds idle_timeout{1000};       // 没有输入时最长睡多久再检查一次
+    int idle_spins = 32;                                // 睡眠前先空转检查几次
+};
+
+/*
+多线程流水线运行时（对应 SLAM/readme.md 的整体流程：输入 → 前端 → 后端 → 回环 → 建图）
+
+    1. 每个阶段一个专用线程，循环调用 step()：step 从输入队列取数据、处理、写到输出队列，
+       返回是否做了事；没事可做时先空转几次，再在阶段自己的 Notifier 上睡眠，
+       输入队列 push 时唤醒它（没有线程在睡时 push 不碰任何锁）；
+    2. 阶段之间用 SpscQueue 连接，每个队列只有一个生产者阶段和一个消费者阶段，
+       满了按队列自己的策略背压或丢弃：跟踪 → 局部建图、局部建图 → 回环这类下游可能很慢的边
+       用 kDropNewest / kDropOldest，慢的回环不会反过来阻塞跟踪；
+    3. 队列记录深度、最大深度、入队 / 出队 / 丢弃数和背压等待时间，阶段记录忙碌时间，
+       stats 随时可读（都是原子计数）；
+    4. 阶段可以绑定到指定 CPU 核，避免跟踪线程和其他阶段抢同一个核；
+    5. 各模块默认用 ThreadPool::global()，一个线程池同一时刻只服务一个 parallelFor 调用方，
+       多个阶段共用它时会互相串行（跟踪会等回环的 parallelFor 做完），所以每个阶段的模块要传入
+       addThreadPool 创建的专用线程池，只有一个阶段会用到的话才可以用 global()。
+用法：
+    Pipeline p;
+    auto* frames = p.addQueue<Frame>("frames", 8, QueuePolicy::kDropOldest);
+    auto* keyframes = p.addQueue<KeyFrameMsg>("keyframes", 16, QueuePolicy::kBlock);
+    HammingMatcher matcher(HammingMatcherOptions(), p.addThreadPool(4));
+    p.addStage("tracking", [&] { Frame f; if (!frames->tryPop(f)) return false; ...; return true; }, {frames});
+    p.start(); ... p.stop();
+ */
+class Pipeline {
+public:
+    Pipeline() = default;
+    ~Pipeline() { stop(); }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // 队列归流水线所有，start 之前创建
+    template <typename T>
+    SpscQueue<T>* addQueue(const std::string& name, int capacity, QueuePolicy policy) {
+        auto* q = new SpscQueue<T>(name, capacity, policy);
+        queues_.emplace_back(q);
+        return q;
+    }
+
+    // 阶段专用的线程池，归流水线所有；num_threads 包括调用它的阶段线程本身，<= 0 时使用 hardware_concurrency
+    ThreadPool* addThreadPool(int num_threads);
+
+    // inputs：这个阶段消费的队列，它们有新元素时唤醒本阶段
+    void addStage(const std::string& name, std::function<bool()> step, const std::vector<QueueBase*>& inputs = {},
+                  const StageOptions& options = StageOptions());
+
+    // stop 之后可以再次 start：队列重新打开（未取走的元素保留），统计继续累计
+    void start();
+    // 通知所有阶段退出并等待线程结束；阶段的最后一次 step 之后不再调用
+    void stop();
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    std::vector<QueueStats> queueStats() const;
+    std::vector<StageStats> stageStats() const;
+
+private:
+    struct Stage {
+        std::string name;
+        std::function<bool()> step;
+        StageOptions options;
+        Notifier notifier;
+        std::vector<QueueBase*> inputs;
+        std::thread thread;
+        std::atomic<std::uint64_t> steps{0};
+        std::atomic<std::uint64_t> idle_waits{0};
+        std::atomic<std::int64_t> busy_ns{0};
+    };
+
+    void run(Stage& stage);
+
+    std::vector<std::unique_ptr<QueueBase>> queues_;
+    std::vector<std::unique_ptr<ThreadPool>> pools_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+    std::atomic<bool> running_{false};
+};
+
+}  // namespace slam
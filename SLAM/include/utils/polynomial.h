@@ -0,0 +1,17 @@
+#pragma once
+
+namespace slam {
+
+// 低次多项式实根，系数按降幂排列：coeffs[0] * x^n + ... + coeffs[n]
+// 返回实根个数，根写入 roots（不排序，重根可能重复出现）
+
+// x^3 + a x^2 + b x + c = 0（Cardano / 三角解法），最多 3 个根
+int solveCubicMonic(double a, double b, double c, double roots[3]);
+
+// 4 次（Ferrari 法 + 牛顿迭代修正），首项系数接近 0 时退化为 3 次
+int solveQuartic(const double coeffs[5], double roots[4]);
+
+// 多项式求值（Horner）
+double evaluatePolynomial(const double* coeffs, int degree, double x);
+
+}  // namespace slam
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace slam {
+
+/*
+HDR 风格的延迟直方图（纳秒）：对数分段，每段 16 个线性子桶，相对误差不超过 1/16，
+覆盖 0 ~ 2^64 ns，固定 976 个桶。只有一个线程写（record 不用原子读改写），其他线程可以随时读。
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr int kHalf = 1 << (kSubBits - 1);
+    static constexpr int kBuckets = (66 - kSubBits) * kHalf;
+
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::uint64_t ns) {
+        bump(counts_[bucketOf(ns)], 1);
+        bump(count_, 1);
+        bump(sum_, ns);
+        if (ns < min_.load(std::memory_order_relaxed)) min_.store(ns, std::memory_order_relaxed);
+        if (ns > max_.load(std::memory_order_relaxed)) max_.store(ns, std::memory_order_relaxed);
+    }
+
+    // 把 other 加进来（调用方独占 this）
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    std::uint64_t min() const { return count() ? min_.load(std::memory_order_relaxed) : 0; }
+    std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const;
+    // p ∈ [0, 1]，返回所在桶的中点
+    double percentile(double p) const;
+
+    static int bucketOf(std::uint64_t ns) {
+        if (ns < 2 * kHalf) return static_cast<int>(ns);
+        const int e = 63 - __builtin_clzll(ns) - (kSubBits - 1);
+        return e * kHalf + static_cast<int>(ns >> e);
+    }
+    // 桶的下界
+    static std::uint64_t bucketLow(int bucket) {
+        if (bucket < 2 * kHalf) return static_cast<std::uint64_t>(bucket);
+        const int e = bucket / kHalf - 1;
+        return static_cast<std::uint64_t>(bucket % kHalf + kHalf) << e;
+    }
+
+private:
+    // 单写者：普通的读 + 写，不需要 lock 前缀
+    static void bump(std::atomic<std::uint64_t>& v, std::uint64_t delta) {
+        v.store(v.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> counts_[kBuckets];
+    std::atomic<std::uint64_t> count_;
+    std::atomic<std::uint64_t> sum_;
+    std::atomic<std::uint64_t> min_;
+    std::atomic<std::uint64_t> max_;
+};
+
+// 一个阶段在所有线程上合并后的延迟统计（微秒）
+struct StageLatency {
+    std::string name;
+    std::uint64_t count = 0;
+    double total_ms = 0.0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+};
+
+struct CounterValue {
+    std::string name;
+    std::int64_t value = 0;
+};
+
+/*
+热路径插桩（各阶段耗时直方图 + 计数器 + Chrome trace 导出）
+
+前端 / 后端 / 回环各阶段以前没有任何计时手段，这里提供一个开销很小的统一入口：
+    1. SLAM_PROFILE_SCOPE("frontend/match") 在作用域结束时记录一次耗时：阶段名到 id 的查找只在
+       每个调用点第一次执行时做一次（函数内 static），之后只是两次读时钟；
+    2. 每个线程第一次记录时注册一块自己的缓冲区（只有这一步加锁），之后只写自己的缓冲区：
+       每个阶段一个 LatencyHistogram、每个计数器一个单写者原子量、一段定长的 trace 事件数组，
+       没有线程间共享的写，也没有 lock 前缀的原子操作，读者（导出、统计）随时可以读；
+    3. 计数器（SLAM_PROFILE_COUNT）记录分配次数、缓存不友好事件（哈希长探测、队列丢弃等）这类
+       只在调用点才知道的事件；
+    4. writeChromeTrace 导出 Chrome trace / Perfetto 能直接打开的 JSON（每次计时一个 "X" 事件，
+       线程名、计数器最终值也一并写出）；trace 数组写满后只丢弃新的事件，直方图照常累计；
+    5. 不定义 SLAM_PROFILING 时所有宏展开为空语句，没有任何开销；定义后每个计时点的开销主要是两次
+       steady_clock 读取（约 100 ns），所以只放在十微秒以上的阶段上（开销 < 1%），不放进逐点的内层循环。
+缓冲区在进程结束前不释放（线程退出后它的数据仍可导出）。
+ */
+class Profiler {
+public:
+    static constexpr int kMaxStages = 256;
+    static constexpr int kMaxCounters = 64;
+
+    static Profiler& global();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // 名字 → id，同名返回同一个 id；超过上限返回 -1（之后的记录被忽略）
+    int stageId(const std::string& name);
+    int counterId(const std::string& name);
+
+    // 当前线程在 trace 里显示的名字
+    void setThreadName(const std::string& name);
+
+    // 是否记录 trace 事件（直方图和计数器总是记录）；每个线程最多保存 events_per_thread 个事件，
+    // 只影响之后才开始记录的线程
+    void setTracing(bool enabled, int events_per_thread = 1 << 16);
+
+    // steady_clock 纳秒
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // 由调用线程记录
+    void record(int stage, std::int64_t start_ns, std::int64_t duration_ns);
+    void count(int counter, std::int64_t delta);
+
+    // 统计（任意线程）
+    std::vector<StageLatency> stageLatencies() const;
+    // 阶段 stage 在所有线程上合并后的直方图
+    void stageHistogram(int stage, LatencyHistogram& out) const;
+    std::vector<CounterValue> counters() const;
+    std::uint64_t droppedEvents() const;
+
+    bool writeChromeTrace(const std::string& path) const;
+
+    // 清空所有统计和 trace；应在没有线程记录时调用
+    void reset();
+
+private:
+    struct TraceEvent {
+        std::int32_t stage;
+        std::int64_t start_ns;
+        std::int64_t duration_ns;
+    };
+    struct ThreadBuffer;
+
+    Profiler();
+    ~Profiler();
+
+    ThreadBuffer& local();
+
+    mutable std::mutex mutex_;          // 注册线程、阶段名、计数器名
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+    std::vector<std::string> stage_names_;
+    std::vector<std::string> counter_names_;
+    std::atomic<bool> tracing_{true};
+    std::atomic<int> events_per_thread_{1 << 16};
+};
+
+// 作用域计时：构造时读时钟，析构时记录
+class ScopedTimer {
+public:
+    explicit ScopedTimer(int stage) : stage_(stage), start_(Profiler::now()) {}
+    ~ScopedTimer() { Profiler::global().record(stage_, start_, Profiler::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    int stage_;
+    std::int64_t start_;
+};
+
+}  // namespace slam
+
+#define SLAM_PROFILE_CONCAT_(a, b) a##b
+#define SLAM_PROFILE_CONCAT(a, b) SLAM_PROFILE_CONCAT_(a, b)
+
+#if defined(SLAM_PROFILING)
+#define SLAM_PROFILE_SCOPE(name)                                                                           \
+    static const int SLAM_PROFILE_CONCAT(slam_profile_stage_, __LINE__) =                                  \
+        ::slam::Profiler::global().stageId(name);                                                          \
+    const ::slam::ScopedTimer SLAM_PROFILE_CONCAT(slam_profile_timer_, __LINE__)(                          \
+        SLAM_PROFILE_CONCAT(slam_profile_stage_, __LINE__))
+#define SLAM_PROFILE_COUNT(name, delta)                                                                    \
+    do {                                                                                                   \
+        static const int slam_profile_counter = ::slam::Profiler::global().counterId(name);                \
+        ::slam::Profiler::global().count(slam_profile_counter, (delta));                                   \
+    } while (0)
+#define SLAM_PROFILE_THREAD(name) ::slam::Profiler::global().setThreadName(name)
+#else
+#define SLAM_PROFILE_SCOPE(name) \
+    do {                         \
+    } while (0)
+#define SLAM_PROFILE_COUNT(name, delta) \
+    do {                                \
+    } while (0)
+#define SLAM_PROFILE_THREAD(name) \
+    do {                          \
+    } while (0)
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace slam {
+
+// 达到置信度 confidence 所需的 RANSAC 迭代次数：log(1 - p) / log(1 - w^m)
+int ransacIterations(double confidence, double inlier_ratio, int sample_size, int max_iterations);
+
+/*
+PROSAC 采样（Chum & Matas 2005）
+
+要求对应点已按质量（例如描述子距离）从好到坏排好序。采样集合从前 m 个点开始，
+按增长函数逐渐扩大到全部 N 个点：前期只在高质量点里采样，内点率高时几次迭代就能
+找到正确模型；扩大到 N 之后退化为普通 RANSAC，所以最坏情况不比 RANSAC 差。
+use_prosac = false 时始终在全部点上均匀采样。
+ */
+class ProsacSampler {
+public:
+    ProsacSampler(int n_points, int sample_size, int max_iterations, bool use_prosac, std::uint32_t seed);
+
+    // 写入 sample_size 个互不相同的下标
+    void sample(int* indices);
+
+    int samplingSize() const { return n_; }
+
+private:
+    int uniformIndex(int upper);    // [0, upper)
+
+    int n_points_;
+    int m_;
+    bool use_prosac_;
+    int t_ = 0;         // 已经采样的次数
+    int n_;             // 当前采样集合大小
+    double T_n_;        // 论文中的 T_n
+    int T_n_prime_;     // 论文中的 T'_n
+    std::mt19937 rng_;
+};
+
+/*
+SPRT 提前拒绝（Matas & Chum 2008, "Randomized RANSAC with Sequential Probability Ratio Test"）
+
+逐个（或逐块）验证点时累积似然比 λ：内点乘 δ/ε，外点乘 (1-δ)/(1-ε)，
+λ 超过阈值 A 即判定为坏模型，不必再验证剩下的点。
+ε：好模型的内点率（用目前最好模型的内点率估计），δ：坏模型上随机点被判为内点的概率。
+ */
+class SprtTest {
+public:
+    // model_cost：拟合一个模型的时间相当于验证多少个点；models_per_sample：每个样本平均解数
+    SprtTest(double epsilon = 0.1, double delta = 0.01, double model_cost = 200.0, double models_per_sample = 2.0);
+
+    // 一次验证 n_inliers 个内点 + n_outliers 个外点后更新 log λ（初值为 0），返回 false 表示应当拒绝
+    bool update(double& log_lambda, int n_inliers, int n_outliers) const;
+
+    // 找到更好的模型后更新 ε
+    void setEpsilon(double epsilon);
+    // 被拒绝模型的内点比例用于在线估计 δ
+    void observeRejected(int n_inliers, int n_tested);
+
+    double epsilon() const { return epsilon_; }
+    double delta() const { return delta_; }
+    double threshold() const { return A_; }
+
+private:
+    void recompute();
+
+    double epsilon_;
+    double delta_;
+    double model_cost_;
+    double models_per_sample_;
+    double A_ = 1.0;
+    double log_A_ = 0.0;
+    double log_inlier_ = 0.0;       // log(δ/ε)
+    double log_outlier_ = 0.0;      // log((1-δ)/(1-ε))
+    double rejected_inliers_ = 0.0;
+    double rejected_tested_ = 0.0;
+};
+
+}  // namespace slam
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+namespace slam {
+
+/*
+紧凑刚体位姿：单位四元数 + 平移，共 7 个标量（对应 Eigen/code10.cpp demo01 的四元数和欧氏变换）
+
+Isometry3d 实质上是 4x4 矩阵（16 个 double = 128 字节），位姿复合要做一次 4x4 乘法（64 次乘法），
+求逆要走通用的仿射逆；热路径上（跟踪时的位姿预测、BA / 位姿图的误差项、轨迹评估）这些都是浪费：
+    1. 存储是紧凑的 7 个标量 (qx, qy, qz, qw, tx, ty, tz)，没有填充，double 56 字节、float 28 字节，
+       前四个和 Eigen::Quaternion 的 coeffs() 顺序相同，rotation() / translation() 是就地的 Map，不拷贝；
+    2. 复合 = 四元数乘法（16 次乘法）+ 一次旋转向量，求逆 = 共轭 + 一次旋转向量，都在头文件里内联，
+       Scalar 是模板参数，编译期就确定为 float / double 的定长代码；
+       只旋转一个点时用四元数公式（v + 2w(u×v) + 2u×(u×v)），同一位姿变换很多点时先展开成 3x3 矩阵；
+    3. 和 Isometry3 互相转换不丢信息（四元数 ↔ 旋转矩阵，只有舍入误差），接口边界上照旧用 Isometry3d；
+    4. RigidPoseArray 是 SoA 的批量容器，100 万个关键帧位姿 56 MB；批量复合 / 求逆 / 相对位姿逐分量连续读写，
+       编译器可以直接向量化。
+四元数在复合后不自动归一化：连乘很多次之后调用 normalize()。
+ */
+template <typename Scalar>
+class RigidPose {
+public:
+    using Quaternion = Eigen::Quaternion<Scalar>;
+    using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+    using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+    using Isometry = Eigen::Transform<Scalar, 3, Eigen::Isometry>;
+
+    RigidPose() : data_{0, 0, 0, 1, 0, 0, 0} {}
+    RigidPose(const Quaternion& q, const Vector3& t) {
+        rotation() = q;
+        translation() = t;
+    }
+    RigidPose(const Matrix3& R, const Vector3& t) : RigidPose(Quaternion(R), t) {}
+    explicit RigidPose(const Isometry& T) : RigidPose(Quaternion(T.linear()), T.translation()) {}
+
+    static RigidPose Identity() { return RigidPose(); }
+
+    Eigen::Map<Quaternion> rotation() { return Eigen::Map<Quaternion>(data_); }
+    Eigen::Map<const Quaternion> rotation() const { return Eigen::Map<const Quaternion>(data_); }
+    Eigen::Map<Vector3> translation() { return Eigen::Map<Vector3>(data_ + 4); }
+    Eigen::Map<const Vector3> translation() const { return Eigen::Map<const Vector3>(data_ + 4); }
+
+    Scalar* data() { return data_; }
+    const Scalar* data() const { return data_; }
+
+    Matrix3 rotationMatrix() const { return rotation().toRotationMatrix(); }
+
+    Isometry toIsometry() const {
+        Isometry T = Isometry::Identity();
+        T.linear() = rotationMatrix();
+        T.translation() = translation();
+        return T;
+    }
+
+    // T^-1 = (q*, -(q* t))
+    RigidPose inverse() const {
+        RigidPose out;
+        out.rotation() = rotation().conjugate();
+        out.translation() = -(out.rotation() * translation());
+        return out;
+    }
+
+    // this * other = (q1 q2, q1 t2 + t1)
+    RigidPose operator*(const RigidPose& other) const {
+        RigidPose out;
+        out.rotation() = rotation() * other.rotation();
+        out.translation() = rotation() * other.translation() + translation();
+        return out;
+    }
+
+    RigidPose& operator*=(const RigidPose& other) { return *this = *this * other; }
+
+    // 相对位姿 this^-1 * other，不构造中间的逆
+    RigidPose between(const RigidPose& other) const {
+        const Quaternion qi = rotation().conjugate();
+        RigidPose out;
+        out.rotation() = qi * other.rotation();
+        out.translation() = qi * (other.translation() - translation());
+        return out;
+    }
+
+    // R p + t
+    Vector3 operator*(const Vector3& p) const { return rotation() * p + translation(); }
+
+    // R^T (p - t)，即 inverse() * p
+    Vector3 inverseTransform(const Vector3& p) const { return rotation().conjugate() * (p - translation()); }
+
+    void normalize() { rotation().normalize(); }
+
+    template <typename NewScalar>
+    RigidPose<NewScalar> cast() const {
+        return RigidPose<NewScalar>(rotation().template cast<NewScalar>(), translation().template cast<NewScalar>());
+    }
+
+private:
+    Scalar data_[7];
+};
+
+using RigidPosed = RigidPose<double>;
+using RigidPosef = RigidPose<float>;
+
+static_assert(sizeof(RigidPosed) == 7 * sizeof(double), "RigidPose must be tightly packed");
+static_assert(sizeof(RigidPosef) == 7 * sizeof(float), "RigidPose must be tightly packed");
+static_assert(std::is_trivially_copyable<RigidPosed>::value, "RigidPose must be trivially copyable");
+
+// 位姿数组（SoA）：每个分量一个连续数组，批量运算逐分量读写
+template <typename Scalar>
+struct RigidPoseArray {
+    std::vector<Scalar> qx, qy, qz, qw, tx, ty, tz;
+
+    int size() const { return static_cast<int>(qw.size()); }
+    void clear();
+    void reserve(int n);
+    void resize(int n);
+
+    void add(const RigidPose<Scalar>& pose);
+    RigidPose<Scalar> get(int i) const;
+    void set(int i, const RigidPose<Scalar>& pose);
+};
+
+// 以下批量运算的输出可以和输入是同一个数组；输出会被 resize 成输入的长度
+
+// out[i] = a[i] * b[i]，a、b 长度相同
+template <typename Scalar>
+void composePoses(const RigidPoseArray<Scalar>& a, const RigidPoseArray<Scalar>& b, RigidPoseArray<Scalar>& out);
+
+// out[i] = a[i]^-1 * b[i]（相对位姿，RPE / 位姿图边的误差）
+template <typename Scalar>
+void relativePoses(const RigidPoseArray<Scalar>& a, const RigidPoseArray<Scalar>& b, RigidPoseArray<Scalar>& out);
+
+// out[i] = poses[i]^-1
+template <typename Scalar>
+void invertPoses(const RigidPoseArray<Scalar>& poses, RigidPoseArray<Scalar>& out);
+
+// out[i] = pose * points[i]：同一个位姿变换 n 个点，先展开成旋转矩阵（每点 9 次乘法）
+template <typename Scalar>
+void transformPoints(const RigidPose<Scalar>& pose, const Eigen::Matrix<Scalar, 3, 1>* points, int n,
+                     Eigen::Matrix<Scalar, 3, 1>* out);
+
+// out[i] = poses[i] * points[i]
+template <typename Scalar>
+void transformPoints(const RigidPoseArray<Scalar>& poses, const Eigen::Matrix<Scalar, 3, 1>* points,
+                     Eigen::Matrix<Scalar, 3, 1>* out);
+
+}  // namespace slam
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace slam {
+
+// 队列满时生产者的处理方式
+enum class QueuePolicy {
+    kBlock,         // 背压：等待消费者腾出空间（上游允许变慢时用）
+    kDropNewest,    // 丢弃新元素，立即返回
+    kDropOldest,    // 丢弃最旧的元素，新元素总能入队（只关心最新数据时用）
+};
+
+// 队列统计（计数都是累计值）
+struct QueueStats {
+    std::string name;
+    int capacity = 0;
+    int depth = 0;              // 当前元素数
+    int max_depth = 0;          // 历史最大深度
+    std::uint64_t pushed = 0;
+    std::uint64_t popped = 0;
+    std::uint64_t dropped = 0;
+    double blocked_ms = 0.0;    // 生产者因背压等待的总时间
+};
+
+// 睡眠 / 唤醒：只有真的有线程在等时 notify 才去碰互斥锁，平时只是一次原子读
+class Notifier {
+public:
+    void notify() {
+        // 与 waitFor 里登记等待者之后的 ready() 检查配对（Dekker 式），保证不会两边都错过
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            signaled_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    // 等到 notify 或超时；ready() 在登记为等待者之后再检查一次，避免漏掉唤醒
+    template <typename Ready>
+    void waitFor(std::chrono::microseconds timeout, Ready ready) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        if (!signaled_ && !ready()) cv_.wait_for(lock, timeout, [this] { return signaled_; });
+        signaled_ = false;
+        waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+private:
+    std::atomic<int> waiters_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool signaled_ = false;
+};
+
+// 类型无关的队列接口（流水线用来汇总统计）
+class QueueBase {
+public:
+    virtual ~QueueBase() = default;
+    virtual QueueStats stats() const = 0;
+    virtual bool empty() const = 0;
+    // 关闭后 kBlock 的生产者不再等待；reopen 恢复背压（流水线停止 / 重新启动时用）
+    virtual void close() = 0;
+    virtual void reopen() = 0;
+    // 消费者所在阶段的唤醒器：有新元素时通知
+    void setConsumerNotifier(Notifier* notifier) { consumer_notifier_.store(notifier, std::memory_order_release); }
+
+protected:
+    std::atomic<Notifier*> consumer_notifier_{nullptr};
+};
+
+/*
+有界单生产者 / 单消费者环形队列（无锁）
+
+    1. 每个槽位带一个序号（Vyukov 有界队列的做法）：seq == pos 表示空闲可写，seq == pos + 1 表示已发布可读，
+       读写位置各自独占一个缓存行，生产者和消费者不争同一个缓存行；
+    2. 消费者先用 CAS 推进读位置占有槽位再取出元素，所以 kDropOldest 时生产者也能用同一个 CAS
+       把最旧的元素“抢”过来丢掉，两边不会同时访问一个槽位；消费者正好在取这个元素时生产者只需等它取完；
+    3. kBlock 时生产者先自旋一小段，再在 Notifier 上睡眠，由消费者取出元素时唤醒。
+只能有一个线程 push、一个线程 pop。
+ */
+template <typename T>
+class SpscQueue : public QueueBase {
+public:
+    SpscQueue(std::string name, int capacity, QueuePolicy policy)
+        : name_(std::move(name)), policy_(policy) {
+        int cap = 1;
+        while (cap < std::max(1, capacity)) cap <<= 1;
+        capacity_ = cap;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+        for (int i = 0; i < cap; ++i) slots_[i].seq.store(static_cast<std::uint64_t>(i), std::memory_order_relaxed);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 生产者：按策略入队，返回元素是否入队（kDropNewest 满时、close 之后返回 false）
+    bool push(T value) {
+        const std::uint64_t h = head_;
+        Slot& slot = slots_[h & mask_];
+        if (slot.seq.load(std::memory_order_acquire) != h && !makeRoom(h, slot)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slot.value = std::move(value);
+        slot.seq.store(h + 1, std::memory_order_release);
+        head_ = h + 1;
+        head_published_.store(h + 1, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        const int depth = static_cast<int>(h + 1 - tail_.load(std::memory_order_relaxed));
+        if (depth > max_depth_.load(std::memory_order_relaxed)) max_depth_.store(depth, std::memory_order_relaxed);
+        if (Notifier* n = consumer_notifier_.load(std::memory_order_acquire)) n->notify();
+        return true;
+    }
+
+    // 消费者：没有元素时返回 false
+    bool tryPop(T& out) {
+        for (;;) {
+            std::uint64_t t = tail_.load(std::memory_order_acquire);
+            Slot& slot = slots_[t & mask_];
+            if (slot.seq.load(std::memory_order_acquire) != t + 1) return false;
+            // 先占有再读：失败说明生产者刚把它当作最旧元素丢掉了
+            if (!tail_.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel)) continue;
+            out = std::move(slot.value);
+            slot.value = T();
+            slot.seq.store(t + capacity_, std::memory_order_release);
+            popped_.fetch_add(1, std::memory_order_relaxed);
+            if (policy_ == QueuePolicy::kBlock) space_.notify();
+            return true;
+        }
+    }
+
+    void close() override {
+        closed_.store(true, std::memory_order_release);
+        space_.notify();
+    }
+    // 队列里剩下的元素保留，重新启动后照常取出
+    void reopen() override { closed_.store(false, std::memory_order_release); }
+
+    int size() const {
+        const std::uint64_t h = head_published_.load(std::memory_order_acquire);
+        const std::uint64_t t = tail_.load(std::memory_order_acquire);
+        return h > t ? static_cast<int>(h - t) : 0;
+    }
+    bool empty() const override { return size() == 0; }
+    int capacity() const { return capacity_; }
+    QueuePolicy policy() const { return policy_; }
+
+    QueueStats stats() const override {
+        QueueStats s;
+        s.name = name_;
+        s.capacity = capacity_;
+        s.depth = size();
+        s.max_depth = max_depth_.load(std::memory_order_relaxed);
+        s.pushed = pushed_.load(std::memory_order_relaxed);
+        s.popped = popped_.load(std::memory_order_relaxed);
+        s.dropped = dropped_.load(std::memory_order_relaxed);
+        s.blocked_ms = blocked_ns_.load(std::memory_order_relaxed) * 1e-6;
+        return s;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> seq{0};
+        T value{};
+    };
+
+    // 槽位 h 还被第 h - capacity 个元素占着（队列满，或者消费者正在取它）
+    bool makeRoom(std::uint64_t h, Slot& slot) {
+        const std::uint64_t oldest = h - capacity_;
+        if (policy_ == QueuePolicy::kDropNewest) return false;
+        if (policy_ == QueuePolicy::kDropOldest) {
+            std::uint64_t t = oldest;
+            if (tail_.compare_exchange_strong(t, oldest + 1, std::memory_order_acq_rel)) {
+                // 抢到了最旧的元素：丢掉它，槽位直接给新元素用
+                slot.value = T();
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            // 消费者正在取它，马上就会释放
+            while (slot.seq.load(std::memory_order_acquire) != h) std::this_thread::yield();
+            return true;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        for (int spin = 0; slot.seq.load(std::memory_order_acquire) != h; ++spin) {
+            if (closed_.load(std::memory_order_acquire)) return false;
+            if (spin < 64) {
+                std::this_thread::yield();
+            } else {
+                space_.waitFor(std::chrono::microseconds(500), [&] {
+                    return slot.seq.load(std::memory_order_acquire) == h || closed_.load(std::memory_order_acquire);
+                });
+            }
+        }
+        blocked_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - start).count(),
+                              std::memory_order_relaxed);
+        return true;
+    }
+
+    std::string name_;
+    QueuePolicy policy_;
+    int capacity_ = 0;
+    std::uint64_t mask_ = 0;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::uint64_t head_ = 0;                  // 生产者私有
+    std::atomic<std::uint64_t> head_published_{0};        // 只用于统计深度
+    alignas(64) std::atomic<std::uint64_t> tail_{0};      // 消费者推进；kDropOldest 时生产者也会推进
+
+    alignas(64) std::atomic<std::uint64_t> pushed_{0};
+    std::atomic<std::uint64_t> popped_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::int64_t> blocked_ns_{0};
+    std::atomic<int> max_depth_{0};
+    std::atomic<bool> closed_{false};
+    Notifier space_;
+};
+
+}  // namespace slam
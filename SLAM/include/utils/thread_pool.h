@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace slam {
+
+// 常驻线程池，只提供 parallelFor 一种用法：
+// 每帧都要并行的前端/后端计算如果每次都创建 std::thread，光创建线程就要几十微秒，
+// 所以线程常驻，用条件变量唤醒；调用线程本身也参与计算。
+class ThreadPool {
+public:
+    // num_threads 包括调用线程，<= 0 时使用 hardware_concurrency
+    explicit ThreadPool(int num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // 把任务 [0, n_tasks) 动态分给所有线程，fn(task, thread_id)，thread_id 属于 [0, size())
+    // 阻塞直到所有任务完成；不可重入（fn 里不能再调用同一个线程池的 parallelFor，会死锁）。
+    // 多个线程同时调用时互相串行：后来的调用方阻塞到前一批任务全部做完才开始分发，
+    // 所以一个线程池同一时刻只服务一个调用方，互相不能等待的线程（如流水线的各个阶段）应该各用一个线程池
+    void parallelFor(int n_tasks, const std::function<void(int, int)>& fn);
+
+    // 进程内共享的默认线程池；各模块不传线程池时用它，多个线程同时使用时互相串行（见 parallelFor）
+    static ThreadPool& global();
+
+private:
+    void workerLoop(int thread_id);
+    void runTasks(int thread_id);
+
+    std::vector<std::thread> workers_;
+    std::mutex caller_mutex_;   // 覆盖一次 parallelFor 的分发和等待，保证同一时刻只有一个任务批次
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(int, int)>* job_ = nullptr;
+    int n_tasks_ = 0;
+    std::atomic<int> next_task_{0};
+    int active_ = 0;            // 还在执行当前任务批次的工作线程数
+    unsigned long generation_ = 0;
+    bool stop_ = false;
+};
+
+}  // namespace slam
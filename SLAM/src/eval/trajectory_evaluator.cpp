@@ -0,0 +1,404 @@
+#include "eval/trajectory_evaluator.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include "utils/mapped_file.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr std::size_t kBytesPerParseTask = 1 << 20;
+
+// 把 [0, n) 分块交给线程池；pool 为空时在调用线程上顺序执行
+template <typename Fn>
+void forChunks(ThreadPool* pool, int n, int chunk, const Fn& fn) {
+    const int n_tasks = (n + chunk - 1) / chunk;
+    if (!pool || n_tasks <= 1) {
+        for (int t = 0; t < n_tasks; ++t) fn(t, t * chunk, std::min(n, (t + 1) * chunk));
+        return;
+    }
+    pool->parallelFor(n_tasks, [&](int task, int) { fn(task, task * chunk, std::min(n, (task + 1) * chunk)); });
+}
+
+inline bool isSeparator(char c) { return c == ' ' || c == ',' || c == '\t' || c == '\r'; }
+
+// 解析一行里的前 count 个数；第一个数在 EuRoC 格式下是整数纳秒
+bool parseLine(const char* p, const char* end, bool euroc, double* values, int count) {
+    for (int k = 0; k < count; ++k) {
+        while (p < end && isSeparator(*p)) ++p;
+        if (k == 0 && euroc) {
+            long long ns = 0;
+            const auto r = std::from_chars(p, end, ns);
+            if (r.ec != std::errc()) return false;
+            values[0] = static_cast<double>(ns / 1000000000) + static_cast<double>(ns % 1000000000) * 1e-9;
+            p = r.ptr;
+        } else {
+            const auto r = std::from_chars(p, end, values[k]);
+            if (r.ec != std::errc()) return false;
+            p = r.ptr;
+        }
+    }
+    return true;
+}
+
+// 解析 [begin, end) 里的完整行（两端都在行边界上）
+bool parseChunk(const char* begin, const char* end, bool euroc, Trajectory& out) {
+    double v[8];
+    const char* p = begin;
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+        const char* q = p;
+        while (q < line_end && (*q == ' ' || *q == '\t' || *q == '\r')) ++q;
+        if (q < line_end && *q != '#') {
+            if (!parseLine(q, line_end, euroc, v, 8)) return false;
+            // TUM：t x y z qx qy qz qw；EuRoC：t x y z qw qx qy qz
+            const Eigen::Quaterniond rotation = euroc ? Eigen::Quaterniond(v[4], v[5], v[6], v[7])
+                                                      : Eigen::Quaterniond(v[7], v[4], v[5], v[6]);
+            out.add(v[0], Eigen::Vector3d(v[1], v[2], v[3]), rotation.normalized());
+        }
+        p = line_end + 1;
+    }
+    return true;
+}
+
+struct Moments {
+    double n = 0.0;
+    Eigen::Vector3d sx = Eigen::Vector3d::Zero();
+    Eigen::Vector3d sy = Eigen::Vector3d::Zero();
+    double sxx = 0.0;
+    Eigen::Matrix3d syx = Eigen::Matrix3d::Zero();
+
+    void merge(const Moments& o) {
+        n += o.n;
+        sx += o.sx;
+        sy += o.sy;
+        sxx += o.sxx;
+        syx += o.syx;
+    }
+};
+
+struct SumStats {
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = 0.0;
+
+    void add(double e) {
+        sum += e;
+        sum_sq += e * e;
+        min = std::min(min, e);
+        max = std::max(max, e);
+    }
+    void merge(const SumStats& o) {
+        sum += o.sum;
+        sum_sq += o.sum_sq;
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+    }
+};
+
+// errors 会被 nth_element 打乱
+ErrorStats summarize(std::vector<double>& errors, const SumStats& sums) {
+    ErrorStats stats;
+    const int n = static_cast<int>(errors.size());
+    if (n == 0) return stats;
+    stats.count = n;
+    stats.mean = sums.sum / n;
+    stats.rmse = std::sqrt(sums.sum_sq / n);
+    stats.std = std::sqrt(std::max(0.0, sums.sum_sq / n - stats.mean * stats.mean));
+    stats.min = sums.min;
+    stats.max = sums.max;
+    auto mid = errors.begin() + n / 2;
+    std::nth_element(errors.begin(), mid, errors.end());
+    stats.median = *mid;
+    if (n % 2 == 0) stats.median = 0.5 * (stats.median + *std::max_element(errors.begin(), mid));
+    return stats;
+}
+
+inline double rotationAngleDeg(const Eigen::Quaterniond& q) {
+    return 2.0 * std::atan2(q.vec().norm(), std::fabs(q.w())) * 180.0 / M_PI;
+}
+
+}  // namespace
+
+void Trajectory::clear() {
+    t.clear();
+    p.clear();
+    q.clear();
+}
+
+void Trajectory::reserve(int n) {
+    t.reserve(n);
+    p.reserve(n);
+    q.reserve(n);
+}
+
+void Trajectory::add(double time, const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation) {
+    t.push_back(time);
+    p.push_back(position);
+    q.push_back(orientation);
+}
+
+TrajectoryEvaluator::TrajectoryEvaluator(const TrajectoryEvaluatorOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()) {}
+
+bool TrajectoryEvaluator::load(const std::string& path, Trajectory& trajectory) const {
+    trajectory.clear();
+    MappedFile file;
+    if (!file.open(path)) return false;
+    file.adviseSequential();
+    const char* data = reinterpret_cast<const char*>(file.data());
+    const char* end = data + file.size();
+
+    // 第一行数据里有逗号就是 EuRoC 的 CSV
+    bool euroc = false;
+    for (const char* p = data; p < end;) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+        if (p < line_end && *p != '#') {
+            euroc = std::memchr(p, ',', line_end - p) != nullptr;
+            break;
+        }
+        p = line_end + 1;
+    }
+
+    // 按行边界切块
+    const int n_chunks = static_cast<int>(std::max<std::size_t>(1, file.size() / kBytesPerParseTask));
+    std::vector<const char*> bounds(n_chunks + 1, end);
+    bounds[0] = data;
+    for (int k = 1; k < n_chunks; ++k) {
+        const char* p = data + file.size() * k / n_chunks;
+        const char* nl = p < end ? static_cast<const char*>(std::memchr(p, '\n', end - p)) : nullptr;
+        bounds[k] = std::max(bounds[k - 1], nl ? nl + 1 : end);
+    }
+    std::vector<Trajectory> parts(n_chunks);
+    std::vector<char> ok(n_chunks, 0);
+    forChunks(pool_, n_chunks, 1, [&](int task, int, int) {
+        parts[task].reserve(static_cast<int>((bounds[task + 1] - bounds[task]) / 64));
+        ok[task] = parseChunk(bounds[task], bounds[task + 1], euroc, parts[task]);
+    });
+    if (std::find(ok.begin(), ok.end(), 0) != ok.end()) return false;
+
+    int total = 0;
+    for (const Trajectory& part : parts) total += part.size();
+    trajectory.reserve(total);
+    for (const Trajectory& part : parts) {
+        trajectory.t.insert(trajectory.t.end(), part.t.begin(), part.t.end());
+        trajectory.p.insert(trajectory.p.end(), part.p.begin(), part.p.end());
+        trajectory.q.insert(trajectory.q.end(), part.q.begin(), part.q.end());
+    }
+
+    if (!std::is_sorted(trajectory.t.begin(), trajectory.t.end())) {
+        std::vector<int> order(total);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return trajectory.t[a] < trajectory.t[b]; });
+        Trajectory sorted;
+        sorted.reserve(total);
+        for (int i : order) sorted.add(trajectory.t[i], trajectory.p[i], trajectory.q[i]);
+        trajectory = std::move(sorted);
+    }
+    return true;
+}
+
+int TrajectoryEvaluator::associate(const Trajectory& gt, const Trajectory& est, std::vector<int>& gt_index,
+                                   std::vector<int>& est_index) const {
+    gt_index.clear();
+    est_index.clear();
+    const int n_gt = gt.size();
+    int j = 0, last = -1;
+    for (int i = 0; i < est.size(); ++i) {
+        const double te = est.t[i] + options_.time_offset;
+        while (j + 1 < n_gt && gt.t[j + 1] <= te) ++j;
+        // 最近的真值只可能是 te 两侧的 j 和 j + 1
+        int best = -1;
+        double best_dt = options_.max_dt;
+        for (int c = j; c <= j + 1 && c < n_gt; ++c) {
+            if (c <= last) continue;
+            const double dt = std::fabs(gt.t[c] - te);
+            if (dt <= best_dt) {
+                best = c;
+                best_dt = dt;
+            }
+        }
+        if (best < 0) continue;
+        gt_index.push_back(best);
+        est_index.push_back(i);
+        last = best;
+    }
+    return static_cast<int>(gt_index.size());
+}
+
+bool TrajectoryEvaluator::align(const std::vector<Eigen::Vector3d>& src, const std::vector<Eigen::Vector3d>& dst,
+                                TrajectoryAlignment& alignment) const {
+    const int n = static_cast<int>(src.size());
+    if (n < 3 || dst.size() != src.size()) return false;
+
+    // 一遍累加（先平移到第一个点附近）
+    const Eigen::Vector3d x0 = src[0], y0 = dst[0];
+    const int chunk = std::max(1, options_.poses_per_task);
+    std::vector<Moments> partial((n + chunk - 1) / chunk);
+    forChunks(pool_, n, chunk, [&](int task, int begin, int end) {
+        Moments m;
+        for (int i = begin; i < end; ++i) {
+            const Eigen::Vector3d x = src[i] - x0, y = dst[i] - y0;
+            m.sx += x;
+            m.sy += y;
+            m.sxx += x.squaredNorm();
+            m.syx.noalias() += y * x.transpose();
+        }
+        m.n = end - begin;
+        partial[task] = m;
+    });
+    Moments m;
+    for (const Moments& part : partial) m.merge(part);
+
+    const Eigen::Vector3d mu_x = m.sx / m.n, mu_y = m.sy / m.n;
+    const Eigen::Matrix3d sigma = m.syx / m.n - mu_y * mu_x.transpose();
+    const double var_x = m.sxx / m.n - mu_x.squaredNorm();
+
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(sigma, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Vector3d S = Eigen::Vector3d::Ones();
+    if (svd.matrixU().determinant() * svd.matrixV().determinant() < 0.0) S(2) = -1.0;
+    alignment.R = svd.matrixU() * S.asDiagonal() * svd.matrixV().transpose();
+    alignment.s = options_.scale && var_x > 0.0 ? svd.singularValues().dot(S) / var_x : 1.0;
+    alignment.t = (y0 + mu_y) - alignment.s * alignment.R * (x0 + mu_x);
+    return true;
+}
+
+bool TrajectoryEvaluator::evaluate(const Trajectory& gt, const Trajectory& est, EvaluationResult& result) const {
+    result = EvaluationResult();
+    std::vector<int> gt_index, est_index;
+    const int m = associate(gt, est, gt_index, est_index);
+    result.num_matched = m;
+    if (m < 3) return false;
+
+    // 匹配上的位姿按 SoA 拷成连续数组，后面各步都是顺序访问
+    std::vector<Eigen::Vector3d> gp(m), ep(m);
+    std::vector<Eigen::Quaterniond> gq(m), eq(m);
+    const int chunk = std::max(1, options_.poses_per_task);
+    forChunks(pool_, m, chunk, [&](int, int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            gp[k] = gt.p[gt_index[k]];
+            gq[k] = gt.q[gt_index[k]];
+            ep[k] = est.p[est_index[k]];
+            eq[k] = est.q[est_index[k]];
+        }
+    });
+    if (options_.align && !align(ep, gp, result.alignment)) return false;
+    const TrajectoryAlignment& a = result.alignment;
+
+    // ATE
+    const int n_tasks = (m + chunk - 1) / chunk;
+    std::vector<double> errors(m);
+    std::vector<SumStats> sums(n_tasks);
+    forChunks(pool_, m, chunk, [&](int task, int begin, int end) {
+        SumStats s;
+        const Eigen::Matrix3d sR = a.s * a.R;
+        for (int k = begin; k < end; ++k) {
+            errors[k] = (gp[k] - (sR * ep[k] + a.t)).norm();
+            s.add(errors[k]);
+        }
+        sums[task] = s;
+    });
+    for (int t = 1; t < n_tasks; ++t) sums[0].merge(sums[t]);
+    result.ate = summarize(errors, sums[0]);
+
+    // RPE：每个尺度上有效的起点 i 都是前缀 [0, count)，终点 j = i + delta 或走过 delta 米后的第一个位姿
+    std::vector<double> travelled;
+    if (!options_.rpe_distances.empty()) {
+        travelled.resize(m);
+        travelled[0] = 0.0;
+        for (int k = 1; k < m; ++k) travelled[k] = travelled[k - 1] + (gp[k] - gp[k - 1]).norm();
+    }
+    struct Scale {
+        bool by_distance;
+        double delta;
+        int count;
+        int first_task;
+    };
+    std::vector<Scale> scales;
+    int total_tasks = 0;
+    const auto add_scale = [&](bool by_distance, double delta, int count) {
+        count = std::max(0, count);
+        scales.push_back({by_distance, delta, count, total_tasks});
+        total_tasks += (count + chunk - 1) / chunk;
+    };
+    for (int d : options_.rpe_frame_deltas) {
+        if (d > 0) add_scale(false, d, m - d);
+    }
+    for (double d : options_.rpe_distances) {
+        if (d <= 0.0) continue;
+        const int count = static_cast<int>(
+            std::upper_bound(travelled.begin(), travelled.end(), travelled.back() - d) - travelled.begin());
+        add_scale(true, d, count);
+    }
+
+    std::vector<std::vector<double>> trans_errors(scales.size()), rot_errors(scales.size());
+    for (std::size_t s = 0; s < scales.size(); ++s) {
+        trans_errors[s].resize(scales[s].count);
+        rot_errors[s].resize(scales[s].count);
+    }
+    std::vector<SumStats> trans_sums(total_tasks), rot_sums(total_tasks);
+    // 所有尺度的块放进同一次 parallelFor
+    const auto run_task = [&](int task) {
+        int s = static_cast<int>(scales.size()) - 1;
+        while (scales[s].first_task > task) --s;
+        const Scale& scale = scales[s];
+        const int begin = (task - scale.first_task) * chunk;
+        const int end = std::min(scale.count, begin + chunk);
+        SumStats ts, rs;
+        int j = begin;
+        for (int i = begin; i < end; ++i) {
+            if (scale.by_distance) {
+                // count 保证 travelled[i] <= back - delta，但 travelled[i] + delta 可能舍入到 back 之上
+                const double target = travelled[i] + scale.delta;
+                while (j < m - 1 && travelled[j] < target) ++j;
+            } else {
+                j = i + static_cast<int>(scale.delta);
+            }
+            const Eigen::Vector3d dg = gq[i].conjugate() * (gp[j] - gp[i]);
+            const Eigen::Vector3d de = a.s * (eq[i].conjugate() * (ep[j] - ep[i]));
+            const Eigen::Quaterniond dq = (gq[i].conjugate() * gq[j]).conjugate() * (eq[i].conjugate() * eq[j]);
+            const double te = (de - dg).norm();
+            const double re = rotationAngleDeg(dq);
+            trans_errors[s][i] = te;
+            rot_errors[s][i] = re;
+            ts.add(te);
+            rs.add(re);
+        }
+        trans_sums[task] = ts;
+        rot_sums[task] = rs;
+    };
+    if (total_tasks > 1) {
+        pool_->parallelFor(total_tasks, [&](int task, int) { run_task(task); });
+    } else if (total_tasks == 1) {
+        run_task(0);
+    }
+
+    for (std::size_t s = 0; s < scales.size(); ++s) {
+        RpeResult rpe;
+        rpe.by_distance = scales[s].by_distance;
+        rpe.delta = scales[s].delta;
+        const int first = scales[s].first_task;
+        const int last = s + 1 < scales.size() ? scales[s + 1].first_task : total_tasks;
+        SumStats ts, rs;
+        for (int t = first; t < last; ++t) {
+            ts.merge(trans_sums[t]);
+            rs.merge(rot_sums[t]);
+        }
+        rpe.translation = summarize(trans_errors[s], ts);
+        rpe.rotation = summarize(rot_errors[s], rs);
+        result.rpe.push_back(rpe);
+    }
+    return true;
+}
+
+}  // namespace slam
@@ -0,0 +1,405 @@
+#include "frontend/essential_ransac.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Eigenvalues>
+
+#include "utils/ransac.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// 五点法用到的三元多项式（变量 x, y, z，最高 3 次）
+// 单项式按 grevlex 序排列：前 10 个是三次项，后 10 个（二次、一次、常数）是商环的基
+
+constexpr int kNumMonomials = 20;
+constexpr int kExponents[kNumMonomials][3] = {
+    {3, 0, 0}, {2, 1, 0}, {2, 0, 1}, {1, 2, 0}, {1, 1, 1}, {1, 0, 2}, {0, 3, 0}, {0, 2, 1}, {0, 1, 2}, {0, 0, 3},
+    {2, 0, 0}, {1, 1, 0}, {1, 0, 1}, {0, 2, 0}, {0, 1, 1}, {0, 0, 2},
+    {1, 0, 0}, {0, 1, 0}, {0, 0, 1},
+    {0, 0, 0}};
+constexpr int kQuadratic = 10;  // 二次多项式只有 [10, 20) 非零
+constexpr int kLinear = 16;     // 一次多项式只有 [16, 20) 非零
+constexpr int kBasis = 10;      // 商环基的起始下标
+
+// 单项式乘法表：kProduct.index[i][j] 是 m_i * m_j 的下标，超过 3 次为 -1
+struct ProductTable {
+    int index[kNumMonomials][kNumMonomials];
+
+    constexpr ProductTable() : index() {
+        for (int i = 0; i < kNumMonomials; ++i) {
+            for (int j = 0; j < kNumMonomials; ++j) {
+                index[i][j] = -1;
+                for (int k = 0; k < kNumMonomials; ++k) {
+                    if (kExponents[k][0] == kExponents[i][0] + kExponents[j][0] &&
+                        kExponents[k][1] == kExponents[i][1] + kExponents[j][1] &&
+                        kExponents[k][2] == kExponents[i][2] + kExponents[j][2]) {
+                        index[i][j] = k;
+                    }
+                }
+            }
+        }
+    }
+};
+constexpr ProductTable kProduct;
+
+using Poly = Eigen::Matrix<double, kNumMonomials, 1>;
+
+// a 只在 [a_begin, 20) 非零，b 只在 [b_begin, 20) 非零，调用方保证乘积不超过 3 次
+Poly multiply(const Poly& a, int a_begin, const Poly& b, int b_begin) {
+    Poly r = Poly::Zero();
+    for (int i = a_begin; i < kNumMonomials; ++i) {
+        if (a[i] == 0.0) continue;
+        for (int j = b_begin; j < kNumMonomials; ++j) r[kProduct.index[i][j]] += a[i] * b[j];
+    }
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// 打分
+
+constexpr int kChunk = 64;      // 打分时每块的对应点数
+using ChunkArray = Eigen::Array<double, kChunk, 1>;
+using ChunkMap = Eigen::Map<const ChunkArray>;
+
+// 对应点按 kChunk 补齐后的副本，尾部 x2 用 NaN 填充，NaN 的比较结果为 false，永远不会被判为内点
+struct PaddedCorrespondences {
+    std::vector<double> x1, y1, x2, y2;
+    int size = 0;
+
+    void load(const TwoViewCorrespondences& data) {
+        size = data.size();
+        const int padded = (size + kChunk - 1) / kChunk * kChunk;
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        x1.assign(padded, 0.0);
+        y1.assign(padded, 0.0);
+        x2.assign(padded, nan);
+        y2.assign(padded, nan);
+        std::copy(data.x1.begin(), data.x1.end(), x1.begin());
+        std::copy(data.y1.begin(), data.y1.end(), y1.begin());
+        std::copy(data.x2.begin(), data.x2.end(), x2.begin());
+        std::copy(data.y2.begin(), data.y2.end(), y2.begin());
+    }
+};
+
+// Sampson 误差 (x2^T E x1)^2 / (|(E x1)_{0,1}|^2 + |(E^T x2)_{0,1}|^2) < threshold2，不做除法
+inline int countChunkInliers(const Eigen::Matrix3d& E, const ChunkArray& x1, const ChunkArray& y1,
+                             const ChunkArray& x2, const ChunkArray& y2, double threshold2) {
+    const ChunkArray l0 = E(0, 0) * x1 + E(0, 1) * y1 + E(0, 2);
+    const ChunkArray l1 = E(1, 0) * x1 + E(1, 1) * y1 + E(1, 2);
+    const ChunkArray l2 = E(2, 0) * x1 + E(2, 1) * y1 + E(2, 2);
+    const ChunkArray m0 = E(0, 0) * x2 + E(1, 0) * y2 + E(2, 0);
+    const ChunkArray m1 = E(0, 1) * x2 + E(1, 1) * y2 + E(2, 1);
+    const ChunkArray c = x2 * l0 + y2 * l1 + l2;
+    return static_cast<int>((c * c < threshold2 * (l0 * l0 + l1 * l1 + m0 * m0 + m1 * m1)).count());
+}
+
+// 一个最小集的全部解及其打分状态，由线程池中的一个任务独占
+struct SampleSlot {
+    int indices[5];
+    int n_solutions = 0;
+    Eigen::Matrix3d E[10];
+    double log_lambda[10];
+    int inliers[10];
+    int tested[10];
+    bool alive[10];
+};
+
+}  // namespace
+
+int solveFivePoint(const Eigen::Vector3d q1[5], const Eigen::Vector3d q2[5], Eigen::Matrix3d E[10]) {
+    // 1. 对极约束 q2^T E q1 = 0 的 5x9 系数矩阵，零空间 4 维：E = x E1 + y E2 + z E3 + E4
+    Eigen::Matrix<double, 9, 5> At;
+    for (int p = 0; p < 5; ++p) {
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) At(3 * i + j, p) = q2[p][i] * q1[p][j];
+        }
+    }
+    const Eigen::HouseholderQR<Eigen::Matrix<double, 9, 5>> qr(At);
+    const Eigen::Matrix<double, 9, 9> Q = qr.householderQ();
+    const Eigen::Matrix<double, 9, 4> N = Q.rightCols<4>();
+
+    Poly e[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            e[i][j].setZero();
+            e[i][j].tail<4>() = N.row(3 * i + j).transpose();
+        }
+    }
+
+    // 2. 10 个三次约束：det(E) = 0，2 E E^T E - tr(E E^T) E = 0
+    Poly EEt[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            EEt[i][j] = multiply(e[i][0], kLinear, e[j][0], kLinear) + multiply(e[i][1], kLinear, e[j][1], kLinear) +
+                        multiply(e[i][2], kLinear, e[j][2], kLinear);
+            EEt[j][i] = EEt[i][j];
+        }
+    }
+    const Poly half_trace = 0.5 * (EEt[0][0] + EEt[1][1] + EEt[2][2]);
+
+    Eigen::Matrix<double, 10, kNumMonomials> M;
+    const Poly minor0 = multiply(e[1][1], kLinear, e[2][2], kLinear) - multiply(e[1][2], kLinear, e[2][1], kLinear);
+    const Poly minor1 = multiply(e[1][0], kLinear, e[2][2], kLinear) - multiply(e[1][2], kLinear, e[2][0], kLinear);
+    const Poly minor2 = multiply(e[1][0], kLinear, e[2][1], kLinear) - multiply(e[1][1], kLinear, e[2][0], kLinear);
+    M.row(0) = (multiply(e[0][0], kLinear, minor0, kQuadratic) - multiply(e[0][1], kLinear, minor1, kQuadratic) +
+                multiply(e[0][2], kLinear, minor2, kQuadratic)).transpose();
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            Poly r = -multiply(half_trace, kQuadratic, e[i][j], kLinear);
+            for (int k = 0; k < 3; ++k) r += multiply(EEt[i][k], kQuadratic, e[k][j], kLinear);
+            M.row(1 + 3 * i + j) = r.transpose();
+        }
+    }
+
+    // 3. 消元 [C | D] -> [I | B]：三次单项式 m_i = -B_i * b，b 是 10 个基单项式
+    const Eigen::PartialPivLU<Eigen::Matrix<double, 10, 10>> lu(M.leftCols<10>());
+    const Eigen::Matrix<double, 10, 10> B = lu.solve(M.rightCols<10>());
+    if (!B.allFinite()) return 0;
+
+    // 4. 乘 x 的作用矩阵：x * b_j 是基单项式时为单位行，否则是三次单项式，取 B 的对应行
+    Eigen::Matrix<double, 10, 10> action = Eigen::Matrix<double, 10, 10>::Zero();
+    for (int j = 0; j < 10; ++j) {
+        const int p = kProduct.index[kLinear][kBasis + j];
+        if (p < kBasis) {
+            action.row(j) = -B.row(p);
+        } else {
+            action(j, p - kBasis) = 1.0;
+        }
+    }
+
+    // 5. 作用矩阵的实特征值就是解的 x 坐标，特征向量与 b = [x², xy, xz, y², yz, z², x, y, z, 1] 在解处的取值成比例。
+    //    代入 x 后前 6 行 (A - xI) b = 0 对剩下的 [y², yz, z², y, z] 是线性的，解一个 6x5 最小二乘，
+    //    比完整的复特征向量分解或者对每个根做 10x10 零空间都便宜
+    const Eigen::EigenSolver<Eigen::Matrix<double, 10, 10>> eig(action, false);
+    if (eig.info() != Eigen::Success) return 0;
+    const auto& values = eig.eigenvalues();
+
+    int n = 0;
+    for (int k = 0; k < 10; ++k) {
+        const double x = values[k].real();
+        if (std::fabs(values[k].imag()) > 1e-8 * std::max(1.0, std::fabs(x))) continue;
+        Eigen::Matrix<double, 6, 5> L;
+        Eigen::Matrix<double, 6, 1> r;
+        for (int j = 0; j < 6; ++j) {
+            // 第 j 行：sum_i action(j, i) b_i = x * b_j，b_j 是 x², xy, xz, y², yz, z²
+            Eigen::Matrix<double, 10, 1> row = action.row(j).transpose();
+            row[j] -= x;
+            L(j, 0) = row[3];
+            L(j, 1) = row[4];
+            L(j, 2) = row[5];
+            L(j, 3) = row[7] + x * row[1];
+            L(j, 4) = row[8] + x * row[2];
+            r[j] = -(row[0] * x * x + row[6] * x + row[9]);
+        }
+        const Eigen::Matrix<double, 5, 1> u = L.householderQr().solve(r);
+        if (!u.allFinite()) continue;
+        const double y = u[3], z = u[4];
+        const Eigen::Matrix<double, 9, 1> v = x * N.col(0) + y * N.col(1) + z * N.col(2) + N.col(3);
+        const double norm = v.norm();
+        if (!(norm > 0.0)) continue;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) E[n](i, j) = v[3 * i + j] / norm;
+        }
+        ++n;
+    }
+    return n;
+}
+
+void decomposeEssential(const Eigen::Matrix3d& E, Eigen::Matrix3d R[4], Eigen::Vector3d t[4]) {
+    const Eigen::JacobiSVD<Eigen::Matrix3d> svd(E, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Matrix3d U = svd.matrixU();
+    Eigen::Matrix3d V = svd.matrixV();
+    if (U.determinant() < 0.0) U = -U;
+    if (V.determinant() < 0.0) V = -V;
+    Eigen::Matrix3d W;
+    W << 0.0, -1.0, 0.0,
+         1.0, 0.0, 0.0,
+         0.0, 0.0, 1.0;
+    R[0] = R[1] = U * W * V.transpose();
+    R[2] = R[3] = U * W.transpose() * V.transpose();
+    t[0] = t[2] = U.col(2);
+    t[1] = t[3] = -U.col(2);
+}
+
+void TwoViewCorrespondences::reserve(int n) {
+    x1.reserve(n);
+    y1.reserve(n);
+    x2.reserve(n);
+    y2.reserve(n);
+}
+
+void TwoViewCorrespondences::clear() {
+    x1.clear();
+    y1.clear();
+    x2.clear();
+    y2.clear();
+}
+
+void TwoViewCorrespondences::add(const Eigen::Vector2d& p1, const Eigen::Vector2d& p2) {
+    x1.push_back(p1.x());
+    y1.push_back(p1.y());
+    x2.push_back(p2.x());
+    y2.push_back(p2.y());
+}
+
+EssentialRansac::EssentialRansac(const EssentialRansacOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()) {}
+
+int EssentialRansac::countInliers(const TwoViewCorrespondences& data, const Eigen::Matrix3d& E, double threshold2,
+                                  std::vector<char>* mask) const {
+    const int n = data.size();
+    if (mask) mask->assign(n, 0);
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        const Eigen::Vector3d p1(data.x1[i], data.y1[i], 1.0);
+        const Eigen::Vector3d p2(data.x2[i], data.y2[i], 1.0);
+        const Eigen::Vector3d l = E * p1;
+        const Eigen::Vector3d m = E.transpose() * p2;
+        const double c = p2.dot(l);
+        if (c * c < threshold2 * (l.head<2>().squaredNorm() + m.head<2>().squaredNorm())) {
+            ++count;
+            if (mask) (*mask)[i] = 1;
+        }
+    }
+    return count;
+}
+
+bool EssentialRansac::estimate(const TwoViewCorrespondences& data, EssentialResult& result) {
+    result = EssentialResult();
+    const int n = data.size();
+    if (n < std::max(5, options_.min_inliers)) return false;
+
+    const double threshold = options_.max_error_px / options_.focal_length;
+    const double threshold2 = threshold * threshold;
+    const int batch_size = std::max(1, options_.batch_size);
+
+    // 五点法平均约 4 个实数解，求解代价大约相当于验证 1000 个点
+    ProsacSampler sampler(n, 5, options_.max_iterations, options_.use_prosac, options_.seed);
+    SprtTest sprt(0.1, 0.01, 1000.0, 4.0);
+
+    PaddedCorrespondences padded;
+    padded.load(data);
+    const int n_padded = static_cast<int>(padded.x1.size());
+
+    std::vector<SampleSlot> slots(batch_size);
+
+    int best_inliers = 0;
+    Eigen::Matrix3d best_E = Eigen::Matrix3d::Zero();
+    int needed = options_.max_iterations;
+
+    while (result.iterations < needed) {
+        // 1. 采样在调用线程上完成，结果与线程数无关
+        int n_samples = 0;
+        for (; n_samples < batch_size && result.iterations < needed; ++n_samples) {
+            sampler.sample(slots[n_samples].indices);
+            ++result.iterations;
+        }
+
+        // 2. 每个任务：五点法求解一个最小集，所有解按块一起打分，SPRT 只读
+        pool_->parallelFor(n_samples, [&](int s, int) {
+            SampleSlot& slot = slots[s];
+            Eigen::Vector3d q1[5], q2[5];
+            for (int k = 0; k < 5; ++k) {
+                const int i = slot.indices[k];
+                q1[k] = Eigen::Vector3d(data.x1[i], data.y1[i], 1.0);
+                q2[k] = Eigen::Vector3d(data.x2[i], data.y2[i], 1.0);
+            }
+            slot.n_solutions = solveFivePoint(q1, q2, slot.E);
+            for (int h = 0; h < slot.n_solutions; ++h) {
+                slot.log_lambda[h] = 0.0;
+                slot.inliers[h] = 0;
+                slot.tested[h] = 0;
+                slot.alive[h] = true;
+            }
+
+            int alive = slot.n_solutions;
+            for (int begin = 0; begin < n_padded && alive > 0; begin += kChunk) {
+                const ChunkMap x1(padded.x1.data() + begin), y1(padded.y1.data() + begin);
+                const ChunkMap x2(padded.x2.data() + begin), y2(padded.y2.data() + begin);
+                const int chunk_size = std::min(kChunk, n - begin);
+                for (int h = 0; h < slot.n_solutions; ++h) {
+                    if (!slot.alive[h]) continue;
+                    const int inl = countChunkInliers(slot.E[h], x1, y1, x2, y2, threshold2);
+                    slot.inliers[h] += inl;
+                    slot.tested[h] += chunk_size;
+                    if (options_.use_sprt && !sprt.update(slot.log_lambda[h], inl, chunk_size - inl)) {
+                        slot.alive[h] = false;
+                        --alive;
+                    }
+                }
+            }
+        });
+
+        // 3. 合并：按样本顺序更新最优模型、SPRT 参数和所需迭代次数
+        for (int s = 0; s < n_samples; ++s) {
+            const SampleSlot& slot = slots[s];
+            result.hypotheses += slot.n_solutions;
+            for (int h = 0; h < slot.n_solutions; ++h) {
+                if (!slot.alive[h]) {
+                    ++result.rejected_by_sprt;
+                    sprt.observeRejected(slot.inliers[h], slot.tested[h]);
+                    continue;
+                }
+                if (slot.inliers[h] <= best_inliers) continue;
+                best_inliers = slot.inliers[h];
+                best_E = slot.E[h];
+                const double ratio = static_cast<double>(best_inliers) / n;
+                sprt.setEpsilon(ratio);
+                needed = ransacIterations(options_.confidence, ratio, 5, options_.max_iterations);
+            }
+        }
+    }
+
+    if (best_inliers < options_.min_inliers) return false;
+
+    // 4. 内点上分解 E，选出正确的 (R, t)
+    std::vector<char> mask;
+    countInliers(data, best_E, threshold2, &mask);
+    result.num_in_front = recoverPose(data, mask, best_E, result.R_21, result.t_21);
+
+    result.success = result.num_in_front >= options_.min_inliers;
+    result.E = best_E;
+    result.num_inliers = best_inliers;
+    result.inlier_mask.swap(mask);
+    return result.success;
+}
+
+int EssentialRansac::recoverPose(const TwoViewCorrespondences& data, const std::vector<char>& inlier_mask,
+                                 const Eigen::Matrix3d& E, Eigen::Matrix3d& R_21, Eigen::Vector3d& t_21) {
+    Eigen::Matrix3d Rs[4];
+    Eigen::Vector3d ts[4];
+    decomposeEssential(E, Rs, ts);
+
+    const int n = data.size();
+    int best = -1;
+    for (int k = 0; k < 4; ++k) {
+        int in_front = 0;
+        for (int i = 0; i < n; ++i) {
+            if (!inlier_mask[i]) continue;
+            // d2 * x2 = d1 * R * x1 + t，两个深度的最小二乘（中点法）
+            const Eigen::Vector3d a = Rs[k] * Eigen::Vector3d(data.x1[i], data.y1[i], 1.0);
+            const Eigen::Vector3d b(data.x2[i], data.y2[i], 1.0);
+            const double aa = a.dot(a), ab = a.dot(b), bb = b.dot(b);
+            const double det = aa * bb - ab * ab;
+            if (det < 1e-12 * aa * bb) continue;   // 视差太小，无法判断
+            const double at = a.dot(ts[k]), bt = b.dot(ts[k]);
+            const double d1 = (-at * bb + ab * bt) / det;
+            const double d2 = (aa * bt - ab * at) / det;
+            if (d1 > 0.0 && d2 > 0.0) ++in_front;
+        }
+        if (in_front > best) {
+            best = in_front;
+            R_21 = Rs[k];
+            t_21 = ts[k];
+        }
+    }
+    return best;
+}
+
+}  // namespace slam
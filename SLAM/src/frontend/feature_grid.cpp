@@ -0,0 +1,97 @@
+#include "frontend/feature_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace slam {
+
+FeatureGrid::FeatureGrid(int grid_cols, int grid_rows)
+    : grid_cols_(grid_cols), grid_rows_(grid_rows) {}
+
+void FeatureGrid::build(const std::vector<KeyPoint>& keypoints, const std::vector<Descriptor>& descriptors,
+                        float min_x, float max_x, float min_y, float max_y) {
+    const int n = static_cast<int>(keypoints.size());
+    const int n_cells = grid_cols_ * grid_rows_;
+    n_keypoints_ = n;
+    min_x_ = min_x;
+    min_y_ = min_y;
+    inv_cell_w_ = grid_cols_ / (max_x - min_x);
+    inv_cell_h_ = grid_rows_ / (max_y - min_y);
+
+    // 计数
+    cell_offsets_.assign(n_cells + 1, 0);
+    cell_of_.resize(n);
+    int n_inside = 0;
+    for (int i = 0; i < n; ++i) {
+        const int cx = static_cast<int>(std::floor((keypoints[i].x - min_x_) * inv_cell_w_));
+        const int cy = static_cast<int>(std::floor((keypoints[i].y - min_y_) * inv_cell_h_));
+        if (cx < 0 || cx >= grid_cols_ || cy < 0 || cy >= grid_rows_) {
+            cell_of_[i] = -1;
+            continue;
+        }
+        cell_of_[i] = cy * grid_cols_ + cx;
+        ++cell_offsets_[cell_of_[i] + 1];
+        ++n_inside;
+    }
+
+    // 前缀和
+    for (int c = 0; c < n_cells; ++c) cell_offsets_[c + 1] += cell_offsets_[c];
+
+    // 散射，同一格子内保持原始顺序
+    std::vector<int>& cursor = cursor_;
+    cursor.assign(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    order_.resize(n_inside);
+    xs_.resize(n_inside);
+    ys_.resize(n_inside);
+    octaves_.resize(n_inside);
+    descriptors_.resize(n_inside);
+    for (int i = 0; i < n; ++i) {
+        const int c = cell_of_[i];
+        if (c < 0) continue;
+        const int k = cursor[c]++;
+        order_[k] = i;
+        xs_[k] = keypoints[i].x;
+        ys_[k] = keypoints[i].y;
+        octaves_[k] = keypoints[i].octave;
+        descriptors_[k] = descriptors[i];
+    }
+}
+
+int FeatureGrid::windowRuns(float x, float y, float radius, int* run_begin, int* run_end) const {
+    const int cx0 = std::max(0, static_cast<int>(std::floor((x - radius - min_x_) * inv_cell_w_)));
+    const int cx1 = std::min(grid_cols_ - 1, static_cast<int>(std::floor((x + radius - min_x_) * inv_cell_w_)));
+    const int cy0 = std::max(0, static_cast<int>(std::floor((y - radius - min_y_) * inv_cell_h_)));
+    const int cy1 = std::min(grid_rows_ - 1, static_cast<int>(std::floor((y + radius - min_y_) * inv_cell_h_)));
+    if (cx0 > cx1 || cy0 > cy1) return 0;
+
+    // 同一行相邻格子在 CSR 中是连续的，一行格子合并成一个区间
+    int n_runs = 0;
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        const int b = cell_offsets_[cy * grid_cols_ + cx0];
+        const int e = cell_offsets_[cy * grid_cols_ + cx1 + 1];
+        if (e > b) {
+            run_begin[n_runs] = b;
+            run_end[n_runs] = e;
+            ++n_runs;
+        }
+    }
+    return n_runs;
+}
+
+void FeatureGrid::featuresInArea(float x, float y, float radius, int min_level, int max_level,
+                                 std::vector<int>& indices) const {
+    indices.clear();
+    std::vector<int> run_begin(grid_rows_), run_end(grid_rows_);
+    const int n_runs = windowRuns(x, y, radius, run_begin.data(), run_end.data());
+    const bool check_level = max_level >= 0;
+    for (int r = 0; r < n_runs; ++r) {
+        for (int k = run_begin[r]; k < run_end[r]; ++k) {
+            if (check_level && (octaves_[k] < min_level || octaves_[k] > max_level)) continue;
+            if (std::fabs(xs_[k] - x) < radius && std::fabs(ys_[k] - y) < radius) {
+                indices.push_back(order_[k]);
+            }
+        }
+    }
+}
+
+}  // namespace slam
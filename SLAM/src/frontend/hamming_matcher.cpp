@@ -0,0 +1,318 @@
+#include "frontend/hamming_matcher.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "utils/profiler.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr int kLanes = 8;                 // 每个分块的描述子数
+constexpr int kWords = 4;                 // 256 位 = 4 个 64 位字
+constexpr std::uint64_t kInvalidKey = 0x7fffffffffffffffULL;   // 保持为正数，AVX2 可用有符号比较
+
+inline void mergeBest(std::uint64_t key, std::uint64_t& best1, std::uint64_t& best2) {
+    best2 = std::min(best2, std::max(best1, key));
+    best1 = std::min(best1, key);
+}
+
+#if defined(__AVX2__) && !(defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__))
+// pshufb 查表计算每个字节的 popcount
+inline __m256i popcountBytes(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+    const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+    return _mm256_add_epi8(lo, hi);
+}
+
+// 键都是非负数，有符号 64 位比较即可
+inline __m256i min64(__m256i a, __m256i b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+inline __m256i max64(__m256i a, __m256i b) {
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+// NQ 个 query 同时扫描 train 分块 [block_begin, block_end)：每个分块只加载一次，
+// 并且 NQ 条最优/次优的依赖链交错执行。列最优先在 NQ 个 query 之间取 min 再写回。
+template <int NQ>
+void scanBlocksAvx512(const Descriptor* query, std::uint32_t query_begin,
+                      const std::uint64_t* blocks, int block_begin, int block_end, int n_train,
+                      std::uint64_t* row_best, std::uint64_t* col_best) {
+    const int last_block = (n_train - 1) / kLanes;
+    const int tail = n_train - last_block * kLanes;
+    const __m512i lane = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i invalid = _mm512_set1_epi64(static_cast<long long>(kInvalidKey));
+    const __mmask8 tail_mask = static_cast<__mmask8>((1u << tail) - 1u);
+
+    __m512i q[NQ][kWords];
+    __m512i qkey[NQ];
+    __m512i b1[NQ], b2[NQ];
+#pragma GCC unroll 4
+    for (int n = 0; n < NQ; ++n) {
+#pragma GCC unroll 4
+        for (int k = 0; k < kWords; ++k) {
+            q[n][k] = _mm512_set1_epi64(static_cast<long long>(query[query_begin + n].words[k]));
+        }
+        qkey[n] = _mm512_set1_epi64(query_begin + n);
+        b1[n] = invalid;
+        b2[n] = invalid;
+    }
+
+    for (int b = block_begin; b < block_end; ++b) {
+        const std::uint64_t* p = blocks + b * kWords * kLanes;
+        __m512i t[kWords];
+#pragma GCC unroll 4
+        for (int k = 0; k < kWords; ++k) t[k] = _mm512_loadu_si512(p + k * kLanes);
+        const __m512i index = _mm512_add_epi64(_mm512_set1_epi64(b * kLanes), lane);
+
+        __m512i col = invalid;
+#pragma GCC unroll 4
+        for (int n = 0; n < NQ; ++n) {
+            __m512i d = _mm512_popcnt_epi64(_mm512_xor_si512(q[n][0], t[0]));
+#pragma GCC unroll 4
+            for (int k = 1; k < kWords; ++k) {
+                d = _mm512_add_epi64(d, _mm512_popcnt_epi64(_mm512_xor_si512(q[n][k], t[k])));
+            }
+            const __m512i dist_hi = _mm512_slli_epi64(d, 32);
+            __m512i key = _mm512_or_si512(dist_hi, index);
+            if (b == last_block) key = _mm512_mask_mov_epi64(invalid, tail_mask, key);
+            b2[n] = _mm512_min_epu64(b2[n], _mm512_max_epu64(b1[n], key));
+            b1[n] = _mm512_min_epu64(b1[n], key);
+            col = _mm512_min_epu64(col, _mm512_or_si512(dist_hi, qkey[n]));
+        }
+
+        if (col_best) {
+            std::uint64_t* c = col_best + b * kLanes;
+            _mm512_storeu_si512(c, _mm512_min_epu64(_mm512_loadu_si512(c), col));
+        }
+    }
+
+    alignas(64) std::uint64_t l1[kLanes], l2[kLanes];
+    for (int n = 0; n < NQ; ++n) {
+        std::uint64_t& best1 = row_best[2 * (query_begin + n)];
+        std::uint64_t& best2 = row_best[2 * (query_begin + n) + 1];
+        _mm512_store_si512(l1, b1[n]);
+        _mm512_store_si512(l2, b2[n]);
+        for (int l = 0; l < kLanes; ++l) {
+            mergeBest(l1[l], best1, best2);
+            best2 = std::min(best2, l2[l]);
+        }
+    }
+}
+#endif
+
+// 一个 query 扫描 train 分块 [block_begin, block_end)，更新该 query 的最优/次优键，
+// col_best 非空时同时更新每个 train 的最优 query 键
+void scanBlocks(const Descriptor* query, std::uint32_t query_index,
+                const std::uint64_t* blocks, int block_begin, int block_end, int n_train,
+                std::uint64_t* row_best, std::uint64_t* col_best) {
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+    scanBlocksAvx512<1>(query, query_index, blocks, block_begin, block_end, n_train, row_best, col_best);
+#else
+    const std::uint64_t* q = query[query_index].words;
+    std::uint64_t& best1 = row_best[2 * query_index];
+    std::uint64_t& best2 = row_best[2 * query_index + 1];
+    const int last_block = (n_train - 1) / kLanes;
+#if defined(__AVX2__)
+    const __m256i q0 = _mm256_set1_epi64x(static_cast<long long>(q[0]));
+    const __m256i q1 = _mm256_set1_epi64x(static_cast<long long>(q[1]));
+    const __m256i q2 = _mm256_set1_epi64x(static_cast<long long>(q[2]));
+    const __m256i q3 = _mm256_set1_epi64x(static_cast<long long>(q[3]));
+    const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i invalid = _mm256_set1_epi64x(static_cast<long long>(kInvalidKey));
+    const __m256i qkey = _mm256_set1_epi64x(query_index);
+    const __m256i zero = _mm256_setzero_si256();
+
+    __m256i b1 = invalid;
+    __m256i b2 = invalid;
+    for (int b = block_begin; b < block_end; ++b) {
+        for (int h = 0; h < 2; ++h) {
+            const std::uint64_t* p = blocks + b * kWords * kLanes + h * 4;
+            const auto ld = [p](int k) {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + k * kLanes));
+            };
+            // 4 个字的字节计数相加最大 32，不会溢出 8 位
+            __m256i acc = popcountBytes(_mm256_xor_si256(q0, ld(0)));
+            acc = _mm256_add_epi8(acc, popcountBytes(_mm256_xor_si256(q1, ld(1))));
+            acc = _mm256_add_epi8(acc, popcountBytes(_mm256_xor_si256(q2, ld(2))));
+            acc = _mm256_add_epi8(acc, popcountBytes(_mm256_xor_si256(q3, ld(3))));
+            const __m256i d = _mm256_sad_epu8(acc, zero);
+
+            const int base = b * kLanes + h * 4;
+            const __m256i dist_hi = _mm256_slli_epi64(d, 32);
+            const __m256i index = _mm256_add_epi64(_mm256_set1_epi64x(base), lane);
+            __m256i key = _mm256_or_si256(dist_hi, index);
+            if (b == last_block) {
+                const __m256i valid = _mm256_cmpgt_epi64(_mm256_set1_epi64x(n_train), index);
+                key = _mm256_blendv_epi8(invalid, key, valid);
+            }
+            b2 = min64(b2, max64(b1, key));
+            b1 = min64(b1, key);
+
+            if (col_best) {
+                __m256i* c = reinterpret_cast<__m256i*>(col_best + base);
+                const __m256i ckey = _mm256_or_si256(dist_hi, qkey);
+                _mm256_storeu_si256(c, min64(_mm256_loadu_si256(c), ckey));
+            }
+        }
+    }
+
+    alignas(32) std::uint64_t l1[4], l2[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(l1), b1);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(l2), b2);
+    for (int l = 0; l < 4; ++l) {
+        mergeBest(l1[l], best1, best2);
+        best2 = std::min(best2, l2[l]);
+    }
+#else
+    const int tail = n_train - last_block * kLanes;
+    for (int b = block_begin; b < block_end; ++b) {
+        const std::uint64_t* p = blocks + b * kWords * kLanes;
+        const int lanes = (b == last_block) ? tail : kLanes;
+        for (int l = 0; l < lanes; ++l) {
+            const std::uint64_t d = __builtin_popcountll(q[0] ^ p[l]) + __builtin_popcountll(q[1] ^ p[8 + l]) +
+                                    __builtin_popcountll(q[2] ^ p[16 + l]) + __builtin_popcountll(q[3] ^ p[24 + l]);
+            const int j = b * kLanes + l;
+            mergeBest((d << 32) | static_cast<std::uint64_t>(j), best1, best2);
+            if (col_best) col_best[j] = std::min(col_best[j], (d << 32) | query_index);
+        }
+    }
+#endif  // __AVX2__
+#endif  // __AVX512VPOPCNTDQ__
+}
+
+}  // namespace
+
+void hammingDistances(const Descriptor& query, const Descriptor* train, int n, int* out) {
+    int i = 0;
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+    // 一个 zmm 装 2 个描述子，4 个 zmm 装 8 个；popcount 后两两相加做 4 -> 1 的归约，
+    // 结果顺序为 [0, 2, 1, 3, 4, 6, 5, 7]，用 permutexvar 还原
+    const __m512i qq = _mm512_broadcast_i64x4(_mm256_load_si256(reinterpret_cast<const __m256i*>(query.words)));
+    const __m512i restore = _mm512_setr_epi64(0, 2, 1, 3, 4, 6, 5, 7);
+    for (; i < n; i += kLanes) {
+        const std::uint64_t* p = train[i].words;
+        const int count = std::min(kLanes, n - i);
+        __m512i v[4];
+        for (int j = 0; j < 4; ++j) {
+            const int valid = std::max(0, std::min(2, count - 2 * j));
+            const __mmask8 m = static_cast<__mmask8>((1u << (4 * valid)) - 1u);
+            v[j] = _mm512_popcnt_epi64(_mm512_xor_si512(qq, _mm512_maskz_loadu_epi64(m, p + 8 * j)));
+        }
+        const __m512i s01 = _mm512_add_epi64(_mm512_unpacklo_epi64(v[0], v[1]), _mm512_unpackhi_epi64(v[0], v[1]));
+        const __m512i s23 = _mm512_add_epi64(_mm512_unpacklo_epi64(v[2], v[3]), _mm512_unpackhi_epi64(v[2], v[3]));
+        const __m512i sum = _mm512_add_epi64(_mm512_shuffle_i64x2(s01, s23, _MM_SHUFFLE(2, 0, 2, 0)),
+                                             _mm512_shuffle_i64x2(s01, s23, _MM_SHUFFLE(3, 1, 3, 1)));
+        const __m256i d = _mm512_cvtepi64_epi32(_mm512_permutexvar_epi64(restore, sum));
+        _mm256_mask_storeu_epi32(out + i, static_cast<__mmask8>((1u << count) - 1u), d);
+    }
+#elif defined(__AVX2__)
+    // 一个 ymm 正好是一个描述子：字节 popcount 后 sad 得到 4 个部分和，4 个描述子的部分和
+    // 两两 unpack 相加、再跨 128 位通道相加，得到 [d0, d1, d2, d3]
+    const __m256i qq = _mm256_load_si256(reinterpret_cast<const __m256i*>(query.words));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+    const auto partial = [&](int k) {
+        const __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(train[i + k].words));
+        return _mm256_sad_epu8(popcountBytes(_mm256_xor_si256(qq, v)), zero);
+    };
+    for (; i + 4 <= n; i += 4) {
+        const __m256i s0 = partial(0), s1 = partial(1), s2 = partial(2), s3 = partial(3);
+        const __m256i s01 = _mm256_add_epi64(_mm256_unpacklo_epi64(s0, s1), _mm256_unpackhi_epi64(s0, s1));
+        const __m256i s23 = _mm256_add_epi64(_mm256_unpacklo_epi64(s2, s3), _mm256_unpackhi_epi64(s2, s3));
+        const __m256i sum = _mm256_add_epi64(_mm256_permute2x128_si256(s01, s23, 0x20),
+                                             _mm256_permute2x128_si256(s01, s23, 0x31));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(sum, order)));
+    }
+#endif
+    for (; i < n; ++i) out[i] = hammingDistance(query, train[i]);
+}
+
+HammingMatcher::HammingMatcher(const HammingMatcherOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()) {}
+
+void HammingMatcher::setTrain(const Descriptor* train, int n_train) {
+    n_train_ = n_train;
+    n_train_blocks_ = (n_train + kLanes - 1) / kLanes;
+    train_blocks_.assign(static_cast<size_t>(n_train_blocks_) * kWords * kLanes, 0);
+    for (int i = 0; i < n_train; ++i) {
+        std::uint64_t* block = train_blocks_.data() + (i / kLanes) * kWords * kLanes;
+        for (int k = 0; k < kWords; ++k) block[k * kLanes + i % kLanes] = train[i].words[k];
+    }
+}
+
+void HammingMatcher::match(const Descriptor* query, int n_query, std::vector<Match>& matches) {
+    SLAM_PROFILE_SCOPE("frontend/match");
+    matches.clear();
+    if (n_query <= 0 || n_train_ <= 0) return;
+
+    const int n_threads = pool_->size();
+    const int query_block = std::max(1, options_.query_block);
+    const int n_tasks = (n_query + query_block - 1) / query_block;
+    const int tile_blocks = std::max(1, options_.train_tile / kLanes);
+
+    row_best_.assign(2 * static_cast<size_t>(n_query), kInvalidKey);
+    if (options_.cross_check) {
+        col_best_.resize(n_threads);
+        for (auto& col : col_best_) col.assign(static_cast<size_t>(n_train_blocks_) * kLanes, kInvalidKey);
+    }
+
+    pool_->parallelFor(n_tasks, [&](int task, int thread_id) {
+        const int q_begin = task * query_block;
+        const int q_end = std::min(n_query, q_begin + query_block);
+        std::uint64_t* col = options_.cross_check ? col_best_[thread_id].data() : nullptr;
+        for (int t = 0; t < n_train_blocks_; t += tile_blocks) {
+            const int t_end = std::min(n_train_blocks_, t + tile_blocks);
+            int i = q_begin;
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+            for (; i + 4 <= q_end; i += 4) {
+                scanBlocksAvx512<4>(query, static_cast<std::uint32_t>(i), train_blocks_.data(), t, t_end,
+                                    n_train_, row_best_.data(), col);
+            }
+#endif
+            for (; i < q_end; ++i) {
+                scanBlocks(query, static_cast<std::uint32_t>(i), train_blocks_.data(), t, t_end,
+                           n_train_, row_best_.data(), col);
+            }
+        }
+    });
+
+    if (options_.cross_check) {
+        std::vector<std::uint64_t>& col = col_best_[0];
+        for (int th = 1; th < n_threads; ++th) {
+            const std::vector<std::uint64_t>& other = col_best_[th];
+            for (int j = 0; j < n_train_; ++j) col[j] = std::min(col[j], other[j]);
+        }
+    }
+
+    for (int i = 0; i < n_query; ++i) {
+        const std::uint64_t best1 = row_best_[2 * i];
+        const std::uint64_t best2 = row_best_[2 * i + 1];
+        if (best1 == kInvalidKey) continue;
+
+        const int d1 = static_cast<int>(best1 >> 32);
+        const int j = static_cast<int>(best1 & 0xffffffffu);
+        if (d1 > options_.max_distance) continue;
+        if (options_.ratio > 0.f && best2 != kInvalidKey) {
+            const int d2 = static_cast<int>(best2 >> 32);
+            if (static_cast<float>(d1) >= options_.ratio * static_cast<float>(d2)) continue;
+        }
+        if (options_.cross_check && static_cast<int>(col_best_[0][j] & 0xffffffffu) != i) continue;
+        matches.push_back({i, j, d1});
+    }
+}
+
+}  // namespace slam
@@ -0,0 +1,379 @@
+#include "frontend/phase_correlation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace slam {
+
+namespace {
+
+// 避免除零：幅值低于它的频率（通常只有被窗压掉的极高频）按零相位处理
+constexpr float kMinMagnitude = 1e-20f;
+
+// 周期 Hann 窗 w[i] = 0.5 (1 - cos(2π i / n))，关于 n / 2 对称，坐标取反（模 n）后不变
+std::vector<float> hann(int n, bool enabled) {
+    std::vector<float> w(n, 1.0f);
+    if (!enabled) return w;
+    for (int i = 0; i < n; ++i) w[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / n));
+    return w;
+}
+
+// 一行像素之和；8 位图用 psadbw 每次累加 32 个字节
+double rowSum(const std::uint8_t* row, int width) {
+    std::uint64_t sum = 0;
+    int x = 0;
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; x + 32 <= width; x += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; x < width; ++x) sum += row[x];
+    return static_cast<double>(sum);
+}
+
+double rowSum(const float* row, int width) {
+    double sum = 0.0;
+    for (int x = 0; x < width; ++x) sum += row[x];
+    return sum;
+}
+
+// out[x] = (row[x] - mean) * wy * wx[x]
+void windowRow(const std::uint8_t* row, int width, float mean, float wy, const float* wx, float* out) {
+    int x = 0;
+#if defined(__AVX2__)
+    const __m256 m = _mm256_set1_ps(mean), w = _mm256_set1_ps(wy);
+    for (; x + 8 <= width; x += 8) {
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + x));
+        const __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+        _mm256_storeu_ps(out + x, _mm256_mul_ps(_mm256_sub_ps(v, m), _mm256_mul_ps(w, _mm256_loadu_ps(wx + x))));
+    }
+#endif
+    for (; x < width; ++x) out[x] = (static_cast<float>(row[x]) - mean) * (wy * wx[x]);
+}
+
+void windowRow(const float* row, int width, float mean, float wy, const float* wx, float* out) {
+    for (int x = 0; x < width; ++x) out[x] = (row[x] - mean) * (wy * wx[x]);
+}
+
+// 2x2 盒式平均：out[x] 是 row0、row1 第 2x、2x + 1 列四个像素的均值
+void downsampleRow(const std::uint8_t* row0, const std::uint8_t* row1, int out_width, float* out) {
+    for (int x = 0; x < out_width; ++x) {
+        const int sum = row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1];
+        out[x] = 0.25f * static_cast<float>(sum);
+    }
+}
+
+// spectrum /= |spectrum|
+void normalize(HalfSpectrum& spectrum) {
+    float* re = spectrum.re.data();
+    float* im = spectrum.im.data();
+    for (std::size_t i = 0; i < spectrum.re.size(); ++i) {
+        const float scale = 1.0f / std::sqrt(re[i] * re[i] + im[i] * im[i] + kMinMagnitude);
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+// 最大值的下标：先用 8 路互相独立的比较求出最大值（不是一条依赖链），再找它第一次出现的位置
+int argmax(const float* values, int count) {
+    constexpr int kLanes = 8;
+    float lanes[kLanes];
+    std::fill(lanes, lanes + kLanes, values[0]);
+    int i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        for (int k = 0; k < kLanes; ++k) lanes[k] = values[i + k] > lanes[k] ? values[i + k] : lanes[k];
+    }
+    float best = *std::max_element(lanes, lanes + kLanes);
+    for (; i < count; ++i) best = std::max(best, values[i]);
+    return static_cast<int>(std::find(values, values + count, best) - values);
+}
+
+// 整像素最大值 + Foroosh 亚像素：sinc 形的峰，两侧较大的邻点 c1 满足 d = c1 / (c1 + c0)
+double findPeak(const float* surface, int width, int height, Eigen::Vector2d& shift) {
+    const int best = argmax(surface, width * height);
+    const int x = best % width, y = best / width;
+    const double c0 = surface[best];
+
+    auto subpixel = [c0](double minus, double plus) {
+        const double c1 = std::max(minus, plus);
+        if (!(c1 > 0.0) || !(c0 > 0.0)) return 0.0;
+        const double d = c1 / (c1 + c0);
+        return plus >= minus ? d : -d;
+    };
+    const double dx = subpixel(surface[y * width + (x + width - 1) % width], surface[y * width + (x + 1) % width]);
+    const double dy =
+        subpixel(surface[((y + height - 1) % height) * width + x], surface[((y + 1) % height) * width + x]);
+
+    // 循环相关：超过一半的位置是负的平移
+    shift.x() = (x > width / 2 ? x - width : x) + dx;
+    shift.y() = (y > height / 2 ? y - height : y) + dy;
+    return c0;
+}
+
+}  // namespace
+
+PhaseCorrelator::PhaseCorrelator(int width, int height, const PhaseCorrelationOptions& options)
+    : width_(std::max(width, 0)),
+      height_(std::max(height, 0)),
+      options_(options),
+      downsample_(options.downsample == 2 && width_ % 4 == 0 && height_ % 2 == 0 ? 2 : 1),
+      grid_width_(width_ / downsample_),
+      grid_height_(height_ / downsample_),
+      fft_(grid_width_, grid_height_),
+      band_fft_(options.half_band && grid_width_ % 4 == 0 && grid_height_ % 2 == 0 ? grid_width_ / 2 : grid_width_,
+                options.half_band && grid_width_ % 4 == 0 && grid_height_ % 2 == 0 ? grid_height_ / 2 : grid_height_),
+      log_polar_fft_(options.log_polar && grid_height_ >= 2 ? std::max(options.log_polar_radii, 2) : 0,
+                     options.log_polar && grid_height_ >= 2 ? std::max(options.log_polar_angles, 2) : 0),
+      candidate_fft_(
+          options.log_polar && grid_width_ % 8 == 0 && grid_height_ % 4 == 0 ? grid_width_ / 4 : grid_width_,
+          options.log_polar && grid_width_ % 8 == 0 && grid_height_ % 4 == 0 ? grid_height_ / 4 : grid_height_) {
+    options_.downsample = downsample_;
+    if (!fft_.valid()) return;
+    window_x_ = hann(grid_width_, options_.window);
+    window_y_ = hann(grid_height_, options_.window);
+    input_.resize(static_cast<std::size_t>(grid_width_) * grid_height_);
+    if (downsample_ > 1) small_.resize(input_.size());
+    surface_.resize(static_cast<std::size_t>(band_fft_.width()) * band_fft_.height());
+    if (!options_.log_polar || !log_polar_fft_.valid()) return;
+
+    // Reddy & Chatterji 的高通 (1 - X)(2 - X)，X = cos(π fx) cos(π fy)：压低对旋转、缩放不敏感的低频
+    const int half_height = grid_height_ / 2 + 1;
+    highpass_.resize(static_cast<std::size_t>(grid_width_) * half_height);
+    magnitude_.resize(highpass_.size());
+    for (int u = 0; u < grid_width_; ++u) {
+        const double fx = static_cast<double>(u > grid_width_ / 2 ? u - grid_width_ : u) / grid_width_;
+        for (int v = 0; v < half_height; ++v) {
+            const double X = std::cos(M_PI * fx) * std::cos(M_PI * v / grid_height_);
+            highpass_[static_cast<std::size_t>(u) * half_height + v] = static_cast<float>((1.0 - X) * (2.0 - X));
+        }
+    }
+
+    // 角度 [0, π)，半径 [2 / min(W, H), 0.5] 周 / 像素按对数均匀采样，每个采样点的双线性插值下标和权重预先算好：
+    // u 是循环的（负频率在 [W/2, W)），v 只有 [0, H/2]，落在 v = H/2 上的点改成从 H/2 - 1 插值、权重 1
+    const int angles = log_polar_fft_.height(), radii = log_polar_fft_.width();
+    const double r_min = 2.0 / std::min(grid_width_, grid_height_), r_max = 0.5;
+    log_step_ = std::log(r_max / r_min) / (radii - 1);
+    log_polar_samples_.resize(static_cast<std::size_t>(radii) * angles);
+    for (int a = 0; a < angles; ++a) {
+        for (int j = 0; j < radii; ++j) {
+            const double radius = r_min * std::exp(j * log_step_);
+            const double fu = radius * std::cos(M_PI * a / angles) * grid_width_;
+            const double fv = radius * std::sin(M_PI * a / angles) * grid_height_;
+            int u0 = static_cast<int>(std::floor(fu)), v0 = static_cast<int>(std::floor(fv));
+            double du = fu - u0, dv = fv - v0;
+            u0 = (u0 % grid_width_ + grid_width_) % grid_width_;
+            if (v0 >= half_height - 1) {
+                v0 = half_height - 2;
+                dv = 1.0;
+            }
+            LogPolarSample& sample = log_polar_samples_[static_cast<std::size_t>(a) * radii + j];
+            sample.offset0 = u0 * half_height + v0;
+            sample.offset1 = (u0 + 1 == grid_width_ ? 0 : u0 + 1) * half_height + v0;
+            sample.du = static_cast<float>(du);
+            sample.dv = static_cast<float>(dv);
+        }
+    }
+    radius_window_ = hann(radii, true);  // 角度方向是周期的，不加窗
+    log_polar_input_.resize(static_cast<std::size_t>(radii) * angles);
+    log_polar_surface_.resize(log_polar_input_.size());
+    warped_.resize(input_.size());
+    candidate_surface_.resize(static_cast<std::size_t>(candidate_fft_.width()) * candidate_fft_.height());
+}
+
+template <typename Pixel>
+void PhaseCorrelator::prepare(const Pixel* image, int stride) {
+    double sum = 0.0;
+    for (int y = 0; y < grid_height_; ++y) sum += rowSum(image + static_cast<std::size_t>(y) * stride, grid_width_);
+    const float mean = static_cast<float>(sum / (static_cast<double>(grid_width_) * grid_height_));
+    for (int y = 0; y < grid_height_; ++y) {
+        windowRow(image + static_cast<std::size_t>(y) * stride, grid_width_, mean, window_y_[y], window_x_.data(),
+                  input_.data() + static_cast<std::size_t>(y) * grid_width_);
+    }
+}
+
+void PhaseCorrelator::load(const std::uint8_t* image, int stride) {
+    if (downsample_ == 1) {
+        prepare(image, stride);
+        return;
+    }
+    for (int y = 0; y < grid_height_; ++y) {
+        const std::uint8_t* row = image + static_cast<std::size_t>(2 * y) * stride;
+        downsampleRow(row, row + stride, grid_width_, small_.data() + static_cast<std::size_t>(y) * grid_width_);
+    }
+    prepare(small_.data(), grid_width_);
+}
+
+void PhaseCorrelator::logPolar(const HalfSpectrum& spectrum) {
+    for (std::size_t i = 0; i < magnitude_.size(); ++i) {
+        magnitude_[i] = highpass_[i] * std::sqrt(spectrum.re[i] * spectrum.re[i] + spectrum.im[i] * spectrum.im[i]);
+    }
+
+    // 按构造时算好的下标和权重双线性采样
+    double sum = 0.0;
+    for (std::size_t i = 0; i < log_polar_samples_.size(); ++i) {
+        const LogPolarSample& sample = log_polar_samples_[i];
+        const float* m0 = magnitude_.data() + sample.offset0;
+        const float* m1 = magnitude_.data() + sample.offset1;
+        const float du = sample.du, dv = sample.dv;
+        const float value = (1.0f - du) * ((1.0f - dv) * m0[0] + dv * m0[1]) + du * ((1.0f - dv) * m1[0] + dv * m1[1]);
+        log_polar_input_[i] = value;
+        sum += value;
+    }
+    const int angles = log_polar_fft_.height(), radii = log_polar_fft_.width();
+    const float mean = static_cast<float>(sum / log_polar_input_.size());
+    for (int a = 0; a < angles; ++a) {
+        float* out = log_polar_input_.data() + static_cast<std::size_t>(a) * radii;
+        for (int j = 0; j < radii; ++j) out[j] = (out[j] - mean) * radius_window_[j];
+    }
+}
+
+Eigen::Vector2d PhaseCorrelator::gridCenter() const {
+    // 缩小 d 倍的网格点 g 对应原图 d g + (d - 1) / 2
+    const double offset = 0.5 * (downsample_ - 1);
+    return Eigen::Vector2d((0.5 * width_ - offset) / downsample_, (0.5 * height_ - offset) / downsample_);
+}
+
+template <typename Pixel>
+void PhaseCorrelator::warp(const Pixel* image, int stride, double rotation, double scale) {
+    double sum = 0.0;
+    for (int y = 0; y < grid_height_; ++y) sum += rowSum(image + static_cast<std::size_t>(y) * stride, grid_width_);
+    const float mean = static_cast<float>(sum / (static_cast<double>(grid_width_) * grid_height_));
+
+    // 源坐标 s = c + A (x - c)，A = scale R(rotation)，沿一行是等差的
+    const Eigen::Vector2d center = gridCenter();
+    const float cx = static_cast<float>(center.x()), cy = static_cast<float>(center.y());
+    const float a = static_cast<float>(scale * std::cos(rotation)), b = static_cast<float>(scale * std::sin(rotation));
+    const float x_max = static_cast<float>(grid_width_ - 1), y_max = static_cast<float>(grid_height_ - 1);
+    for (int y = 0; y < grid_height_; ++y) {
+        float* out = warped_.data() + static_cast<std::size_t>(y) * grid_width_;
+        const float sx0 = cx - a * cx - b * (y - cy);
+        const float sy0 = cy - b * cx + a * (y - cy);
+        for (int x = 0; x < grid_width_; ++x) {
+            const float sx = sx0 + a * x, sy = sy0 + b * x;
+            if (!(sx >= 0.0f && sy >= 0.0f && sx < x_max && sy < y_max)) {
+                out[x] = mean;
+                continue;
+            }
+            const int x0 = static_cast<int>(sx), y0 = static_cast<int>(sy);
+            const float wx = sx - x0, wy = sy - y0;
+            const Pixel* p = image + static_cast<std::size_t>(y0) * stride + x0;
+            out[x] = (1.0f - wy) * ((1.0f - wx) * p[0] + wx * p[1]) +
+                     wy * ((1.0f - wx) * p[stride] + wx * p[stride + 1]);
+        }
+    }
+}
+
+double PhaseCorrelator::correlate(RealFft2D& fft, const HalfSpectrum& spectrum, const HalfSpectrum& reference,
+                                  bool conjugate, std::vector<float>& surface, Eigen::Vector2d& shift) {
+    // C = F conj(R) / |F|（|R| = 1）；conjugate 时把 F 换成 conj(F)。
+    // 只取 fft 尺寸内的频率：u' < W'/2 对应 u = u'，其余对应负频率 u = u' + W - W'；v' 对应 v = v'
+    const int width = fft.width(), stride = fft.height() / 2 + 1;
+    cross_.width = width;
+    cross_.height = fft.height();
+    cross_.stride = stride;
+    cross_.re.resize(static_cast<std::size_t>(width) * stride);
+    cross_.im.resize(cross_.re.size());
+    const float sign = conjugate ? -1.0f : 1.0f;
+    for (int u = 0; u < width; ++u) {
+        const std::size_t offset = static_cast<std::size_t>(u < width / 2 ? u : u + spectrum.width - width) *
+                                   spectrum.stride;
+        const float* fr = spectrum.re.data() + offset;
+        const float* fi = spectrum.im.data() + offset;
+        const float* rr = reference.re.data() + offset;
+        const float* ri = reference.im.data() + offset;
+        float* cr = cross_.re.data() + static_cast<std::size_t>(u) * stride;
+        float* ci = cross_.im.data() + static_cast<std::size_t>(u) * stride;
+        for (int v = 0; v < stride; ++v) {
+            const float scale = 1.0f / std::sqrt(fr[v] * fr[v] + fi[v] * fi[v] + kMinMagnitude);
+            const float f_im = sign * fi[v];
+            cr[v] = (fr[v] * rr[v] + f_im * ri[v]) * scale;
+            ci[v] = (f_im * rr[v] - fr[v] * ri[v]) * scale;
+        }
+    }
+    fft.inverse(cross_, surface.data(), width);
+    const double response = findPeak(surface.data(), width, fft.height(), shift);
+    shift.x() *= static_cast<double>(spectrum.width) / width;
+    shift.y() *= static_cast<double>(spectrum.height) / fft.height();
+    return response;
+}
+
+bool PhaseCorrelator::setReference(const std::uint8_t* image, int stride) {
+    has_reference_ = false;
+    if (!fft_.valid() || !image || stride < width_) return false;
+    load(image, stride);
+    fft_.forward(input_.data(), grid_width_, reference_);
+    if (options_.log_polar && log_polar_fft_.valid()) {
+        logPolar(reference_);
+        log_polar_fft_.forward(log_polar_input_.data(), log_polar_fft_.width(), log_polar_reference_);
+        normalize(log_polar_reference_);
+    }
+    normalize(reference_);
+    has_reference_ = true;
+    return true;
+}
+
+bool PhaseCorrelator::estimateTranslation(const std::uint8_t* image, int stride, PhaseCorrelationResult& result) {
+    result = PhaseCorrelationResult();
+    if (!has_reference_ || !image || stride < width_) return false;
+    load(image, stride);
+    fft_.forward(input_.data(), grid_width_, spectrum_);
+    result.response = correlate(band_fft_, spectrum_, reference_, false, surface_, result.shift);
+    result.shift *= downsample_;
+    result.success = result.response >= options_.min_response;
+    return result.success;
+}
+
+bool PhaseCorrelator::estimateSimilarity(const std::uint8_t* image, int stride, PhaseCorrelationResult& result) {
+    result = PhaseCorrelationResult();
+    if (!has_reference_ || !options_.log_polar || !log_polar_fft_.valid() || !image || stride < width_) return false;
+
+    // 1. 对数极坐标下的平移 → 旋转、缩放：M(log ρ, φ) = M_ref(log ρ + log s, φ - θ)
+    load(image, stride);
+    fft_.forward(input_.data(), grid_width_, spectrum_);
+    logPolar(spectrum_);
+    log_polar_fft_.forward(log_polar_input_.data(), log_polar_fft_.width(), log_polar_spectrum_);
+    Eigen::Vector2d log_polar_shift;
+    result.log_polar_response = correlate(log_polar_fft_, log_polar_spectrum_, log_polar_reference_, false,
+                                          log_polar_surface_, log_polar_shift);
+    const double rotation = log_polar_shift.y() * M_PI / log_polar_fft_.height();
+    const double scale = std::exp(-log_polar_shift.x() * log_step_);
+
+    // 2. 反向变换回参考图的姿态后做平移相关；θ + π 的候选是关于中心的点反射，谱取共轭即可。
+    //    错误候选的峰只有噪声的高度，用 W/4 x H/4 的低频相关就能分开，只对选中的候选做完整的相关
+    if (downsample_ == 1) {
+        warp(image, stride, rotation, scale);
+    } else {
+        warp(small_.data(), grid_width_, rotation, scale);
+    }
+    prepare(warped_.data(), grid_width_);
+    fft_.forward(input_.data(), grid_width_, spectrum_);
+    Eigen::Vector2d shift;
+    const double response0 = correlate(candidate_fft_, spectrum_, reference_, false, candidate_surface_, shift);
+    const double response1 = correlate(candidate_fft_, spectrum_, reference_, true, candidate_surface_, shift);
+    const bool flipped = response1 > response0;
+    result.rotation = flipped ? (rotation > 0.0 ? rotation - M_PI : rotation + M_PI) : rotation;
+    result.scale = scale;
+    result.response = correlate(band_fft_, spectrum_, reference_, flipped, surface_, shift);
+    // 共轭是关于网格 (N / 2, N / 2) 的点反射，反向变换的中心 c 不在那里时（downsample = 2 时差 1/4 格），
+    // 关于 c 的反射再平移 2 c - N
+    if (flipped) shift += 2.0 * gridCenter() - Eigen::Vector2d(grid_width_, grid_height_);
+
+    // 反向变换后的图 I'(x) = I_ref(x - t')，t' = A⁻¹ shift，A = scale R(result.rotation)；
+    // θ + π 的候选量到的是反射图的平移，同样满足这个关系；网格上的平移乘 downsample 换回原图像素
+    Eigen::Matrix2d A;
+    A << std::cos(result.rotation), -std::sin(result.rotation), std::sin(result.rotation), std::cos(result.rotation);
+    result.shift = downsample_ * scale * A * shift;
+    result.success = result.response >= options_.min_response;
+    return result.success;
+}
+
+}  // namespace slam
@@ -0,0 +1,339 @@
+#include "frontend/pnp_ransac.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "utils/polynomial.h"
+#include "utils/profiler.h"
+#include "utils/ransac.h"
+
+namespace slam {
+
+namespace {
+
+constexpr int kChunk = 64;      // 打分时每块的对应点数
+using ChunkArray = Eigen::Array<double, kChunk, 1>;
+
+// 一块对应点，尾块用 NaN 填充，NaN 的比较结果为 false，永远不会被判为内点
+struct Chunk {
+    ChunkArray X, Y, Z, x, y;
+    int size = 0;
+
+    void load(const PnPCorrespondences& data, int begin) {
+        size = std::min(kChunk, data.size() - begin);
+        if (size < kChunk) {
+            x.setConstant(std::numeric_limits<double>::quiet_NaN());
+            y.setConstant(std::numeric_limits<double>::quiet_NaN());
+            X.setZero();
+            Y.setZero();
+            Z.setOnes();
+        }
+        for (int i = 0; i < size; ++i) {
+            X[i] = data.X[begin + i];
+            Y[i] = data.Y[begin + i];
+            Z[i] = data.Z[begin + i];
+            x[i] = data.x[begin + i];
+            y[i] = data.y[begin + i];
+        }
+    }
+
+    int countInliers(const Eigen::Matrix3d& R, const Eigen::Vector3d& t, double threshold2) const {
+        const ChunkArray zc = R(2, 0) * X + R(2, 1) * Y + R(2, 2) * Z + t(2);
+        const ChunkArray inv_z = zc.inverse();
+        const ChunkArray ex = (R(0, 0) * X + R(0, 1) * Y + R(0, 2) * Z + t(0)) * inv_z - x;
+        const ChunkArray ey = (R(1, 0) * X + R(1, 1) * Y + R(1, 2) * Z + t(1)) * inv_z - y;
+        return static_cast<int>(((ex * ex + ey * ey < threshold2) && (zc > 0.0)).count());
+    }
+};
+
+struct Hypothesis {
+    Eigen::Matrix3d R;
+    Eigen::Vector3d t;
+    double log_lambda = 0.0;
+    int inliers = 0;
+    int tested = 0;
+    bool alive = true;
+};
+
+inline Eigen::Matrix3d skew(const Eigen::Vector3d& v) {
+    Eigen::Matrix3d S;
+    S << 0.0, -v.z(), v.y(),
+         v.z(), 0.0, -v.x(),
+         -v.y(), v.x(), 0.0;
+    return S;
+}
+
+}  // namespace
+
+void absoluteOrientation(const Eigen::Vector3d* P, const Eigen::Vector3d* Q, int n,
+                         Eigen::Matrix3d& R, Eigen::Vector3d& t) {
+    Eigen::Vector3d mp = Eigen::Vector3d::Zero(), mq = Eigen::Vector3d::Zero();
+    for (int i = 0; i < n; ++i) {
+        mp += P[i];
+        mq += Q[i];
+    }
+    mp /= n;
+    mq /= n;
+    Eigen::Matrix3d H = Eigen::Matrix3d::Zero();
+    for (int i = 0; i < n; ++i) H += (P[i] - mp) * (Q[i] - mq).transpose();
+
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(H, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Matrix3d D = Eigen::Matrix3d::Identity();
+    if ((svd.matrixV() * svd.matrixU().transpose()).determinant() < 0.0) D(2, 2) = -1.0;
+    R = svd.matrixV() * D * svd.matrixU().transpose();
+    t = mq - R * mp;
+}
+
+int solveP3P(const Eigen::Vector3d f[3], const Eigen::Vector3d P[3], Eigen::Matrix3d R[4], Eigen::Vector3d t[4]) {
+    // 边长：a 对着方向 2、3 的夹角 α，b 对着 1、3 的夹角 β，c 对着 1、2 的夹角 γ
+    const double a2 = (P[1] - P[2]).squaredNorm();
+    const double b2 = (P[0] - P[2]).squaredNorm();
+    const double c2 = (P[0] - P[1]).squaredNorm();
+    if (b2 < 1e-12 || a2 < 1e-12 || c2 < 1e-12) return 0;
+
+    const double cos_a = f[1].dot(f[2]);
+    const double cos_b = f[0].dot(f[2]);
+    const double cos_g = f[0].dot(f[1]);
+
+    // Grunert：s2 = u s1，s3 = v s1，消元得到关于 v 的 4 次方程
+    const double amc = (a2 - c2) / b2;
+    const double apc = (a2 + c2) / b2;
+    const double bmc = (b2 - c2) / b2;
+    const double bma = (b2 - a2) / b2;
+    const double ca2 = cos_a * cos_a, cb2 = cos_b * cos_b, cg2 = cos_g * cos_g;
+
+    double coeffs[5];
+    coeffs[0] = (amc - 1.0) * (amc - 1.0) - 4.0 * c2 / b2 * ca2;
+    coeffs[1] = 4.0 * (amc * (1.0 - amc) * cos_b - (1.0 - apc) * cos_a * cos_g + 2.0 * c2 / b2 * ca2 * cos_b);
+    coeffs[2] = 2.0 * (amc * amc - 1.0 + 2.0 * amc * amc * cb2 + 2.0 * bmc * ca2 -
+                       4.0 * apc * cos_a * cos_b * cos_g + 2.0 * bma * cg2);
+    coeffs[3] = 4.0 * (-amc * (1.0 + amc) * cos_b + 2.0 * a2 / b2 * cg2 * cos_b - (1.0 - apc) * cos_a * cos_g);
+    coeffs[4] = (1.0 + amc) * (1.0 + amc) - 4.0 * a2 / b2 * cg2;
+
+    double vs[4];
+    const int n_roots = solveQuartic(coeffs, vs);
+
+    int n = 0;
+    for (int i = 0; i < n_roots; ++i) {
+        const double v = vs[i];
+        if (v <= 0.0) continue;
+        const double denom = 2.0 * (cos_g - v * cos_a);
+        if (std::fabs(denom) < 1e-12) continue;
+        const double u = ((-1.0 + amc) * v * v - 2.0 * amc * cos_b * v + 1.0 + amc) / denom;
+        if (u <= 0.0) continue;
+        const double s1_sq = b2 / (1.0 + v * v - 2.0 * v * cos_b);
+        if (!(s1_sq > 0.0)) continue;
+        const double s1 = std::sqrt(s1_sq);
+
+        const Eigen::Vector3d Q[3] = {s1 * f[0], u * s1 * f[1], v * s1 * f[2]};
+        absoluteOrientation(P, Q, 3, R[n], t[n]);
+        ++n;
+    }
+    return n;
+}
+
+void PnPCorrespondences::reserve(int n) {
+    X.reserve(n);
+    Y.reserve(n);
+    Z.reserve(n);
+    x.reserve(n);
+    y.reserve(n);
+}
+
+void PnPCorrespondences::clear() {
+    X.clear();
+    Y.clear();
+    Z.clear();
+    x.clear();
+    y.clear();
+}
+
+void PnPCorrespondences::add(const Eigen::Vector3d& Pw, const Eigen::Vector2d& xn) {
+    X.push_back(Pw.x());
+    Y.push_back(Pw.y());
+    Z.push_back(Pw.z());
+    x.push_back(xn.x());
+    y.push_back(xn.y());
+}
+
+PnPRansac::PnPRansac(const PnPRansacOptions& options) : options_(options) {}
+
+int PnPRansac::countInliers(const PnPCorrespondences& data, const Eigen::Matrix3d& R, const Eigen::Vector3d& t,
+                            double threshold2, std::vector<char>* mask) const {
+    const int n = data.size();
+    if (mask) mask->assign(n, 0);
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        const Eigen::Vector3d Xc = R * Eigen::Vector3d(data.X[i], data.Y[i], data.Z[i]) + t;
+        if (Xc.z() <= 0.0) continue;
+        const double ex = Xc.x() / Xc.z() - data.x[i];
+        const double ey = Xc.y() / Xc.z() - data.y[i];
+        if (ex * ex + ey * ey < threshold2) {
+            ++count;
+            if (mask) (*mask)[i] = 1;
+        }
+    }
+    return count;
+}
+
+bool PnPRansac::estimate(const PnPCorrespondences& data, PnPResult& result) {
+    SLAM_PROFILE_SCOPE("frontend/pnp_ransac");
+    result = PnPResult();
+    const int n = data.size();
+    if (n < std::max(4, options_.min_inliers)) return false;
+
+    const double threshold = options_.max_error_px / options_.focal_length;
+    const double threshold2 = threshold * threshold;
+    const int batch_size = std::max(1, options_.batch_size);
+
+    ProsacSampler sampler(n, 3, options_.max_iterations, options_.use_prosac, options_.seed);
+    SprtTest sprt;
+
+    std::vector<Hypothesis> hypotheses;
+    hypotheses.reserve(4 * batch_size);
+    Chunk chunk;
+
+    int best_inliers = 0;
+    Eigen::Matrix3d best_R = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d best_t = Eigen::Vector3d::Zero();
+    int needed = options_.max_iterations;
+
+    while (result.iterations < needed) {
+        // 1. 一批最小集 -> P3P 假设
+        hypotheses.clear();
+        for (int s = 0; s < batch_size && result.iterations < needed; ++s) {
+            int idx[3];
+            sampler.sample(idx);
+            ++result.iterations;
+
+            Eigen::Vector3d f[3], P[3];
+            for (int k = 0; k < 3; ++k) {
+                f[k] = Eigen::Vector3d(data.x[idx[k]], data.y[idx[k]], 1.0).normalized();
+                P[k] = Eigen::Vector3d(data.X[idx[k]], data.Y[idx[k]], data.Z[idx[k]]);
+            }
+            Eigen::Matrix3d Rs[4];
+            Eigen::Vector3d ts[4];
+            const int n_sol = solveP3P(f, P, Rs, ts);
+            for (int k = 0; k < n_sol; ++k) {
+                Hypothesis h;
+                h.R = Rs[k];
+                h.t = ts[k];
+                hypotheses.push_back(h);
+            }
+        }
+        result.hypotheses += static_cast<int>(hypotheses.size());
+        if (hypotheses.empty()) continue;
+
+        // 2. 按块打分，一块数据对所有存活假设复用；每块后做 SPRT
+        int alive = static_cast<int>(hypotheses.size());
+        for (int begin = 0; begin < n && alive > 0; begin += kChunk) {
+            chunk.load(data, begin);
+            for (Hypothesis& h : hypotheses) {
+                if (!h.alive) continue;
+                const int inl = chunk.countInliers(h.R, h.t, threshold2);
+                h.inliers += inl;
+                h.tested += chunk.size;
+                if (options_.use_sprt && !sprt.update(h.log_lambda, inl, chunk.size - inl)) {
+                    h.alive = false;
+                    --alive;
+                    ++result.rejected_by_sprt;
+                    sprt.observeRejected(h.inliers, h.tested);
+                }
+            }
+        }
+
+        // 3. 更新最优模型和所需迭代次数
+        for (const Hypothesis& h : hypotheses) {
+            if (!h.alive || h.inliers <= best_inliers) continue;
+            best_inliers = h.inliers;
+            best_R = h.R;
+            best_t = h.t;
+            const double ratio = static_cast<double>(best_inliers) / n;
+            sprt.setEpsilon(ratio);
+            needed = ransacIterations(options_.confidence, ratio, 3, options_.max_iterations);
+        }
+    }
+
+    if (best_inliers < options_.min_inliers) return false;
+
+    // 4. 内点上非线性优化，再用优化后的位姿重新判定内点
+    std::vector<char> mask;
+    countInliers(data, best_R, best_t, threshold2, &mask);
+    if (options_.refine_iterations > 0) {
+        Eigen::Matrix3d R = best_R;
+        Eigen::Vector3d t = best_t;
+        refine(data, mask, options_.refine_iterations, R, t);
+        std::vector<char> refined_mask;
+        const int refined = countInliers(data, R, t, threshold2, &refined_mask);
+        if (refined >= best_inliers) {
+            best_R = R;
+            best_t = t;
+            best_inliers = refined;
+            mask.swap(refined_mask);
+        }
+    }
+
+    result.success = best_inliers >= options_.min_inliers;
+    result.R_cw = best_R;
+    result.t_cw = best_t;
+    result.num_inliers = best_inliers;
+    result.inlier_mask.swap(mask);
+    return result.success;
+}
+
+void PnPRansac::refine(const PnPCorrespondences& data, const std::vector<char>& inlier_mask, int iterations,
+                       Eigen::Matrix3d& R_cw, Eigen::Vector3d& t_cw) {
+    const int n = data.size();
+    double last_cost = std::numeric_limits<double>::max();
+    Eigen::Matrix3d last_R = R_cw;
+    Eigen::Vector3d last_t = t_cw;
+    for (int it = 0; it < iterations; ++it) {
+        Eigen::Matrix<double, 6, 6> H = Eigen::Matrix<double, 6, 6>::Zero();
+        Eigen::Matrix<double, 6, 1> g = Eigen::Matrix<double, 6, 1>::Zero();
+        double cost = 0.0;
+        for (int i = 0; i < n; ++i) {
+            if (!inlier_mask[i]) continue;
+            const Eigen::Vector3d Xc = R_cw * Eigen::Vector3d(data.X[i], data.Y[i], data.Z[i]) + t_cw;
+            if (Xc.z() <= 0.0) continue;
+            const double iz = 1.0 / Xc.z();
+            const Eigen::Vector2d r(Xc.x() * iz - data.x[i], Xc.y() * iz - data.y[i]);
+
+            // 左扰动 T <- exp(δ) T，δ = [ω, v]：dXc/dω = -[Xc]x，dXc/dv = I
+            Eigen::Matrix<double, 2, 3> Jp;
+            Jp << iz, 0.0, -Xc.x() * iz * iz,
+                  0.0, iz, -Xc.y() * iz * iz;
+            Eigen::Matrix<double, 2, 6> J;
+            J.leftCols<3>() = -Jp * skew(Xc);
+            J.rightCols<3>() = Jp;
+
+            H.noalias() += J.transpose() * J;
+            g.noalias() += J.transpose() * r;
+            cost += r.squaredNorm();
+        }
+        if (cost >= last_cost) {
+            // 上一步让代价变大，退回
+            R_cw = last_R;
+            t_cw = last_t;
+            break;
+        }
+        last_cost = cost;
+        last_R = R_cw;
+        last_t = t_cw;
+
+        const Eigen::Matrix<double, 6, 1> delta = H.ldlt().solve(-g);
+        if (!delta.allFinite()) break;
+        const Eigen::Vector3d omega = delta.head<3>();
+        const double angle = omega.norm();
+        const Eigen::Matrix3d dR = (angle > 1e-12)
+                                       ? Eigen::AngleAxisd(angle, omega / angle).toRotationMatrix()
+                                       : Eigen::Matrix3d::Identity() + skew(omega);
+        R_cw = dR * R_cw;
+        t_cw = dR * t_cw + delta.tail<3>();
+        if (delta.norm() < 1e-10) break;
+    }
+    // 消除累积的数值误差，保持正交
+    R_cw = Eigen::Quaterniond(R_cw).normalized().toRotationMatrix();
+}
+
+}  // namespace slam
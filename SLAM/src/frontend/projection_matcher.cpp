@@ -0,0 +1,106 @@
+#include "frontend/projection_matcher.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "frontend/hamming_matcher.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+ProjectionMatcher::ProjectionMatcher(const ProjectionMatcherOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()) {}
+
+int ProjectionMatcher::match(const FeatureGrid& grid, const MapPointBatch& points,
+                             const Eigen::Matrix3f& R_cw, const Eigen::Vector3f& t_cw,
+                             const PinholeCamera& camera, std::vector<Match>& matches) {
+    matches.clear();
+    const int n = points.size();
+    if (n == 0 || grid.size() == 0) return 0;
+
+    best_train_.assign(n, -1);
+    best_distance_.assign(n, INT_MAX);
+
+    // 每层的搜索半径
+    constexpr int kMaxLevels = 32;
+    float level_radius[kMaxLevels];
+    level_radius[0] = options_.radius;
+    for (int l = 1; l < kMaxLevels; ++l) level_radius[l] = level_radius[l - 1] * options_.scale_factor;
+
+    const bool use_level = !points.predicted_level.empty();
+    const int per_task = std::max(1, options_.points_per_task);
+    const int n_tasks = (n + per_task - 1) / per_task;
+
+    pool_->parallelFor(n_tasks, [&](int task, int) {
+        const int begin = task * per_task;
+        const int m = std::min(n, begin + per_task) - begin;
+
+        // 1. 整块变换 + 投影，Eigen 数组表达式会被向量化
+        Eigen::Map<const Eigen::ArrayXf> X(points.x.data() + begin, m);
+        Eigen::Map<const Eigen::ArrayXf> Y(points.y.data() + begin, m);
+        Eigen::Map<const Eigen::ArrayXf> Z(points.z.data() + begin, m);
+        const Eigen::ArrayXf zc = R_cw(2, 0) * X + R_cw(2, 1) * Y + R_cw(2, 2) * Z + t_cw(2);
+        const Eigen::ArrayXf inv_z = zc.max(options_.min_depth).inverse();
+        const Eigen::ArrayXf u = camera.fx * (R_cw(0, 0) * X + R_cw(0, 1) * Y + R_cw(0, 2) * Z + t_cw(0)) * inv_z + camera.cx;
+        const Eigen::ArrayXf v = camera.fy * (R_cw(1, 0) * X + R_cw(1, 1) * Y + R_cw(1, 2) * Z + t_cw(1)) * inv_z + camera.cy;
+
+        std::vector<int> run_begin(grid.gridRows()), run_end(grid.gridRows());
+        std::vector<int> dist;
+
+        for (int i = 0; i < m; ++i) {
+            if (zc[i] < options_.min_depth) continue;
+            const float px = u[i], py = v[i];
+            if (px < 0.f || py < 0.f || px >= camera.width || py >= camera.height) continue;
+
+            const int p = begin + i;
+            const int level = use_level ? points.predicted_level[p] : -1;
+            const float radius = level_radius[std::min(std::max(level, 0), kMaxLevels - 1)];
+
+            // 2. 窗口内每一行格子是一段连续描述子，直接整段算距离
+            const int n_runs = grid.windowRuns(px, py, radius, run_begin.data(), run_end.data());
+            const Descriptor& desc = points.descriptors[p];
+            int best1 = INT_MAX, best2 = INT_MAX, best_k = -1;
+            for (int r = 0; r < n_runs; ++r) {
+                const int len = run_end[r] - run_begin[r];
+                if (static_cast<int>(dist.size()) < len) dist.resize(len);
+                hammingDistances(desc, grid.descriptors() + run_begin[r], len, dist.data());
+                for (int j = 0; j < len; ++j) {
+                    const int k = run_begin[r] + j;
+                    // ORB-SLAM 只在预测层及其上一层里找
+                    if (level >= 0 && (grid.octave(k) < level - 1 || grid.octave(k) > level)) continue;
+                    if (std::fabs(grid.x(k) - px) >= radius || std::fabs(grid.y(k) - py) >= radius) continue;
+                    const int d = dist[j];
+                    if (d < best1) {
+                        best2 = best1;
+                        best1 = d;
+                        best_k = k;
+                    } else if (d < best2) {
+                        best2 = d;
+                    }
+                }
+            }
+
+            if (best_k < 0 || best1 > options_.max_distance) continue;
+            if (options_.ratio > 0.f && best2 != INT_MAX &&
+                static_cast<float>(best1) >= options_.ratio * static_cast<float>(best2)) continue;
+            best_train_[p] = grid.originalIndex(best_k);
+            best_distance_[p] = best1;
+        }
+    });
+
+    // 3. 一个特征点只分给距离最小的地图点
+    claimed_.assign(grid.numKeypoints(), LLONG_MAX);
+    for (int p = 0; p < n; ++p) {
+        const int t = best_train_[p];
+        if (t < 0) continue;
+        claimed_[t] = std::min(claimed_[t], (static_cast<long long>(best_distance_[p]) << 32) | p);
+    }
+    for (int p = 0; p < n; ++p) {
+        const int t = best_train_[p];
+        if (t >= 0 && (claimed_[t] & 0xffffffffLL) == p) matches.push_back({p, t, best_distance_[p]});
+    }
+    return static_cast<int>(matches.size());
+}
+
+}  // namespace slam
@@ -0,0 +1,231 @@
+#include "frontend/quadtree_uniformizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace slam {
+
+QuadtreeUniformizer::QuadtreeUniformizer(int max_keypoints, float min_cell_size)
+    : min_cell_size_(min_cell_size) {
+    // 每次分裂最多产生 4 个子节点，叶子数不超过点数，arena 总节点数 < 4N/3 + 根节点数
+    arena_.reserve(2 * max_keypoints + 16);
+    entries_.reserve(max_keypoints);
+    leaves_.reserve(max_keypoints);
+    next_leaves_.reserve(max_keypoints);
+    expand_.reserve(max_keypoints);
+    spare_.reserve(max_keypoints);
+}
+
+bool QuadtreeUniformizer::splittable(const Node& node) const {
+    return node.end - node.begin > 1 &&
+           (node.x1 - node.x0) * 0.5f >= min_cell_size_ &&
+           (node.y1 - node.y0) * 0.5f >= min_cell_size_;
+}
+
+void QuadtreeUniformizer::split(const Node& node, std::vector<int>& out) {
+    const float mx = 0.5f * (node.x0 + node.x1);
+    const float my = 0.5f * (node.y0 + node.y1);
+    Entry* first = entries_.data() + node.begin;
+    Entry* last = entries_.data() + node.end;
+
+    // 先按 x 把区间分成左右两半，再各自按 y 分成上下两半：[左上 | 左下 | 右上 | 右下]
+    Entry* mid_x = std::partition(first, last, [mx](const Entry& e) { return e.x < mx; });
+    Entry* mid_l = std::partition(first, mid_x, [my](const Entry& e) { return e.y < my; });
+    Entry* mid_r = std::partition(mid_x, last, [my](const Entry& e) { return e.y < my; });
+
+    const int base = node.begin;
+    const int b[5] = {base,
+                      base + static_cast<int>(mid_l - first),
+                      base + static_cast<int>(mid_x - first),
+                      base + static_cast<int>(mid_r - first),
+                      node.end};
+    const Node children[4] = {
+        {node.x0, node.y0, mx, my, b[0], b[1]},
+        {node.x0, my, mx, node.y1, b[1], b[2]},
+        {mx, node.y0, node.x1, my, b[2], b[3]},
+        {mx, my, node.x1, node.y1, b[3], b[4]},
+    };
+    for (const Node& child : children) {
+        if (child.end > child.begin) {
+            out.push_back(static_cast<int>(arena_.size()));
+            arena_.push_back(child);
+        }
+    }
+}
+
+void QuadtreeUniformizer::runOnRange(int begin, int end,
+                                     float min_x, float max_x, float min_y, float max_y,
+                                     int target, std::vector<int>& selected) {
+    const int n = end - begin;
+    if (n <= 0 || target <= 0) return;
+
+    arena_.clear();
+    leaves_.clear();
+
+    // 根节点：按宽高比把区域切成若干列，避免宽图像上第一次分裂得到细长节点
+    const float width = max_x - min_x;
+    const float height = max_y - min_y;
+    const int n_roots = std::max(1, static_cast<int>(std::lround(width / std::max(height, 1.f))));
+    const float root_w = width / n_roots;
+    Entry* cur = entries_.data() + begin;
+    Entry* last = entries_.data() + end;
+    for (int i = 0; i < n_roots; ++i) {
+        const float x0 = min_x + i * root_w;
+        const float x1 = (i + 1 == n_roots) ? max_x : x0 + root_w;
+        Entry* next = (i + 1 == n_roots)
+                          ? last
+                          : std::partition(cur, last, [x1](const Entry& e) { return e.x < x1; });
+        if (next > cur) {
+            leaves_.push_back(static_cast<int>(arena_.size()));
+            arena_.push_back({x0, min_y, x1, max_y,
+                              static_cast<int>(cur - entries_.data()),
+                              static_cast<int>(next - entries_.data())});
+        }
+        cur = next;
+    }
+
+    // 逐层分裂，直到叶子数达到目标或者没有可分裂的节点
+    while (static_cast<int>(leaves_.size()) < target) {
+        expand_.clear();
+        for (int id : leaves_) {
+            if (splittable(arena_[id])) expand_.push_back(id);
+        }
+        if (expand_.empty()) break;
+
+        next_leaves_.clear();
+        if (leaves_.size() + 3 * expand_.size() <= static_cast<size_t>(target)) {
+            // 整层分裂也不会超过目标，直接全部分裂
+            for (int id : leaves_) {
+                if (splittable(arena_[id])) {
+                    const Node node = arena_[id];
+                    split(node, next_leaves_);
+                } else {
+                    next_leaves_.push_back(id);
+                }
+            }
+        } else {
+            // 最后一轮：优先分裂点数最多的节点，叶子数一旦达到目标就停止
+            std::sort(expand_.begin(), expand_.end(), [&](int a, int b) {
+                const int na = arena_[a].end - arena_[a].begin;
+                const int nb = arena_[b].end - arena_[b].begin;
+                return na != nb ? na > nb : a < b;
+            });
+            int count = static_cast<int>(leaves_.size());
+            for (int id : expand_) {
+                if (count >= target) break;
+                const Node node = arena_[id];
+                const size_t before = next_leaves_.size();
+                split(node, next_leaves_);
+                count += static_cast<int>(next_leaves_.size() - before) - 1;
+                arena_[id].begin = -1;  // 标记为已分裂
+            }
+            for (int id : leaves_) {
+                if (arena_[id].begin >= 0) next_leaves_.push_back(id);
+            }
+        }
+        leaves_.swap(next_leaves_);
+    }
+
+    // 响应值降序，响应值相同时按下标保证结果确定
+    auto stronger = [](const Entry& a, const Entry& b) {
+        return a.response != b.response ? a.response > b.response : a.index < b.index;
+    };
+
+    // 每个叶子节点保留响应值最大的点，并把它交换到区间起点，剩余的点留作补齐候选
+    spare_.clear();
+    for (int id : leaves_) {
+        const Node& node = arena_[id];
+        int best = node.begin;
+        for (int k = node.begin + 1; k < node.end; ++k) {
+            if (stronger(entries_[k], entries_[best])) best = k;
+        }
+        std::swap(entries_[node.begin], entries_[best]);
+        spare_.push_back(entries_[node.begin]);
+    }
+
+    const int n_leaves = static_cast<int>(leaves_.size());
+    if (n_leaves > target) {
+        std::nth_element(spare_.begin(), spare_.begin() + target, spare_.end(), stronger);
+        spare_.resize(target);
+    } else if (n_leaves < target) {
+        // 受最小节点尺寸限制的叶子里还有多余的点，按响应值补齐到目标数
+        for (int id : leaves_) {
+            const Node& node = arena_[id];
+            spare_.insert(spare_.end(), entries_.begin() + node.begin + 1, entries_.begin() + node.end);
+        }
+        const int need = std::min(target, static_cast<int>(spare_.size()));
+        std::nth_element(spare_.begin() + n_leaves, spare_.begin() + need, spare_.end(), stronger);
+        spare_.resize(need);
+    }
+    std::sort(spare_.begin(), spare_.end(), stronger);
+    for (const Entry& e : spare_) selected.push_back(e.index);
+}
+
+void QuadtreeUniformizer::distribute(const std::vector<KeyPoint>& keypoints,
+                                     float min_x, float max_x, float min_y, float max_y,
+                                     int target, std::vector<int>& selected) {
+    selected.clear();
+    const int n = static_cast<int>(keypoints.size());
+    entries_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        entries_[i] = {keypoints[i].x, keypoints[i].y, keypoints[i].response, i};
+    }
+    runOnRange(0, n, min_x, max_x, min_y, max_y, target, selected);
+}
+
+void QuadtreeUniformizer::distributePerLevel(const std::vector<KeyPoint>& keypoints,
+                                             const std::vector<int>& level_targets,
+                                             const std::vector<float>& level_widths,
+                                             const std::vector<float>& level_heights,
+                                             std::vector<int>& selected) {
+    selected.clear();
+    const int n_levels = static_cast<int>(level_targets.size());
+    const int n = static_cast<int>(keypoints.size());
+
+    // 一次计数排序把特征点按层分组，层号越界的点直接丢弃
+    level_begin_.assign(n_levels + 1, 0);
+    for (const KeyPoint& kp : keypoints) {
+        if (kp.octave >= 0 && kp.octave < n_levels) ++level_begin_[kp.octave + 1];
+    }
+    for (int l = 0; l < n_levels; ++l) level_begin_[l + 1] += level_begin_[l];
+
+    entries_.resize(level_begin_[n_levels]);
+    std::vector<int>& cursor = next_leaves_;
+    cursor.assign(level_begin_.begin(), level_begin_.end() - 1);
+    for (int i = 0; i < n; ++i) {
+        const KeyPoint& kp = keypoints[i];
+        if (kp.octave >= 0 && kp.octave < n_levels) {
+            entries_[cursor[kp.octave]++] = {kp.x, kp.y, kp.response, i};
+        }
+    }
+
+    for (int l = 0; l < n_levels; ++l) {
+        runOnRange(level_begin_[l], level_begin_[l + 1],
+                   0.f, level_widths[l], 0.f, level_heights[l], level_targets[l], selected);
+    }
+}
+
+std::vector<int> QuadtreeUniformizer::computeLevelTargets(int total, int n_levels, float scale_factor) {
+    std::vector<int> targets(n_levels, 0);
+    if (n_levels <= 0) return targets;
+
+    // scale_factor <= 1 时等比数列退化（公比 1 时分母为 0），按层平均分配，余数给前面的层
+    if (!(scale_factor > 1.f)) {
+        const int share = std::max(total, 0) / n_levels, remainder = std::max(total, 0) % n_levels;
+        for (int l = 0; l < n_levels; ++l) targets[l] = share + (l < remainder ? 1 : 0);
+        return targets;
+    }
+
+    const float factor = 1.f / scale_factor;
+    float desired = total * (1.f - factor) / (1.f - std::pow(factor, static_cast<float>(n_levels)));
+    int sum = 0;
+    for (int l = 0; l + 1 < n_levels; ++l) {
+        targets[l] = static_cast<int>(std::lround(desired));
+        sum += targets[l];
+        desired *= factor;
+    }
+    targets[n_levels - 1] = std::max(total - sum, 0);
+    return targets;
+}
+
+}  // namespace slam
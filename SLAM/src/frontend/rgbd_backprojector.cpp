@@ -0,0 +1,209 @@
+#include "frontend/rgbd_backprojector.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include <Eigen/Core>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+// 一行 n 个像素：z = d * scale，范围外为 NaN，x = z * ray_x，y = z * ray_y；返回有效点数
+int backProjectRow(const std::uint16_t* d, const float* ray_x, const float* ray_y, int n, const RgbdOptions& options,
+                   float* x, float* y, float* z) {
+    int i = 0;
+    int valid = 0;
+#if defined(__AVX2__)
+    const __m256 scale = _mm256_set1_ps(options.depth_scale);
+    const __m256 z_min = _mm256_set1_ps(options.min_depth);
+    const __m256 z_max = _mm256_set1_ps(options.max_depth);
+    const __m256 nan = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+    for (; i + 8 <= n; i += 8) {
+        const __m256i di = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i)));
+        __m256 vz = _mm256_mul_ps(_mm256_cvtepi32_ps(di), scale);
+        const __m256 ok = _mm256_and_ps(_mm256_cmp_ps(vz, z_min, _CMP_GE_OQ), _mm256_cmp_ps(vz, z_max, _CMP_LE_OQ));
+        vz = _mm256_blendv_ps(nan, vz, ok);
+        // NaN 乘射线仍是 NaN，x、y 不需要再做一次选择
+        _mm256_storeu_ps(z + i, vz);
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(vz, _mm256_loadu_ps(ray_x + i)));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(vz, _mm256_loadu_ps(ray_y + i)));
+        valid += __builtin_popcount(static_cast<unsigned>(_mm256_movemask_ps(ok)));
+    }
+#endif
+    // 剩余像素（没有 AVX2 时是整行）：Map 直接包装原始缓冲区，由 Eigen 的表达式做向量化
+    const int m = n - i;
+    if (m > 0) {
+        using ArrayXu16 = Eigen::Array<std::uint16_t, Eigen::Dynamic, 1>;
+        const Eigen::Map<const ArrayXu16> dm(d + i, m);
+        const Eigen::Map<const Eigen::ArrayXf> rx(ray_x + i, m), ry(ray_y + i, m);
+        Eigen::Map<Eigen::ArrayXf> xm(x + i, m), ym(y + i, m), zm(z + i, m);
+        zm = dm.cast<float>() * options.depth_scale;
+        const auto ok = (zm >= options.min_depth) && (zm <= options.max_depth);
+        valid += static_cast<int>(ok.count());
+        zm = ok.select(zm, std::numeric_limits<float>::quiet_NaN());
+        xm = zm * rx;
+        ym = zm * ry;
+    }
+    return valid;
+}
+
+// 一行 RGB 交错像素拆成三个通道
+void splitRgbRow(const std::uint8_t* rgb, int n, std::uint8_t* r, std::uint8_t* g, std::uint8_t* b) {
+    int i = 0;
+#if defined(__SSSE3__)
+    // 16 个像素 = 48 字节 = 3 个 xmm；每个通道从 3 个寄存器里各取一段（-1 的位置置 0），再按位或拼起来
+    const __m128i r0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i b0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+    for (; i + 16 <= n; i += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(rgb + 3 * i);
+        const __m128i a = _mm_loadu_si128(p), c = _mm_loadu_si128(p + 1), e = _mm_loadu_si128(p + 2);
+        const auto gather = [&](__m128i m0, __m128i m1, __m128i m2) {
+            return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m0), _mm_shuffle_epi8(c, m1)),
+                                _mm_shuffle_epi8(e, m2));
+        };
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(r + i), gather(r0, r1, r2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(g + i), gather(g0, g1, g2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b + i), gather(b0, b1, b2));
+    }
+#endif
+    for (; i < n; ++i) {
+        r[i] = rgb[3 * i];
+        g[i] = rgb[3 * i + 1];
+        b[i] = rgb[3 * i + 2];
+    }
+}
+
+}  // namespace
+
+RgbdBackProjector::RgbdBackProjector(const PinholeCamera& camera, const RgbdOptions& options, ThreadPool* pool)
+    : width_(camera.width), height_(camera.height), options_(options), pool_(pool ? pool : &ThreadPool::global()) {
+    // 针孔模型的射线按行、列可分离，但逐像素存一份可以和任意射线表共用同一个内核
+    ray_x_.resize(static_cast<size_t>(width_) * height_);
+    ray_y_.resize(ray_x_.size());
+    const float inv_fx = 1.0f / camera.fx, inv_fy = 1.0f / camera.fy;
+    for (int v = 0; v < height_; ++v) {
+        const float ry = (static_cast<float>(v) - camera.cy) * inv_fy;
+        for (int u = 0; u < width_; ++u) {
+            ray_x_[static_cast<size_t>(v) * width_ + u] = (static_cast<float>(u) - camera.cx) * inv_fx;
+            ray_y_[static_cast<size_t>(v) * width_ + u] = ry;
+        }
+    }
+    allocateWorkspaces();
+}
+
+RgbdBackProjector::RgbdBackProjector(int width, int height, std::vector<float> ray_x, std::vector<float> ray_y,
+                                     const RgbdOptions& options, ThreadPool* pool)
+    : width_(width), height_(height), options_(options), pool_(pool ? pool : &ThreadPool::global()),
+      ray_x_(std::move(ray_x)), ray_y_(std::move(ray_y)) {
+    allocateWorkspaces();
+}
+
+void RgbdBackProjector::allocateWorkspaces() {
+    options_.band_rows = std::max(1, options_.band_rows);
+    const size_t n = static_cast<size_t>(options_.band_rows) * width_;
+    workspaces_.resize(pool_->size());
+    for (Workspace& ws : workspaces_) {
+        ws.x.resize(n);
+        ws.y.resize(n);
+        ws.z.resize(n);
+        ws.r.resize(n);
+        ws.g.resize(n);
+        ws.b.resize(n);
+    }
+}
+
+int RgbdBackProjector::processBand(const std::uint16_t* depth, int depth_stride, const std::uint8_t* rgb,
+                                   int rgb_stride, int row_begin, int row_end, float* x, float* y, float* z,
+                                   std::uint8_t* r, std::uint8_t* g, std::uint8_t* b) const {
+    const char* depth_bytes = reinterpret_cast<const char*>(depth);
+    int valid = 0;
+    for (int v = row_begin; v < row_end; ++v) {
+        const size_t offset = static_cast<size_t>(v - row_begin) * width_;
+        const size_t ray_offset = static_cast<size_t>(v) * width_;
+        const auto* row = reinterpret_cast<const std::uint16_t*>(depth_bytes + static_cast<size_t>(v) * depth_stride);
+        valid += backProjectRow(row, ray_x_.data() + ray_offset, ray_y_.data() + ray_offset, width_, options_,
+                                x + offset, y + offset, z + offset);
+        if (rgb) {
+            splitRgbRow(rgb + static_cast<size_t>(v) * rgb_stride, width_, r + offset, g + offset, b + offset);
+        }
+    }
+    return valid;
+}
+
+void RgbdBackProjector::process(const std::uint16_t* depth, int depth_stride, const std::uint8_t* rgb,
+                                int rgb_stride, const BandConsumer& consumer) {
+    const int band_rows = options_.band_rows;
+    const int n_bands = (height_ + band_rows - 1) / band_rows;
+    pool_->parallelFor(n_bands, [&](int task, int thread_id) {
+        Workspace& ws = workspaces_[thread_id];
+        PointBand band;
+        band.row_begin = task * band_rows;
+        band.row_end = std::min(height_, band.row_begin + band_rows);
+        band.width = width_;
+        band.num_valid = processBand(depth, depth_stride, rgb, rgb_stride, band.row_begin, band.row_end,
+                                     ws.x.data(), ws.y.data(), ws.z.data(), ws.r.data(), ws.g.data(), ws.b.data());
+        band.x = ws.x.data();
+        band.y = ws.y.data();
+        band.z = ws.z.data();
+        if (rgb) {
+            band.r = ws.r.data();
+            band.g = ws.g.data();
+            band.b = ws.b.data();
+        }
+        consumer(band, thread_id);
+    });
+}
+
+int RgbdBackProjector::process(const std::uint16_t* depth, int depth_stride, const std::uint8_t* rgb,
+                               int rgb_stride, PointCloudSoA& cloud) {
+    const size_t n = static_cast<size_t>(width_) * height_;
+    cloud.width = width_;
+    cloud.height = height_;
+    cloud.x.resize(n);
+    cloud.y.resize(n);
+    cloud.z.resize(n);
+    if (rgb) {
+        cloud.r.resize(n);
+        cloud.g.resize(n);
+        cloud.b.resize(n);
+    } else {
+        cloud.r.clear();
+        cloud.g.clear();
+        cloud.b.clear();
+    }
+
+    const int band_rows = options_.band_rows;
+    const int n_bands = (height_ + band_rows - 1) / band_rows;
+    std::vector<int> band_valid(n_bands, 0);
+    pool_->parallelFor(n_bands, [&](int task, int) {
+        const int row_begin = task * band_rows;
+        const int row_end = std::min(height_, row_begin + band_rows);
+        const size_t offset = static_cast<size_t>(row_begin) * width_;
+        band_valid[task] = processBand(depth, depth_stride, rgb, rgb_stride, row_begin, row_end,
+                                       cloud.x.data() + offset, cloud.y.data() + offset, cloud.z.data() + offset,
+                                       rgb ? cloud.r.data() + offset : nullptr,
+                                       rgb ? cloud.g.data() + offset : nullptr,
+                                       rgb ? cloud.b.data() + offset : nullptr);
+    });
+
+    cloud.num_valid = 0;
+    for (int v : band_valid) cloud.num_valid += v;
+    return cloud.num_valid;
+}
+
+}  // namespace slam
@@ -0,0 +1,387 @@
+#include "frontend/sgm_stereo.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr int kCensusHalfWidth = 4;     // 9x7 窗口
+constexpr int kCensusHalfHeight = 3;
+constexpr std::uint8_t kMaxCost = 31;   // 中心对称 census 共 31 位，也用作越界视差的代价
+constexpr int kPathPad = 8;             // 每个像素的路径值前后留出的元素数，[-1] 和 [D] 是哨兵
+constexpr std::uint16_t kSentinel = 0xffff;
+constexpr int kCensusRowsPerTask = 16;
+
+// 一行的中心对称 census：比较关于中心对称的像素对，y 必须在 [3, height - 3) 内
+void censusRow(const std::uint8_t* image, int stride, int width, int y, std::uint32_t* out) {
+    std::fill(out, out + width, 0u);
+    for (int dy = -kCensusHalfHeight; dy <= 0; ++dy) {
+        for (int dx = -kCensusHalfWidth; dx <= kCensusHalfWidth; ++dx) {
+            if (dy == 0 && dx >= 0) break;
+            const std::uint8_t* a = image + (y + dy) * stride + dx;
+            const std::uint8_t* b = image + (y - dy) * stride - dx;
+            for (int x = kCensusHalfWidth; x < width - kCensusHalfWidth; ++x) {
+                out[x] = (out[x] << 1) | static_cast<std::uint32_t>(a[x] > b[x]);
+            }
+        }
+    }
+    for (int x = 0; x < kCensusHalfWidth; ++x) out[x] = 0;
+    for (int x = std::max(kCensusHalfWidth, width - kCensusHalfWidth); x < width; ++x) out[x] = 0;
+}
+
+#if defined(__AVX2__)
+// 每个 32 位元素的 popcount：pshufb 查表得到每字节的计数，再两次乘加横向求和
+inline __m256i popcount32(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+    const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+    const __m256i bytes = _mm256_add_epi8(lo, hi);
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+#endif
+
+// 一行的匹配代价 cost[x * D + d] = popcount(census_l[x] ^ census_r[x - d])
+// reversed 是右图 census 的逆序副本（长度 width + D），使 census_r[x - d] 对 d 连续
+void costRow(const std::uint32_t* census_l, const std::uint32_t* census_r, int width, int D,
+             std::uint32_t* reversed, std::uint8_t* cost) {
+    for (int k = 0; k < width; ++k) reversed[k] = census_r[width - 1 - k];
+    std::fill(reversed + width, reversed + width + D, 0u);
+
+    for (int x = 0; x < width; ++x) {
+        const std::uint32_t* r = reversed + (width - 1 - x);
+        std::uint8_t* c = cost + x * D;
+#if defined(__AVX2__)
+        const __m256i l = _mm256_set1_epi32(static_cast<int>(census_l[x]));
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        for (int d = 0; d < D; d += 32) {
+            const __m256i* p = reinterpret_cast<const __m256i*>(r + d);
+            const __m256i c0 = popcount32(_mm256_xor_si256(l, _mm256_loadu_si256(p)));
+            const __m256i c1 = popcount32(_mm256_xor_si256(l, _mm256_loadu_si256(p + 1)));
+            const __m256i c2 = popcount32(_mm256_xor_si256(l, _mm256_loadu_si256(p + 2)));
+            const __m256i c3 = popcount32(_mm256_xor_si256(l, _mm256_loadu_si256(p + 3)));
+            // 32 位 -> 8 位，pack 按 128 位通道交错，最后按 32 位重排回原顺序
+            const __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(c0, c1), _mm256_packus_epi32(c2, c3));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + d), _mm256_permutevar8x32_epi32(packed, order));
+        }
+#else
+        for (int d = 0; d < D; ++d) c[d] = static_cast<std::uint8_t>(__builtin_popcount(census_l[x] ^ r[d]));
+#endif
+        // x - d < 0 时右图没有对应像素
+        for (int d = x + 1; d < D; ++d) c[d] = kMaxCost;
+    }
+}
+
+enum class SumMode { kNone, kStore, kAdd };   // 预热行不累加 / 前向写入 / 后向累加
+
+/*
+一个像素同时更新 4 个方向的路径代价（前向或后向的 4 个方向），方向 k：
+    L_k(p, d) = C(p, d) + min(L_k(p-r, d), L_k(p-r, d±1) + P1, min_i L_k(p-r, i) + P2) - min_i L_k(p-r, i)
+4 个方向共用一次代价加载，求和后只读写一次 sum。
+prev[k][-1] 和 prev[k][D] 是哨兵 0xffff，饱和加法后仍然最大，d±1 越界时自然不会被选中。
+cur_min[k] 返回 min_d L_k(p, d)。
+ */
+template <SumMode kMode>
+inline void updatePaths(const std::uint8_t* cost, const std::uint16_t* const prev[4], const std::uint16_t prev_min[4],
+                        std::uint16_t* const cur[4], std::uint16_t cur_min[4], std::uint16_t* sum, int D,
+                        std::uint16_t P1, std::uint16_t P2) {
+#if defined(__AVX2__)
+    const __m256i p1 = _mm256_set1_epi16(static_cast<short>(P1));
+    __m256i vjump[4], vprev_min[4], vmin[4];
+    for (int k = 0; k < 4; ++k) {
+        vjump[k] = _mm256_set1_epi16(static_cast<short>(std::min(prev_min[k] + P2, 0xffff)));
+        vprev_min[k] = _mm256_set1_epi16(static_cast<short>(prev_min[k]));
+        vmin[k] = _mm256_set1_epi16(-1);
+    }
+    for (int d = 0; d < D; d += 16) {
+        const __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cost + d)));
+        __m256i total = _mm256_setzero_si256();
+        for (int k = 0; k < 4; ++k) {
+            const std::uint16_t* pk = prev[k] + d;
+            const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pk));
+            const __m256i pm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pk - 1));
+            const __m256i pp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pk + 1));
+            __m256i t = _mm256_min_epu16(p, _mm256_adds_epu16(_mm256_min_epu16(pm, pp), p1));
+            t = _mm256_min_epu16(t, vjump[k]);
+            const __m256i v = _mm256_adds_epu16(c, _mm256_subs_epu16(t, vprev_min[k]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(cur[k] + d), v);
+            vmin[k] = _mm256_min_epu16(vmin[k], v);
+            total = _mm256_adds_epu16(total, v);
+        }
+        __m256i* s = reinterpret_cast<__m256i*>(sum + d);
+        if (kMode == SumMode::kStore) _mm256_storeu_si256(s, total);
+        if (kMode == SumMode::kAdd) _mm256_storeu_si256(s, _mm256_adds_epu16(_mm256_loadu_si256(s), total));
+    }
+    for (int k = 0; k < 4; ++k) {
+        const __m128i m = _mm_min_epu16(_mm256_castsi256_si128(vmin[k]), _mm256_extracti128_si256(vmin[k], 1));
+        cur_min[k] = static_cast<std::uint16_t>(_mm_cvtsi128_si32(_mm_minpos_epu16(m)));
+    }
+#else
+    for (int k = 0; k < 4; ++k) cur_min[k] = 0xffff;
+    for (int d = 0; d < D; ++d) {
+        int total = 0;
+        for (int k = 0; k < 4; ++k) {
+            const std::uint16_t* pk = prev[k];
+            int t = std::min<int>(pk[d], std::min<int>(pk[d - 1], pk[d + 1]) + P1);
+            t = std::min(t, prev_min[k] + P2);
+            const std::uint16_t v = static_cast<std::uint16_t>(std::min(cost[d] + t - prev_min[k], 0xffff));
+            cur[k][d] = v;
+            cur_min[k] = std::min(cur_min[k], v);
+            total += v;
+        }
+        if (kMode == SumMode::kStore) sum[d] = static_cast<std::uint16_t>(std::min(total, 0xffff));
+        if (kMode == SumMode::kAdd) sum[d] = static_cast<std::uint16_t>(std::min(sum[d] + total, 0xffff));
+    }
+#endif
+}
+
+// 聚合代价最小的视差（相同时取较小的视差）
+inline int argminDisparity(const std::uint16_t* s, int D) {
+#if defined(__AVX2__)
+    __m256i vmin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    for (int d = 16; d < D; d += 16) {
+        vmin = _mm256_min_epu16(vmin, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + d)));
+    }
+    const __m128i m = _mm_min_epu16(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+    const __m256i target = _mm256_set1_epi16(static_cast<short>(_mm_cvtsi128_si32(_mm_minpos_epu16(m))));
+    for (int d = 0; d < D; d += 16) {
+        const __m256i eq = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + d)), target);
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        if (mask) return d + __builtin_ctz(mask) / 2;
+    }
+    return 0;
+#else
+    return static_cast<int>(std::min_element(s, s + D) - s);
+#endif
+}
+
+// 右图视差：d_R(x - d) = argmin_d S(x, d)。min_r / disp_r 按 k = width - 1 - x_r 逆序存放，
+// 使同一个 x 的全部 d 在内存中连续；x - d < 0 的部分落在末尾的 D 个填充元素里
+inline void updateRightDisparity(const std::uint16_t* s, int x, int width, int D, std::uint16_t* min_r,
+                                 std::uint16_t* disp_r) {
+    std::uint16_t* m = min_r + (width - 1 - x);
+    std::uint16_t* r = disp_r + (width - 1 - x);
+#if defined(__AVX2__)
+    __m256i dv = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i step = _mm256_set1_epi16(16);
+    for (int d = 0; d < D; d += 16) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + d));
+        const __m256i old_min = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + d));
+        const __m256i new_min = _mm256_min_epu16(v, old_min);
+        // new_min != old_min 即 v < old_min
+        const __m256i keep = _mm256_cmpeq_epi16(new_min, old_min);
+        const __m256i old_disp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(m + d), new_min);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + d), _mm256_blendv_epi8(dv, old_disp, keep));
+        dv = _mm256_add_epi16(dv, step);
+    }
+#else
+    for (int d = 0; d < D; ++d) {
+        if (s[d] < m[d]) {
+            m[d] = s[d];
+            r[d] = static_cast<std::uint16_t>(d);
+        }
+    }
+#endif
+}
+
+}  // namespace
+
+struct SgmStereo::Workspace {
+    std::vector<std::uint8_t> cost;         // (band_rows + 2 * overlap) 行的代价
+    std::vector<std::uint16_t> sum;         // band_rows 行的 8 方向聚合代价
+    std::vector<std::uint16_t> paths;       // 3 个跨行方向 x 2 行 + 水平方向 2 个像素 + 全零的起点
+    std::vector<std::uint16_t> path_min;    // 3 个跨行方向 x 2 行，每个像素的路径最小值
+    std::vector<std::uint32_t> reversed;    // 右图 census 逆序
+    std::vector<std::uint16_t> min_r, disp_r;
+    std::vector<std::uint16_t> disp_l;
+};
+
+SgmStereo::SgmStereo(int width, int height, const SgmOptions& options, ThreadPool* pool)
+    : width_(width), height_(height), options_(options), pool_(pool ? pool : &ThreadPool::global()) {
+    options_.max_disparity = std::max(32, (options_.max_disparity + 31) / 32 * 32);
+    options_.band_overlap = std::max(0, options_.band_overlap);
+    const int n_bands = (options_.band_rows > 0) ? (height_ + options_.band_rows - 1) / options_.band_rows
+                                                 : pool_->size();
+    band_rows_ = std::max(1, (height_ + n_bands - 1) / n_bands);
+
+    census_left_.resize(static_cast<size_t>(width_) * height_);
+    census_right_.resize(static_cast<size_t>(width_) * height_);
+
+    const int D = options_.max_disparity;
+    const size_t stride = D + 2 * kPathPad;
+    const size_t row_cells = static_cast<size_t>(width_) * D;
+    workspaces_.resize(pool_->size());
+    for (Workspace& ws : workspaces_) {
+        ws.cost.resize((band_rows_ + 2 * options_.band_overlap) * row_cells);
+        ws.sum.resize(band_rows_ * row_cells);
+        // 哨兵只需设置一次，之后只写 [0, D)
+        ws.paths.assign((6 * static_cast<size_t>(width_) + 3) * stride, kSentinel);
+        std::fill(ws.paths.end() - stride + kPathPad, ws.paths.end() - kPathPad, 0);
+        ws.path_min.resize(6 * static_cast<size_t>(width_));
+        ws.reversed.resize(width_ + D);
+        ws.min_r.resize(width_ + D);
+        ws.disp_r.resize(width_ + D);
+        ws.disp_l.resize(width_);
+    }
+}
+
+SgmStereo::~SgmStereo() = default;
+
+void SgmStereo::compute(const std::uint8_t* left, const std::uint8_t* right, int stride, float* disparity) {
+    // 1. census，按行分组并行
+    const int n_census_tasks = (height_ + kCensusRowsPerTask - 1) / kCensusRowsPerTask;
+    pool_->parallelFor(n_census_tasks, [&](int task, int) {
+        const int y_end = std::min(height_, (task + 1) * kCensusRowsPerTask);
+        for (int y = task * kCensusRowsPerTask; y < y_end; ++y) {
+            std::uint32_t* cl = census_left_.data() + static_cast<size_t>(y) * width_;
+            std::uint32_t* cr = census_right_.data() + static_cast<size_t>(y) * width_;
+            if (y < kCensusHalfHeight || y >= height_ - kCensusHalfHeight) {
+                std::fill(cl, cl + width_, 0u);
+                std::fill(cr, cr + width_, 0u);
+                continue;
+            }
+            censusRow(left, stride, width_, y, cl);
+            censusRow(right, stride, width_, y, cr);
+        }
+    });
+
+    // 2. 按行带聚合并选择视差
+    const int n_bands = (height_ + band_rows_ - 1) / band_rows_;
+    pool_->parallelFor(n_bands, [&](int band, int thread_id) {
+        const int row_begin = band * band_rows_;
+        const int row_end = std::min(height_, row_begin + band_rows_);
+        processBand(row_begin, row_end, workspaces_[thread_id], disparity);
+    });
+}
+
+void SgmStereo::processBand(int row_begin, int row_end, Workspace& ws, float* disparity) const {
+    const int W = width_;
+    const int D = options_.max_disparity;
+    const std::uint16_t P1 = static_cast<std::uint16_t>(options_.P1);
+    const std::uint16_t P2 = static_cast<std::uint16_t>(std::max(options_.P1, options_.P2));
+    const size_t row_cells = static_cast<size_t>(W) * D;
+    const size_t stride = D + 2 * kPathPad;
+
+    // 预热区间 [a, b)
+    const int a = std::max(0, row_begin - options_.band_overlap);
+    const int b = std::min(height_, row_end + options_.band_overlap);
+
+    for (int y = a; y < b; ++y) {
+        costRow(census_left_.data() + static_cast<size_t>(y) * W, census_right_.data() + static_cast<size_t>(y) * W,
+                W, D, ws.reversed.data(), ws.cost.data() + (y - a) * row_cells);
+    }
+
+    // 路径缓冲：rows[dir][k] 是跨行方向 dir 第 k 行（两行交替）的起点，每个像素占 stride 个元素
+    std::uint16_t* rows[3][2];
+    std::uint16_t* mins[3][2];
+    for (int dir = 0; dir < 3; ++dir) {
+        for (int k = 0; k < 2; ++k) {
+            rows[dir][k] = ws.paths.data() + (dir * 2 + k) * W * stride + kPathPad;
+            mins[dir][k] = ws.path_min.data() + (dir * 2 + k) * W;
+        }
+    }
+    std::uint16_t* horizontal[2] = {ws.paths.data() + 6 * W * stride + kPathPad,
+                                    ws.paths.data() + (6 * W + 1) * stride + kPathPad};
+    const std::uint16_t* zero = ws.paths.data() + (6 * W + 2) * stride + kPathPad;
+
+    // 一行的 4 个方向：方向 0 是水平方向（行内前一个像素），方向 1..3 是跨行方向，
+    // 前一个像素在上一行（后向时为下一行）的 x + row_dx[dir]
+    auto aggregateRow = [&](const std::uint8_t* cost_row, std::uint16_t* sum_row, SumMode mode, bool first_row,
+                            int cur, int x_begin, int x_step, const int row_dx[3]) {
+        const int prev_row = 1 - cur;
+        const std::uint16_t* prev[4];
+        std::uint16_t prev_min[4];
+        std::uint16_t* out[4];
+        std::uint16_t out_min[4];
+        prev[0] = zero;
+        prev_min[0] = 0;
+        for (int i = 0, x = x_begin; i < W; ++i, x += x_step) {
+            out[0] = horizontal[i & 1];
+            for (int dir = 0; dir < 3; ++dir) {
+                const int px = x + row_dx[dir];
+                const bool start = first_row || px < 0 || px >= W;
+                prev[dir + 1] = start ? zero : rows[dir][prev_row] + px * stride;
+                prev_min[dir + 1] = start ? 0 : mins[dir][prev_row][px];
+                out[dir + 1] = rows[dir][cur] + x * stride;
+            }
+            const std::uint8_t* c = cost_row + x * D;
+            std::uint16_t* s = sum_row ? sum_row + x * D : nullptr;
+            if (mode == SumMode::kStore) {
+                updatePaths<SumMode::kStore>(c, prev, prev_min, out, out_min, s, D, P1, P2);
+            } else if (mode == SumMode::kAdd) {
+                updatePaths<SumMode::kAdd>(c, prev, prev_min, out, out_min, s, D, P1, P2);
+            } else {
+                updatePaths<SumMode::kNone>(c, prev, prev_min, out, out_min, s, D, P1, P2);
+            }
+            prev[0] = out[0];
+            prev_min[0] = out_min[0];
+            for (int dir = 0; dir < 3; ++dir) mins[dir][cur][x] = out_min[dir + 1];
+        }
+    };
+
+    // 3. 前向：左、左上、上、右上，行带内的行直接写入 sum
+    const int forward_dx[3] = {-1, 0, 1};
+    int cur = 0;
+    for (int y = a; y < row_end; ++y) {
+        const bool inside = y >= row_begin;
+        aggregateRow(ws.cost.data() + (y - a) * row_cells,
+                     inside ? ws.sum.data() + (y - row_begin) * row_cells : nullptr,
+                     inside ? SumMode::kStore : SumMode::kNone, y == a, cur, 0, 1, forward_dx);
+        cur = 1 - cur;
+    }
+
+    // 4. 后向：右、右下、下、左下；一行聚合完成后立即选择视差
+    const int backward_dx[3] = {1, 0, -1};
+    cur = 0;
+    for (int y = b - 1; y >= row_begin; --y) {
+        const bool inside = y < row_end;
+        std::uint16_t* sum_row = inside ? ws.sum.data() + (y - row_begin) * row_cells : nullptr;
+        aggregateRow(ws.cost.data() + (y - a) * row_cells, sum_row, inside ? SumMode::kAdd : SumMode::kNone,
+                     y == b - 1, cur, W - 1, -1, backward_dx);
+        cur = 1 - cur;
+        if (!inside) continue;
+
+        // 5. 胜者为王 + 左右一致性 + 亚像素
+        float* out = disparity + static_cast<size_t>(y) * W;
+        if (y < kCensusHalfHeight || y >= height_ - kCensusHalfHeight) {
+            std::fill(out, out + W, kInvalidDisparity);
+            continue;
+        }
+        if (options_.lr_check) std::fill(ws.min_r.begin(), ws.min_r.end(), kSentinel);
+        for (int x = 0; x < W; ++x) {
+            const std::uint16_t* s = sum_row + x * D;
+            ws.disp_l[x] = static_cast<std::uint16_t>(argminDisparity(s, D));
+            if (options_.lr_check) updateRightDisparity(s, x, W, D, ws.min_r.data(), ws.disp_r.data());
+        }
+        for (int x = 0; x < W; ++x) {
+            const int d = ws.disp_l[x];
+            if (x < kCensusHalfWidth || x >= W - kCensusHalfWidth || x - d < kCensusHalfWidth) {
+                out[x] = kInvalidDisparity;
+                continue;
+            }
+            if (options_.lr_check && std::abs(ws.disp_r[W - 1 - (x - d)] - d) > options_.lr_max_diff) {
+                out[x] = kInvalidDisparity;
+                continue;
+            }
+            float value = static_cast<float>(d);
+            if (options_.subpixel && d > 0 && d < D - 1) {
+                const std::uint16_t* s = sum_row + x * D;
+                const int denom = s[d - 1] + s[d + 1] - 2 * s[d];
+                if (denom > 0) value += 0.5f * static_cast<float>(s[d - 1] - s[d + 1]) / denom;
+            }
+            out[x] = value;
+        }
+    }
+}
+
+}  // namespace slam
@@ -0,0 +1,303 @@
+#include "frontend/two_view_model_selector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Eigenvalues>
+
+#include "utils/profiler.h"
+#include "utils/ransac.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr int kSampleSize = 8;          // 两个模型共用的最小集大小（单应 DLT 用 8 个点做最小二乘）
+constexpr double kChi2OneDof = 3.841;   // 95% 分位数，1 自由度（点到对极线）
+constexpr double kChi2TwoDof = 5.991;   // 95% 分位数，2 自由度（点到点）
+
+constexpr int kChunk = 64;              // 打分时每块的对应点数
+using ChunkArray = Eigen::Array<double, kChunk, 1>;
+using ChunkMap = Eigen::Map<const ChunkArray>;
+using Matrix9d = Eigen::Matrix<double, 9, 9>;
+using Vector9d = Eigen::Matrix<double, 9, 1>;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+// Hartley 归一化：平移到质心，按平均绝对偏差缩放
+Eigen::Matrix3d normalizePoints(const std::vector<double>& x, const std::vector<double>& y,
+                                std::vector<double>& xn, std::vector<double>& yn) {
+    const int n = static_cast<int>(x.size());
+    double mx = 0.0, my = 0.0;
+    for (int i = 0; i < n; ++i) {
+        mx += x[i];
+        my += y[i];
+    }
+    mx /= n;
+    my /= n;
+    double sx = 0.0, sy = 0.0;
+    for (int i = 0; i < n; ++i) {
+        sx += std::fabs(x[i] - mx);
+        sy += std::fabs(y[i] - my);
+    }
+    sx = (sx > 0.0) ? n / sx : 1.0;
+    sy = (sy > 0.0) ? n / sy : 1.0;
+
+    xn.resize(n);
+    yn.resize(n);
+    for (int i = 0; i < n; ++i) {
+        xn[i] = (x[i] - mx) * sx;
+        yn[i] = (y[i] - my) * sy;
+    }
+    Eigen::Matrix3d T;
+    T << sx, 0.0, -mx * sx,
+         0.0, sy, -my * sy,
+         0.0, 0.0, 1.0;
+    return T;
+}
+
+// 两个模型共用的数据：归一化坐标（拟合用）、补齐的像素坐标（打分用）、最小集
+struct SharedData {
+    int n = 0;
+    std::vector<double> xn1, yn1, xn2, yn2;
+    Eigen::Matrix3d T1, T2;
+    // 补齐到 kChunk 的倍数，尾部 x2/y2 为 NaN，NaN 的比较结果为 false，永远不会被判为内点
+    std::vector<double> x1, y1, x2, y2;
+    std::vector<int> samples;       // max_iterations 组，每组 kSampleSize 个下标
+
+    void load(const TwoViewCorrespondences& pixels, int iterations, std::uint32_t seed) {
+        n = pixels.size();
+        T1 = normalizePoints(pixels.x1, pixels.y1, xn1, yn1);
+        T2 = normalizePoints(pixels.x2, pixels.y2, xn2, yn2);
+
+        const int padded = (n + kChunk - 1) / kChunk * kChunk;
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        x1.assign(padded, 0.0);
+        y1.assign(padded, 0.0);
+        x2.assign(padded, nan);
+        y2.assign(padded, nan);
+        std::copy(pixels.x1.begin(), pixels.x1.end(), x1.begin());
+        std::copy(pixels.y1.begin(), pixels.y1.end(), y1.begin());
+        std::copy(pixels.x2.begin(), pixels.x2.end(), x2.begin());
+        std::copy(pixels.y2.begin(), pixels.y2.end(), y2.begin());
+
+        ProsacSampler sampler(n, kSampleSize, iterations, false, seed);
+        samples.resize(static_cast<size_t>(iterations) * kSampleSize);
+        for (int it = 0; it < iterations; ++it) sampler.sample(samples.data() + it * kSampleSize);
+    }
+
+    int paddedSize() const { return static_cast<int>(x1.size()); }
+};
+
+Eigen::Matrix3d reshape(const Vector9d& v) {
+    Eigen::Matrix3d M;
+    M << v[0], v[1], v[2],
+         v[3], v[4], v[5],
+         v[6], v[7], v[8];
+    return M;
+}
+
+// 归一化坐标下的 DLT，A^T A 的最小特征向量，再反归一化
+Eigen::Matrix3d fitHomography(const SharedData& d, const int* idx) {
+    Matrix9d AtA = Matrix9d::Zero();
+    for (int k = 0; k < kSampleSize; ++k) {
+        const int i = idx[k];
+        const double u1 = d.xn1[i], v1 = d.yn1[i], u2 = d.xn2[i], v2 = d.yn2[i];
+        Vector9d a, b;
+        a << 0.0, 0.0, 0.0, -u1, -v1, -1.0, v2 * u1, v2 * v1, v2;
+        b << u1, v1, 1.0, 0.0, 0.0, 0.0, -u2 * u1, -u2 * v1, -u2;
+        AtA.noalias() += a * a.transpose() + b * b.transpose();
+    }
+    const Eigen::SelfAdjointEigenSolver<Matrix9d> eig(AtA);
+    return d.T2.inverse() * reshape(eig.eigenvectors().col(0)) * d.T1;
+}
+
+// 8 点法，强制秩 2 后反归一化
+Eigen::Matrix3d fitFundamental(const SharedData& d, const int* idx) {
+    Matrix9d AtA = Matrix9d::Zero();
+    for (int k = 0; k < kSampleSize; ++k) {
+        const int i = idx[k];
+        const double u1 = d.xn1[i], v1 = d.yn1[i], u2 = d.xn2[i], v2 = d.yn2[i];
+        Vector9d a;
+        a << u2 * u1, u2 * v1, u2, v2 * u1, v2 * v1, v2, u1, v1, 1.0;
+        AtA.noalias() += a * a.transpose();
+    }
+    const Eigen::SelfAdjointEigenSolver<Matrix9d> eig(AtA);
+    const Eigen::JacobiSVD<Eigen::Matrix3d> svd(reshape(eig.eigenvectors().col(0)),
+                                                Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Vector3d s = svd.singularValues();
+    s[2] = 0.0;
+    const Eigen::Matrix3d Fn = svd.matrixU() * s.asDiagonal() * svd.matrixV().transpose();
+    return d.T2.transpose() * Fn * d.T1;
+}
+
+// x -> H x 的转移误差平方，a 方向的点投到 b
+inline ChunkArray transferError(const Eigen::Matrix3d& H, const ChunkArray& xa, const ChunkArray& ya,
+                                const ChunkArray& xb, const ChunkArray& yb) {
+    const ChunkArray inv_w = (H(2, 0) * xa + H(2, 1) * ya + H(2, 2)).inverse();
+    const ChunkArray du = (H(0, 0) * xa + H(0, 1) * ya + H(0, 2)) * inv_w - xb;
+    const ChunkArray dv = (H(1, 0) * xa + H(1, 1) * ya + H(1, 2)) * inv_w - yb;
+    return du * du + dv * dv;
+}
+
+// 双向对称转移误差：每个方向在阈值内累加 (χ²_2 - χ²)，两个方向都在阈值内才算内点
+double scoreHomography(const SharedData& d, const Eigen::Matrix3d& H, double inv_sigma2, int* inliers) {
+    const Eigen::Matrix3d H_inv = H.inverse();
+    double score = 0.0;
+    int count = 0;
+    for (int begin = 0; begin < d.paddedSize(); begin += kChunk) {
+        const ChunkMap x1(d.x1.data() + begin), y1(d.y1.data() + begin);
+        const ChunkMap x2(d.x2.data() + begin), y2(d.y2.data() + begin);
+        const ChunkArray e2 = transferError(H, x1, y1, x2, y2) * inv_sigma2;
+        const ChunkArray e1 = transferError(H_inv, x2, y2, x1, y1) * inv_sigma2;
+        score += (e1 < kChi2TwoDof).select(kChi2TwoDof - e1, 0.0).sum() +
+                 (e2 < kChi2TwoDof).select(kChi2TwoDof - e2, 0.0).sum();
+        count += static_cast<int>(((e1 < kChi2TwoDof) && (e2 < kChi2TwoDof)).count());
+    }
+    *inliers = count;
+    return score;
+}
+
+inline ChunkArray sampsonError(const Eigen::Matrix3d& F, const ChunkArray& x1, const ChunkArray& y1,
+                               const ChunkArray& x2, const ChunkArray& y2) {
+    const ChunkArray l0 = F(0, 0) * x1 + F(0, 1) * y1 + F(0, 2);
+    const ChunkArray l1 = F(1, 0) * x1 + F(1, 1) * y1 + F(1, 2);
+    const ChunkArray l2 = F(2, 0) * x1 + F(2, 1) * y1 + F(2, 2);
+    const ChunkArray m0 = F(0, 0) * x2 + F(1, 0) * y2 + F(2, 0);
+    const ChunkArray m1 = F(0, 1) * x2 + F(1, 1) * y2 + F(2, 1);
+    const ChunkArray c = x2 * l0 + y2 * l1 + l2;
+    return c * c / (l0 * l0 + l1 * l1 + m0 * m0 + m1 * m1);
+}
+
+// Sampson 误差是两幅图像上修正量的平方和，两幅图像对称时约为单幅图像上点到对极线距离平方的一半；
+// 乘 2 换算成单幅图像的距离平方后按 1 自由度判定内点，得分按两幅图像各计一次，与单应的双向得分可比
+double scoreFundamental(const SharedData& d, const Eigen::Matrix3d& F, double inv_sigma2, int* inliers) {
+    double score = 0.0;
+    int count = 0;
+    for (int begin = 0; begin < d.paddedSize(); begin += kChunk) {
+        const ChunkMap x1(d.x1.data() + begin), y1(d.y1.data() + begin);
+        const ChunkMap x2(d.x2.data() + begin), y2(d.y2.data() + begin);
+        const ChunkArray e = sampsonError(F, x1, y1, x2, y2) * (2.0 * inv_sigma2);
+        score += 2.0 * (e < kChi2OneDof).select(kChi2TwoDof - e, 0.0).sum();
+        count += static_cast<int>((e < kChi2OneDof).count());
+    }
+    *inliers = count;
+    return score;
+}
+
+struct ModelSearch {
+    Eigen::Matrix3d model = Eigen::Matrix3d::Zero();
+    double score = 0.0;
+    int inliers = 0;
+    int iterations = 0;
+};
+
+// 在共用的最小集上依次拟合、打分，按目前最优模型的内点率提前结束
+template <typename FitFn, typename ScoreFn>
+ModelSearch searchModel(const SharedData& d, const TwoViewModelOptions& options, double inv_sigma2, FitFn fit,
+                        ScoreFn score_fn) {
+    ModelSearch best;
+    int needed = options.max_iterations;
+    for (int it = 0; it < needed; ++it) {
+        const Eigen::Matrix3d model = fit(d, d.samples.data() + it * kSampleSize);
+        ++best.iterations;
+        if (!model.allFinite()) continue;
+        int inliers = 0;
+        const double score = score_fn(d, model, inv_sigma2, &inliers);
+        if (score <= best.score) continue;
+        best.model = model;
+        best.score = score;
+        best.inliers = inliers;
+        needed = ransacIterations(options.confidence, static_cast<double>(inliers) / d.n, kSampleSize,
+                                  options.max_iterations);
+    }
+    return best;
+}
+
+void homographyMask(const TwoViewCorrespondences& p, const Eigen::Matrix3d& H, double th2,
+                    std::vector<char>& mask) {
+    const Eigen::Matrix3d H_inv = H.inverse();
+    const int n = p.size();
+    mask.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        const Eigen::Vector3d a(p.x1[i], p.y1[i], 1.0), b(p.x2[i], p.y2[i], 1.0);
+        const Eigen::Vector2d e2 = (H * a).hnormalized() - b.head<2>();
+        const Eigen::Vector2d e1 = (H_inv * b).hnormalized() - a.head<2>();
+        mask[i] = e1.squaredNorm() < th2 && e2.squaredNorm() < th2;
+    }
+}
+
+void fundamentalMask(const TwoViewCorrespondences& p, const Eigen::Matrix3d& F, double th2,
+                     std::vector<char>& mask) {
+    const int n = p.size();
+    mask.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        const Eigen::Vector3d a(p.x1[i], p.y1[i], 1.0), b(p.x2[i], p.y2[i], 1.0);
+        const Eigen::Vector3d l = F * a;
+        const Eigen::Vector3d m = F.transpose() * b;
+        const double c = b.dot(l);
+        mask[i] = 2.0 * c * c < th2 * (l.head<2>().squaredNorm() + m.head<2>().squaredNorm());
+    }
+}
+
+}  // namespace
+
+TwoViewModelSelector::TwoViewModelSelector(const TwoViewModelOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()) {}
+
+bool TwoViewModelSelector::select(const TwoViewCorrespondences& pixels, TwoViewModelResult& result) {
+    SLAM_PROFILE_SCOPE("frontend/two_view_model");
+    result = TwoViewModelResult();
+    const Clock::time_point start = Clock::now();
+    if (pixels.size() < kSampleSize || options_.max_iterations <= 0) return false;
+
+    // 1. 归一化、补齐和最小集只做一次
+    SharedData data;
+    data.load(pixels, options_.max_iterations, options_.seed);
+    result.timing.normalize_ms = elapsedMs(start);
+
+    // 2. 单应和基础矩阵作为两个任务同时运行（线程池只有一个线程时退化为顺序执行）
+    const double inv_sigma2 = 1.0 / (options_.sigma * options_.sigma);
+    ModelSearch h, f;
+    pool_->parallelFor(2, [&](int task, int) {
+        const Clock::time_point t0 = Clock::now();
+        if (task == 0) {
+            h = searchModel(data, options_, inv_sigma2, fitHomography, scoreHomography);
+            homographyMask(pixels, h.model, kChi2TwoDof * options_.sigma * options_.sigma, result.inliers_h);
+            result.timing.homography_ms = elapsedMs(t0);
+        } else {
+            f = searchModel(data, options_, inv_sigma2, fitFundamental, scoreFundamental);
+            fundamentalMask(pixels, f.model, kChi2OneDof * options_.sigma * options_.sigma, result.inliers_f);
+            result.timing.fundamental_ms = elapsedMs(t0);
+        }
+    });
+
+    // 3. 按得分比例选择模型
+    const Clock::time_point t_select = Clock::now();
+    result.H_21 = h.model;
+    result.F_21 = f.model;
+    result.score_h = h.score;
+    result.score_f = f.score;
+    result.num_inliers_h = h.inliers;
+    result.num_inliers_f = f.inliers;
+    result.iterations_h = h.iterations;
+    result.iterations_f = f.iterations;
+    const double total_score = h.score + f.score;
+    if (total_score > 0.0) {
+        result.ratio_h = h.score / total_score;
+        result.model = (result.ratio_h > options_.homography_ratio) ? TwoViewModel::kHomography
+                                                                    : TwoViewModel::kFundamental;
+    }
+    result.timing.select_ms = elapsedMs(t_select);
+    result.timing.total_ms = elapsedMs(start);
+    return result.model != TwoViewModel::kNone;
+}
+
+}  // namespace slam
@@ -0,0 +1,620 @@
+#include "input/dataset_reader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <tuple>
+
+#include "utils/profiler.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'L', 'A', 'M', 'P', 'A', 'C', 'K'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint64_t kSectionAlign = 64;
+constexpr std::uint32_t kMaxImageSide = 1u << 16;   // pack 里单张图的宽、高上限
+
+// pack 文件头；各段依次为 IMU 表、帧表、像素
+struct PackHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t images_per_frame;
+    std::uint32_t num_frames;
+    std::uint32_t num_imu;
+    std::uint64_t offsets[3];
+};
+
+struct PackImu {
+    std::int64_t t_ns;
+    double gyro[3];
+    double acc[3];
+};
+
+struct PackImage {
+    std::uint64_t offset;       // 相对文件开头，64 字节对齐
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t channels;
+    std::uint32_t bytes_per_channel;
+};
+
+struct PackFrame {
+    std::int64_t t_ns;
+    PackImage images[2];
+};
+
+std::uint64_t alignUp(std::uint64_t x) { return (x + kSectionAlign - 1) / kSectionAlign * kSectionAlign; }
+
+bool fileExists(const std::string& path) { return static_cast<bool>(std::ifstream(path)); }
+
+struct Token {
+    const char* begin;
+    const char* end;
+};
+
+// 逐行切分映射的文本文件，跳过空行和 # 注释；分隔符是逗号和空白（EuRoC 用逗号，TUM 用空格）
+template <typename Fn>
+void forEachRecord(const MappedFile& file, const Fn& fn) {
+    const char* p = reinterpret_cast<const char*>(file.data());
+    const char* end = p + file.size();
+    std::vector<Token> tokens;
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+        tokens.clear();
+        const char* q = p;
+        while (q < line_end) {
+            while (q < line_end && (*q == ',' || *q == ' ' || *q == '\t' || *q == '\r')) ++q;
+            if (q == line_end) break;
+            const char* start = q;
+            while (q < line_end && !(*q == ',' || *q == ' ' || *q == '\t' || *q == '\r')) ++q;
+            tokens.push_back({start, q});
+        }
+        if (!tokens.empty() && *tokens[0].begin != '#') fn(tokens);
+        p = line_end + 1;
+    }
+}
+
+bool parseInt64(const Token& token, std::int64_t& value) {
+    if (token.begin == token.end || token.end - token.begin > 19) return false;
+    std::uint64_t v = 0;
+    for (const char* c = token.begin; c < token.end; ++c) {
+        if (*c < '0' || *c > '9') return false;
+        v = v * 10 + static_cast<std::uint64_t>(*c - '0');
+    }
+    // EuRoC 的纳秒时间戳是 19 位，刚好在 int64 范围内
+    if (v > static_cast<std::uint64_t>(INT64_MAX)) return false;
+    value = static_cast<std::int64_t>(v);
+    return true;
+}
+
+// 十进制秒 → 纳秒，精确换算（小数超过 9 位的部分截断）
+bool parseSecondsNs(const Token& token, std::int64_t& value) {
+    const char* dot = std::find(token.begin, token.end, '.');
+    std::int64_t seconds = 0;
+    if (!parseInt64({token.begin, dot}, seconds)) return false;
+    std::int64_t fraction = 0;
+    int digits = 0;
+    if (dot != token.end) {
+        for (const char* c = dot + 1; c < token.end; ++c) {
+            if (*c < '0' || *c > '9') return false;
+            if (digits < 9) {
+                fraction = fraction * 10 + (*c - '0');
+                ++digits;
+            }
+        }
+    }
+    for (; digits < 9; ++digits) fraction *= 10;
+    value = seconds * 1000000000 + fraction;
+    return true;
+}
+
+// strtod 需要以 0 结尾的字符串，映射的文件不保证，所以先拷到栈上
+bool parseDouble(const Token& token, double& value) {
+    char buffer[64];
+    const std::size_t n = static_cast<std::size_t>(token.end - token.begin);
+    if (n == 0 || n >= sizeof(buffer)) return false;
+    std::memcpy(buffer, token.begin, n);
+    buffer[n] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + n;
+}
+
+struct Stamped {
+    std::int64_t t_ns;
+    std::string path;
+};
+
+// 时间戳 + 文件名的列表（EuRoC 的 data.csv、TUM 的 rgb.txt / depth.txt），按时间排序
+bool readImageList(const std::string& list, const std::string& dir, bool decimal_seconds, std::vector<Stamped>& out) {
+    MappedFile file;
+    if (!file.open(list)) return false;
+    file.adviseSequential();
+    bool ok = true;
+    forEachRecord(file, [&](const std::vector<Token>& tokens) {
+        Stamped s;
+        if (tokens.size() < 2 || !(decimal_seconds ? parseSecondsNs(tokens[0], s.t_ns) : parseInt64(tokens[0], s.t_ns))) {
+            ok = false;
+            return;
+        }
+        s.path = dir + "/" + std::string(tokens[1].begin, tokens[1].end);
+        out.push_back(std::move(s));
+    });
+    std::stable_sort(out.begin(), out.end(), [](const Stamped& a, const Stamped& b) { return a.t_ns < b.t_ns; });
+    return ok;
+}
+
+}  // namespace
+
+DatasetReader::DatasetReader(const DatasetOptions& options, ThreadPool* pool) : options_(options), pool_(pool) {}
+
+DatasetReader::~DatasetReader() { close(); }
+
+bool DatasetReader::open(const std::string& path) {
+    close();
+    bool ok = false;
+    if (fileExists(path + "/mav0/cam0/data.csv")) {
+        ok = openEuRoC(path + "/mav0");
+    } else if (fileExists(path + "/cam0/data.csv")) {
+        ok = openEuRoC(path);
+    } else if (fileExists(path + "/rgb.txt")) {
+        ok = openTum(path);
+    } else {
+        ok = openPack(path);
+    }
+    if (!ok || frame_times_.empty()) {
+        close();
+        return false;
+    }
+    if (format_ != DatasetFormat::kPack) startPrefetch();
+    return true;
+}
+
+void DatasetReader::close() {
+    stopPrefetch();
+    format_ = DatasetFormat::kNone;
+    images_per_frame_ = 0;
+    imu_.clear();
+    frame_times_.clear();
+    image_paths_.clear();
+    pack_images_.clear();
+    pack_file_.close();
+    next_imu_ = 0;
+    next_frame_ = 0;
+}
+
+bool DatasetReader::openEuRoC(const std::string& root) {
+    std::vector<Stamped> cam0, cam1;
+    if (!readImageList(root + "/cam0/data.csv", root + "/cam0/data", false, cam0)) return false;
+    const bool stereo = options_.second_image && readImageList(root + "/cam1/data.csv", root + "/cam1/data", false, cam1);
+
+    images_per_frame_ = stereo ? 2 : 1;
+    if (stereo) {
+        // EuRoC 的双目是硬件同步的，按相同时间戳配对；配不上的帧丢掉
+        std::size_t j = 0;
+        for (const Stamped& left : cam0) {
+            while (j < cam1.size() && cam1[j].t_ns < left.t_ns) ++j;
+            if (j == cam1.size()) break;
+            if (cam1[j].t_ns != left.t_ns) continue;
+            frame_times_.push_back(left.t_ns);
+            image_paths_.push_back(left.path);
+            image_paths_.push_back(cam1[j].path);
+        }
+    } else {
+        for (const Stamped& left : cam0) {
+            frame_times_.push_back(left.t_ns);
+            image_paths_.push_back(left.path);
+        }
+    }
+
+    MappedFile imu;
+    if (imu.open(root + "/imu0/data.csv")) {
+        imu.adviseSequential();
+        bool ok = true;
+        forEachRecord(imu, [&](const std::vector<Token>& tokens) {
+            ImuSample s;
+            double v[6];
+            ok = ok && tokens.size() >= 7 && parseInt64(tokens[0], s.t_ns);
+            for (int k = 0; ok && k < 6; ++k) ok = parseDouble(tokens[k + 1], v[k]);
+            if (!ok) return;
+            s.gyro = Eigen::Vector3d(v[0], v[1], v[2]);
+            s.acc = Eigen::Vector3d(v[3], v[4], v[5]);
+            imu_.push_back(s);
+        });
+        if (!ok) return false;
+    }
+    std::stable_sort(imu_.begin(), imu_.end(), [](const ImuSample& a, const ImuSample& b) { return a.t_ns < b.t_ns; });
+    format_ = DatasetFormat::kEuRoC;
+    return true;
+}
+
+bool DatasetReader::openTum(const std::string& root) {
+    std::vector<Stamped> rgb, depth;
+    if (!readImageList(root + "/rgb.txt", root, true, rgb)) return false;
+    const bool rgbd = options_.second_image && readImageList(root + "/depth.txt", root, true, depth);
+
+    images_per_frame_ = rgbd ? 2 : 1;
+    if (rgbd) {
+        // 和 TUM 的 associate.py 一样：时间差不超过 max_dt 的所有 (rgb, depth) 对按时间差从小到大贪心一对一匹配
+        const std::int64_t max_dt = static_cast<std::int64_t>(options_.tum_max_dt * 1e9);
+        std::vector<std::tuple<std::int64_t, int, int>> pairs;
+        std::size_t lo = 0;
+        for (std::size_t i = 0; i < rgb.size(); ++i) {
+            while (lo < depth.size() && depth[lo].t_ns < rgb[i].t_ns - max_dt) ++lo;
+            for (std::size_t j = lo; j < depth.size() && depth[j].t_ns <= rgb[i].t_ns + max_dt; ++j) {
+                pairs.emplace_back(std::abs(depth[j].t_ns - rgb[i].t_ns), static_cast<int>(i), static_cast<int>(j));
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+        std::vector<int> match(rgb.size(), -1);
+        std::vector<char> depth_used(depth.size(), 0);
+        for (const auto& pair : pairs) {
+            const int i = std::get<1>(pair), j = std::get<2>(pair);
+            if (match[i] >= 0 || depth_used[j]) continue;
+            match[i] = j;
+            depth_used[j] = 1;
+        }
+        for (std::size_t i = 0; i < rgb.size(); ++i) {
+            if (match[i] < 0) continue;
+            frame_times_.push_back(rgb[i].t_ns);
+            image_paths_.push_back(rgb[i].path);
+            image_paths_.push_back(depth[match[i]].path);
+        }
+    } else {
+        for (const Stamped& s : rgb) {
+            frame_times_.push_back(s.t_ns);
+            image_paths_.push_back(s.path);
+        }
+    }
+
+    // TUM RGB-D 只有 Kinect 的加速度计（没有陀螺仪），gyro 置零
+    MappedFile acc;
+    if (acc.open(root + "/accelerometer.txt")) {
+        acc.adviseSequential();
+        bool ok = true;
+        forEachRecord(acc, [&](const std::vector<Token>& tokens) {
+            ImuSample s;
+            double v[3];
+            ok = ok && tokens.size() >= 4 && parseSecondsNs(tokens[0], s.t_ns);
+            for (int k = 0; ok && k < 3; ++k) ok = parseDouble(tokens[k + 1], v[k]);
+            if (!ok) return;
+            s.acc = Eigen::Vector3d(v[0], v[1], v[2]);
+            imu_.push_back(s);
+        });
+        if (!ok) return false;
+    }
+    std::stable_sort(imu_.begin(), imu_.end(), [](const ImuSample& a, const ImuSample& b) { return a.t_ns < b.t_ns; });
+    format_ = DatasetFormat::kTumRgbd;
+    return true;
+}
+
+bool DatasetReader::openPack(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(PackHeader)) return false;
+    PackHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) return false;
+    if (header.images_per_frame < 1 || header.images_per_frame > 2) return false;
+    const std::uint64_t sizes[2] = {sizeof(PackImu) * std::uint64_t(header.num_imu),
+                                    sizeof(PackFrame) * std::uint64_t(header.num_frames)};
+    // 用减法比较：文件里的偏移不可信，offset + size 可能回绕
+    const std::uint64_t file_size = file.size();
+    for (int s = 0; s < 2; ++s) {
+        if (header.offsets[s] % kSectionAlign != 0 || header.offsets[s] > file_size ||
+            sizes[s] > file_size - header.offsets[s]) {
+            return false;
+        }
+    }
+
+    const std::uint8_t* base = file.data();
+    imu_.resize(header.num_imu);
+    for (std::uint32_t k = 0; k < header.num_imu; ++k) {
+        PackImu record;
+        std::memcpy(&record, base + header.offsets[0] + k * sizeof(PackImu), sizeof(record));
+        imu_[k].t_ns = record.t_ns;
+        imu_[k].gyro = Eigen::Vector3d(record.gyro[0], record.gyro[1], record.gyro[2]);
+        imu_[k].acc = Eigen::Vector3d(record.acc[0], record.acc[1], record.acc[2]);
+    }
+
+    // 帧表很小，读进来并检查每张图的边界；像素留在映射里
+    images_per_frame_ = static_cast<int>(header.images_per_frame);
+    frame_times_.resize(header.num_frames);
+    pack_images_.resize(std::size_t(header.num_frames) * images_per_frame_);
+    for (std::uint32_t i = 0; i < header.num_frames; ++i) {
+        PackFrame record;
+        std::memcpy(&record, base + header.offsets[1] + i * sizeof(PackFrame), sizeof(record));
+        frame_times_[i] = record.t_ns;
+        for (int k = 0; k < images_per_frame_; ++k) {
+            const PackImage& image = record.images[k];
+            // 各维先单独限幅，乘积不会溢出（最多 2^16 * 2^16 * 4 * 8）
+            if (image.width > kMaxImageSide || image.height > kMaxImageSide || image.channels > 4 ||
+                image.bytes_per_channel > 8) {
+                return false;
+            }
+            const std::uint64_t bytes =
+                std::uint64_t(image.width) * image.height * image.channels * image.bytes_per_channel;
+            if (image.offset % kSectionAlign != 0 || image.offset > file_size || bytes > file_size - image.offset) {
+                return false;
+            }
+            ImageView& view = pack_images_[std::size_t(i) * images_per_frame_ + k];
+            view.width = static_cast<int>(image.width);
+            view.height = static_cast<int>(image.height);
+            view.channels = static_cast<int>(image.channels);
+            view.bytes_per_channel = static_cast<int>(image.bytes_per_channel);
+            view.data = base + image.offset;
+        }
+    }
+    // 回放基本是顺序读，加大预读
+    file.adviseSequential();
+    pack_file_ = std::move(file);
+    format_ = DatasetFormat::kPack;
+    return true;
+}
+
+bool DatasetReader::next(DatasetEvent& event) {
+    const bool has_imu = next_imu_ < static_cast<int>(imu_.size());
+    const bool has_frame = next_frame_ < numFrames();
+    if (!has_imu && !has_frame) return false;
+    // 时间相同时先给 IMU
+    if (has_imu && (!has_frame || imu_[next_imu_].t_ns <= frame_times_[next_frame_])) {
+        event.type = DatasetEvent::kImu;
+        event.t_ns = imu_[next_imu_].t_ns;
+        event.index = next_imu_++;
+    } else {
+        event.type = DatasetEvent::kImage;
+        event.t_ns = frame_times_[next_frame_];
+        event.index = next_frame_++;
+    }
+    return true;
+}
+
+void DatasetReader::reset() {
+    next_imu_ = 0;
+    next_frame_ = 0;
+}
+
+bool DatasetReader::decodeFrame(int i, std::vector<Image>& images) const {
+    SLAM_PROFILE_SCOPE("input/decode_frame");
+    images.resize(images_per_frame_);
+    for (int k = 0; k < images_per_frame_; ++k) {
+        MappedFile file;
+        if (!file.open(image_paths_[std::size_t(i) * images_per_frame_ + k])) return false;
+        file.adviseSequential();
+        if (!decodeImage(file.data(), file.size(), images[k])) return false;
+    }
+    return true;
+}
+
+bool DatasetReader::frame(int i, DatasetFrame& out) {
+    if (i < 0 || i >= numFrames()) return false;
+    out.t_ns = frame_times_[i];
+    out.index = i;
+    out.num_images = images_per_frame_;
+    out.storage.reset();
+
+    if (format_ == DatasetFormat::kPack) {
+        for (int k = 0; k < images_per_frame_; ++k) out.images[k] = pack_images_[std::size_t(i) * images_per_frame_ + k];
+        // 提示内核提前读入后面 prefetch 帧的像素
+        const int last = std::min(numFrames() - 1, i + options_.prefetch);
+        if (last > i) {
+            const ImageView& first = pack_images_[std::size_t(i + 1) * images_per_frame_];
+            const ImageView& end = pack_images_[std::size_t(last) * images_per_frame_ + images_per_frame_ - 1];
+            const std::size_t begin = static_cast<std::size_t>(first.data - pack_file_.data());
+            const std::size_t finish = static_cast<std::size_t>(end.data - pack_file_.data()) +
+                                       std::size_t(end.stride()) * end.height;
+            pack_file_.willNeed(begin, finish - begin);
+        }
+        return true;
+    }
+
+    std::shared_ptr<const std::vector<Image>> images;
+    if (slots_.empty()) {
+        auto decoded = std::make_shared<std::vector<Image>>();
+        if (!decodeFrame(i, *decoded)) return false;
+        images = decoded;
+    } else {
+        const int window = static_cast<int>(slots_.size());
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (window_begin_ != i) {
+            window_begin_ = i;
+            wake_.notify_one();
+        }
+        Slot& slot = slots_[i % window];
+        if (slot.index != i) {
+            // 还没排进预取：占住这个槽（预取线程就不会再解它），在调用线程上解码
+            SLAM_PROFILE_COUNT("input/prefetch_miss", 1);
+            slot.index = i;
+            slot.ready = false;
+            slot.images.reset();
+            lock.unlock();
+            auto decoded = std::make_shared<std::vector<Image>>();
+            const bool ok = decodeFrame(i, *decoded);
+            lock.lock();
+            if (slot.index == i) {
+                slot.ready = true;
+                slot.ok = ok;
+                slot.images = decoded;
+            }
+            if (!ok) return false;
+            images = decoded;
+        } else {
+            ready_.wait(lock, [&] { return slot.index != i || slot.ready; });
+            if (slot.index != i || !slot.ok) return false;
+            images = slot.images;
+        }
+    }
+
+    for (int k = 0; k < images_per_frame_; ++k) {
+        const Image& image = (*images)[k];
+        ImageView& view = out.images[k];
+        view.width = image.width;
+        view.height = image.height;
+        view.channels = image.channels;
+        view.bytes_per_channel = image.bytes_per_channel;
+        view.data = image.data.data();
+    }
+    out.storage = std::move(images);
+    return true;
+}
+
+void DatasetReader::startPrefetch() {
+    if (options_.prefetch <= 0) return;
+    if (!pool_) {
+        if (!owned_pool_) owned_pool_.reset(new ThreadPool(options_.decode_threads));
+        pool_ = owned_pool_.get();
+    }
+    slots_.assign(options_.prefetch, Slot());
+    window_begin_ = 0;
+    stop_ = false;
+    prefetch_thread_ = std::thread([this] { prefetchLoop(); });
+}
+
+void DatasetReader::stopPrefetch() {
+    if (prefetch_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        prefetch_thread_.join();
+    }
+    slots_.clear();
+    if (owned_pool_ && pool_ == owned_pool_.get()) pool_ = nullptr;
+}
+
+void DatasetReader::prefetchLoop() {
+    const int window = static_cast<int>(slots_.size());
+    // 每批交给线程池的帧数：每个线程两帧，摊薄一次 parallelFor 的唤醒开销
+    const int max_batch = 2 * pool_->size();
+    std::vector<int> batch;
+    std::vector<std::shared_ptr<std::vector<Image>>> decoded;
+    std::vector<char> ok;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        // 窗口里按帧号从小到大找还没排上的帧
+        batch.clear();
+        const int end = std::min(numFrames(), window_begin_ + window);
+        for (int i = window_begin_; i < end && static_cast<int>(batch.size()) < max_batch; ++i) {
+            Slot& slot = slots_[i % window];
+            if (slot.index == i) continue;
+            slot.index = i;
+            slot.ready = false;
+            slot.images.reset();
+            batch.push_back(i);
+        }
+        if (batch.empty()) {
+            if (stop_) return;
+            wake_.wait(lock);
+            if (stop_) return;
+            continue;
+        }
+        lock.unlock();
+
+        const int n = static_cast<int>(batch.size());
+        decoded.assign(n, nullptr);
+        ok.assign(n, 0);
+        pool_->parallelFor(n, [&](int task, int) {
+            decoded[task] = std::make_shared<std::vector<Image>>();
+            ok[task] = decodeFrame(batch[task], *decoded[task]);
+        });
+
+        lock.lock();
+        for (int t = 0; t < n; ++t) {
+            // 窗口在解码期间移走了的话，这个槽已经分给了别的帧，结果丢掉
+            Slot& slot = slots_[batch[t] % window];
+            if (slot.index != batch[t]) continue;
+            slot.ready = true;
+            slot.ok = ok[t] != 0;
+            slot.images = std::move(decoded[t]);
+        }
+        ready_.notify_all();
+        if (stop_) return;
+    }
+}
+
+bool DatasetReader::writePack(DatasetReader& reader, const std::string& path) {
+    if (reader.format() == DatasetFormat::kNone) return false;
+    PackHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.images_per_frame = static_cast<std::uint32_t>(reader.imagesPerFrame());
+    header.num_frames = static_cast<std::uint32_t>(reader.numFrames());
+    header.num_imu = static_cast<std::uint32_t>(reader.imu().size());
+    header.offsets[0] = alignUp(sizeof(PackHeader));
+    header.offsets[1] = alignUp(header.offsets[0] + sizeof(PackImu) * std::uint64_t(header.num_imu));
+    header.offsets[2] = alignUp(header.offsets[1] + sizeof(PackFrame) * std::uint64_t(header.num_frames));
+
+    std::vector<PackImu> imu(header.num_imu);
+    for (std::uint32_t k = 0; k < header.num_imu; ++k) {
+        const ImuSample& s = reader.imu()[k];
+        std::memset(&imu[k], 0, sizeof(PackImu));
+        imu[k].t_ns = s.t_ns;
+        for (int a = 0; a < 3; ++a) {
+            imu[k].gyro[a] = s.gyro[a];
+            imu[k].acc[a] = s.acc[a];
+        }
+    }
+
+    // 先写临时文件，成功后再改名：失败时不会留下一个截断的 pack 文件
+    const std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out) return false;
+    const auto fail = [&] {
+        out.close();
+        std::remove(tmp_path.c_str());
+        return false;
+    };
+    const char zeros[kSectionAlign] = {};
+    // 先写头和 IMU 表，帧表等像素写完（知道偏移）再回填
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(zeros, static_cast<std::streamsize>(header.offsets[0] - sizeof(header)));
+    out.write(reinterpret_cast<const char*>(imu.data()), static_cast<std::streamsize>(sizeof(PackImu) * imu.size()));
+    std::uint64_t written = header.offsets[0] + sizeof(PackImu) * imu.size();
+    out.write(zeros, static_cast<std::streamsize>(header.offsets[1] - written));
+    std::vector<PackFrame> frames(header.num_frames);
+    std::memset(frames.data(), 0, sizeof(PackFrame) * frames.size());
+    out.write(reinterpret_cast<const char*>(frames.data()), static_cast<std::streamsize>(sizeof(PackFrame) * frames.size()));
+    written = header.offsets[1] + sizeof(PackFrame) * frames.size();
+
+    DatasetFrame frame;
+    for (int i = 0; i < reader.numFrames(); ++i) {
+        if (!reader.frame(i, frame)) return fail();
+        frames[i].t_ns = frame.t_ns;
+        for (int k = 0; k < frame.num_images; ++k) {
+            const ImageView& view = frame.images[k];
+            if (view.width > static_cast<int>(kMaxImageSide) || view.height > static_cast<int>(kMaxImageSide)) {
+                return fail();
+            }
+            const std::uint64_t bytes = std::uint64_t(view.stride()) * view.height;
+            const std::uint64_t offset = alignUp(written);
+            out.write(zeros, static_cast<std::streamsize>(offset - written));
+            out.write(reinterpret_cast<const char*>(view.data), static_cast<std::streamsize>(bytes));
+            written = offset + bytes;
+            PackImage& image = frames[i].images[k];
+            image.offset = offset;
+            image.width = static_cast<std::uint32_t>(view.width);
+            image.height = static_cast<std::uint32_t>(view.height);
+            image.channels = static_cast<std::uint32_t>(view.channels);
+            image.bytes_per_channel = static_cast<std::uint32_t>(view.bytes_per_channel);
+        }
+    }
+    out.seekp(static_cast<std::streamoff>(header.offsets[1]));
+    out.write(reinterpret_cast<const char*>(frames.data()), static_cast<std::streamsize>(sizeof(PackFrame) * frames.size()));
+    out.close();
+    if (!out) return fail();
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace slam
@@ -0,0 +1,406 @@
+#include "input/image_decoder.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace slam {
+
+namespace {
+
+// ---------------------------------------------------------------- inflate
+
+constexpr int kFastBits = 10;
+
+class BitReader {
+public:
+    BitReader(const std::uint8_t* data, std::size_t size) : p_(data), end_(data + size) {}
+
+    // 保证缓冲区里至少有 57 位；读过末尾时补 0，并记下补了多少字节
+    void refill() {
+        while (bits_ <= 56) {
+            std::uint64_t byte = 0;
+            if (p_ < end_) {
+                byte = *p_++;
+            } else {
+                ++overrun_;
+            }
+            buffer_ |= byte << bits_;
+            bits_ += 8;
+        }
+    }
+    std::uint32_t peek(int n) const { return static_cast<std::uint32_t>(buffer_ & ((std::uint64_t(1) << n) - 1)); }
+    void consume(int n) {
+        buffer_ >>= n;
+        bits_ -= n;
+    }
+    std::uint32_t get(int n) {
+        if (n == 0) return 0;
+        if (bits_ < n) refill();
+        const std::uint32_t v = peek(n);
+        consume(n);
+        return v;
+    }
+    void alignToByte() { consume(bits_ & 7); }
+    // 真正读过了数据末尾（补的 0 被用掉了）
+    bool overrun() const { return overrun_ * 8 > bits_; }
+
+private:
+    const std::uint8_t* p_;
+    const std::uint8_t* end_;
+    std::uint64_t buffer_ = 0;
+    int bits_ = 0;
+    int overrun_ = 0;
+};
+
+// 规范 Huffman 码：fast 表按低位在前的码（deflate 的位序）直接索引，项为 (长度 << 9) | 符号
+struct Huffman {
+    std::uint16_t count[16];
+    std::uint16_t symbol[288];
+    std::uint16_t fast[1 << kFastBits];
+
+    bool build(const std::uint8_t* lengths, int n) {
+        std::memset(count, 0, sizeof(count));
+        std::memset(fast, 0, sizeof(fast));
+        for (int i = 0; i < n; ++i) ++count[lengths[i]];
+        count[0] = 0;
+        int left = 1;
+        for (int len = 1; len < 16; ++len) {
+            left = (left << 1) - count[len];
+            if (left < 0) return false;     // 超额分配
+        }
+        std::uint16_t offsets[16];
+        offsets[1] = 0;
+        for (int len = 1; len < 15; ++len) offsets[len + 1] = offsets[len] + count[len];
+        for (int i = 0; i < n; ++i) {
+            if (lengths[i]) symbol[offsets[lengths[i]]++] = static_cast<std::uint16_t>(i);
+        }
+        // 短码填快表：规范码按 (长度, 符号) 顺序递增
+        int code = 0, index = 0;
+        for (int len = 1; len <= kFastBits; ++len) {
+            for (int k = 0; k < count[len]; ++k, ++code, ++index) {
+                int reversed = 0;
+                for (int b = 0; b < len; ++b) reversed |= ((code >> b) & 1) << (len - 1 - b);
+                const std::uint16_t entry = static_cast<std::uint16_t>((len << 9) | symbol[index]);
+                for (int fill = reversed; fill < (1 << kFastBits); fill += 1 << len) fast[fill] = entry;
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    // 返回符号，码无效时返回 -1
+    int decode(BitReader& in) const {
+        in.refill();
+        const std::uint16_t entry = fast[in.peek(kFastBits)];
+        if (entry) {
+            in.consume(entry >> 9);
+            return entry & 511;
+        }
+        // 长码：逐位按规范码解（puff 的做法）
+        const std::uint32_t bits = in.peek(15);
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len < 16; ++len) {
+            code |= (bits >> (len - 1)) & 1;
+            const int c = count[len];
+            if (code - first < c) {
+                in.consume(len);
+                return symbol[index + (code - first)];
+            }
+            index += c;
+            first = (first + c) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+};
+
+const std::uint16_t kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                       31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const std::uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const std::uint16_t kDistBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                     193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const std::uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const std::uint8_t kCodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+bool inflateCodes(BitReader& in, const Huffman& lit, const Huffman& dist, std::uint8_t* out, std::size_t capacity,
+                  std::size_t& pos) {
+    for (;;) {
+        int sym = lit.decode(in);
+        if (sym < 0) return false;
+        if (sym < 256) {
+            if (pos >= capacity) return false;
+            out[pos++] = static_cast<std::uint8_t>(sym);
+            continue;
+        }
+        if (sym == 256) return true;
+        sym -= 257;
+        if (sym >= 29) return false;
+        const std::size_t length = kLengthBase[sym] + in.get(kLengthExtra[sym]);
+        const int dsym = dist.decode(in);
+        if (dsym < 0 || dsym >= 30) return false;
+        const std::size_t distance = kDistBase[dsym] + in.get(kDistExtra[dsym]);
+        if (distance > pos || length > capacity - pos) return false;
+        std::uint8_t* dst = out + pos;
+        const std::uint8_t* src = dst - distance;
+        // 重叠拷贝（distance < length 时是重复模式），只能逐字节
+        for (std::size_t k = 0; k < length; ++k) dst[k] = src[k];
+        pos += length;
+    }
+}
+
+// zlib 流解压到 out[0, capacity)，返回解出的字节数，失败返回 -1
+long inflateZlib(const std::uint8_t* data, std::size_t size, std::uint8_t* out, std::size_t capacity) {
+    if (size < 2 || (data[0] & 0x0f) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) return -1;
+    BitReader in(data + 2, size - 2);
+    Huffman lit, dist;
+    std::size_t pos = 0;
+    bool last = false;
+    while (!last) {
+        last = in.get(1);
+        const int type = static_cast<int>(in.get(2));
+        if (type == 0) {
+            in.alignToByte();
+            const std::uint32_t len = in.get(16);
+            const std::uint32_t nlen = in.get(16);
+            if ((len ^ 0xffff) != nlen || len > capacity - pos) return -1;
+            for (std::uint32_t k = 0; k < len; ++k) out[pos++] = static_cast<std::uint8_t>(in.get(8));
+        } else if (type == 1) {
+            std::uint8_t lengths[288 + 30];
+            std::memset(lengths, 8, 144);
+            std::memset(lengths + 144, 9, 112);
+            std::memset(lengths + 256, 7, 24);
+            std::memset(lengths + 280, 8, 8);
+            std::memset(lengths + 288, 5, 30);
+            if (!lit.build(lengths, 288) || !dist.build(lengths + 288, 30)) return -1;
+            if (!inflateCodes(in, lit, dist, out, capacity, pos)) return -1;
+        } else if (type == 2) {
+            const int hlit = static_cast<int>(in.get(5)) + 257;
+            const int hdist = static_cast<int>(in.get(5)) + 1;
+            const int hclen = static_cast<int>(in.get(4)) + 4;
+            if (hlit > 286 || hdist > 30) return -1;
+            std::uint8_t cl_lengths[19] = {};
+            for (int k = 0; k < hclen; ++k) cl_lengths[kCodeLengthOrder[k]] = static_cast<std::uint8_t>(in.get(3));
+            Huffman cl;
+            if (!cl.build(cl_lengths, 19)) return -1;
+            std::uint8_t lengths[286 + 30] = {};
+            for (int k = 0; k < hlit + hdist;) {
+                const int sym = cl.decode(in);
+                if (sym < 0) return -1;
+                if (sym < 16) {
+                    lengths[k++] = static_cast<std::uint8_t>(sym);
+                    continue;
+                }
+                int repeat = 0;
+                std::uint8_t value = 0;
+                if (sym == 16) {
+                    if (k == 0) return -1;
+                    value = lengths[k - 1];
+                    repeat = 3 + static_cast<int>(in.get(2));
+                } else if (sym == 17) {
+                    repeat = 3 + static_cast<int>(in.get(3));
+                } else {
+                    repeat = 11 + static_cast<int>(in.get(7));
+                }
+                if (k + repeat > hlit + hdist) return -1;
+                while (repeat--) lengths[k++] = value;
+            }
+            if (lengths[256] == 0) return -1;
+            if (!lit.build(lengths, hlit) || !dist.build(lengths + hlit, hdist)) return -1;
+            if (!inflateCodes(in, lit, dist, out, capacity, pos)) return -1;
+        } else {
+            return -1;
+        }
+        if (in.overrun()) return -1;
+    }
+    return static_cast<long>(pos);
+}
+
+// ---------------------------------------------------------------- PNG
+
+inline std::uint32_t readBe32(const std::uint8_t* p) {
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+}
+
+inline int paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+// 反滤波：raw 每行前有一个滤波类型字节，结果写到 out（无填充）
+bool unfilter(const std::uint8_t* raw, std::uint8_t* out, int height, std::size_t row_bytes, int bpp) {
+    const std::uint8_t* prev = nullptr;
+    for (int y = 0; y < height; ++y) {
+        const int filter = *raw++;
+        std::uint8_t* cur = out + y * row_bytes;
+        switch (filter) {
+        case 0:
+            std::memcpy(cur, raw, row_bytes);
+            break;
+        case 1:
+            for (std::size_t x = 0; x < row_bytes; ++x)
+                cur[x] = static_cast<std::uint8_t>(raw[x] + (x >= static_cast<std::size_t>(bpp) ? cur[x - bpp] : 0));
+            break;
+        case 2:
+            for (std::size_t x = 0; x < row_bytes; ++x) cur[x] = static_cast<std::uint8_t>(raw[x] + (prev ? prev[x] : 0));
+            break;
+        case 3:
+            for (std::size_t x = 0; x < row_bytes; ++x) {
+                const int a = x >= static_cast<std::size_t>(bpp) ? cur[x - bpp] : 0;
+                const int b = prev ? prev[x] : 0;
+                cur[x] = static_cast<std::uint8_t>(raw[x] + ((a + b) >> 1));
+            }
+            break;
+        case 4:
+            for (std::size_t x = 0; x < row_bytes; ++x) {
+                const int a = x >= static_cast<std::size_t>(bpp) ? cur[x - bpp] : 0;
+                const int b = prev ? prev[x] : 0;
+                const int c = prev && x >= static_cast<std::size_t>(bpp) ? prev[x - bpp] : 0;
+                cur[x] = static_cast<std::uint8_t>(raw[x] + paeth(a, b, c));
+            }
+            break;
+        default:
+            return false;
+        }
+        raw += row_bytes;
+        prev = cur;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool decodePng(const std::uint8_t* data, std::size_t size, Image& image) {
+    static const std::uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    if (size < 8 + 25 || std::memcmp(data, kSignature, 8) != 0) return false;
+
+    std::uint32_t width = 0, height = 0;
+    int depth = 0, color = -1;
+    const std::uint8_t* palette = nullptr;
+    int palette_size = 0;
+    // IDAT 只有一块时直接用映射的内存，多块时拼起来
+    const std::uint8_t* idat = nullptr;
+    std::size_t idat_size = 0;
+    std::vector<std::uint8_t> idat_joined;
+    int idat_chunks = 0;
+
+    std::size_t pos = 8;
+    while (pos + 12 <= size) {
+        const std::uint32_t length = readBe32(data + pos);
+        const std::uint8_t* type = data + pos + 4;
+        const std::uint8_t* body = data + pos + 8;
+        if (length > size - pos - 12) return false;
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13) return false;
+            width = readBe32(body);
+            height = readBe32(body + 4);
+            depth = body[8];
+            color = body[9];
+            if (body[10] != 0 || body[11] != 0 || body[12] != 0) return false;    // 只支持非隔行
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            palette = body;
+            palette_size = static_cast<int>(length / 3);
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            if (++idat_chunks == 1) {
+                idat = body;
+                idat_size = length;
+            } else {
+                if (idat_chunks == 2) idat_joined.assign(idat, idat + idat_size);
+                idat_joined.insert(idat_joined.end(), body, body + length);
+            }
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + length;
+    }
+    if (idat_chunks > 1) {
+        idat = idat_joined.data();
+        idat_size = idat_joined.size();
+    }
+    if (!idat || width == 0 || height == 0 || width > (1u << 16) || height > (1u << 16)) return false;
+
+    int channels = 0;
+    switch (color) {
+    case 0: channels = 1; break;
+    case 2: channels = 3; break;
+    case 3: channels = 1; break;
+    case 4: channels = 2; break;
+    case 6: channels = 4; break;
+    default: return false;
+    }
+    if (!(depth == 8 || (depth == 16 && color != 3))) return false;
+    if (color == 3 && !palette) return false;
+    const int bytes_per_channel = depth / 8;
+    const int bpp = channels * bytes_per_channel;
+    const std::size_t row_bytes = static_cast<std::size_t>(width) * bpp;
+    const std::size_t raw_size = (row_bytes + 1) * height;
+
+    std::vector<std::uint8_t> raw(raw_size);
+    if (inflateZlib(idat, idat_size, raw.data(), raw_size) != static_cast<long>(raw_size)) return false;
+
+    image.width = static_cast<int>(width);
+    image.height = static_cast<int>(height);
+    image.bytes_per_channel = bytes_per_channel;
+    image.channels = color == 3 ? 3 : channels;
+    image.data.resize(row_bytes * height);
+    if (!unfilter(raw.data(), image.data.data(), image.height, row_bytes, bpp)) return false;
+
+    if (depth == 16) {
+        // PNG 是大端
+        std::uint8_t* p = image.data.data();
+        for (std::size_t k = 0; k + 1 < image.data.size(); k += 2) std::swap(p[k], p[k + 1]);
+    } else if (color == 3) {
+        std::vector<std::uint8_t> rgb(static_cast<std::size_t>(width) * height * 3);
+        for (std::size_t k = 0; k < image.data.size(); ++k) {
+            const int index = image.data[k];
+            if (index >= palette_size) return false;
+            std::memcpy(&rgb[3 * k], palette + 3 * index, 3);
+        }
+        image.data.swap(rgb);
+    }
+    return true;
+}
+
+bool decodePnm(const std::uint8_t* data, std::size_t size, Image& image) {
+    if (size < 3 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) return false;
+    const int channels = data[1] == '5' ? 1 : 3;
+    // 头部：宽、高、最大值三个十进制数，中间是空白或 # 注释
+    std::size_t pos = 2;
+    long values[3];
+    for (long& v : values) {
+        for (;;) {
+            while (pos < size && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r' || data[pos] == '\n')) ++pos;
+            if (pos < size && data[pos] == '#') {
+                while (pos < size && data[pos] != '\n') ++pos;
+                continue;
+            }
+            break;
+        }
+        if (pos >= size || data[pos] < '0' || data[pos] > '9') return false;
+        v = 0;
+        while (pos < size && data[pos] >= '0' && data[pos] <= '9' && v < (1L << 20)) v = v * 10 + (data[pos++] - '0');
+    }
+    ++pos;  // 最大值后面的单个空白
+    if (values[0] <= 0 || values[1] <= 0 || values[2] <= 0 || values[2] > 65535) return false;
+    const int bytes_per_channel = values[2] > 255 ? 2 : 1;
+    const std::size_t n = static_cast<std::size_t>(values[0]) * values[1] * channels * bytes_per_channel;
+    if (pos > size || size - pos < n) return false;
+    image.width = static_cast<int>(values[0]);
+    image.height = static_cast<int>(values[1]);
+    image.channels = channels;
+    image.bytes_per_channel = bytes_per_channel;
+    image.data.assign(data + pos, data + pos + n);
+    if (bytes_per_channel == 2) {
+        for (std::size_t k = 0; k + 1 < n; k += 2) std::swap(image.data[k], image.data[k + 1]);
+    }
+    return true;
+}
+
+bool decodeImage(const std::uint8_t* data, std::size_t size, Image& image) {
+    if (size >= 8 && data[0] == 0x89 && data[1] == 'P') return decodePng(data, size, image);
+    if (size >= 2 && data[0] == 'P') return decodePnm(data, size, image);
+    return false;
+}
+
+}  // namespace slam
@@ -0,0 +1,225 @@
+#include "input/imu_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace slam {
+
+namespace {
+
+// 样本和 64 位字之间的换算：t_ns、gyro、acc 依次占一个字
+inline std::uint64_t toWord(double v) {
+    std::uint64_t w;
+    std::memcpy(&w, &v, sizeof(w));
+    return w;
+}
+
+inline double fromWord(std::uint64_t w) {
+    double v;
+    std::memcpy(&v, &w, sizeof(v));
+    return v;
+}
+
+inline void lerp(const ImuSample& a, const ImuSample& b, std::int64_t t, ImuSample& out) {
+    const double w = static_cast<double>(t - a.t_ns) / static_cast<double>(b.t_ns - a.t_ns);
+    out.t_ns = t;
+    out.gyro = a.gyro + w * (b.gyro - a.gyro);
+    out.acc = a.acc + w * (b.acc - a.acc);
+}
+
+}  // namespace
+
+ImuBuffer::ImuBuffer(int capacity) {
+    std::uint64_t n = 4;
+    while (n < static_cast<std::uint64_t>(std::max(capacity, 1))) n <<= 1;
+    slots_.reset(new Slot[n]);
+    for (std::uint64_t i = 0; i < n; ++i) {
+        for (std::atomic<std::uint64_t>& word : slots_[i].words) word.store(0, std::memory_order_relaxed);
+    }
+    mask_ = n - 1;
+}
+
+ImuSample ImuBuffer::at(std::uint64_t seq) const {
+    const Slot& slot = slots_[seq & mask_];
+    std::uint64_t words[kSampleWords];
+    for (int i = 0; i < kSampleWords; ++i) words[i] = slot.words[i].load(std::memory_order_relaxed);
+    ImuSample sample;
+    sample.t_ns = static_cast<std::int64_t>(words[0]);
+    for (int a = 0; a < 3; ++a) {
+        sample.gyro[a] = fromWord(words[1 + a]);
+        sample.acc[a] = fromWord(words[4 + a]);
+    }
+    return sample;
+}
+
+std::int64_t ImuBuffer::timeAt(std::uint64_t seq) const {
+    return static_cast<std::int64_t>(slots_[seq & mask_].words[0].load(std::memory_order_relaxed));
+}
+
+bool ImuBuffer::push(const ImuSample& sample) {
+    const std::uint64_t h = head_.load(std::memory_order_relaxed);
+    if (h > 0 && sample.t_ns <= last_t_) return false;
+    // seqlock 的写端：先登记（读者据此知道序号 h - capacity 的槽正在被覆盖），再写数据，再发布
+    reserved_.store(h + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::uint64_t words[kSampleWords];
+    words[0] = static_cast<std::uint64_t>(sample.t_ns);
+    for (int a = 0; a < 3; ++a) {
+        words[1 + a] = toWord(sample.gyro[a]);
+        words[4 + a] = toWord(sample.acc[a]);
+    }
+    Slot& slot = slots_[h & mask_];
+    for (int i = 0; i < kSampleWords; ++i) slot.words[i].store(words[i], std::memory_order_relaxed);
+    head_.store(h + 1, std::memory_order_release);
+    last_t_ = sample.t_ns;
+    return true;
+}
+
+void ImuBuffer::readable(std::uint64_t& begin, std::uint64_t& end) const {
+    end = head_.load(std::memory_order_acquire);
+    const std::uint64_t reserved = reserved_.load(std::memory_order_relaxed);
+    const std::uint64_t cap = mask_ + 1;
+    begin = reserved > cap ? reserved - cap : 0;
+    begin = std::min(begin, end);
+}
+
+bool ImuBuffer::intact(std::uint64_t seq) const {
+    // seqlock 的读端：先读数据，再确认写者还没登记覆盖 seq
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq + mask_ + 1 >= reserved_.load(std::memory_order_relaxed);
+}
+
+bool ImuBuffer::valid(const ImuSpan& span) const { return span.empty() || intact(span.begin_seq); }
+
+bool ImuBuffer::timeRange(std::int64_t& oldest, std::int64_t& latest) const {
+    for (;;) {
+        std::uint64_t begin, end;
+        readable(begin, end);
+        if (begin == end) return false;
+        oldest = timeAt(begin);
+        latest = timeAt(end - 1);
+        if (intact(begin)) return true;
+    }
+}
+
+std::uint64_t ImuBuffer::lowerBound(std::int64_t t, std::uint64_t begin, std::uint64_t end, std::uint64_t hint) const {
+    hint = std::min(std::max(hint, begin), end);
+    std::uint64_t lo, hi;
+    if (hint < end && timeAt(hint) < t) {
+        // 向新的方向倍增
+        lo = hint + 1;
+        hi = end;
+        for (std::uint64_t step = 1;; step <<= 1) {
+            const std::uint64_t probe = hint + step;
+            if (probe >= end) break;
+            if (timeAt(probe) >= t) {
+                hi = probe;
+                break;
+            }
+            lo = probe + 1;
+        }
+    } else {
+        // hint 处已经 >= t（或在末尾）：向旧的方向倍增
+        lo = begin;
+        hi = hint;
+        for (std::uint64_t step = 1;; step <<= 1) {
+            if (hint - begin < step) break;
+            const std::uint64_t probe = hint - step;
+            if (timeAt(probe) < t) {
+                lo = probe + 1;
+                break;
+            }
+            hi = probe;
+        }
+    }
+    while (lo < hi) {
+        const std::uint64_t mid = lo + (hi - lo) / 2;
+        if (timeAt(mid) < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+ImuSpan ImuBuffer::makeSpan(std::uint64_t begin, std::uint64_t end) const {
+    ImuSpan span;
+    span.buffer = this;
+    span.begin_seq = begin;
+    span.count = static_cast<int>(end - begin);
+    return span;
+}
+
+bool ImuBuffer::interpolateAt(std::int64_t t, std::uint64_t begin, std::uint64_t end, ImuSample& out,
+                              std::uint64_t& seq) const {
+    if (begin == end) return false;
+    const std::uint64_t s = lowerBound(t, begin, end, seq);
+    if (s == end) return false;
+    const ImuSample b = at(s);
+    if (b.t_ns == t) {
+        out = b;
+    } else {
+        if (s == begin) return false;
+        const ImuSample a = at(s - 1);
+        // 拷出来的两个样本如果被覆盖过，时间戳不会恰好夹住 t（或者由调用方的 intact 检查发现）
+        if (!(a.t_ns < t && t < b.t_ns)) return false;
+        lerp(a, b, t, out);
+    }
+    seq = s;
+    return true;
+}
+
+bool ImuBuffer::interpolate(std::int64_t t, ImuSample& out, Cursor& cursor) const {
+    std::uint64_t begin, end;
+    readable(begin, end);
+    std::uint64_t seq = cursor.seq;
+    if (!interpolateAt(t, begin, end, out, seq) || !intact(seq > begin ? seq - 1 : seq)) return false;
+    cursor.seq = seq;
+    return true;
+}
+
+int ImuBuffer::interpolate(const std::int64_t* times, int n, ImuSample* out, Cursor& cursor) const {
+    std::uint64_t begin, end;
+    readable(begin, end);
+    std::uint64_t seq = cursor.seq;
+    int done = 0;
+    std::uint64_t oldest = end;
+    for (; done < n; ++done) {
+        if (!interpolateAt(times[done], begin, end, out[done], seq)) break;
+        oldest = std::min(oldest, seq > begin ? seq - 1 : seq);
+    }
+    // 时间递增时最早用到的样本最先可能被覆盖，只检查它
+    if (done > 0 && !intact(oldest)) return 0;
+    if (done > 0) cursor.seq = seq;
+    return done;
+}
+
+bool ImuBuffer::range(std::int64_t t0, std::int64_t t1, ImuSpan& span, Cursor& cursor) const {
+    std::uint64_t begin, end;
+    readable(begin, end);
+    if (begin == end || t0 > t1 || t0 < timeAt(begin) || t1 > timeAt(end - 1)) return false;
+    const std::uint64_t first = lowerBound(t0, begin, end, cursor.seq);
+    const std::uint64_t last = lowerBound(t1 + 1, first, end, first);
+    if (!intact(first)) return false;
+    span = makeSpan(first, last);
+    cursor.seq = last;
+    return true;
+}
+
+bool ImuBuffer::interval(std::int64_t t0, std::int64_t t1, ImuInterval& out, Cursor& cursor) const {
+    if (t0 >= t1) return false;
+    std::uint64_t begin, end;
+    readable(begin, end);
+    std::uint64_t s0 = cursor.seq;
+    if (!interpolateAt(t0, begin, end, out.start, s0)) return false;
+    std::uint64_t s1 = s0;
+    if (!interpolateAt(t1, begin, end, out.end, s1)) return false;
+    if (!intact(s0 > begin ? s0 - 1 : s0)) return false;
+    // s0 是第一个 >= t0 的样本，恰好落在 t0 上时它已经作为 start 了
+    out.inner = makeSpan(timeAt(s0) == t0 ? s0 + 1 : s0, s1);
+    cursor.seq = s1;
+    return true;
+}
+
+}  // namespace slam
@@ -0,0 +1,147 @@
+#include "loop/bow_database.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/profiler.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr float kWeightScale = 65535.f;
+constexpr int kTasksPerThread = 4;
+constexpr int kImagesPerReduceTask = 4096;
+
+void putVarint(std::vector<std::uint8_t>& bytes, std::uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline std::uint32_t getVarint(const std::uint8_t*& p) {
+    std::uint32_t value = *p & 0x7f;
+    int shift = 7;
+    while (*p++ & 0x80) {
+        value |= static_cast<std::uint32_t>(*p & 0x7f) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+}  // namespace
+
+BowDatabase::BowDatabase(int num_words, ThreadPool* pool)
+    : pool_(pool ? pool : &ThreadPool::global()), postings_(std::max(0, num_words)),
+      scores_(pool_->size()), common_(pool_->size()) {}
+
+int BowDatabase::add(const BowVector& bow) {
+    const int image = num_images_++;
+    for (const BowEntry& e : bow) {
+        if (e.word >= postings_.size()) continue;
+        PostingList& list = postings_[e.word];
+        putVarint(list.bytes, static_cast<std::uint32_t>(image - list.last_image));
+        const long q = std::lround(e.weight * kWeightScale);
+        const auto w = static_cast<std::uint16_t>(std::min(65535L, std::max(1L, q)));
+        list.bytes.push_back(static_cast<std::uint8_t>(w & 0xff));
+        list.bytes.push_back(static_cast<std::uint8_t>(w >> 8));
+        list.last_image = image;
+    }
+    return image;
+}
+
+std::size_t BowDatabase::postingBytes() const {
+    std::size_t bytes = 0;
+    for (const PostingList& list : postings_) bytes += list.bytes.size();
+    return bytes;
+}
+
+void BowDatabase::query(const BowVector& bow, int max_results, std::vector<BowQueryResult>& results,
+                        int max_image, float min_score) {
+    SLAM_PROFILE_SCOPE("loop/bow_query");
+    results.clear();
+    const int n_images = max_image < 0 ? num_images_ : std::min(max_image, num_images_);
+    if (bow.empty() || n_images <= 0 || max_results <= 0) return;
+
+    // 按倒排表字节数把查询单词分成大致均衡的几段
+    std::vector<std::size_t> cumulative(bow.size() + 1, 0);
+    for (size_t i = 0; i < bow.size(); ++i) {
+        const std::size_t bytes = bow[i].word < postings_.size() ? postings_[bow[i].word].bytes.size() : 0;
+        cumulative[i + 1] = cumulative[i] + bytes;
+    }
+    if (cumulative.back() == 0) return;
+    const int n_threads = pool_->size();
+    const int n_tasks = std::max(1, std::min(static_cast<int>(bow.size()), kTasksPerThread * n_threads));
+    std::vector<int> split(n_tasks + 1, 0);
+    for (int t = 1; t < n_tasks; ++t) {
+        const std::size_t target = cumulative.back() * t / n_tasks;
+        split[t] = static_cast<int>(std::lower_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin());
+    }
+    split[n_tasks] = static_cast<int>(bow.size());
+
+    std::vector<char> used(n_threads, 0);
+    pool_->parallelFor(n_tasks, [&](int task, int thread_id) {
+        std::vector<float>& scores = scores_[thread_id];
+        std::vector<std::uint16_t>& common = common_[thread_id];
+        if (!used[thread_id]) {
+            // 只清零本次查询用到的范围
+            if (scores.size() < static_cast<size_t>(num_images_)) {
+                scores.resize(num_images_);
+                common.resize(num_images_);
+            }
+            std::fill(scores.begin(), scores.begin() + n_images, 0.f);
+            std::fill(common.begin(), common.begin() + n_images, 0);
+            used[thread_id] = 1;
+        }
+        for (int i = split[task]; i < split[task + 1]; ++i) {
+            if (bow[i].word >= postings_.size()) continue;
+            const PostingList& list = postings_[bow[i].word];
+            const float v = bow[i].weight;
+            const std::uint8_t* p = list.bytes.data();
+            const std::uint8_t* end = p + list.bytes.size();
+            int image = -1;
+            while (p < end) {
+                image += static_cast<int>(getVarint(p));
+                if (image >= n_images) break;   // 图像 id 递增，后面的都超出范围
+                const float w = static_cast<float>(p[0] | (p[1] << 8)) * (1.f / kWeightScale);
+                p += 2;
+                scores[image] += std::min(v, w);
+                ++common[image];
+            }
+        }
+    });
+
+    // 按图像区间归约各线程的得分
+    const int n_reduce = (n_images + kImagesPerReduceTask - 1) / kImagesPerReduceTask;
+    std::vector<std::vector<BowQueryResult>> partial(n_reduce);
+    pool_->parallelFor(n_reduce, [&](int task, int) {
+        const int begin = task * kImagesPerReduceTask;
+        const int end = std::min(n_images, begin + kImagesPerReduceTask);
+        for (int image = begin; image < end; ++image) {
+            float score = 0.f;
+            int common = 0;
+            for (int t = 0; t < n_threads; ++t) {
+                if (!used[t]) continue;
+                score += scores_[t][image];
+                common += common_[t][image];
+            }
+            if (common > 0 && score > min_score) partial[task].push_back({image, score, common});
+        }
+    });
+
+    for (const auto& p : partial) results.insert(results.end(), p.begin(), p.end());
+    const auto better = [](const BowQueryResult& a, const BowQueryResult& b) {
+        return a.score > b.score || (a.score == b.score && a.image < b.image);
+    };
+    if (static_cast<int>(results.size()) > max_results) {
+        std::partial_sort(results.begin(), results.begin() + max_results, results.end(), better);
+        results.resize(max_results);
+    } else {
+        std::sort(results.begin(), results.end(), better);
+    }
+}
+
+}  // namespace slam
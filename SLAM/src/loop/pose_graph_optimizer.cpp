@@ -0,0 +1,746 @@
+#include "loop/pose_graph_optimizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include <Eigen/SparseCore>
+#include <Eigen/OrderingMethods>
+
+#include "utils/profiler.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+template <int D>
+using Mat = Eigen::Matrix<double, D, D>;
+template <int D>
+using Vec = Eigen::Matrix<double, D, 1>;
+
+constexpr int kTasksPerThread = 4;
+
+Eigen::Matrix3d hat(const Eigen::Vector3d& v) {
+    Eigen::Matrix3d m;
+    m << 0.0, -v.z(), v.y(),
+         v.z(), 0.0, -v.x(),
+         -v.y(), v.x(), 0.0;
+    return m;
+}
+
+Eigen::Matrix3d expSO3(const Eigen::Vector3d& phi) {
+    const double theta = phi.norm();
+    if (theta < 1e-10) {
+        return Eigen::Quaterniond(1.0, 0.5 * phi.x(), 0.5 * phi.y(), 0.5 * phi.z()).normalized().toRotationMatrix();
+    }
+    return Eigen::AngleAxisd(theta, phi / theta).toRotationMatrix();
+}
+
+Eigen::Vector3d logSO3(const Eigen::Matrix3d& R) {
+    Eigen::Quaterniond q(R);
+    q.normalize();
+    if (q.w() < 0.0) q.coeffs() = -q.coeffs();
+    const double n = q.vec().norm();
+    // 小角度时 2 * atan2(n, w) / n -> 2 / w
+    const double scale = n < 1e-10 ? 2.0 / q.w() : 2.0 * std::atan2(n, q.w()) / n;
+    return scale * q.vec();
+}
+
+// 右 Jacobian 的逆 Jr^-1(θ) = I + θ^/2 + (1/θ² - (1 + cos θ) / (2 θ sin θ)) θ^²
+Eigen::Matrix3d rightJacobianInvSO3(const Eigen::Vector3d& theta) {
+    const double t = theta.norm();
+    const Eigen::Matrix3d W = hat(theta);
+    if (t < 1e-6) return Eigen::Matrix3d::Identity() + 0.5 * W;
+    const double c = 1.0 / (t * t) - (1.0 + std::cos(t)) / (2.0 * t * std::sin(t));
+    return Eigen::Matrix3d::Identity() + 0.5 * W + c * W * W;
+}
+
+// 相似变换 (R, t, s)：x -> s R x + t
+struct Sim3 {
+    Eigen::Matrix3d R;
+    Eigen::Vector3d t;
+    double s;
+};
+
+Sim3 compose(const Sim3& a, const Sim3& b) { return {a.R * b.R, a.s * (a.R * b.t) + a.t, a.s * b.s}; }
+
+Sim3 inverse(const Sim3& a) {
+    const Eigen::Matrix3d Rt = a.R.transpose();
+    return {Rt, -(Rt * a.t) / a.s, 1.0 / a.s};
+}
+
+template <int D>
+Sim3 vertexSim3(const PoseGraphVertex& v) {
+    return {v.R_wc, v.t_wc, D == 7 ? v.s : 1.0};
+}
+
+template <int D>
+Sim3 edgeSim3(const PoseGraphEdge& e) {
+    return {e.R_ij, e.t_ij, D == 7 ? e.s_ij : 1.0};
+}
+
+// 一条边线性化的结果
+template <int D>
+struct EdgeBlocks {
+    Mat<D> H_ii, H_ij, H_jj;
+    Vec<D> g_i, g_j;
+};
+
+// 残差 r = [t_E, Log(R_E), ln s_E]，E = Z^-1 S_i^-1 S_j；jacobians 非空时同时给出对 δ_i、δ_j 的 Jacobian
+template <int D>
+Vec<D> edgeResidual(const Sim3& Si, const Sim3& Sj, const Sim3& Z, Mat<D>* J_i, Mat<D>* J_j) {
+    const Sim3 Zinv = inverse(Z);
+    const Sim3 E = compose(compose(Zinv, inverse(Si)), Sj);
+    const Eigen::Vector3d theta = logSO3(E.R);
+    Vec<D> r;
+    r.template head<3>() = E.t;
+    r.template segment<3>(3) = theta;
+    if (D == 7) r[D - 1] = std::log(E.s);
+    if (!J_i) return r;
+
+    const Eigen::Matrix3d Jr_inv = rightJacobianInvSO3(theta);
+    // δ_j：E' = E * (Exp(φ), ρ, e^σ)
+    J_j->setZero();
+    J_j->template block<3, 3>(0, 0) = E.s * E.R;
+    J_j->template block<3, 3>(3, 3) = Jr_inv;
+    if (D == 7) (*J_j)(D - 1, D - 1) = 1.0;
+    // δ_i：E' = A * E，A = Z^-1 (Exp(φ), ρ, e^σ)^-1 Z 的一阶展开
+    const Eigen::Matrix3d RzT = Z.R.transpose();
+    const double inv_sz = 1.0 / Z.s;
+    J_i->setZero();
+    J_i->template block<3, 3>(0, 0) = -inv_sz * RzT;
+    J_i->template block<3, 3>(0, 3) = hat(E.t) * RzT + inv_sz * RzT * hat(Z.t);
+    J_i->template block<3, 3>(3, 3) = -Jr_inv * E.R.transpose() * RzT;
+    if (D == 7) {
+        J_i->template block<3, 1>(0, D - 1) = -E.t - inv_sz * (RzT * Z.t);
+        (*J_i)(D - 1, D - 1) = -1.0;
+    }
+    return r;
+}
+
+// 把 [0, n) 分块交给线程池
+template <typename Fn>
+void forChunks(ThreadPool* pool, int n, int chunk, const Fn& fn) {
+    chunk = std::max(1, chunk);
+    const int n_tasks = (n + chunk - 1) / chunk;
+    if (n_tasks == 0) return;
+    pool->parallelFor(n_tasks, [&](int task, int thread_id) {
+        fn(task, task * chunk, std::min(n, (task + 1) * chunk), thread_id);
+    });
+}
+
+}  // namespace
+
+// 只与图结构有关的部分：排序、超节点、组装映射、并行分解的子树划分
+struct PoseGraphOptimizer::Symbolic {
+    // 结构键
+    int num_vertices = 0;
+    std::vector<int> edge_ends;
+    std::vector<char> fixed;
+
+    int n = 0;                              // 自由顶点数，即块列数
+    std::vector<int> column_of_vertex;      // 顶点 -> 列（固定顶点为 -1）
+    std::vector<int> vertex_of_column;
+
+    // 超节点 s 包含块列 [first[s], first[s + 1])，对角块以下的非零块行为 rows[row_ptr[s], row_ptr[s + 1])；
+    // relative 与 rows 一一对应，是这些行在父超节点波前矩阵中的局部块下标
+    int num_supernodes = 0;
+    std::vector<int> first, row_ptr, rows, relative, parent;
+    std::vector<int> child_ptr, children;
+    // 以块为单位的偏移：L 的面板 (w + m) x w，传给父节点的更新矩阵 m x m
+    std::vector<std::size_t> panel_offset, update_offset;
+    long factor_blocks = 0;
+    int max_rows = 0;
+
+    // 第 j 列的组装来源：对角 (边, 端点 0/1)，非对角 (边, 是否转置, 在超节点面板中的局部块行)
+    std::vector<int> diag_ptr, diag_edge;
+    std::vector<char> diag_side;
+    std::vector<int> off_ptr, off_edge, off_local_row;
+    std::vector<char> off_transposed;
+
+    // 并行分解：互不相交的子树（超节点升序），以及最后顺序处理的靠近根的超节点
+    std::vector<std::vector<int>> subtree_nodes;
+    std::vector<int> top_nodes;
+
+    bool matches(const std::vector<PoseGraphVertex>& vertices, const std::vector<PoseGraphEdge>& edges) const {
+        if (num_vertices != static_cast<int>(vertices.size()) || edge_ends.size() != 2 * edges.size()) return false;
+        for (size_t e = 0; e < edges.size(); ++e) {
+            if (edge_ends[2 * e] != edges[e].i || edge_ends[2 * e + 1] != edges[e].j) return false;
+        }
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            if (fixed[v] != static_cast<char>(vertices[v].fixed)) return false;
+        }
+        return true;
+    }
+};
+
+PoseGraphOptimizer::PoseGraphOptimizer(const PoseGraphOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()) {}
+
+PoseGraphOptimizer::~PoseGraphOptimizer() = default;
+
+void PoseGraphOptimizer::analyze(const std::vector<PoseGraphVertex>& vertices, const std::vector<PoseGraphEdge>& edges) {
+    symbolic_.reset(new Symbolic);
+    Symbolic& sym = *symbolic_;
+    const int n_vertices = static_cast<int>(vertices.size());
+    const int n_edges = static_cast<int>(edges.size());
+    sym.num_vertices = n_vertices;
+    sym.edge_ends.resize(2 * edges.size());
+    sym.fixed.resize(n_vertices);
+    bool any_fixed = false;
+    for (int v = 0; v < n_vertices; ++v) {
+        sym.fixed[v] = vertices[v].fixed;
+        any_fixed |= vertices[v].fixed;
+    }
+    for (int e = 0; e < n_edges; ++e) {
+        sym.edge_ends[2 * e] = edges[e].i;
+        sym.edge_ends[2 * e + 1] = edges[e].j;
+    }
+
+    // 自由顶点编号；没有固定顶点时固定第 0 个
+    std::vector<int> var_of_vertex(n_vertices, -1);
+    int n = 0;
+    for (int v = 0; v < n_vertices; ++v) {
+        if (!sym.fixed[v] && (any_fixed || v != 0)) var_of_vertex[v] = n++;
+    }
+    sym.n = n;
+
+    const auto valid_edge = [&](const PoseGraphEdge& e) {
+        return e.i >= 0 && e.j >= 0 && e.i < n_vertices && e.j < n_vertices && e.i != e.j;
+    };
+
+    // 1. 块图上的 AMD 排序
+    std::vector<Eigen::Triplet<int>> triplets;
+    triplets.reserve(2 * edges.size() + n);
+    for (int k = 0; k < n; ++k) triplets.emplace_back(k, k, 1);
+    for (const PoseGraphEdge& e : edges) {
+        if (!valid_edge(e)) continue;
+        const int a = var_of_vertex[e.i], b = var_of_vertex[e.j];
+        if (a < 0 || b < 0) continue;
+        triplets.emplace_back(a, b, 1);
+        triplets.emplace_back(b, a, 1);
+    }
+    Eigen::SparseMatrix<int> pattern(n, n);
+    pattern.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::AMDOrdering<int>::PermutationType perm;
+    Eigen::AMDOrdering<int>()(pattern, perm);
+
+    // perm.indices()[k] 是第 k 个消元的变量
+    std::vector<int> column_of_var(n);
+    for (int k = 0; k < n; ++k) column_of_var[perm.indices()[k]] = k;
+    sym.column_of_vertex.assign(n_vertices, -1);
+    sym.vertex_of_column.assign(n, -1);
+    for (int v = 0; v < n_vertices; ++v) {
+        if (var_of_vertex[v] >= 0) {
+            sym.column_of_vertex[v] = column_of_var[var_of_vertex[v]];
+            sym.vertex_of_column[sym.column_of_vertex[v]] = v;
+        }
+    }
+
+    // 排序后的邻接表
+    std::vector<std::vector<int>> adjacency(n);
+    for (const PoseGraphEdge& e : edges) {
+        if (!valid_edge(e)) continue;
+        const int a = sym.column_of_vertex[e.i], b = sym.column_of_vertex[e.j];
+        if (a < 0 || b < 0) continue;
+        adjacency[a].push_back(b);
+        adjacency[b].push_back(a);
+    }
+
+    // 2. 消元树（Liu 算法，带路径压缩）
+    std::vector<int> parent(n, -1), ancestor(n, -1);
+    for (int j = 0; j < n; ++j) {
+        for (int i : adjacency[j]) {
+            if (i >= j) continue;
+            int r = i;
+            while (ancestor[r] != -1 && ancestor[r] != j) {
+                const int next = ancestor[r];
+                ancestor[r] = j;
+                r = next;
+            }
+            if (ancestor[r] == -1) {
+                ancestor[r] = j;
+                parent[r] = j;
+            }
+        }
+    }
+    std::vector<std::vector<int>> column_children(n);
+    for (int j = 0; j < n; ++j) {
+        if (parent[j] >= 0) column_children[parent[j]].push_back(j);
+    }
+
+    // 3. L 的列结构：struct(j) = {j 的下方邻居} ∪ (子节点的结构 \ {j})
+    std::vector<std::vector<int>> column_rows(n);
+    std::vector<int> mark(n, -1);
+    for (int j = 0; j < n; ++j) {
+        std::vector<int>& s = column_rows[j];
+        mark[j] = j;
+        for (int i : adjacency[j]) {
+            if (i > j && mark[i] != j) {
+                mark[i] = j;
+                s.push_back(i);
+            }
+        }
+        for (int c : column_children[j]) {
+            for (int i : column_rows[c]) {
+                if (mark[i] != j) {
+                    mark[i] = j;
+                    s.push_back(i);
+                }
+            }
+        }
+        std::sort(s.begin(), s.end());
+    }
+
+    // 4. 基本超节点：j - 1 的父节点是 j、j 只有这一个子节点，且 struct(j - 1) = {j} ∪ struct(j)，
+    //    这样的相邻列在 L 中的非零结构完全相同，合并成一个稠密面板
+    std::vector<int> sn_of_column(n);
+    for (int j = 0; j < n; ++j) {
+        const bool merge = j > 0 && parent[j - 1] == j && column_children[j].size() == 1 &&
+                           column_rows[j - 1].size() == column_rows[j].size() + 1;
+        if (!merge) sym.first.push_back(j);
+        sn_of_column[j] = static_cast<int>(sym.first.size()) - 1;
+    }
+    const int ns = static_cast<int>(sym.first.size());
+    sym.num_supernodes = ns;
+    sym.first.push_back(n);
+
+    sym.row_ptr.assign(ns + 1, 0);
+    sym.parent.assign(ns, -1);
+    for (int s = 0; s < ns; ++s) {
+        const std::vector<int>& r = column_rows[sym.first[s + 1] - 1];
+        sym.row_ptr[s + 1] = sym.row_ptr[s] + static_cast<int>(r.size());
+        sym.rows.insert(sym.rows.end(), r.begin(), r.end());
+        // 最后一列的消元树父节点就是它下方的第一个非零行
+        if (!r.empty()) sym.parent[s] = sn_of_column[r.front()];
+        sym.max_rows = std::max(sym.max_rows, static_cast<int>(r.size()));
+    }
+    // 块行 r 在超节点 s 面板中的局部块下标
+    const auto local_row = [&](int s, int r) {
+        if (r < sym.first[s + 1]) return r - sym.first[s];
+        const auto begin = sym.rows.begin() + sym.row_ptr[s], end = sym.rows.begin() + sym.row_ptr[s + 1];
+        return (sym.first[s + 1] - sym.first[s]) + static_cast<int>(std::lower_bound(begin, end, r) - begin);
+    };
+    sym.relative.resize(sym.rows.size());
+    for (int s = 0; s < ns; ++s) {
+        for (int p = sym.row_ptr[s]; p < sym.row_ptr[s + 1]; ++p) sym.relative[p] = local_row(sym.parent[s], sym.rows[p]);
+    }
+    sym.child_ptr.assign(ns + 1, 0);
+    for (int s = 0; s < ns; ++s) {
+        if (sym.parent[s] >= 0) ++sym.child_ptr[sym.parent[s] + 1];
+    }
+    for (int s = 0; s < ns; ++s) sym.child_ptr[s + 1] += sym.child_ptr[s];
+    sym.children.resize(sym.child_ptr[ns]);
+    {
+        std::vector<int> fill(sym.child_ptr.begin(), sym.child_ptr.end() - 1);
+        for (int s = 0; s < ns; ++s) {
+            if (sym.parent[s] >= 0) sym.children[fill[sym.parent[s]]++] = s;
+        }
+    }
+    sym.panel_offset.assign(ns + 1, 0);
+    sym.update_offset.assign(ns + 1, 0);
+    sym.factor_blocks = 0;
+    for (int s = 0; s < ns; ++s) {
+        const std::size_t w = sym.first[s + 1] - sym.first[s], m = sym.row_ptr[s + 1] - sym.row_ptr[s];
+        sym.panel_offset[s + 1] = sym.panel_offset[s] + (w + m) * w;
+        sym.update_offset[s + 1] = sym.update_offset[s] + m * m;
+        sym.factor_blocks += static_cast<long>(w * (w + 1) / 2 + w * m);
+    }
+
+    // 5. 组装映射：每条边的 H 块写到哪一列、面板的哪一块行
+    std::vector<std::vector<std::pair<int, char>>> diag_terms(n);
+    std::vector<std::vector<std::pair<int, int>>> off_terms(n);    // (边 * 2 + 是否转置, 局部块行)
+    for (int e = 0; e < n_edges; ++e) {
+        if (!valid_edge(edges[e])) continue;
+        const int a = sym.column_of_vertex[edges[e].i], b = sym.column_of_vertex[edges[e].j];
+        if (a >= 0) diag_terms[a].emplace_back(e, 0);
+        if (b >= 0) diag_terms[b].emplace_back(e, 1);
+        if (a < 0 || b < 0) continue;
+        const int col = std::min(a, b), row = std::max(a, b);
+        // 块 (row, col)：row 是 j 端时为 H_ji = H_ij^T
+        off_terms[col].emplace_back(2 * e + (row == b ? 1 : 0), local_row(sn_of_column[col], row));
+    }
+    sym.diag_ptr.assign(n + 1, 0);
+    sym.off_ptr.assign(n + 1, 0);
+    for (int j = 0; j < n; ++j) {
+        sym.diag_ptr[j + 1] = sym.diag_ptr[j] + static_cast<int>(diag_terms[j].size());
+        sym.off_ptr[j + 1] = sym.off_ptr[j] + static_cast<int>(off_terms[j].size());
+        for (const auto& t : diag_terms[j]) {
+            sym.diag_edge.push_back(t.first);
+            sym.diag_side.push_back(t.second);
+        }
+        for (const auto& t : off_terms[j]) {
+            sym.off_edge.push_back(t.first / 2);
+            sym.off_transposed.push_back(static_cast<char>(t.first % 2));
+            sym.off_local_row.push_back(t.second);
+        }
+    }
+
+    // 6. 子树划分：按 (w + m)² w 估计每个超节点的工作量
+    const int n_threads = pool_->size();
+    sym.subtree_nodes.clear();
+    sym.top_nodes.clear();
+    if (n_threads <= 1) {
+        sym.top_nodes.resize(ns);
+        for (int s = 0; s < ns; ++s) sym.top_nodes[s] = s;
+        return;
+    }
+    std::vector<double> weight(ns, 0.0);
+    double total = 0.0;
+    for (int s = 0; s < ns; ++s) {
+        const double w = sym.first[s + 1] - sym.first[s], m = sym.row_ptr[s + 1] - sym.row_ptr[s];
+        const double work = (w + m) * (w + m) * w;
+        weight[s] += work;
+        total += work;
+        if (sym.parent[s] >= 0) weight[sym.parent[s]] += weight[s];   // 子节点下标小于父节点，到这里已累加完
+    }
+    const double threshold = total / (kTasksPerThread * n_threads);
+    std::vector<int> stack;
+    for (int s = 0; s < ns; ++s) {
+        if (sym.parent[s] < 0) stack.push_back(s);
+    }
+    while (!stack.empty()) {
+        const int node = stack.back();
+        stack.pop_back();
+        if (weight[node] > threshold) {
+            sym.top_nodes.push_back(node);
+            stack.insert(stack.end(), sym.children.begin() + sym.child_ptr[node],
+                         sym.children.begin() + sym.child_ptr[node + 1]);
+            continue;
+        }
+        std::vector<int> nodes{node};
+        for (size_t q = 0; q < nodes.size(); ++q) {
+            nodes.insert(nodes.end(), sym.children.begin() + sym.child_ptr[nodes[q]],
+                         sym.children.begin() + sym.child_ptr[nodes[q] + 1]);
+        }
+        std::sort(nodes.begin(), nodes.end());
+        sym.subtree_nodes.push_back(std::move(nodes));
+    }
+    std::sort(sym.top_nodes.begin(), sym.top_nodes.end());
+}
+
+bool PoseGraphOptimizer::optimize(std::vector<PoseGraphVertex>& vertices, const std::vector<PoseGraphEdge>& edges,
+                                  PoseGraphSummary* summary) {
+    SLAM_PROFILE_SCOPE("loop/pose_graph");
+    PoseGraphSummary local;
+    PoseGraphSummary& s = summary ? *summary : local;
+    s = PoseGraphSummary();
+    const auto start = Clock::now();
+    const bool ok = options_.type == PoseGraphType::kSim3 ? optimizeImpl<7>(vertices, edges, s)
+                                                          : optimizeImpl<6>(vertices, edges, s);
+    s.total_ms = elapsedMs(start);
+    return ok;
+}
+
+template <int D>
+bool PoseGraphOptimizer::optimizeImpl(std::vector<PoseGraphVertex>& vertices, const std::vector<PoseGraphEdge>& edges,
+                                      PoseGraphSummary& summary) {
+    const auto call_start = Clock::now();
+    auto t0 = call_start;
+    if (!symbolic_ || !symbolic_->matches(vertices, edges)) {
+        analyze(vertices, edges);
+    } else {
+        summary.reused_symbolic = true;
+    }
+    summary.symbolic_ms = elapsedMs(t0);
+    const Symbolic& sym = *symbolic_;
+    const int n = sym.n;
+    const int ns = sym.num_supernodes;
+    const int n_vertices = static_cast<int>(vertices.size());
+    const int n_edges = static_cast<int>(edges.size());
+    summary.num_variables = n;
+    summary.num_factor_blocks = sym.factor_blocks;
+
+    const auto valid_edge = [&](const PoseGraphEdge& e) {
+        return e.i >= 0 && e.j >= 0 && e.i < n_vertices && e.j < n_vertices && e.i != e.j;
+    };
+    const int edge_chunk = std::max(1, options_.edges_per_task);
+    const int n_edge_tasks = (n_edges + edge_chunk - 1) / edge_chunk;
+    std::vector<double> partial_chi2(std::max(1, n_edge_tasks));
+
+    // χ²（jacobians 为真时同时计算每条边的 H 块）
+    std::vector<EdgeBlocks<D>> blocks(n_edges);
+    const auto evaluate = [&](const std::vector<PoseGraphVertex>& vs, bool jacobians) {
+        std::fill(partial_chi2.begin(), partial_chi2.end(), 0.0);
+        forChunks(pool_, n_edges, edge_chunk, [&](int task, int begin, int end, int) {
+            double chi2 = 0.0;
+            Mat<D> J_i, J_j;
+            for (int e = begin; e < end; ++e) {
+                const PoseGraphEdge& edge = edges[e];
+                if (!valid_edge(edge)) continue;
+                const Mat<D> omega = edge.information.template topLeftCorner<D, D>();
+                const Sim3 Si = vertexSim3<D>(vs[edge.i]), Sj = vertexSim3<D>(vs[edge.j]), Z = edgeSim3<D>(edge);
+                const Vec<D> r = edgeResidual<D>(Si, Sj, Z, jacobians ? &J_i : nullptr, &J_j);
+                const Vec<D> wr = omega * r;
+                chi2 += r.dot(wr);
+                if (!jacobians) continue;
+                EdgeBlocks<D>& b = blocks[e];
+                const Mat<D> JiT_omega = J_i.transpose() * omega;
+                const Mat<D> JjT_omega = J_j.transpose() * omega;
+                b.H_ii.noalias() = JiT_omega * J_i;
+                b.H_ij.noalias() = JiT_omega * J_j;
+                b.H_jj.noalias() = JjT_omega * J_j;
+                b.g_i.noalias() = J_i.transpose() * wr;
+                b.g_j.noalias() = J_j.transpose() * wr;
+            }
+            partial_chi2[task] = chi2;
+        });
+        double chi2 = 0.0;
+        for (double c : partial_chi2) chi2 += c;
+        return chi2;
+    };
+
+    t0 = Clock::now();
+    double chi2 = evaluate(vertices, true);
+    summary.linearize_ms += elapsedMs(t0);
+    summary.initial_chi2 = summary.final_chi2 = chi2;
+    if (n == 0 || !std::isfinite(chi2)) return std::isfinite(chi2);
+
+    std::vector<double> panels(sym.panel_offset[ns] * D * D);
+    std::vector<double> updates(sym.update_offset[ns] * D * D);
+    Eigen::VectorXd delta(static_cast<Eigen::Index>(n) * D);
+    const int column_chunk = std::max(1, options_.columns_per_task);
+
+    // 多波前分解一个超节点：组装 H + λ diag(H) 的这几列，加上子节点的更新矩阵，
+    // 再对波前矩阵做部分 Cholesky：L11 = chol(F11)，L21 = F21 L11^-T，U = F22 - L21 L21^T 留给父节点
+    std::atomic<bool> factor_ok{true};
+    double lambda = options_.initial_lambda;
+    const auto factor_node = [&](int s) {
+        const int f = sym.first[s];
+        const int w = sym.first[s + 1] - f;
+        const int m = sym.row_ptr[s + 1] - sym.row_ptr[s];
+        Eigen::Map<Eigen::MatrixXd> P(panels.data() + sym.panel_offset[s] * D * D, (w + m) * D, w * D);
+        Eigen::Map<Eigen::MatrixXd> U(updates.data() + sym.update_offset[s] * D * D, m * D, m * D);
+        P.setZero();
+        U.setZero();
+        for (int lc = 0; lc < w; ++lc) {
+            const int j = f + lc;
+            auto A = P.template block<D, D>(lc * D, lc * D);
+            for (int p = sym.diag_ptr[j]; p < sym.diag_ptr[j + 1]; ++p) {
+                const EdgeBlocks<D>& eb = blocks[sym.diag_edge[p]];
+                A += sym.diag_side[p] == 0 ? eb.H_ii : eb.H_jj;
+            }
+            A.diagonal() += lambda * A.diagonal().cwiseMax(1e-9);
+            for (int p = sym.off_ptr[j]; p < sym.off_ptr[j + 1]; ++p) {
+                const EdgeBlocks<D>& eb = blocks[sym.off_edge[p]];
+                auto B = P.template block<D, D>(sym.off_local_row[p] * D, lc * D);
+                if (sym.off_transposed[p]) {
+                    B += eb.H_ij.transpose();
+                } else {
+                    B += eb.H_ij;
+                }
+            }
+        }
+        // 子节点的更新矩阵按局部下标加进来（只用下三角）
+        for (int q = sym.child_ptr[s]; q < sym.child_ptr[s + 1]; ++q) {
+            const int c = sym.children[q];
+            const int mc = sym.row_ptr[c + 1] - sym.row_ptr[c];
+            const Eigen::Map<const Eigen::MatrixXd> Uc(updates.data() + sym.update_offset[c] * D * D, mc * D, mc * D);
+            const int* rel = sym.relative.data() + sym.row_ptr[c];
+            for (int b = 0; b < mc; ++b) {
+                for (int a = b; a < mc; ++a) {
+                    const auto src = Uc.template block<D, D>(a * D, b * D);
+                    if (rel[b] < w) {
+                        P.template block<D, D>(rel[a] * D, rel[b] * D) += src;
+                    } else {
+                        U.template block<D, D>((rel[a] - w) * D, (rel[b] - w) * D) += src;
+                    }
+                }
+            }
+        }
+        if (w == 1) {
+            // 单列超节点（稀疏图里最常见）：全部用定长 D x D 块运算
+            auto L11 = P.template block<D, D>(0, 0);
+            Eigen::LLT<Mat<D>> llt(L11);
+            if (llt.info() != Eigen::Success) {
+                factor_ok = false;
+                return;
+            }
+            L11 = llt.matrixL();
+            for (int a = 0; a < m; ++a) {
+                auto B = P.template block<D, D>((a + 1) * D, 0);
+                llt.matrixU().template solveInPlace<Eigen::OnTheRight>(B);
+            }
+            for (int b = 0; b < m; ++b) {
+                const Mat<D> Bb = P.template block<D, D>((b + 1) * D, 0);
+                for (int a = b; a < m; ++a) {
+                    U.template block<D, D>(a * D, b * D).noalias() -= P.template block<D, D>((a + 1) * D, 0) * Bb.transpose();
+                }
+            }
+            return;
+        }
+        Eigen::Ref<Eigen::MatrixXd> F11 = P.topRows(w * D);
+        Eigen::LLT<Eigen::Ref<Eigen::MatrixXd>> llt(F11);
+        if (llt.info() != Eigen::Success) {
+            factor_ok = false;
+            return;
+        }
+        if (m == 0) return;
+        auto F21 = P.bottomRows(m * D);
+        llt.matrixU().template solveInPlace<Eigen::OnTheRight>(F21);
+        U.template selfadjointView<Eigen::Lower>().rankUpdate(F21, -1.0);
+    };
+    const auto factorize = [&]() {
+        factor_ok = true;
+        if (!sym.subtree_nodes.empty()) {
+            pool_->parallelFor(static_cast<int>(sym.subtree_nodes.size()), [&](int task, int) {
+                for (int s : sym.subtree_nodes[task]) {
+                    if (!factor_ok) return;
+                    factor_node(s);
+                }
+            });
+        }
+        for (int s : sym.top_nodes) {
+            if (!factor_ok) break;
+            factor_node(s);
+        }
+        return factor_ok.load();
+    };
+
+    // 右端项 -g
+    const auto assemble_rhs = [&]() {
+        forChunks(pool_, n, column_chunk, [&](int, int begin, int end, int) {
+            for (int j = begin; j < end; ++j) {
+                Vec<D> b = Vec<D>::Zero();
+                for (int p = sym.diag_ptr[j]; p < sym.diag_ptr[j + 1]; ++p) {
+                    const EdgeBlocks<D>& eb = blocks[sym.diag_edge[p]];
+                    b -= sym.diag_side[p] == 0 ? eb.g_i : eb.g_j;
+                }
+                delta.template segment<D>(static_cast<Eigen::Index>(j) * D) = b;
+            }
+        });
+    };
+
+    // L L^T δ = -g，按超节点做稠密三角求解
+    Eigen::VectorXd gathered(static_cast<Eigen::Index>(sym.max_rows) * D);
+    const auto solve = [&]() {
+        for (int s = 0; s < ns; ++s) {
+            const int f = sym.first[s], w = sym.first[s + 1] - f, m = sym.row_ptr[s + 1] - sym.row_ptr[s];
+            const Eigen::Map<const Eigen::MatrixXd> P(panels.data() + sym.panel_offset[s] * D * D, (w + m) * D, w * D);
+            const int* rows = sym.rows.data() + sym.row_ptr[s];
+            if (w == 1) {
+                auto y = delta.template segment<D>(static_cast<Eigen::Index>(f) * D);
+                const Mat<D> L11 = P.template block<D, D>(0, 0);
+                L11.template triangularView<Eigen::Lower>().solveInPlace(y);
+                const Vec<D> x = y;
+                for (int a = 0; a < m; ++a) {
+                    delta.template segment<D>(static_cast<Eigen::Index>(rows[a]) * D).noalias() -=
+                        P.template block<D, D>((a + 1) * D, 0) * x;
+                }
+                continue;
+            }
+            auto y = delta.segment(static_cast<Eigen::Index>(f) * D, w * D);
+            P.topRows(w * D).template triangularView<Eigen::Lower>().solveInPlace(y);
+            if (m == 0) continue;
+            auto g = gathered.head(m * D);
+            g.noalias() = P.bottomRows(m * D) * y;
+            for (int a = 0; a < m; ++a) {
+                delta.template segment<D>(static_cast<Eigen::Index>(rows[a]) * D) -= g.template segment<D>(a * D);
+            }
+        }
+        for (int s = ns - 1; s >= 0; --s) {
+            const int f = sym.first[s], w = sym.first[s + 1] - f, m = sym.row_ptr[s + 1] - sym.row_ptr[s];
+            const Eigen::Map<const Eigen::MatrixXd> P(panels.data() + sym.panel_offset[s] * D * D, (w + m) * D, w * D);
+            const int* rows = sym.rows.data() + sym.row_ptr[s];
+            if (w == 1) {
+                Vec<D> y = delta.template segment<D>(static_cast<Eigen::Index>(f) * D);
+                for (int a = 0; a < m; ++a) {
+                    y.noalias() -= P.template block<D, D>((a + 1) * D, 0).transpose() *
+                                   delta.template segment<D>(static_cast<Eigen::Index>(rows[a]) * D);
+                }
+                const Mat<D> L11 = P.template block<D, D>(0, 0);
+                L11.template triangularView<Eigen::Lower>().transpose().solveInPlace(y);
+                delta.template segment<D>(static_cast<Eigen::Index>(f) * D) = y;
+                continue;
+            }
+            auto y = delta.segment(static_cast<Eigen::Index>(f) * D, w * D);
+            if (m > 0) {
+                auto g = gathered.head(m * D);
+                for (int a = 0; a < m; ++a) {
+                    g.template segment<D>(a * D) = delta.template segment<D>(static_cast<Eigen::Index>(rows[a]) * D);
+                }
+                y.noalias() -= P.bottomRows(m * D).transpose() * g;
+            }
+            P.topRows(w * D).template triangularView<Eigen::Lower>().transpose().solveInPlace(y);
+        }
+    };
+
+    std::vector<PoseGraphVertex> candidate = vertices;
+    bool improved = false;
+    auto iteration_start = Clock::now();
+    for (int it = 0; it < options_.max_iterations; ++it) {
+        if (it > 0 && options_.time_budget_ms > 0.0) {
+            // 按上一次迭代的耗时预估：下一次做不完就停下，已接受的步已经写回 vertices
+            if (elapsedMs(call_start) + elapsedMs(iteration_start) > options_.time_budget_ms) {
+                summary.budget_exhausted = true;
+                break;
+            }
+        }
+        iteration_start = Clock::now();
+        summary.iterations = it + 1;
+        t0 = Clock::now();
+        const bool factored = factorize();
+        summary.factorize_ms += elapsedMs(t0);
+        if (!factored) {
+            lambda *= 10.0;
+            continue;
+        }
+        t0 = Clock::now();
+        assemble_rhs();
+        solve();
+        summary.solve_ms += elapsedMs(t0);
+
+        // S ⊞ δ = S * (Exp(φ), ρ, e^σ)
+        t0 = Clock::now();
+        forChunks(pool_, n, column_chunk, [&](int, int begin, int end, int) {
+            for (int j = begin; j < end; ++j) {
+                const int v = sym.vertex_of_column[j];
+                const PoseGraphVertex& cur = vertices[v];
+                PoseGraphVertex& next = candidate[v];
+                const Vec<D> d = delta.template segment<D>(static_cast<Eigen::Index>(j) * D);
+                next.R_wc = cur.R_wc * expSO3(d.template segment<3>(3));
+                next.t_wc = cur.t_wc + (D == 7 ? cur.s : 1.0) * (cur.R_wc * d.template head<3>());
+                next.s = D == 7 ? cur.s * std::exp(d[D - 1]) : cur.s;
+            }
+        });
+        const double new_chi2 = evaluate(candidate, false);
+        summary.linearize_ms += elapsedMs(t0);
+
+        if (!(new_chi2 < chi2)) {
+            // 已经在极小值附近：步长带来的变化在容差以内就认为收敛
+            if (std::fabs(new_chi2 - chi2) <= options_.function_tolerance * chi2) {
+                summary.converged = true;
+                break;
+            }
+            lambda *= 10.0;
+            continue;
+        }
+        const double relative = (chi2 - new_chi2) / std::max(chi2, 1e-300);
+        for (int j = 0; j < n; ++j) {
+            const int v = sym.vertex_of_column[j];
+            vertices[v] = candidate[v];
+        }
+        chi2 = new_chi2;
+        improved = true;
+        lambda = std::max(lambda / 10.0, 1e-12);
+        if (relative < options_.function_tolerance) {
+            summary.converged = true;
+            break;
+        }
+        t0 = Clock::now();
+        evaluate(vertices, true);
+        summary.linearize_ms += elapsedMs(t0);
+    }
+    summary.final_chi2 = chi2;
+    return improved || summary.converged;
+}
+
+}  // namespace slam
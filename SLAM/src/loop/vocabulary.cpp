@@ -0,0 +1,479 @@
+#include "loop/vocabulary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+#include "frontend/hamming_matcher.h"
+#include "utils/profiler.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr int kMaxBranching = 64;
+constexpr std::uint32_t kNotWord = 0xffffffffu;
+constexpr char kMagic[8] = {'S', 'L', 'A', 'M', 'V', 'O', 'C', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint64_t kSectionAlign = 64;
+constexpr int kDescriptorsPerTask = 1024;
+
+// 二进制文件头；各段依次为 描述子、first_child、num_children、word_of_node、idf
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t branching;
+    std::uint32_t levels;
+    std::uint32_t num_nodes;
+    std::uint32_t num_words;
+    std::uint32_t reserved;
+    std::uint64_t offsets[5];
+};
+
+std::uint64_t alignUp(std::uint64_t x) { return (x + kSectionAlign - 1) / kSectionAlign * kSectionAlign; }
+
+// 把 [0, n) 分块交给线程池；pool 为空时在调用线程上顺序执行
+template <typename Fn>
+void forChunks(ThreadPool* pool, int n, int chunk, const Fn& fn) {
+    const int n_tasks = (n + chunk - 1) / chunk;
+    if (!pool || n_tasks <= 1) {
+        for (int t = 0; t < n_tasks; ++t) fn(t * chunk, std::min(n, (t + 1) * chunk), 0);
+        return;
+    }
+    pool->parallelFor(n_tasks, [&](int task, int thread_id) {
+        fn(task * chunk, std::min(n, (task + 1) * chunk), thread_id);
+    });
+}
+
+struct NodeClusters {
+    std::vector<Descriptor> centers;
+    std::vector<std::vector<int>> members;
+};
+
+// 一个节点的 k-majority 聚类：k-means++ 初始化，分配用 hammingDistances 一次算 k 个中心，
+// 中心按位多数表决；pool 非空时分配和按位计数在成员上并行（只有少数大节点时用）
+void clusterNode(const std::vector<Descriptor>& all, const std::vector<int>& members, int k, int max_iterations,
+                 std::uint32_t seed, ThreadPool* pool, NodeClusters& out) {
+    out.centers.clear();
+    out.members.clear();
+    const int n = static_cast<int>(members.size());
+    if (n <= 1) return;
+    if (n <= k) {
+        // 描述子比分支数还少：每个描述子单独成为一个子节点（DBoW2 的做法）
+        for (int m : members) {
+            out.centers.push_back(all[m]);
+            out.members.push_back({m});
+        }
+        return;
+    }
+
+    std::mt19937 rng(seed);
+    out.centers.push_back(all[members[rng() % n]]);
+    std::vector<double> d2(n);
+    for (int i = 0; i < n; ++i) {
+        const double d = hammingDistance(all[members[i]], out.centers[0]);
+        d2[i] = d * d;
+    }
+    while (static_cast<int>(out.centers.size()) < k) {
+        // 成员全部和已有中心重合时权重全为 0，discrete_distribution 未定义，改为均匀选取
+        int chosen = 0;
+        if (std::any_of(d2.begin(), d2.end(), [](double w) { return w > 0.0; })) {
+            std::discrete_distribution<int> pick(d2.begin(), d2.end());
+            chosen = pick(rng);
+        } else {
+            chosen = static_cast<int>(rng() % n);
+        }
+        const Descriptor& c = all[members[chosen]];
+        out.centers.push_back(c);
+        for (int i = 0; i < n; ++i) {
+            const double d = hammingDistance(all[members[i]], c);
+            d2[i] = std::min(d2[i], d * d);
+        }
+    }
+
+    const int n_threads = pool ? pool->size() : 1;
+    std::vector<int> assignment(n, -1);
+    std::vector<std::vector<int>> bit_counts(n_threads, std::vector<int>(static_cast<size_t>(k) * 256));
+    std::vector<int> cluster_sizes(static_cast<size_t>(n_threads) * k);
+    std::vector<char> changed(n_threads);
+    for (int it = 0; it < max_iterations; ++it) {
+        for (auto& counts : bit_counts) std::fill(counts.begin(), counts.end(), 0);
+        std::fill(cluster_sizes.begin(), cluster_sizes.end(), 0);
+        std::fill(changed.begin(), changed.end(), 0);
+        forChunks(pool, n, kDescriptorsPerTask, [&](int begin, int end, int thread_id) {
+            int dist[kMaxBranching];
+            int* counts = bit_counts[thread_id].data();
+            for (int i = begin; i < end; ++i) {
+                const Descriptor& d = all[members[i]];
+                hammingDistances(d, out.centers.data(), k, dist);
+                const int best = static_cast<int>(std::min_element(dist, dist + k) - dist);
+                if (assignment[i] != best) changed[thread_id] = 1;
+                assignment[i] = best;
+                ++cluster_sizes[thread_id * k + best];
+                int* c = counts + best * 256;
+                for (int w = 0; w < 4; ++w) {
+                    for (int b = 0; b < 64; ++b) c[w * 64 + b] += static_cast<int>((d.words[w] >> b) & 1u);
+                }
+            }
+        });
+        if (std::find(changed.begin(), changed.end(), 1) == changed.end()) break;
+
+        for (int c = 0; c < k; ++c) {
+            int size = 0;
+            for (int t = 0; t < n_threads; ++t) size += cluster_sizes[t * k + c];
+            if (size == 0) continue;    // 空簇保留旧中心
+            Descriptor center;
+            for (int bit = 0; bit < 256; ++bit) {
+                int ones = 0;
+                for (int t = 0; t < n_threads; ++t) ones += bit_counts[t][c * 256 + bit];
+                if (2 * ones > size) center.words[bit / 64] |= std::uint64_t{1} << (bit % 64);
+            }
+            out.centers[c] = center;
+        }
+    }
+
+    // 丢掉空簇
+    std::vector<std::vector<int>> groups(k);
+    for (int i = 0; i < n; ++i) groups[assignment[i]].push_back(members[i]);
+    std::vector<Descriptor> centers;
+    for (int c = 0; c < k; ++c) {
+        if (groups[c].empty()) continue;
+        centers.push_back(out.centers[c]);
+        out.members.push_back(std::move(groups[c]));
+    }
+    out.centers = std::move(centers);
+}
+
+}  // namespace
+
+void Vocabulary::clear() {
+    branching_ = levels_ = num_nodes_ = num_words_ = 0;
+    descriptors_ = nullptr;
+    first_child_ = num_children_ = word_of_node_ = nullptr;
+    idf_ = nullptr;
+    owned_descriptors_.clear();
+    owned_first_child_.clear();
+    owned_num_children_.clear();
+    owned_word_of_node_.clear();
+    owned_idf_.clear();
+    file_.close();
+}
+
+void Vocabulary::bindOwned() {
+    num_nodes_ = static_cast<int>(owned_descriptors_.size());
+    num_words_ = static_cast<int>(owned_idf_.size());
+    descriptors_ = owned_descriptors_.data();
+    first_child_ = owned_first_child_.data();
+    num_children_ = owned_num_children_.data();
+    word_of_node_ = owned_word_of_node_.data();
+    idf_ = owned_idf_.data();
+}
+
+bool Vocabulary::train(const std::vector<std::vector<Descriptor>>& images, const VocabularyTrainOptions& options,
+                       ThreadPool* pool) {
+    clear();
+    if (options.branching < 2 || options.branching > kMaxBranching || options.levels < 1) return false;
+    if (!pool) pool = &ThreadPool::global();
+
+    std::vector<Descriptor> all;
+    for (const auto& image : images) all.insert(all.end(), image.begin(), image.end());
+    if (all.empty()) return false;
+
+    branching_ = options.branching;
+    levels_ = options.levels;
+    owned_descriptors_.assign(1, Descriptor());
+    owned_first_child_.assign(1, 0);
+    owned_num_children_.assign(1, 0);
+
+    // 逐层聚类：frontier 是当前层的节点，子节点按 frontier 的顺序追加，所以节点下标就是层序
+    std::vector<std::uint32_t> frontier{0};
+    std::vector<std::vector<int>> frontier_members(1);
+    frontier_members[0].resize(all.size());
+    for (size_t i = 0; i < all.size(); ++i) frontier_members[0][i] = static_cast<int>(i);
+
+    for (int level = 0; level < levels_ && !frontier.empty(); ++level) {
+        const int n_nodes = static_cast<int>(frontier.size());
+        std::vector<NodeClusters> clusters(n_nodes);
+        const auto node_seed = [&](int i) { return options.seed + 7919u * frontier[i]; };
+        if (n_nodes < pool->size()) {
+            // 节点少（靠近根）时每个节点内部并行
+            for (int i = 0; i < n_nodes; ++i) {
+                clusterNode(all, frontier_members[i], branching_, options.max_iterations, node_seed(i), pool,
+                            clusters[i]);
+            }
+        } else {
+            pool->parallelFor(n_nodes, [&](int i, int) {
+                clusterNode(all, frontier_members[i], branching_, options.max_iterations, node_seed(i), nullptr,
+                            clusters[i]);
+            });
+        }
+
+        std::vector<std::uint32_t> next;
+        std::vector<std::vector<int>> next_members;
+        for (int i = 0; i < n_nodes; ++i) {
+            NodeClusters& c = clusters[i];
+            if (c.centers.empty()) continue;
+            owned_first_child_[frontier[i]] = static_cast<std::uint32_t>(owned_descriptors_.size());
+            owned_num_children_[frontier[i]] = static_cast<std::uint32_t>(c.centers.size());
+            for (size_t j = 0; j < c.centers.size(); ++j) {
+                next.push_back(static_cast<std::uint32_t>(owned_descriptors_.size()));
+                next_members.push_back(std::move(c.members[j]));
+                owned_descriptors_.push_back(c.centers[j]);
+                owned_first_child_.push_back(0);
+                owned_num_children_.push_back(0);
+            }
+        }
+        frontier = std::move(next);
+        frontier_members = std::move(next_members);
+    }
+
+    // 没有子节点的就是单词，按层序编号
+    owned_word_of_node_.assign(owned_descriptors_.size(), kNotWord);
+    std::uint32_t n_words = 0;
+    for (size_t i = 0; i < owned_descriptors_.size(); ++i) {
+        if (owned_num_children_[i] == 0) owned_word_of_node_[i] = n_words++;
+    }
+    owned_idf_.assign(n_words, 0.f);
+    bindOwned();
+
+    // IDF：每个单词出现在多少幅训练图像中；训练中没有出现的单词权重为 0
+    const int n_images = static_cast<int>(images.size());
+    std::vector<std::vector<std::uint32_t>> image_words(n_images);
+    pool->parallelFor(n_images, [&](int i, int) {
+        std::vector<std::uint32_t>& words = image_words[i];
+        for (const Descriptor& d : images[i]) words.push_back(wordId(d));
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+    });
+    std::vector<int> occurrences(n_words, 0);
+    for (const auto& words : image_words) {
+        for (std::uint32_t w : words) ++occurrences[w];
+    }
+    for (std::uint32_t w = 0; w < n_words; ++w) {
+        if (occurrences[w] > 0) owned_idf_[w] = static_cast<float>(std::log(double(n_images) / occurrences[w]));
+    }
+    return true;
+}
+
+bool Vocabulary::loadText(const std::string& path) {
+    clear();
+    std::ifstream in(path);
+    if (!in) return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    const char* p = text.c_str();
+    char* end = nullptr;
+    const auto next_long = [&](long& value) {
+        value = std::strtol(p, &end, 10);
+        if (end == p) return false;
+        p = end;
+        return true;
+    };
+    long k = 0, levels = 0, scoring = 0, weighting = 0;
+    if (!next_long(k) || !next_long(levels) || !next_long(scoring) || !next_long(weighting)) return false;
+    if (k < 2 || k > kMaxBranching || levels < 1) return false;
+
+    // 文件里节点 i（从 1 开始）每行一个：父节点、是否叶子、32 个字节、权重
+    std::vector<std::uint32_t> parent{0};
+    std::vector<Descriptor> descriptors{Descriptor()};
+    std::vector<float> weights{0.f};
+    std::vector<char> is_leaf{0};
+    for (;;) {
+        long parent_id = 0, leaf = 0;
+        if (!next_long(parent_id)) break;
+        if (!next_long(leaf)) return false;
+        Descriptor d;
+        for (int b = 0; b < 32; ++b) {
+            long byte = 0;
+            if (!next_long(byte)) return false;
+            d.words[b / 8] |= static_cast<std::uint64_t>(byte & 0xff) << (8 * (b % 8));
+        }
+        const double weight = std::strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+        if (parent_id < 0 || parent_id >= static_cast<long>(parent.size())) return false;
+        parent.push_back(static_cast<std::uint32_t>(parent_id));
+        is_leaf.push_back(leaf != 0);
+        descriptors.push_back(d);
+        weights.push_back(static_cast<float>(weight));
+    }
+
+    // 按层序重排：同一父节点的子节点保持文件中的顺序
+    const size_t n = parent.size();
+    if (n < 2) return false;
+    std::vector<std::uint32_t> child_begin(n + 1, 0), children(n);
+    for (size_t i = 1; i < n; ++i) ++child_begin[parent[i] + 1];
+    for (size_t i = 0; i < n; ++i) child_begin[i + 1] += child_begin[i];
+    {
+        std::vector<std::uint32_t> fill(child_begin.begin(), child_begin.end() - 1);
+        for (size_t i = 1; i < n; ++i) children[fill[parent[i]]++] = static_cast<std::uint32_t>(i);
+    }
+    std::vector<std::uint32_t> order{0};
+    order.reserve(n);
+    owned_descriptors_.reserve(n);
+    for (size_t q = 0; q < order.size(); ++q) {
+        const std::uint32_t node = order[q];
+        const std::uint32_t count = child_begin[node + 1] - child_begin[node];
+        if (count > static_cast<std::uint32_t>(kMaxBranching)) return false;
+        owned_descriptors_.push_back(descriptors[node]);
+        owned_first_child_.push_back(count ? static_cast<std::uint32_t>(order.size()) : 0);
+        owned_num_children_.push_back(count);
+        order.insert(order.end(), children.begin() + child_begin[node], children.begin() + child_begin[node + 1]);
+    }
+    owned_word_of_node_.assign(owned_descriptors_.size(), kNotWord);
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (owned_num_children_[i] == 0 && i > 0) {
+            owned_word_of_node_[i] = static_cast<std::uint32_t>(owned_idf_.size());
+            owned_idf_.push_back(weights[order[i]]);
+        }
+    }
+    branching_ = static_cast<int>(k);
+    levels_ = static_cast<int>(levels);
+    bindOwned();
+    return true;
+}
+
+bool Vocabulary::save(const std::string& path) const {
+    if (empty()) return false;
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.branching = static_cast<std::uint32_t>(branching_);
+    header.levels = static_cast<std::uint32_t>(levels_);
+    header.num_nodes = static_cast<std::uint32_t>(num_nodes_);
+    header.num_words = static_cast<std::uint32_t>(num_words_);
+
+    const void* sections[5] = {descriptors_, first_child_, num_children_, word_of_node_, idf_};
+    const std::uint64_t sizes[5] = {
+        sizeof(Descriptor) * std::uint64_t(num_nodes_), sizeof(std::uint32_t) * std::uint64_t(num_nodes_),
+        sizeof(std::uint32_t) * std::uint64_t(num_nodes_), sizeof(std::uint32_t) * std::uint64_t(num_nodes_),
+        sizeof(float) * std::uint64_t(num_words_)};
+    std::uint64_t offset = alignUp(sizeof(FileHeader));
+    for (int s = 0; s < 5; ++s) {
+        header.offsets[s] = offset;
+        offset = alignUp(offset + sizes[s]);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    const char zeros[kSectionAlign] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t written = sizeof(header);
+    for (int s = 0; s < 5; ++s) {
+        out.write(zeros, static_cast<std::streamsize>(header.offsets[s] - written));
+        out.write(static_cast<const char*>(sections[s]), static_cast<std::streamsize>(sizes[s]));
+        written = header.offsets[s] + sizes[s];
+    }
+    return static_cast<bool>(out);
+}
+
+bool Vocabulary::load(const std::string& path) {
+    clear();
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(FileHeader)) return false;
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) return false;
+    if (header.branching < 2 || header.branching > static_cast<std::uint32_t>(kMaxBranching)) return false;
+
+    const std::uint32_t max_count = static_cast<std::uint32_t>(std::numeric_limits<int>::max());
+    if (header.num_nodes == 0 || header.num_nodes > max_count || header.num_words > max_count) return false;
+    const std::uint64_t sizes[5] = {
+        sizeof(Descriptor) * std::uint64_t(header.num_nodes), sizeof(std::uint32_t) * std::uint64_t(header.num_nodes),
+        sizeof(std::uint32_t) * std::uint64_t(header.num_nodes),
+        sizeof(std::uint32_t) * std::uint64_t(header.num_nodes), sizeof(float) * std::uint64_t(header.num_words)};
+    for (int s = 0; s < 5; ++s) {
+        // 用减法比较，避免 offset + size 在 uint64 上回绕
+        if (header.offsets[s] % kSectionAlign != 0 || header.offsets[s] > file.size() ||
+            sizes[s] > file.size() - header.offsets[s]) {
+            return false;
+        }
+    }
+
+    // 节点表逐个校验（只读子节点表和单词表，描述子仍然按需分页）：子节点区间在节点数以内且都在
+    // 父节点之后（层序），所以下降一定会终止；单词节点的 id 小于单词数
+    const std::uint8_t* data = file.data();
+    const auto* first_child = reinterpret_cast<const std::uint32_t*>(data + header.offsets[1]);
+    const auto* num_children = reinterpret_cast<const std::uint32_t*>(data + header.offsets[2]);
+    const auto* word_of_node = reinterpret_cast<const std::uint32_t*>(data + header.offsets[3]);
+    for (std::uint32_t i = 0; i < header.num_nodes; ++i) {
+        const std::uint32_t count = num_children[i];
+        if (count == 0) {
+            if (word_of_node[i] >= header.num_words) return false;
+            continue;
+        }
+        if (count > header.branching || first_child[i] <= i || first_child[i] > header.num_nodes ||
+            count > header.num_nodes - first_child[i]) {
+            return false;
+        }
+    }
+
+    const std::uint8_t* base = file.data();
+    descriptors_ = reinterpret_cast<const Descriptor*>(base + header.offsets[0]);
+    first_child_ = reinterpret_cast<const std::uint32_t*>(base + header.offsets[1]);
+    num_children_ = reinterpret_cast<const std::uint32_t*>(base + header.offsets[2]);
+    word_of_node_ = reinterpret_cast<const std::uint32_t*>(base + header.offsets[3]);
+    idf_ = reinterpret_cast<const float*>(base + header.offsets[4]);
+    branching_ = static_cast<int>(header.branching);
+    levels_ = static_cast<int>(header.levels);
+    num_nodes_ = static_cast<int>(header.num_nodes);
+    num_words_ = static_cast<int>(header.num_words);
+    // 下降路径是随机的，关闭预读避免读入用不到的页面
+    file.adviseRandom();
+    file_ = std::move(file);
+    return true;
+}
+
+std::uint32_t Vocabulary::wordId(const Descriptor& descriptor) const {
+    std::uint32_t node = 0;
+    int dist[kMaxBranching];
+    while (num_children_[node] > 0) {
+        const std::uint32_t first = first_child_[node];
+        const int n = static_cast<int>(num_children_[node]);
+        hammingDistances(descriptor, descriptors_ + first, n, dist);
+        node = first + static_cast<std::uint32_t>(std::min_element(dist, dist + n) - dist);
+    }
+    return word_of_node_[node];
+}
+
+void Vocabulary::transform(const Descriptor* descriptors, int n, BowVector& bow, std::uint32_t* word_ids,
+                           ThreadPool* pool) const {
+    SLAM_PROFILE_SCOPE("loop/bow_transform");
+    bow.clear();
+    if (empty() || n <= 0) return;
+
+    std::vector<std::uint32_t> words(n);
+    forChunks(pool, n, kDescriptorsPerTask / 4, [&](int begin, int end, int) {
+        for (int i = begin; i < end; ++i) words[i] = wordId(descriptors[i]);
+    });
+    if (word_ids) std::copy(words.begin(), words.end(), word_ids);
+
+    // TF-IDF：tf = 单词出现次数 / 描述子数，再做 L1 归一化
+    std::sort(words.begin(), words.end());
+    double total = 0.0;
+    for (int i = 0; i < n;) {
+        int j = i + 1;
+        while (j < n && words[j] == words[i]) ++j;
+        const float weight = idf_[words[i]] * static_cast<float>(j - i) / static_cast<float>(n);
+        if (weight > 0.f) {
+            bow.push_back({words[i], weight});
+            total += weight;
+        }
+        i = j;
+    }
+    if (total > 0.0) {
+        const float inv = static_cast<float>(1.0 / total);
+        for (BowEntry& e : bow) e.weight *= inv;
+    }
+}
+
+}  // namespace slam
@@ -0,0 +1,190 @@
+#include "mapping/keyframe_database.h"
+
+#include <algorithm>
+
+namespace slam {
+
+namespace {
+
+// 权重降序，同权重按 id 升序（结果确定）
+bool heavier(const CovisibilityEdge& a, const CovisibilityEdge& b) {
+    return a.weight > b.weight || (a.weight == b.weight && a.keyframe < b.keyframe);
+}
+
+}  // namespace
+
+KeyFrameDatabase::~KeyFrameDatabase() {
+    // 析构时不应再有读者
+    for (std::atomic<Chunk*>& c : chunks_) {
+        Chunk* chunk = c.load();
+        if (!chunk) continue;
+        for (Entry& e : chunk->entries) {
+            delete e.keyframe.load();
+            delete e.pose.load();
+            delete e.edges.load();
+        }
+        delete chunk;
+    }
+}
+
+const KeyFrameDatabase::Entry* KeyFrameDatabase::entry(int id) const {
+    if (id < 0 || id >= next_id_.load(std::memory_order_acquire)) return nullptr;
+    const Chunk* chunk = chunks_[id >> kChunkBits].load(std::memory_order_acquire);
+    return chunk ? &chunk->entries[id & (kChunkSize - 1)] : nullptr;
+}
+
+KeyFrameDatabase::Entry* KeyFrameDatabase::entryForWrite(int id) {
+    return const_cast<Entry*>(entry(id));
+}
+
+const KeyFrame* KeyFrameDatabase::keyframe(int id) const {
+    const Entry* e = entry(id);
+    return e ? e->keyframe.load(std::memory_order_acquire) : nullptr;
+}
+
+const KeyFramePose* KeyFrameDatabase::pose(int id) const {
+    const Entry* e = entry(id);
+    return e ? e->pose.load(std::memory_order_acquire) : nullptr;
+}
+
+CovisibilitySpan KeyFrameDatabase::covisibles(int id) const {
+    const Entry* e = entry(id);
+    const EdgeList* edges = e ? e->edges.load(std::memory_order_acquire) : nullptr;
+    if (!edges) return CovisibilitySpan();
+    return {edges->data(), static_cast<int>(edges->size())};
+}
+
+CovisibilitySpan KeyFrameDatabase::bestCovisibles(int id, int n) const {
+    CovisibilitySpan span = covisibles(id);
+    span.size = std::max(0, std::min(span.size, n));
+    return span;
+}
+
+CovisibilitySpan KeyFrameDatabase::covisiblesAbove(int id, int min_weight) const {
+    CovisibilitySpan span = covisibles(id);
+    span.size = static_cast<int>(std::partition_point(span.begin(), span.end(),
+                                                      [min_weight](const CovisibilityEdge& e) {
+                                                          return e.weight >= min_weight;
+                                                      }) -
+                                 span.begin());
+    return span;
+}
+
+int KeyFrameDatabase::weight(int id, int other) const {
+    for (const CovisibilityEdge& e : covisibles(id)) {
+        if (e.keyframe == other) return e.weight;
+    }
+    return 0;
+}
+
+int KeyFrameDatabase::add(KeyFrame keyframe, const KeyFramePose& pose) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const int id = next_id_.load(std::memory_order_relaxed);
+    const int c = id >> kChunkBits;
+    if (c >= kMaxChunks) return -1;
+    if (!chunks_[c].load(std::memory_order_relaxed)) chunks_[c].store(new Chunk, std::memory_order_release);
+    Entry& e = chunks_[c].load(std::memory_order_relaxed)->entries[id & (kChunkSize - 1)];
+    keyframe.id = id;
+    e.keyframe.store(new KeyFrame(std::move(keyframe)), std::memory_order_release);
+    e.pose.store(new KeyFramePose(pose), std::memory_order_release);
+    e.edges.store(new EdgeList(), std::memory_order_release);
+    // 条目写好之后才让读者看到这个 id
+    next_id_.store(id + 1, std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void KeyFrameDatabase::publishEdges(Entry* e, EdgeList* edges) {
+    reclaimer_.retire(e->edges.exchange(edges, std::memory_order_acq_rel));
+}
+
+void KeyFrameDatabase::setEdge(int id, int other, int weight) {
+    Entry* e = entryForWrite(id);
+    const EdgeList* old = e ? e->edges.load(std::memory_order_relaxed) : nullptr;
+    if (!old) return;
+    auto* edges = new EdgeList();
+    edges->reserve(old->size() + 1);
+    for (const CovisibilityEdge& x : *old) {
+        if (x.keyframe != other) edges->push_back(x);
+    }
+    if (weight > 0) {
+        const CovisibilityEdge edge{other, weight};
+        edges->insert(std::upper_bound(edges->begin(), edges->end(), edge, heavier), edge);
+    }
+    publishEdges(e, edges);
+}
+
+bool KeyFrameDatabase::erase(int id) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Entry* e = entryForWrite(id);
+    if (!e || !e->keyframe.load(std::memory_order_relaxed)) return false;
+    const EdgeList* edges = e->edges.exchange(nullptr, std::memory_order_acq_rel);
+    for (const CovisibilityEdge& x : *edges) setEdge(x.keyframe, id, 0);
+    reclaimer_.retire(edges);
+    reclaimer_.retire(e->keyframe.exchange(nullptr, std::memory_order_acq_rel));
+    reclaimer_.retire(e->pose.exchange(nullptr, std::memory_order_acq_rel));
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    reclaimer_.reclaim();
+    return true;
+}
+
+bool KeyFrameDatabase::setPose(int id, const KeyFramePose& pose) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Entry* e = entryForWrite(id);
+    if (!e || !e->keyframe.load(std::memory_order_relaxed)) return false;
+    reclaimer_.retire(e->pose.exchange(new KeyFramePose(pose), std::memory_order_acq_rel));
+    reclaimer_.reclaim();
+    return true;
+}
+
+void KeyFrameDatabase::setPoses(const std::vector<int>& ids, const std::vector<KeyFramePose>& poses) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const size_t n = std::min(ids.size(), poses.size());
+    std::vector<const KeyFramePose*> old;
+    old.reserve(n);
+    for (size_t k = 0; k < n; ++k) {
+        Entry* e = entryForWrite(ids[k]);
+        if (!e || !e->keyframe.load(std::memory_order_relaxed)) continue;
+        old.push_back(e->pose.exchange(new KeyFramePose(poses[k]), std::memory_order_acq_rel));
+    }
+    // 全部替换完再 retire：整批只需要读者离开一次
+    for (const KeyFramePose* p : old) reclaimer_.retire(p);
+    reclaimer_.reclaim();
+}
+
+bool KeyFrameDatabase::updateConnections(int id, const std::vector<CovisibilityEdge>& edges) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Entry* e = entryForWrite(id);
+    if (!e || !e->keyframe.load(std::memory_order_relaxed)) return false;
+
+    auto* list = new EdgeList();
+    list->reserve(edges.size());
+    for (const CovisibilityEdge& x : edges) {
+        if (x.weight > 0 && x.keyframe != id && keyframe(x.keyframe)) list->push_back(x);
+    }
+    std::sort(list->begin(), list->end(), [](const CovisibilityEdge& a, const CovisibilityEdge& b) {
+        return a.keyframe < b.keyframe || (a.keyframe == b.keyframe && a.weight > b.weight);
+    });
+    list->erase(std::unique(list->begin(), list->end(),
+                            [](const CovisibilityEdge& a, const CovisibilityEdge& b) { return a.keyframe == b.keyframe; }),
+                list->end());
+
+    // 邻居一侧：旧邻居里不再相连的删掉，新邻居更新权重
+    const EdgeList* old = e->edges.load(std::memory_order_relaxed);
+    for (const CovisibilityEdge& x : *old) {
+        const bool kept = std::binary_search(list->begin(), list->end(), x,
+                                             [](const CovisibilityEdge& a, const CovisibilityEdge& b) {
+                                                 return a.keyframe < b.keyframe;
+                                             });
+        if (!kept) setEdge(x.keyframe, id, 0);
+    }
+    for (const CovisibilityEdge& x : *list) {
+        if (weight(x.keyframe, id) != x.weight) setEdge(x.keyframe, id, x.weight);
+    }
+    std::sort(list->begin(), list->end(), heavier);
+    publishEdges(e, list);
+    reclaimer_.reclaim();
+    return true;
+}
+
+}  // namespace slam
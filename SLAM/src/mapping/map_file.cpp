@@ -0,0 +1,523 @@
+#include "mapping/map_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace slam {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'L', 'A', 'M', 'M', 'A', 'P', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint64_t kSectionAlign = 64;
+
+// 各段的顺序
+enum Section {
+    kKeyFrameIds,           // int32[K]
+    kTimestamps,            // double[K]
+    kPoses,                 // RigidPosed[K]，T_cw
+    kFeatureOffsets,        // uint32[K + 1]
+    kKeyPoints,             // KeyPoint[F]
+    kDescriptors,           // Descriptor[F]
+    kFeaturePoints,         // int32[F]
+    kPointIds,              // int32[P]
+    kPositions,             // Vector3d[P]
+    kPointDescriptors,      // Descriptor[P]
+    kObservationOffsets,    // uint32[P + 1]
+    kObservations,          // MapObservation[O]
+    kCovisibilityOffsets,   // uint32[K + 1]
+    kCovisibility,          // CovisibilityEdge[E]
+    kKeyFrameIndex,         // MapIdIndex[K]
+    kPointIndex,            // MapIdIndex[P]
+    kRegions,               // MapRegion[R]
+    kNumSections
+};
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_keyframes;
+    std::uint32_t num_points;
+    std::uint32_t num_features;
+    std::uint32_t num_observations;
+    std::uint32_t num_edges;
+    std::uint32_t num_regions;
+    std::uint32_t reserved;
+    double region_size;
+    std::uint64_t offsets[kNumSections];
+};
+
+// 各段直接按内存布局读写，布局变了必须改版本号
+static_assert(sizeof(KeyPoint) == 20, "map file layout");
+static_assert(sizeof(Descriptor) == 32, "map file layout");
+static_assert(sizeof(RigidPosed) == 56, "map file layout");
+static_assert(sizeof(Eigen::Vector3d) == 24, "map file layout");
+static_assert(sizeof(CovisibilityEdge) == 8, "map file layout");
+static_assert(sizeof(MapObservation) == 8 && sizeof(MapIdIndex) == 8, "map file layout");
+static_assert(sizeof(MapRegion) == 28, "map file layout");
+
+std::uint64_t alignUp(std::uint64_t x) { return (x + kSectionAlign - 1) / kSectionAlign * kSectionAlign; }
+
+void sectionSizes(const FileHeader& h, std::uint64_t sizes[kNumSections]) {
+    const std::uint64_t k = h.num_keyframes, p = h.num_points, f = h.num_features;
+    sizes[kKeyFrameIds] = sizeof(std::int32_t) * k;
+    sizes[kTimestamps] = sizeof(double) * k;
+    sizes[kPoses] = sizeof(RigidPosed) * k;
+    sizes[kFeatureOffsets] = sizeof(std::uint32_t) * (k + 1);
+    sizes[kKeyPoints] = sizeof(KeyPoint) * f;
+    sizes[kDescriptors] = sizeof(Descriptor) * f;
+    sizes[kFeaturePoints] = sizeof(std::int32_t) * f;
+    sizes[kPointIds] = sizeof(std::int32_t) * p;
+    sizes[kPositions] = sizeof(Eigen::Vector3d) * p;
+    sizes[kPointDescriptors] = sizeof(Descriptor) * p;
+    sizes[kObservationOffsets] = sizeof(std::uint32_t) * (p + 1);
+    sizes[kObservations] = sizeof(MapObservation) * std::uint64_t(h.num_observations);
+    sizes[kCovisibilityOffsets] = sizeof(std::uint32_t) * (k + 1);
+    sizes[kCovisibility] = sizeof(CovisibilityEdge) * std::uint64_t(h.num_edges);
+    sizes[kKeyFrameIndex] = sizeof(MapIdIndex) * k;
+    sizes[kPointIndex] = sizeof(MapIdIndex) * p;
+    sizes[kRegions] = sizeof(MapRegion) * std::uint64_t(h.num_regions);
+}
+
+struct Cell {
+    std::int32_t v[3];
+
+    bool operator<(const Cell& o) const { return std::lexicographical_compare(v, v + 3, o.v, o.v + 3); }
+    bool operator==(const Cell& o) const { return v[0] == o.v[0] && v[1] == o.v[1] && v[2] == o.v[2]; }
+};
+
+Cell cellOf(const Eigen::Vector3d& p, double inv_size) {
+    Cell c;
+    for (int i = 0; i < 3; ++i) {
+        const double f = std::floor(p[i] * inv_size);
+        c.v[i] = static_cast<std::int32_t>(std::max(-1e9, std::min(1e9, f)));
+    }
+    return c;
+}
+
+// 按区域稳定排序后的下标顺序
+std::vector<int> sortByCell(const std::vector<Cell>& cells) {
+    std::vector<int> order(cells.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return cells[a] < cells[b]; });
+    return order;
+}
+
+std::vector<MapIdIndex> buildIndex(const std::vector<std::int32_t>& ids) {
+    std::vector<MapIdIndex> index(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) index[i] = {ids[i], static_cast<std::int32_t>(i)};
+    std::sort(index.begin(), index.end(), [](const MapIdIndex& a, const MapIdIndex& b) { return a.id < b.id; });
+    return index;
+}
+
+// CSR 偏移表：从 0 开始、单调不减、末项等于元素总数
+bool validOffsets(const std::uint32_t* offsets, std::uint32_t n, std::uint32_t total) {
+    if (offsets[0] != 0 || offsets[n] != total) return false;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (offsets[i] > offsets[i + 1]) return false;
+    }
+    return true;
+}
+
+// id 索引：下标在 [0, n) 内、按 id 严格升序（findId 用二分查找）
+bool validIndex(const MapIdIndex* index, std::uint32_t n) {
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (index[i].index < 0 || static_cast<std::uint32_t>(index[i].index) >= n) return false;
+        if (i > 0 && index[i - 1].id >= index[i].id) return false;
+    }
+    return true;
+}
+
+// 点到网格单元（轴对齐立方体）的距离平方
+double cellDistanceSq(const MapRegion& r, const Eigen::Vector3d& p, double size) {
+    double d2 = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        const double lo = r.cell[i] * size, hi = lo + size;
+        const double d = p[i] < lo ? lo - p[i] : (p[i] > hi ? p[i] - hi : 0.0);
+        d2 += d * d;
+    }
+    return d2;
+}
+
+}  // namespace
+
+MapWriter::MapWriter(double region_size) : region_size_(region_size > 0.0 ? region_size : 50.0) {}
+
+void MapWriter::addKeyFrame(const KeyFrame& keyframe, const RigidPosed& T_cw,
+                            const std::vector<CovisibilityEdge>& covisibles) {
+    PendingKeyFrame kf;
+    kf.id = keyframe.id;
+    kf.timestamp = keyframe.timestamp;
+    kf.T_cw = T_cw;
+    kf.keypoints = keyframe.keypoints;
+    kf.descriptors = keyframe.descriptors;
+    kf.map_points = keyframe.map_points;
+    kf.covisibles = covisibles;
+    // 特征点、描述子、地图点三个数组按特征一一对应，长度不一致时取最短的
+    const std::size_t n = std::min({kf.keypoints.size(), kf.descriptors.size(), kf.map_points.size()});
+    kf.keypoints.resize(n);
+    kf.descriptors.resize(n);
+    kf.map_points.resize(n);
+    keyframes_.push_back(std::move(kf));
+}
+
+void MapWriter::addKeyFrames(KeyFrameDatabase& database) {
+    auto guard = database.read();
+    const int bound = database.idBound();
+    for (int id = 0; id < bound; ++id) {
+        const KeyFrame* keyframe = database.keyframe(id);
+        const KeyFramePose* pose = database.pose(id);
+        if (!keyframe || !pose) continue;
+        const CovisibilitySpan edges = database.covisibles(id);
+        addKeyFrame(*keyframe, RigidPosed(pose->R_cw, pose->t_cw),
+                    std::vector<CovisibilityEdge>(edges.begin(), edges.end()));
+    }
+}
+
+void MapWriter::addMapPoint(int id, const Eigen::Vector3d& position, const Descriptor& descriptor) {
+    PendingPoint point;
+    point.id = id;
+    point.position = position;
+    point.descriptor = descriptor;
+    points_.push_back(point);
+}
+
+void MapWriter::clear() {
+    keyframes_.clear();
+    points_.clear();
+}
+
+bool MapWriter::save(const std::string& path) const {
+    const double inv_size = 1.0 / region_size_;
+
+    // 按 id 去重（保留先加入的），再按区域排序
+    std::vector<int> kf_source, point_source;
+    {
+        std::unordered_map<int, int> seen;
+        for (int i = 0; i < static_cast<int>(keyframes_.size()); ++i) {
+            if (seen.emplace(keyframes_[i].id, i).second) kf_source.push_back(i);
+        }
+        seen.clear();
+        for (int i = 0; i < static_cast<int>(points_.size()); ++i) {
+            if (seen.emplace(points_[i].id, i).second) point_source.push_back(i);
+        }
+    }
+    std::vector<Cell> kf_cells(kf_source.size()), point_cells(point_source.size());
+    for (std::size_t i = 0; i < kf_source.size(); ++i) {
+        // 相机中心 C = -R_cw^T t_cw
+        kf_cells[i] = cellOf(keyframes_[kf_source[i]].T_cw.inverseTransform(Eigen::Vector3d::Zero()), inv_size);
+    }
+    for (std::size_t i = 0; i < point_source.size(); ++i) {
+        point_cells[i] = cellOf(points_[point_source[i]].position, inv_size);
+    }
+    const std::vector<int> kf_order = sortByCell(kf_cells);
+    const std::vector<int> point_order = sortByCell(point_cells);
+    const int num_kf = static_cast<int>(kf_order.size());
+    const int num_points = static_cast<int>(point_order.size());
+
+    // 区域表：两个有序的单元序列归并
+    std::vector<MapRegion> regions;
+    for (int a = 0, b = 0; a < num_kf || b < num_points;) {
+        Cell cell;
+        if (b == num_points || (a < num_kf && kf_cells[kf_order[a]] < point_cells[point_order[b]])) {
+            cell = kf_cells[kf_order[a]];
+        } else {
+            cell = point_cells[point_order[b]];
+        }
+        MapRegion r;
+        std::copy(cell.v, cell.v + 3, r.cell);
+        r.first_keyframe = static_cast<std::uint32_t>(a);
+        r.first_point = static_cast<std::uint32_t>(b);
+        while (a < num_kf && kf_cells[kf_order[a]] == cell) ++a;
+        while (b < num_points && point_cells[point_order[b]] == cell) ++b;
+        r.num_keyframes = static_cast<std::uint32_t>(a) - r.first_keyframe;
+        r.num_points = static_cast<std::uint32_t>(b) - r.first_point;
+        regions.push_back(r);
+    }
+
+    // id → 文件内下标
+    std::unordered_map<int, int> kf_index, point_index;
+    std::vector<std::int32_t> kf_ids(num_kf), point_ids(num_points);
+    for (int k = 0; k < num_kf; ++k) {
+        kf_ids[k] = keyframes_[kf_source[kf_order[k]]].id;
+        kf_index.emplace(kf_ids[k], k);
+    }
+    for (int p = 0; p < num_points; ++p) {
+        point_ids[p] = points_[point_source[point_order[p]]].id;
+        point_index.emplace(point_ids[p], p);
+    }
+
+    // 关键帧各段
+    std::vector<double> timestamps(num_kf);
+    std::vector<RigidPosed> poses(num_kf);
+    std::vector<std::uint32_t> feature_offsets(num_kf + 1, 0), covisibility_offsets(num_kf + 1, 0);
+    std::vector<KeyPoint> keypoints;
+    std::vector<Descriptor> descriptors;
+    std::vector<std::int32_t> feature_points;
+    std::vector<CovisibilityEdge> covisibility;
+    std::vector<std::vector<MapObservation>> point_observations(num_points);
+    for (int k = 0; k < num_kf; ++k) {
+        const PendingKeyFrame& kf = keyframes_[kf_source[kf_order[k]]];
+        timestamps[k] = kf.timestamp;
+        poses[k] = kf.T_cw;
+        keypoints.insert(keypoints.end(), kf.keypoints.begin(), kf.keypoints.end());
+        descriptors.insert(descriptors.end(), kf.descriptors.begin(), kf.descriptors.end());
+        for (int f = 0; f < static_cast<int>(kf.map_points.size()); ++f) {
+            const auto it = kf.map_points[f] >= 0 ? point_index.find(kf.map_points[f]) : point_index.end();
+            if (it == point_index.end()) {
+                feature_points.push_back(-1);
+                continue;
+            }
+            feature_points.push_back(it->second);
+            point_observations[it->second].push_back({k, f});
+        }
+        feature_offsets[k + 1] = static_cast<std::uint32_t>(keypoints.size());
+
+        const std::size_t first_edge = covisibility.size();
+        for (const CovisibilityEdge& e : kf.covisibles) {
+            const auto it = kf_index.find(e.keyframe);
+            if (it != kf_index.end() && e.weight > 0) covisibility.push_back({it->second, e.weight});
+        }
+        std::stable_sort(covisibility.begin() + first_edge, covisibility.end(),
+                         [](const CovisibilityEdge& a, const CovisibilityEdge& b) { return a.weight > b.weight; });
+        covisibility_offsets[k + 1] = static_cast<std::uint32_t>(covisibility.size());
+    }
+
+    // 地图点各段
+    std::vector<Eigen::Vector3d> positions(num_points);
+    std::vector<Descriptor> point_descriptors(num_points);
+    std::vector<std::uint32_t> observation_offsets(num_points + 1, 0);
+    std::vector<MapObservation> observations;
+    for (int p = 0; p < num_points; ++p) {
+        const PendingPoint& point = points_[point_source[point_order[p]]];
+        positions[p] = point.position;
+        point_descriptors[p] = point.descriptor;
+        observations.insert(observations.end(), point_observations[p].begin(), point_observations[p].end());
+        observation_offsets[p + 1] = static_cast<std::uint32_t>(observations.size());
+    }
+
+    const std::vector<MapIdIndex> kf_id_index = buildIndex(kf_ids);
+    const std::vector<MapIdIndex> point_id_index = buildIndex(point_ids);
+
+    // 计数超过 int 范围的文件 MapReader 会拒绝打开，不写出一个打不开（或截断了计数）的文件；
+    // 各偏移表都不超过对应的总数，总数放得下时前面转成 uint32 的偏移也没有截断
+    const std::size_t counts[] = {static_cast<std::size_t>(num_kf), static_cast<std::size_t>(num_points),
+                                  keypoints.size(), observations.size(), covisibility.size(), regions.size()};
+    for (std::size_t c : counts) {
+        if (c > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) return false;
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.num_keyframes = static_cast<std::uint32_t>(num_kf);
+    header.num_points = static_cast<std::uint32_t>(num_points);
+    header.num_features = static_cast<std::uint32_t>(keypoints.size());
+    header.num_observations = static_cast<std::uint32_t>(observations.size());
+    header.num_edges = static_cast<std::uint32_t>(covisibility.size());
+    header.num_regions = static_cast<std::uint32_t>(regions.size());
+    header.region_size = region_size_;
+
+    const void* sections[kNumSections] = {
+        kf_ids.data(),       timestamps.data(),          poses.data(),          feature_offsets.data(),
+        keypoints.data(),    descriptors.data(),         feature_points.data(), point_ids.data(),
+        positions.data(),    point_descriptors.data(),   observation_offsets.data(), observations.data(),
+        covisibility_offsets.data(), covisibility.data(), kf_id_index.data(), point_id_index.data(),
+        regions.data()};
+    std::uint64_t sizes[kNumSections];
+    sectionSizes(header, sizes);
+    std::uint64_t offset = alignUp(sizeof(FileHeader));
+    for (int s = 0; s < kNumSections; ++s) {
+        header.offsets[s] = offset;
+        offset = alignUp(offset + sizes[s]);
+    }
+
+    // 先写临时文件，成功后再改名：写到一半失败（或进程崩溃）时原来的地图文件不受影响
+    const std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out) return false;
+    const char zeros[kSectionAlign] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t written = sizeof(header);
+    for (int s = 0; s < kNumSections; ++s) {
+        out.write(zeros, static_cast<std::streamsize>(header.offsets[s] - written));
+        if (sizes[s] > 0) out.write(static_cast<const char*>(sections[s]), static_cast<std::streamsize>(sizes[s]));
+        written = header.offsets[s] + sizes[s];
+    }
+    out.close();
+    if (!out || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MapReader::open(const std::string& path) {
+    close();
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(FileHeader)) return false;
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) return false;
+    if (!(header.region_size > 0.0)) return false;
+
+    // 计数要能放进 int（访问函数按 int 下标）
+    const std::uint32_t counts[] = {header.num_keyframes,    header.num_points, header.num_features,
+                                    header.num_observations, header.num_edges,  header.num_regions};
+    for (std::uint32_t c : counts) {
+        if (c > static_cast<std::uint32_t>(std::numeric_limits<std::int32_t>::max())) return false;
+    }
+
+    // 用减法比较：文件里的偏移不可信，offset + size 可能回绕
+    std::uint64_t sizes[kNumSections];
+    sectionSizes(header, sizes);
+    const std::uint64_t file_size = file.size();
+    for (int s = 0; s < kNumSections; ++s) {
+        if (header.offsets[s] % kSectionAlign != 0 || header.offsets[s] > file_size ||
+            sizes[s] > file_size - header.offsets[s]) {
+            return false;
+        }
+    }
+
+    const std::uint8_t* base = file.data();
+    auto section = [&](Section s) { return base + header.offsets[s]; };
+    keyframe_ids_ = reinterpret_cast<const std::int32_t*>(section(kKeyFrameIds));
+    timestamps_ = reinterpret_cast<const double*>(section(kTimestamps));
+    poses_ = reinterpret_cast<const RigidPosed*>(section(kPoses));
+    feature_offsets_ = reinterpret_cast<const std::uint32_t*>(section(kFeatureOffsets));
+    keypoints_ = reinterpret_cast<const KeyPoint*>(section(kKeyPoints));
+    descriptors_ = reinterpret_cast<const Descriptor*>(section(kDescriptors));
+    feature_points_ = reinterpret_cast<const std::int32_t*>(section(kFeaturePoints));
+    point_ids_ = reinterpret_cast<const std::int32_t*>(section(kPointIds));
+    positions_ = reinterpret_cast<const Eigen::Vector3d*>(section(kPositions));
+    point_descriptors_ = reinterpret_cast<const Descriptor*>(section(kPointDescriptors));
+    observation_offsets_ = reinterpret_cast<const std::uint32_t*>(section(kObservationOffsets));
+    observations_ = reinterpret_cast<const MapObservation*>(section(kObservations));
+    covisibility_offsets_ = reinterpret_cast<const std::uint32_t*>(section(kCovisibilityOffsets));
+    covisibility_ = reinterpret_cast<const CovisibilityEdge*>(section(kCovisibility));
+    keyframe_index_ = reinterpret_cast<const MapIdIndex*>(section(kKeyFrameIndex));
+    point_index_ = reinterpret_cast<const MapIdIndex*>(section(kPointIndex));
+    regions_ = reinterpret_cast<const MapRegion*>(section(kRegions));
+
+    // 所有存下标的段在这里校验一遍，之后的访问函数不再检查；
+    // 体积最大的特征点、描述子、位姿、坐标各段不含下标，仍然只在访问时才读入
+    const std::uint32_t nk = header.num_keyframes, np = header.num_points;
+    if (!validOffsets(feature_offsets_, nk, header.num_features) ||
+        !validOffsets(observation_offsets_, np, header.num_observations) ||
+        !validOffsets(covisibility_offsets_, nk, header.num_edges)) {
+        return false;
+    }
+    for (std::uint32_t f = 0; f < header.num_features; ++f) {
+        if (feature_points_[f] < -1 || (feature_points_[f] >= 0 && std::uint32_t(feature_points_[f]) >= np)) {
+            return false;
+        }
+    }
+    for (std::uint32_t o = 0; o < header.num_observations; ++o) {
+        const MapObservation& obs = observations_[o];
+        if (obs.keyframe < 0 || std::uint32_t(obs.keyframe) >= nk || obs.feature < 0) return false;
+        const std::uint32_t k = static_cast<std::uint32_t>(obs.keyframe);
+        if (std::uint32_t(obs.feature) >= feature_offsets_[k + 1] - feature_offsets_[k]) return false;
+    }
+    for (std::uint32_t e = 0; e < header.num_edges; ++e) {
+        if (covisibility_[e].keyframe < 0 || std::uint32_t(covisibility_[e].keyframe) >= nk) return false;
+    }
+    if (!validIndex(keyframe_index_, nk) || !validIndex(point_index_, np)) return false;
+    for (std::uint32_t r = 0; r < header.num_regions; ++r) {
+        const MapRegion& region = regions_[r];
+        if (region.first_keyframe > nk || region.num_keyframes > nk - region.first_keyframe ||
+            region.first_point > np || region.num_points > np - region.first_point) {
+            return false;
+        }
+    }
+
+    num_keyframes_ = static_cast<int>(nk);
+    num_points_ = static_cast<int>(np);
+    num_regions_ = static_cast<int>(header.num_regions);
+    region_size_ = header.region_size;
+    // 按区域访问，关闭预读，避免读入没去过的区域
+    file.adviseRandom();
+    file_ = std::move(file);
+    return true;
+}
+
+void MapReader::close() {
+    file_.close();
+    num_keyframes_ = num_points_ = num_regions_ = 0;
+    region_size_ = 0.0;
+}
+
+CovisibilitySpan MapReader::covisibles(int k) const {
+    const std::uint32_t first = covisibility_offsets_[k];
+    return {covisibility_ + first, static_cast<int>(covisibility_offsets_[k + 1] - first)};
+}
+
+CovisibilitySpan MapReader::bestCovisibles(int k, int n) const {
+    CovisibilitySpan span = covisibles(k);
+    span.size = std::max(0, std::min(span.size, n));
+    return span;
+}
+
+ObservationSpan MapReader::observations(int p) const {
+    const std::uint32_t first = observation_offsets_[p];
+    return {observations_ + first, static_cast<int>(observation_offsets_[p + 1] - first)};
+}
+
+int MapReader::findId(const MapIdIndex* index, int n, int id) {
+    const MapIdIndex* it =
+        std::lower_bound(index, index + n, id, [](const MapIdIndex& e, int value) { return e.id < value; });
+    return it != index + n && it->id == id ? it->index : -1;
+}
+
+int MapReader::findKeyFrame(int id) const { return findId(keyframe_index_, num_keyframes_, id); }
+
+int MapReader::findMapPoint(int id) const { return findId(point_index_, num_points_, id); }
+
+void MapReader::regionsNear(const Eigen::Vector3d& center, double radius, std::vector<int>& regions) const {
+    regions.clear();
+    // 区域表很小（每个区域 28 字节），直接扫描
+    const double r2 = radius * radius;
+    for (int r = 0; r < num_regions_; ++r) {
+        if (cellDistanceSq(regions_[r], center, region_size_) <= r2) regions.push_back(r);
+    }
+}
+
+void MapReader::willNeed(const void* base, std::size_t size, std::uint64_t first, std::uint64_t count) const {
+    if (count == 0) return;
+    const std::size_t offset = static_cast<std::size_t>(static_cast<const std::uint8_t*>(base) - file_.data());
+    file_.willNeed(offset + first * size, count * size);
+}
+
+void MapReader::prefetchRegion(int r) const {
+    const MapRegion& region = regions_[r];
+    const std::uint64_t k0 = region.first_keyframe, nk = region.num_keyframes;
+    const std::uint64_t p0 = region.first_point, np = region.num_points;
+
+    willNeed(keyframe_ids_, sizeof(std::int32_t), k0, nk);
+    willNeed(timestamps_, sizeof(double), k0, nk);
+    willNeed(poses_, sizeof(RigidPosed), k0, nk);
+    if (nk > 0) {
+        const std::uint64_t f0 = feature_offsets_[k0], nf = feature_offsets_[k0 + nk] - f0;
+        willNeed(keypoints_, sizeof(KeyPoint), f0, nf);
+        willNeed(descriptors_, sizeof(Descriptor), f0, nf);
+        willNeed(feature_points_, sizeof(std::int32_t), f0, nf);
+        const std::uint64_t e0 = covisibility_offsets_[k0], ne = covisibility_offsets_[k0 + nk] - e0;
+        willNeed(covisibility_, sizeof(CovisibilityEdge), e0, ne);
+    }
+
+    willNeed(point_ids_, sizeof(std::int32_t), p0, np);
+    willNeed(positions_, sizeof(Eigen::Vector3d), p0, np);
+    willNeed(point_descriptors_, sizeof(Descriptor), p0, np);
+    if (np > 0) {
+        const std::uint64_t o0 = observation_offsets_[p0], no = observation_offsets_[p0 + np] - o0;
+        willNeed(observations_, sizeof(MapObservation), o0, no);
+    }
+}
+
+}  // namespace slam
@@ -0,0 +1,334 @@
+#include "mapping/map_point_hash.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/profiler.h"
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr int kFieldBits = 21;
+constexpr std::int64_t kFieldBias = std::int64_t(1) << (kFieldBits - 1);
+constexpr int kInitialCapacity = 1024;
+
+// 偏移 (ox, oy, oz) ∈ {-1, 0, 1}³ 对应的掩码位和键增量
+inline int neighborBit(int ox, int oy, int oz) { return (ox + 1) * 9 + (oy + 1) * 3 + (oz + 1); }
+
+inline std::int64_t keyOffset(int ox, int oy, int oz) {
+    // 乘法而不是左移：负偏移左移是未定义行为
+    constexpr std::int64_t kY = std::int64_t(1) << kFieldBits, kX = kY << kFieldBits;
+    return ox * kX + oy * kY + oz;
+}
+
+inline int field(double v) {
+    const double f = std::floor(v);
+    return static_cast<int>(std::max<double>(-kFieldBias + 1, std::min<double>(kFieldBias - 2, f)));
+}
+
+}  // namespace
+
+MapPointHash::MapPointHash(const MapPointHashOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()), inv_voxel_(0.5 / options.radius) {
+    rehash(kInitialCapacity);
+}
+
+std::uint64_t MapPointHash::keyOf(const Eigen::Vector3d& p) const {
+    const std::uint64_t ix = static_cast<std::uint64_t>(field(p.x() * inv_voxel_) + kFieldBias);
+    const std::uint64_t iy = static_cast<std::uint64_t>(field(p.y() * inv_voxel_) + kFieldBias);
+    const std::uint64_t iz = static_cast<std::uint64_t>(field(p.z() * inv_voxel_) + kFieldBias);
+    return (ix << (2 * kFieldBits)) | (iy << kFieldBits) | iz;
+}
+
+int MapPointHash::findSlot(std::uint64_t key) const {
+    int s = static_cast<int>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+    for (;;) {
+        const std::uint64_t k = table_[s].key;
+        if (k == key) return s;
+        if (k == kEmptyKey) return -1;
+        s = (s + 1) & mask_;
+    }
+}
+
+int MapPointHash::findOrCreateSlot(std::uint64_t key) {
+    const int found = findSlot(key);
+    if (found >= 0) return found;
+    if (2 * (used_slots_ + 1) > static_cast<int>(table_.size())) {
+        // 空体素占了一半以上时原容量重建即可
+        rehash(4 * num_voxels_ < used_slots_ ? static_cast<int>(table_.size()) : 2 * static_cast<int>(table_.size()));
+    }
+    int s = static_cast<int>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+    while (table_[s].key != kEmptyKey) s = (s + 1) & mask_;
+    table_[s].key = key;
+    table_[s].head = -1;
+    table_[s].count = 0;
+    table_[s].neighbors = computeNeighborMask(key);
+    ++used_slots_;
+    return s;
+}
+
+void MapPointHash::rehash(int capacity) {
+    SLAM_PROFILE_COUNT("mapping/hash_rehash", 1);
+    std::vector<Voxel> old(capacity);
+    old.swap(table_);
+    mask_ = capacity - 1;
+    used_slots_ = 0;
+    // 空体素直接丢掉；邻居掩码只描述占用情况，搬动后仍然有效
+    for (const Voxel& v : old) {
+        if (v.key == kEmptyKey || v.count == 0) continue;
+        int s = static_cast<int>((v.key * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+        while (table_[s].key != kEmptyKey) s = (s + 1) & mask_;
+        table_[s] = v;
+        ++used_slots_;
+        for (int id = v.head; id >= 0; id = next_[id]) voxel_[id] = s;
+    }
+}
+
+std::uint32_t MapPointHash::computeNeighborMask(std::uint64_t key) const {
+    std::uint32_t mask = 0;
+    for (int ox = -1; ox <= 1; ++ox) {
+        for (int oy = -1; oy <= 1; ++oy) {
+            for (int oz = -1; oz <= 1; ++oz) {
+                if (ox == 0 && oy == 0 && oz == 0) continue;
+                const int s = findSlot(key + keyOffset(ox, oy, oz));
+                if (s >= 0 && table_[s].count > 0) mask |= 1u << neighborBit(ox, oy, oz);
+            }
+        }
+    }
+    return mask;
+}
+
+void MapPointHash::setNeighborBits(int slot, bool occupied) {
+    const std::uint64_t key = table_[slot].key;
+    for (int ox = -1; ox <= 1; ++ox) {
+        for (int oy = -1; oy <= 1; ++oy) {
+            for (int oz = -1; oz <= 1; ++oz) {
+                if (ox == 0 && oy == 0 && oz == 0) continue;
+                const int s = findSlot(key + keyOffset(ox, oy, oz));
+                if (s < 0) continue;
+                // 从邻居看过来的偏移是反方向
+                const std::uint32_t bit = 1u << neighborBit(-ox, -oy, -oz);
+                if (occupied) {
+                    table_[s].neighbors |= bit;
+                } else {
+                    table_[s].neighbors &= ~bit;
+                }
+            }
+        }
+    }
+}
+
+void MapPointHash::link(int id, int slot) {
+    Voxel& v = table_[slot];
+    prev_[id] = -1;
+    next_[id] = v.head;
+    if (v.head >= 0) prev_[v.head] = id;
+    v.head = id;
+    voxel_[id] = slot;
+    if (++v.count == 1) {
+        ++num_voxels_;
+        setNeighborBits(slot, true);
+    }
+}
+
+void MapPointHash::unlink(int id) {
+    const int slot = voxel_[id];
+    Voxel& v = table_[slot];
+    if (prev_[id] >= 0) {
+        next_[prev_[id]] = next_[id];
+    } else {
+        v.head = next_[id];
+    }
+    if (next_[id] >= 0) prev_[next_[id]] = prev_[id];
+    voxel_[id] = -1;
+    if (--v.count == 0) {
+        --num_voxels_;
+        setNeighborBits(slot, false);
+    }
+}
+
+void MapPointHash::markDirty(int id) {
+    if (dirty_[id]) return;
+    dirty_[id] = 1;
+    dirty_list_.push_back(id);
+}
+
+void MapPointHash::grow(int id) {
+    if (id < static_cast<int>(voxel_.size())) return;
+    const size_t n = static_cast<size_t>(id) + 1;
+    positions_.resize(n);
+    descriptors_.resize(n);
+    voxel_.resize(n, -1);
+    prev_.resize(n, -1);
+    next_.resize(n, -1);
+    dirty_.resize(n, 0);
+}
+
+void MapPointHash::insert(int id, const Eigen::Vector3d& position, const Descriptor& descriptor) {
+    if (id < 0) return;
+    grow(id);
+    if (voxel_[id] >= 0) {
+        unlink(id);
+    } else {
+        ++num_points_;
+    }
+    positions_[id] = position;
+    descriptors_[id] = descriptor;
+    link(id, findOrCreateSlot(keyOf(position)));
+    markDirty(id);
+}
+
+void MapPointHash::move(int id, const Eigen::Vector3d& position) {
+    if (!contains(id)) return;
+    positions_[id] = position;
+    markDirty(id);
+    const std::uint64_t key = keyOf(position);
+    if (table_[voxel_[id]].key == key) return;
+    unlink(id);
+    link(id, findOrCreateSlot(key));
+}
+
+void MapPointHash::setDescriptor(int id, const Descriptor& descriptor) {
+    if (!contains(id)) return;
+    descriptors_[id] = descriptor;
+    markDirty(id);
+}
+
+void MapPointHash::erase(int id) {
+    if (!contains(id)) return;
+    unlink(id);
+    --num_points_;
+}
+
+void MapPointHash::clear() {
+    std::fill(voxel_.begin(), voxel_.end(), -1);
+    std::fill(dirty_.begin(), dirty_.end(), 0);
+    dirty_list_.clear();
+    num_points_ = 0;
+    num_voxels_ = 0;
+    table_.assign(table_.size(), Voxel());
+    used_slots_ = 0;
+    packed_ids_.clear();
+    packed_positions_.clear();
+    packed_descriptors_.clear();
+}
+
+int MapPointHash::bestMatch(int id, bool packed, int* distance) const {
+    const Eigen::Vector3d& p = positions_[id];
+    const Descriptor& d = descriptors_[id];
+    const int home_slot = voxel_[id];
+    const Voxel& home = table_[home_slot];
+    const double r2 = options_.radius * options_.radius;
+    // 点在体素内偏向哪一侧，就只看那一侧的邻居
+    const Eigen::Vector3d scaled = p * inv_voxel_;
+    const int dx = scaled.x() - std::floor(scaled.x()) < 0.5 ? -1 : 1;
+    const int dy = scaled.y() - std::floor(scaled.y()) < 0.5 ? -1 : 1;
+    const int dz = scaled.z() - std::floor(scaled.z()) < 0.5 ? -1 : 1;
+
+    int best = -1, best_hamming = options_.max_hamming + 1;
+    double best_d2 = 0.0;
+    const auto consider = [&](int q, const Eigen::Vector3d& position, const Descriptor& descriptor) {
+        if (q == id) return;
+        const double d2 = (position - p).squaredNorm();
+        if (d2 > r2) return;
+        const int h = hammingDistance(d, descriptor);
+        if (h < best_hamming || (h == best_hamming && (d2 < best_d2 || (d2 == best_d2 && q < best)))) {
+            best = q;
+            best_hamming = h;
+            best_d2 = d2;
+        }
+    };
+    for (int k = 0; k < 8; ++k) {
+        const int ox = (k & 1) ? dx : 0, oy = (k & 2) ? dy : 0, oz = (k & 4) ? dz : 0;
+        int slot = home_slot;
+        if (k > 0) {
+            if (!(home.neighbors & (1u << neighborBit(ox, oy, oz)))) continue;
+            slot = findSlot(home.key + keyOffset(ox, oy, oz));
+        }
+        if (packed) {
+            const Voxel& v = table_[slot];
+            for (int i = v.begin; i < v.begin + v.count; ++i) {
+                consider(packed_ids_[i], packed_positions_[i], packed_descriptors_[i]);
+            }
+        } else {
+            for (int q = table_[slot].head; q >= 0; q = next_[q]) consider(q, positions_[q], descriptors_[q]);
+        }
+    }
+    if (distance) *distance = best >= 0 ? best_hamming : 0;
+    return best;
+}
+
+int MapPointHash::findDuplicate(int id, int* distance) const {
+    if (!contains(id)) return -1;
+    return bestMatch(id, false, distance);
+}
+
+void MapPointHash::pack() {
+    // 按槽位计数排序：每个体素的点连续存放，融合时邻居体素的点是几段连续内存
+    packed_ids_.resize(num_points_);
+    packed_positions_.resize(num_points_);
+    packed_descriptors_.resize(num_points_);
+    int i = 0;
+    for (Voxel& v : table_) {
+        v.begin = i;
+        for (int q = v.head; q >= 0; q = next_[q], ++i) {
+            packed_ids_[i] = q;
+            packed_positions_[i] = positions_[q];
+            packed_descriptors_[i] = descriptors_[q];
+        }
+    }
+}
+
+void MapPointHash::fusionCandidates(std::vector<FusionCandidate>& candidates, bool all) {
+    candidates.clear();
+    const int n_queries = all ? num_points_ : static_cast<int>(dirty_list_.size());
+    if (n_queries == 0) {
+        for (int id : dirty_list_) dirty_[id] = 0;
+        dirty_list_.clear();
+        return;
+    }
+    // 查询的点多时先整理成按体素连续的布局，少量脏点直接沿链表查；
+    // 全部检查时查询取刚 pack() 出的 packed_ids_（只含现存的点，按体素顺序）
+    const bool packed = 4 * n_queries >= num_points_;
+    if (packed) pack();
+    std::vector<int> queries;
+    if (all) {
+        queries = packed_ids_;
+    } else {
+        queries.reserve(dirty_list_.size());
+        for (int id : dirty_list_) {
+            if (voxel_[id] >= 0) queries.push_back(id);
+        }
+    }
+    for (int id : dirty_list_) dirty_[id] = 0;
+    dirty_list_.clear();
+    if (queries.empty()) return;
+
+    const int n = static_cast<int>(queries.size());
+    std::vector<FusionCandidate> best(n);
+    const int chunk = std::max(1, options_.points_per_task);
+    pool_->parallelFor((n + chunk - 1) / chunk, [&](int task, int) {
+        const int end = std::min(n, (task + 1) * chunk);
+        for (int i = task * chunk; i < end; ++i) {
+            const int id = queries[i];
+            int h = 0;
+            const int q = bestMatch(id, packed, &h);
+            if (q >= 0) best[i] = {std::min(id, q), std::max(id, q), h};
+        }
+    });
+    for (const FusionCandidate& c : best) {
+        if (c.point >= 0) candidates.push_back(c);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const FusionCandidate& a, const FusionCandidate& b) {
+        return a.point < b.point || (a.point == b.point && a.other < b.other);
+    });
+    candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                 [](const FusionCandidate& a, const FusionCandidate& b) {
+                                     return a.point == b.point && a.other == b.other;
+                                 }),
+                     candidates.end());
+}
+
+}  // namespace slam
@@ -0,0 +1,194 @@
+#include "mapping/triangulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+constexpr int kRefineIterations = 1;   // 线性解已经很接近，一步就够
+
+// 视角的预计算量：世界系下的旋转和光心
+struct ViewCache {
+    Eigen::Matrix3d R_cw, R_wc;
+    Eigen::Vector3d t_cw, center;
+};
+
+struct Observation {
+    const ViewCache* view;
+    double x, y;
+    Eigen::Vector3d bearing;        // 世界系单位射线
+};
+
+// 两条射线 C_i + s b_i 与 C_j + u b_j 公垂线的垂足参数（b 为单位向量）；平行时返回 false
+bool closestRayParameters(const Observation& oi, const Observation& oj, double& s, double& u) {
+    const double a = oi.bearing.dot(oj.bearing);
+    const double denom = a * a - 1.0;
+    if (std::fabs(denom) < 1e-12) return false;
+    const Eigen::Vector3d w = oj.view->center - oi.view->center;
+    const double wi = w.dot(oi.bearing), wj = w.dot(oj.bearing);
+    u = (wj - a * wi) / denom;
+    s = wi + a * u;
+    return true;
+}
+
+TriangulationStatus triangulateTrack(const std::vector<Observation>& obs, const TriangulatorOptions& options,
+                                     double cos_min_parallax, Eigen::Vector3d& X, Eigen::Matrix3d& cov) {
+    const int n = static_cast<int>(obs.size());
+    if (n < 2) return TriangulationStatus::kTooFewViews;
+
+    // 1. 最大视差角 = 射线两两点积的最小值
+    int best_i = 0, best_j = 1;
+    double min_cos = 2.0;
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            const double c = obs[i].bearing.dot(obs[j].bearing);
+            if (c < min_cos) {
+                min_cos = c;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+    if (min_cos > cos_min_parallax) return TriangulationStatus::kLowParallax;
+
+    // 2. 视差最大的两条射线必须在两个相机前方相交，否则不做线性求解
+    double s_i = 0.0, s_j = 0.0;
+    if (!closestRayParameters(obs[best_i], obs[best_j], s_i, s_j)) return TriangulationStatus::kLowParallax;
+    if (s_i <= 0.0 || s_j <= 0.0) return TriangulationStatus::kBehindCamera;
+
+    // 3. 定长 3x3 线性求解
+    Eigen::Matrix3d A = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d b = Eigen::Vector3d::Zero();
+    if (options.method == TriangulationMethod::kDlt) {
+        // x (r3 X + t3) = r1 X + t1，y (r3 X + t3) = r2 X + t2
+        for (const Observation& o : obs) {
+            const Eigen::Matrix3d& R = o.view->R_cw;
+            const Eigen::Vector3d& t = o.view->t_cw;
+            const Eigen::RowVector3d a0 = o.x * R.row(2) - R.row(0);
+            const Eigen::RowVector3d a1 = o.y * R.row(2) - R.row(1);
+            const double b0 = t[0] - o.x * t[2];
+            const double b1 = t[1] - o.y * t[2];
+            A.noalias() += a0.transpose() * a0 + a1.transpose() * a1;
+            b.noalias() += a0.transpose() * b0 + a1.transpose() * b1;
+        }
+    } else {
+        // 到各射线距离平方和：sum (I - b b^T)(X - C) = 0
+        for (const Observation& o : obs) {
+            const Eigen::Matrix3d P = Eigen::Matrix3d::Identity() - o.bearing * o.bearing.transpose();
+            A += P;
+            b.noalias() += P * o.view->center;
+        }
+    }
+    const Eigen::LDLT<Eigen::Matrix3d> ldlt(A);
+    if (ldlt.info() != Eigen::Success || !(ldlt.vectorD().minCoeff() > 1e-12 * ldlt.vectorD().maxCoeff())) {
+        return TriangulationStatus::kDegenerate;
+    }
+    X = ldlt.solve(b);
+
+    // 4. 线性解不是最大似然解（DLT 最小化代数误差，中点法最小化三维距离），在重投影误差上做一步
+    //    Gauss-Newton；最后一次的信息矩阵 J^T J 同时给出协方差
+    Eigen::Matrix3d information;
+    for (int it = 0; it <= kRefineIterations; ++it) {
+        information.setZero();
+        Eigen::Vector3d gradient = Eigen::Vector3d::Zero();
+        for (const Observation& o : obs) {
+            const Eigen::Vector3d Xc = o.view->R_cw * X + o.view->t_cw;
+            if (Xc.z() <= 0.0) return TriangulationStatus::kBehindCamera;
+            const double iz = 1.0 / Xc.z();
+            const Eigen::Vector2d r(Xc.x() * iz - o.x, Xc.y() * iz - o.y);
+            Eigen::Matrix<double, 2, 3> J;
+            J << iz, 0.0, -Xc.x() * iz * iz,
+                 0.0, iz, -Xc.y() * iz * iz;
+            const Eigen::Matrix<double, 2, 3> Jw = J * o.view->R_cw;
+            information.noalias() += Jw.transpose() * Jw;
+            gradient.noalias() += Jw.transpose() * r;
+        }
+        if (it == kRefineIterations) break;
+        const Eigen::Vector3d dX = information.ldlt().solve(-gradient);
+        if (!dX.allFinite()) return TriangulationStatus::kDegenerate;
+        X += dX;
+    }
+
+    // 5. 每个视角的重投影误差
+    const double max_error = options.max_error_px / options.focal_length;
+    const double max_error2 = max_error * max_error;
+    for (const Observation& o : obs) {
+        const Eigen::Vector3d Xc = o.view->R_cw * X + o.view->t_cw;
+        const double iz = 1.0 / Xc.z();
+        const double ex = Xc.x() * iz - o.x, ey = Xc.y() * iz - o.y;
+        if (ex * ex + ey * ey > max_error2) return TriangulationStatus::kLargeError;
+    }
+    const double sigma = options.sigma_px / options.focal_length;
+    cov = (sigma * sigma) * information.inverse();
+    return TriangulationStatus::kOk;
+}
+
+}  // namespace
+
+void TrackBatch::reserve(int n_tracks, int n_observations) {
+    offsets.reserve(n_tracks + 1);
+    view.reserve(n_observations);
+    x.reserve(n_observations);
+    y.reserve(n_observations);
+}
+
+void TrackBatch::clear() {
+    offsets.assign(1, 0);
+    view.clear();
+    x.clear();
+    y.clear();
+}
+
+void TrackBatch::addObservation(int view_index, const Eigen::Vector2d& xn) {
+    view.push_back(view_index);
+    x.push_back(xn.x());
+    y.push_back(xn.y());
+}
+
+Triangulator::Triangulator(const TriangulatorOptions& options, ThreadPool* pool)
+    : options_(options), pool_(pool ? pool : &ThreadPool::global()) {}
+
+int Triangulator::triangulate(const std::vector<TriangulationView>& views, const TrackBatch& tracks,
+                              TriangulationResult& result) {
+    const int n = tracks.size();
+    result.points.resize(n);
+    result.covariances.resize(n);
+    result.status.resize(n);
+    result.num_valid = 0;
+    if (n == 0) return 0;
+
+    std::vector<ViewCache> cache(views.size());
+    for (size_t i = 0; i < views.size(); ++i) {
+        cache[i].R_cw = views[i].R_cw;
+        cache[i].t_cw = views[i].t_cw;
+        cache[i].R_wc = views[i].R_cw.transpose();
+        cache[i].center = -cache[i].R_wc * views[i].t_cw;
+    }
+
+    const double cos_min_parallax = std::cos(options_.min_parallax_deg * M_PI / 180.0);
+    const int per_task = std::max(1, options_.tracks_per_task);
+    const int n_tasks = (n + per_task - 1) / per_task;
+    pool_->parallelFor(n_tasks, [&](int task, int) {
+        std::vector<Observation> obs;
+        const int end = std::min(n, (task + 1) * per_task);
+        for (int i = task * per_task; i < end; ++i) {
+            obs.clear();
+            for (int k = tracks.offsets[i]; k < tracks.offsets[i + 1]; ++k) {
+                const ViewCache& v = cache[tracks.view[k]];
+                obs.push_back({&v, tracks.x[k], tracks.y[k],
+                               (v.R_wc * Eigen::Vector3d(tracks.x[k], tracks.y[k], 1.0)).normalized()});
+            }
+            result.status[i] = triangulateTrack(obs, options_, cos_min_parallax, result.points[i],
+                                                result.covariances[i]);
+        }
+    });
+
+    for (TriangulationStatus s : result.status) result.num_valid += (s == TriangulationStatus::kOk);
+    return result.num_valid;
+}
+
+}  // namespace slam
@@ -0,0 +1,230 @@
+#include "utils/block_least_squares.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace slam {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+}  // namespace
+
+template <int BR, int BC>
+BlockLeastSquares<BR, BC>::BlockLeastSquares(const BlockLeastSquaresOptions& options) : options_(options) {}
+
+template <int BR, int BC>
+void BlockLeastSquares<BR, BC>::setPattern(int num_residual_blocks, int num_variables,
+                                           std::vector<std::pair<int, int>> blocks) {
+    num_residuals_ = std::max(num_residual_blocks, 0);
+    num_variables_ = std::max(num_variables, 0);
+    const bool use_float = options_.precision == JacobianPrecision::kFloat;
+    if (use_float) {
+        J_float_.setPattern(num_residuals_, num_variables_, std::move(blocks));
+        J_double_.resize(0, 0);
+    } else {
+        J_double_.setPattern(num_residuals_, num_variables_, std::move(blocks));
+        J_float_.resize(0, 0);
+    }
+    r_ = Eigen::VectorXd::Zero(static_cast<Eigen::Index>(num_residuals_) * BR);
+    const std::vector<int>& row_ptr = use_float ? J_float_.rowPtr() : J_double_.rowPtr();
+    const std::vector<int>& col = use_float ? J_float_.colIndex() : J_double_.colIndex();
+
+    // 1. H 的块模式：同一残差块里两两变量（上三角）+ 所有对角块
+    std::vector<std::pair<int, int>> h_blocks;
+    for (int i = 0; i < num_residuals_; ++i) {
+        for (int k1 = row_ptr[i]; k1 < row_ptr[i + 1]; ++k1) {
+            for (int k2 = k1; k2 < row_ptr[i + 1]; ++k2) h_blocks.emplace_back(col[k1], col[k2]);
+        }
+    }
+    for (int c = 0; c < num_variables_; ++c) h_blocks.emplace_back(c, c);
+    H_.setPattern(num_variables_, num_variables_, std::move(h_blocks));
+
+    pair_block_.clear();
+    for (int i = 0; i < num_residuals_; ++i) {
+        for (int k1 = row_ptr[i]; k1 < row_ptr[i + 1]; ++k1) {
+            for (int k2 = k1; k2 < row_ptr[i + 1]; ++k2) pair_block_.push_back(H_.findBlock(col[k1], col[k2]));
+        }
+    }
+    diag_block_.resize(num_variables_);
+    for (int c = 0; c < num_variables_; ++c) diag_block_[c] = H_.findBlock(c, c);
+
+    // 2. H 的块值 → Eigen 稀疏矩阵值的位置：把下标当作值转换一次，转换结果里的值就是来源
+    constexpr int kHBlock = BC * BC;
+    for (int k = 0; k < H_.nonZeroBlocks(); ++k) {
+        double* v = H_.block(k).data();
+        for (int j = 0; j < kHBlock; ++j) v[j] = static_cast<double>(k * kHBlock + j);
+    }
+    H_sparse_ = H_.toSparse();
+    sparse_source_.resize(H_sparse_.nonZeros());
+    for (Eigen::Index i = 0; i < H_sparse_.nonZeros(); ++i) {
+        sparse_source_[i] = static_cast<int>(H_sparse_.valuePtr()[i]);
+    }
+    H_.setZero();
+    analyzed_ = false;
+
+    const Eigen::Index n = static_cast<Eigen::Index>(num_variables_) * BC;
+    g_ = Eigen::VectorXd::Zero(n);
+    damping_ = Eigen::VectorXd::Zero(n);
+    rg_ = Eigen::VectorXd::Zero(n);
+    correction_ = Eigen::VectorXd::Zero(n);
+}
+
+template <int BR, int BC>
+void BlockLeastSquares<BR, BC>::setZero() {
+    J_double_.setZero();
+    J_float_.setZero();
+    r_.setZero();
+}
+
+template <int BR, int BC>
+bool BlockLeastSquares<BR, BC>::setJacobian(int residual, int variable, const JacobianBlock& J) {
+    if (options_.precision == JacobianPrecision::kFloat) {
+        const int k = J_float_.findBlock(residual, variable);
+        if (k < 0) return false;
+        J_float_.block(k) = J.template cast<float>();
+    } else {
+        const int k = J_double_.findBlock(residual, variable);
+        if (k < 0) return false;
+        J_double_.block(k) = J;
+    }
+    return true;
+}
+
+template <int BR, int BC>
+void BlockLeastSquares<BR, BC>::setResidual(int residual, const ResidualBlock& r) {
+    if (residual < 0 || residual >= num_residuals_) return;
+    r_.template segment<BR>(static_cast<Eigen::Index>(residual) * BR) = r;
+}
+
+template <int BR, int BC>
+std::size_t BlockLeastSquares<BR, BC>::jacobianBytes() const {
+    const std::size_t r_bytes = r_.size() * sizeof(double);
+    if (options_.precision == JacobianPrecision::kFloat) {
+        return J_float_.values().size() * sizeof(float) + J_float_.colIndex().size() * sizeof(int) +
+               J_float_.rowPtr().size() * sizeof(int) + r_bytes;
+    }
+    return J_double_.values().size() * sizeof(double) + J_double_.colIndex().size() * sizeof(int) +
+           J_double_.rowPtr().size() * sizeof(int) + r_bytes;
+}
+
+template <int BR, int BC>
+template <typename Scalar>
+void BlockLeastSquares<BR, BC>::assemble(const BlockSparseMatrix<Scalar, BR, BC>& J, const double* r) {
+    H_.setZero();
+    g_.setZero();
+    const std::vector<int>& row_ptr = J.rowPtr();
+    const std::vector<int>& col = J.colIndex();
+    int p = 0;
+    for (int i = 0; i < num_residuals_; ++i) {
+        const ResidualBlock ri = ResidualMap(r + static_cast<std::size_t>(i) * BR);
+        for (int k1 = row_ptr[i]; k1 < row_ptr[i + 1]; ++k1) {
+            // float 块转 double 后相乘：乘积精确，只有累加的舍入
+            const JacobianBlock A = J.block(k1).template cast<double>();
+            g_.template segment<BC>(static_cast<Eigen::Index>(col[k1]) * BC).noalias() += A.transpose() * ri;
+            for (int k2 = k1; k2 < row_ptr[i + 1]; ++k2) {
+                H_.block(pair_block_[p++]).noalias() += A.transpose() * J.block(k2).template cast<double>();
+            }
+        }
+    }
+}
+
+template <int BR, int BC>
+template <typename Scalar>
+void BlockLeastSquares<BR, BC>::normalResidual(const BlockSparseMatrix<Scalar, BR, BC>& J, const double* r,
+                                               const Eigen::VectorXd& delta, double lambda) {
+    // 一遍读 J：先算这个残差块的 e_i = r_i + Σ J_k δ_c，再散写 J_kᵀ e_i
+    const std::vector<int>& row_ptr = J.rowPtr();
+    const std::vector<int>& col = J.colIndex();
+    rg_.setZero();
+    for (int i = 0; i < num_residuals_; ++i) {
+        ResidualBlock ei = ResidualMap(r + static_cast<std::size_t>(i) * BR);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            ei.noalias() +=
+                J.block(k).template cast<double>() * delta.template segment<BC>(static_cast<Eigen::Index>(col[k]) * BC);
+        }
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            rg_.template segment<BC>(static_cast<Eigen::Index>(col[k]) * BC).noalias() +=
+                J.block(k).template cast<double>().transpose() * ei;
+        }
+    }
+    if (lambda > 0.0) rg_ += damping_.cwiseProduct(delta);
+}
+
+template <int BR, int BC>
+bool BlockLeastSquares<BR, BC>::solve(double lambda, Eigen::VectorXd& delta, BlockLeastSquaresSummary* summary) {
+    BlockLeastSquaresSummary s;
+    const auto start = Clock::now();
+    const bool use_float = options_.precision == JacobianPrecision::kFloat;
+
+    // 1. 组装 H、g，加阻尼，拷到稀疏矩阵
+    auto t0 = Clock::now();
+    if (use_float) {
+        assemble(J_float_, r_.data());
+    } else {
+        assemble(J_double_, r_.data());
+    }
+    for (int c = 0; c < num_variables_; ++c) {
+        auto block = H_.block(diag_block_[c]);
+        for (int j = 0; j < BC; ++j) {
+            const double d = lambda * std::max(block(j, j), 1e-12);
+            damping_[static_cast<Eigen::Index>(c) * BC + j] = d;
+            block(j, j) += d;
+        }
+    }
+    const double* h = H_.values().data();
+    double* v = H_sparse_.valuePtr();
+    for (std::size_t i = 0; i < sparse_source_.size(); ++i) v[i] = h[sparse_source_[i]];
+    s.assemble_ms = elapsedMs(t0);
+
+    // 2. 数值分解（符号分解只做一次）
+    t0 = Clock::now();
+    if (!analyzed_) {
+        llt_.analyzePattern(H_sparse_);
+        analyzed_ = true;
+    }
+    llt_.factorize(H_sparse_);
+    s.factorize_ms = elapsedMs(t0);
+    if (llt_.info() != Eigen::Success) {
+        s.total_ms = elapsedMs(start);
+        if (summary) *summary = s;
+        return false;
+    }
+
+    // 3. 直接求解 + 半正规方程迭代修正
+    t0 = Clock::now();
+    delta = llt_.solve(-g_);
+    for (int step = 0; step < options_.max_refinement_steps; ++step) {
+        const auto refine_start = Clock::now();
+        if (use_float) {
+            normalResidual(J_float_, r_.data(), delta, lambda);
+        } else {
+            normalResidual(J_double_, r_.data(), delta, lambda);
+        }
+        s.refine_ms += elapsedMs(refine_start);
+        correction_ = llt_.solve(rg_);
+        delta -= correction_;
+        const double rel = correction_.norm() / std::max(delta.norm(), 1e-300);
+        if (step == 0) s.first_correction = rel;
+        s.last_correction = rel;
+        ++s.refinement_steps;
+        if (rel < options_.refinement_tolerance) break;
+    }
+    s.solve_ms = elapsedMs(t0);
+    s.success = delta.allFinite();
+    s.total_ms = elapsedMs(start);
+    if (summary) *summary = s;
+    return s.success;
+}
+
+template class BlockLeastSquares<6, 6>;
+template class BlockLeastSquares<3, 3>;
+template class BlockLeastSquares<2, 6>;
+template class BlockLeastSquares<3, 6>;
+
+}  // namespace slam
@@ -0,0 +1,219 @@
+#include "utils/block_sparse_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+namespace {
+
+// 每个并行任务至少这么多个非零块（6x6 double 块约 10 ns 一个），太少时线程唤醒的开销比计算还大
+constexpr int kMinBlocksPerTask = 2048;
+
+}  // namespace
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::resize(int block_rows, int block_cols) {
+    block_rows_ = std::max(block_rows, 0);
+    block_cols_ = std::max(block_cols, 0);
+    row_ptr_.assign(block_rows_ + 1, 0);
+    col_.clear();
+    values_.clear();
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::setPattern(int block_rows, int block_cols,
+                                                   std::vector<std::pair<int, int>> blocks) {
+    resize(block_rows, block_cols);
+    blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                [&](const std::pair<int, int>& b) {
+                                    return b.first < 0 || b.first >= block_rows_ || b.second < 0 ||
+                                           b.second >= block_cols_;
+                                }),
+                 blocks.end());
+    std::sort(blocks.begin(), blocks.end());
+    blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+
+    col_.resize(blocks.size());
+    for (std::size_t k = 0; k < blocks.size(); ++k) {
+        ++row_ptr_[blocks[k].first + 1];
+        col_[k] = blocks[k].second;
+    }
+    for (int r = 0; r < block_rows_; ++r) row_ptr_[r + 1] += row_ptr_[r];
+    values_.assign(blocks.size() * kBlockSize, Scalar(0));
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::setZero() {
+    std::fill(values_.begin(), values_.end(), Scalar(0));
+}
+
+template <typename Scalar, int BR, int BC>
+int BlockSparseMatrix<Scalar, BR, BC>::findBlock(int block_row, int block_col) const {
+    if (block_row < 0 || block_row >= block_rows_) return -1;
+    const auto begin = col_.begin() + row_ptr_[block_row];
+    const auto end = col_.begin() + row_ptr_[block_row + 1];
+    const auto it = std::lower_bound(begin, end, block_col);
+    return it != end && *it == block_col ? static_cast<int>(it - col_.begin()) : -1;
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::partitionRows(int n_parts, std::vector<int>& bounds) const {
+    const int nnz = nonZeroBlocks();
+    bounds.resize(n_parts + 1);
+    bounds[0] = 0;
+    for (int p = 1; p < n_parts; ++p) {
+        const int target = static_cast<int>(static_cast<long long>(nnz) * p / n_parts);
+        const auto it = std::lower_bound(row_ptr_.begin(), row_ptr_.end(), target);
+        const int r = static_cast<int>(it - row_ptr_.begin());
+        bounds[p] = std::clamp(r, bounds[p - 1], block_rows_);
+    }
+    bounds[n_parts] = block_rows_;
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::multiplyRows(int row_begin, int row_end, const Scalar* x, Scalar* y,
+                                                     Scalar alpha, bool accumulate) const {
+    using RowVector = Eigen::Matrix<Scalar, BR, 1>;
+    using ColVector = Eigen::Matrix<Scalar, BC, 1>;
+    const Scalar* values = values_.data();
+    const int* col = col_.data();
+    for (int r = row_begin; r < row_end; ++r) {
+        // 块行的结果留在寄存器里，最后只写一次 y
+        RowVector acc = RowVector::Zero();
+        for (int k = row_ptr_[r], end = row_ptr_[r + 1]; k < end; ++k) {
+            acc.noalias() += ConstBlockMap(values + static_cast<std::size_t>(k) * kBlockSize) *
+                             Eigen::Map<const ColVector>(x + static_cast<std::size_t>(col[k]) * BC);
+        }
+        Eigen::Map<RowVector> out(y + static_cast<std::size_t>(r) * BR);
+        if (accumulate) {
+            out += alpha * acc;
+        } else {
+            out = alpha * acc;
+        }
+    }
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::multiplyImpl(const Scalar* x, Scalar* y, Scalar alpha, bool accumulate,
+                                                     ThreadPool* pool) const {
+    ThreadPool& tp = pool ? *pool : ThreadPool::global();
+    const int n_tasks = std::min(tp.size() * 4, nonZeroBlocks() / kMinBlocksPerTask);
+    if (n_tasks <= 1) {
+        multiplyRows(0, block_rows_, x, y, alpha, accumulate);
+        return;
+    }
+    std::vector<int> bounds;
+    partitionRows(n_tasks, bounds);
+    tp.parallelFor(n_tasks, [&](int task, int) {
+        multiplyRows(bounds[task], bounds[task + 1], x, y, alpha, accumulate);
+    });
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::multiply(const Scalar* x, Scalar* y, ThreadPool* pool) const {
+    multiplyImpl(x, y, Scalar(1), false, pool);
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::multiplyAdd(const Scalar* x, Scalar* y, Scalar alpha, ThreadPool* pool) const {
+    multiplyImpl(x, y, alpha, true, pool);
+}
+
+template <typename Scalar, int BR, int BC>
+void BlockSparseMatrix<Scalar, BR, BC>::multiplyTranspose(const Scalar* x, Scalar* y) const {
+    using RowVector = Eigen::Matrix<Scalar, BR, 1>;
+    using ColVector = Eigen::Matrix<Scalar, BC, 1>;
+    std::fill(y, y + cols(), Scalar(0));
+    for (int r = 0; r < block_rows_; ++r) {
+        const Eigen::Map<const RowVector> xr(x + static_cast<std::size_t>(r) * BR);
+        for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; ++k) {
+            Eigen::Map<ColVector> yc(y + static_cast<std::size_t>(col_[k]) * BC);
+            yc.noalias() += block(k).transpose() * xr;
+        }
+    }
+}
+
+template <typename Scalar, int BR, int BC>
+typename BlockSparseMatrix<Scalar, BR, BC>::Dense BlockSparseMatrix<Scalar, BR, BC>::toDense() const {
+    Dense dense = Dense::Zero(rows(), cols());
+    for (int r = 0; r < block_rows_; ++r) {
+        for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; ++k) {
+            dense.template block<BR, BC>(r * BR, col_[k] * BC) = block(k);
+        }
+    }
+    return dense;
+}
+
+template <typename Scalar, int BR, int BC>
+typename BlockSparseMatrix<Scalar, BR, BC>::Sparse BlockSparseMatrix<Scalar, BR, BC>::toSparse() const {
+    std::vector<Eigen::Triplet<Scalar>> triplets;
+    triplets.reserve(values_.size());
+    for (int r = 0; r < block_rows_; ++r) {
+        for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; ++k) {
+            const ConstBlockMap b = block(k);
+            for (int j = 0; j < BC; ++j) {
+                for (int i = 0; i < BR; ++i) triplets.emplace_back(r * BR + i, col_[k] * BC + j, b(i, j));
+            }
+        }
+    }
+    Sparse sparse(rows(), cols());
+    sparse.setFromTriplets(triplets.begin(), triplets.end());
+    return sparse;
+}
+
+template <typename Scalar, int BR, int BC>
+bool BlockSparseMatrix<Scalar, BR, BC>::fromDense(const Dense& dense, Scalar tolerance) {
+    if (dense.rows() % BR != 0 || dense.cols() % BC != 0) return false;
+    resize(static_cast<int>(dense.rows() / BR), static_cast<int>(dense.cols() / BC));
+    for (int r = 0; r < block_rows_; ++r) {
+        for (int c = 0; c < block_cols_; ++c) {
+            const auto b = dense.template block<BR, BC>(r * BR, c * BC);
+            if (!(b.cwiseAbs().maxCoeff() > tolerance)) continue;
+            col_.push_back(c);
+            values_.resize(values_.size() + kBlockSize);
+            block(nonZeroBlocks() - 1) = b;
+        }
+        row_ptr_[r + 1] = nonZeroBlocks();
+    }
+    return true;
+}
+
+template <typename Scalar, int BR, int BC>
+bool BlockSparseMatrix<Scalar, BR, BC>::fromSparse(const Sparse& sparse, Scalar tolerance) {
+    if (sparse.rows() % BR != 0 || sparse.cols() % BC != 0) return false;
+    const int block_rows = static_cast<int>(sparse.rows() / BR);
+    const int block_cols = static_cast<int>(sparse.cols() / BC);
+    std::vector<std::pair<int, int>> pattern;
+    pattern.reserve(sparse.nonZeros());
+    for (int c = 0; c < sparse.outerSize(); ++c) {
+        for (typename Sparse::InnerIterator it(sparse, c); it; ++it) {
+            if (std::abs(it.value()) > tolerance) pattern.emplace_back(static_cast<int>(it.row()) / BR, c / BC);
+        }
+    }
+    setPattern(block_rows, block_cols, std::move(pattern));
+    for (int c = 0; c < sparse.outerSize(); ++c) {
+        for (typename Sparse::InnerIterator it(sparse, c); it; ++it) {
+            const int k = findBlock(static_cast<int>(it.row()) / BR, c / BC);
+            if (k >= 0) block(k)(static_cast<int>(it.row()) % BR, c % BC) += it.value();
+        }
+    }
+    return true;
+}
+
+#define SLAM_INSTANTIATE_BLOCK_SPARSE(Scalar)       \
+    template class BlockSparseMatrix<Scalar, 3, 3>; \
+    template class BlockSparseMatrix<Scalar, 6, 6>; \
+    template class BlockSparseMatrix<Scalar, 6, 3>; \
+    template class BlockSparseMatrix<Scalar, 3, 6>; \
+    template class BlockSparseMatrix<Scalar, 2, 6>; \
+    template class BlockSparseMatrix<Scalar, 2, 3>;
+
+SLAM_INSTANTIATE_BLOCK_SPARSE(float)
+SLAM_INSTANTIATE_BLOCK_SPARSE(double)
+
+#undef SLAM_INSTANTIATE_BLOCK_SPARSE
+
+}  // namespace slam
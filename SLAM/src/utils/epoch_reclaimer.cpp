@@ -0,0 +1,90 @@
+#include "utils/epoch_reclaimer.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace slam {
+
+namespace {
+
+// 每个线程从不同的槽位开始找，读线程少时基本一次 CAS 就能占到
+unsigned slotHint() {
+    static std::atomic<unsigned> next{0};
+    thread_local const unsigned hint = next.fetch_add(1, std::memory_order_relaxed);
+    return hint;
+}
+
+}  // namespace
+
+EpochReclaimer::Guard& EpochReclaimer::Guard::operator=(Guard&& other) noexcept {
+    if (this != &other) {
+        release();
+        slot_ = other.slot_;
+        other.slot_ = nullptr;
+    }
+    return *this;
+}
+
+void EpochReclaimer::Guard::release() {
+    if (slot_) {
+        slot_->store(0, std::memory_order_release);
+        slot_ = nullptr;
+    }
+}
+
+EpochReclaimer::~EpochReclaimer() {
+    for (const Retired& r : retired_) r.deleter(r.p);
+}
+
+EpochReclaimer::Guard EpochReclaimer::enter() {
+    const unsigned start = slotHint();
+    for (;;) {
+        for (int k = 0; k < kMaxReaders; ++k) {
+            Slot& slot = slots_[(start + k) % kMaxReaders];
+            std::uint64_t e = epoch_.load();
+            std::uint64_t expected = 0;
+            if (!slot.epoch.compare_exchange_strong(expected, e)) continue;
+            // 登记之后再确认一次全局 epoch：写者在登记前推进了 epoch 就改登记新值，
+            // 保证登记值稳定时之后读到的都是已经摘除旧对象后的数据
+            for (std::uint64_t now = epoch_.load(); now != e; now = epoch_.load()) {
+                e = now;
+                slot.epoch.store(e);
+            }
+            return Guard(&slot.epoch);
+        }
+        std::this_thread::yield();
+    }
+}
+
+void EpochReclaimer::retire(void* p, void (*deleter)(void*)) {
+    // 摘除之后推进 epoch：在新 epoch 登记的读者不可能再读到 p
+    const std::uint64_t e = epoch_.fetch_add(1);
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    retired_.push_back({p, deleter, e});
+}
+
+int EpochReclaimer::reclaim() {
+    std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+    for (const Slot& slot : slots_) {
+        const std::uint64_t e = slot.epoch.load();
+        if (e != 0) oldest = std::min(oldest, e);
+    }
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        const auto split = std::partition(retired_.begin(), retired_.end(),
+                                          [oldest](const Retired& r) { return r.epoch >= oldest; });
+        ready.assign(split, retired_.end());
+        retired_.erase(split, retired_.end());
+    }
+    for (const Retired& r : ready) r.deleter(r.p);
+    return static_cast<int>(ready.size());
+}
+
+std::size_t EpochReclaimer::pending() const {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    return retired_.size();
+}
+
+}  // namespace slam
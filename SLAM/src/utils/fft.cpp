@@ -0,0 +1,465 @@
+#include "utils/fft.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace slam {
+
+namespace {
+
+// 分块转置的块大小（两个 16x16 float 块都留在 L1 里）
+constexpr int kTile = 16;
+
+// 沿 batch 的 SIMD 包：GCC / Clang 的向量类型直接支持 + - *，同一份蝶形代码既处理整包也处理尾部标量
+#if defined(__AVX512F__)
+constexpr int kLanes = 16;
+using Packet = __m512;
+inline Packet load(const float* p, Packet) { return _mm512_loadu_ps(p); }
+inline void store(float* p, Packet v) { _mm512_storeu_ps(p, v); }
+inline Packet broadcast(float x, Packet) { return _mm512_set1_ps(x); }
+#elif defined(__AVX2__)
+constexpr int kLanes = 8;
+using Packet = __m256;
+inline Packet load(const float* p, Packet) { return _mm256_loadu_ps(p); }
+inline void store(float* p, Packet v) { _mm256_storeu_ps(p, v); }
+inline Packet broadcast(float x, Packet) { return _mm256_set1_ps(x); }
+#endif
+
+inline float load(const float* p, float) { return *p; }
+inline void store(float* p, float v) { *p = v; }
+inline float broadcast(float x, float) { return x; }
+
+// 各级蝶形：输入第 r 行是 x + r * in_stride，输出第 r 行是 y + r * out_stride，每行 batch 个元素；
+// w 是本级第 1..radix-1 行的旋转因子（逆变换取共轭）。T 是 Packet 或 float，b 是本次处理的起点
+template <bool Inverse, typename T>
+inline void radix2(const float* xr, const float* xi, std::size_t is, float* yr, float* yi, std::size_t os,
+                   const float* w_re, const float* w_im, int b) {
+    const T wr = broadcast(w_re[0], T()), wi = broadcast(Inverse ? -w_im[0] : w_im[0], T());
+    const T x0r = load(xr + b, T()), x0i = load(xi + b, T());
+    const T x1r = load(xr + is + b, T()), x1i = load(xi + is + b, T());
+    const T ar = x1r * wr - x1i * wi, ai = x1r * wi + x1i * wr;
+    store(yr + b, x0r + ar);
+    store(yi + b, x0i + ai);
+    store(yr + os + b, x0r - ar);
+    store(yi + os + b, x0i - ai);
+}
+
+template <bool Inverse, typename T>
+inline void radix3(const float* xr, const float* xi, std::size_t is, float* yr, float* yi, std::size_t os,
+                   const float* w_re, const float* w_im, int b) {
+    const T w1r = broadcast(w_re[0], T()), w1i = broadcast(Inverse ? -w_im[0] : w_im[0], T());
+    const T w2r = broadcast(w_re[1], T()), w2i = broadcast(Inverse ? -w_im[1] : w_im[1], T());
+    // e^{∓2πi/3} = -1/2 ∓ i √3/2
+    const T half = broadcast(0.5f, T());
+    const T s = broadcast(Inverse ? 0.86602540378443865f : -0.86602540378443865f, T());
+    const T x0r = load(xr + b, T()), x0i = load(xi + b, T());
+    const T x1r = load(xr + is + b, T()), x1i = load(xi + is + b, T());
+    const T x2r = load(xr + 2 * is + b, T()), x2i = load(xi + 2 * is + b, T());
+    const T ar = x1r * w1r - x1i * w1i, ai = x1r * w1i + x1i * w1r;
+    const T br = x2r * w2r - x2i * w2i, bi = x2r * w2i + x2i * w2r;
+    const T tr = ar + br, ti = ai + bi;
+    const T mr = x0r - half * tr, mi = x0i - half * ti;
+    const T dr = s * (ar - br), di = s * (ai - bi);  // ∓ √3/2 (a - b)，再乘 i
+    store(yr + b, x0r + tr);
+    store(yi + b, x0i + ti);
+    store(yr + os + b, mr - di);
+    store(yi + os + b, mi + dr);
+    store(yr + 2 * os + b, mr + di);
+    store(yi + 2 * os + b, mi - dr);
+}
+
+template <bool Inverse, typename T>
+inline void radix4(const float* xr, const float* xi, std::size_t is, float* yr, float* yi, std::size_t os,
+                   const float* w_re, const float* w_im, int b) {
+    const T w1r = broadcast(w_re[0], T()), w1i = broadcast(Inverse ? -w_im[0] : w_im[0], T());
+    const T w2r = broadcast(w_re[1], T()), w2i = broadcast(Inverse ? -w_im[1] : w_im[1], T());
+    const T w3r = broadcast(w_re[2], T()), w3i = broadcast(Inverse ? -w_im[2] : w_im[2], T());
+    const T x0r = load(xr + b, T()), x0i = load(xi + b, T());
+    const T x1r = load(xr + is + b, T()), x1i = load(xi + is + b, T());
+    const T x2r = load(xr + 2 * is + b, T()), x2i = load(xi + 2 * is + b, T());
+    const T x3r = load(xr + 3 * is + b, T()), x3i = load(xi + 3 * is + b, T());
+    const T v1r = x1r * w1r - x1i * w1i, v1i = x1r * w1i + x1i * w1r;
+    const T v2r = x2r * w2r - x2i * w2i, v2i = x2r * w2i + x2i * w2r;
+    const T v3r = x3r * w3r - x3i * w3i, v3i = x3r * w3i + x3i * w3r;
+    const T a0r = x0r + v2r, a0i = x0i + v2i;
+    const T a1r = x0r - v2r, a1i = x0i - v2i;
+    const T a2r = v1r + v3r, a2i = v1i + v3i;
+    // (v1 - v3) 正变换乘 -i，逆变换乘 +i
+    const T dr = v1r - v3r, di = v1i - v3i;
+    const T a3r = Inverse ? T() - di : di;
+    const T a3i = Inverse ? dr : T() - dr;
+    store(yr + b, a0r + a2r);
+    store(yi + b, a0i + a2i);
+    store(yr + os + b, a1r + a3r);
+    store(yi + os + b, a1i + a3i);
+    store(yr + 2 * os + b, a0r - a2r);
+    store(yi + 2 * os + b, a0i - a2i);
+    store(yr + 3 * os + b, a1r - a3r);
+    store(yi + 3 * os + b, a1i - a3i);
+}
+
+// 4 点 DFT（正变换乘 -i，逆变换乘 +i），结果写回 c0..c3
+template <bool Inverse, typename T>
+inline void dft4(T& c0r, T& c0i, T& c1r, T& c1i, T& c2r, T& c2i, T& c3r, T& c3i) {
+    const T e0r = c0r + c2r, e0i = c0i + c2i;
+    const T e1r = c0r - c2r, e1i = c0i - c2i;
+    const T e2r = c1r + c3r, e2i = c1i + c3i;
+    const T dr = c1r - c3r, di = c1i - c3i;
+    const T e3r = Inverse ? T() - di : di;
+    const T e3i = Inverse ? dr : T() - dr;
+    c0r = e0r + e2r;
+    c0i = e0i + e2i;
+    c1r = e1r + e3r;
+    c1i = e1i + e3i;
+    c2r = e0r - e2r;
+    c2i = e0i - e2i;
+    c3r = e1r - e3r;
+    c3i = e1i - e3i;
+}
+
+// 基 8：先做一层基 2（频率抽取），奇数一半乘 W8^k，再各做一次 4 点 DFT；一级顶三级基 2，少读写两遍数据
+template <bool Inverse, typename T>
+inline void radix8(const float* xr, const float* xi, std::size_t is, float* yr, float* yi, std::size_t os,
+                   const float* w_re, const float* w_im, int b) {
+    T vr[8], vi[8];
+    vr[0] = load(xr + b, T());
+    vi[0] = load(xi + b, T());
+    for (int r = 1; r < 8; ++r) {
+        const T x_r = load(xr + r * is + b, T()), x_i = load(xi + r * is + b, T());
+        const T wr = broadcast(w_re[r - 1], T()), wi = broadcast(Inverse ? -w_im[r - 1] : w_im[r - 1], T());
+        vr[r] = x_r * wr - x_i * wi;
+        vi[r] = x_r * wi + x_i * wr;
+    }
+    T ar[4], ai[4], br[4], bi[4];
+    for (int k = 0; k < 4; ++k) {
+        ar[k] = vr[k] + vr[k + 4];
+        ai[k] = vi[k] + vi[k + 4];
+        br[k] = vr[k] - vr[k + 4];
+        bi[k] = vi[k] - vi[k + 4];
+    }
+    // b_k *= W8^k，W8 = e^{∓iπ/4}
+    const T h = broadcast(0.70710678118654752f, T());
+    if (Inverse) {
+        const T t1r = h * (br[1] - bi[1]), t1i = h * (br[1] + bi[1]);
+        const T t2r = T() - bi[2], t2i = br[2];
+        const T t3r = T() - h * (br[3] + bi[3]), t3i = h * (br[3] - bi[3]);
+        br[1] = t1r, bi[1] = t1i, br[2] = t2r, bi[2] = t2i, br[3] = t3r, bi[3] = t3i;
+    } else {
+        const T t1r = h * (br[1] + bi[1]), t1i = h * (bi[1] - br[1]);
+        const T t2r = bi[2], t2i = T() - br[2];
+        const T t3r = h * (bi[3] - br[3]), t3i = T() - h * (br[3] + bi[3]);
+        br[1] = t1r, bi[1] = t1i, br[2] = t2r, bi[2] = t2i, br[3] = t3r, bi[3] = t3i;
+    }
+    dft4<Inverse>(ar[0], ai[0], ar[1], ai[1], ar[2], ai[2], ar[3], ai[3]);
+    dft4<Inverse>(br[0], bi[0], br[1], bi[1], br[2], bi[2], br[3], bi[3]);
+    for (int k = 0; k < 4; ++k) {
+        store(yr + 2 * k * os + b, ar[k]);
+        store(yi + 2 * k * os + b, ai[k]);
+        store(yr + (2 * k + 1) * os + b, br[k]);
+        store(yi + (2 * k + 1) * os + b, bi[k]);
+    }
+}
+
+// 其余素因子：直接 O(p²) 的 DFT，y_q = Σ_r (w_r x_r) e^{∓2πi qr/p}，每项的系数先在标量里合并
+template <bool Inverse, typename T>
+inline void radixGeneric(int radix, const float* xr, const float* xi, std::size_t is, float* yr, float* yi,
+                         std::size_t os, const float* w_re, const float* w_im, const float* root_re,
+                         const float* root_im, int b) {
+    for (int q = 0; q < radix; ++q) {
+        T accr = load(xr + b, T()), acci = load(xi + b, T());
+        for (int r = 1; r < radix; ++r) {
+            const int t = (q * r) % radix;
+            const float er = root_re[t], ei = Inverse ? -root_im[t] : root_im[t];
+            const float wr = w_re[r - 1], wi = Inverse ? -w_im[r - 1] : w_im[r - 1];
+            const T cr = broadcast(wr * er - wi * ei, T()), ci = broadcast(wr * ei + wi * er, T());
+            const T x_r = load(xr + r * is + b, T()), x_i = load(xi + r * is + b, T());
+            accr = accr + x_r * cr - x_i * ci;
+            acci = acci + x_r * ci + x_i * cr;
+        }
+        store(yr + q * os + b, accr);
+        store(yi + q * os + b, acci);
+    }
+}
+
+// 整包部分用 Packet，剩下的逐个标量
+template <typename Kernel>
+inline void forBatch(int batch, Kernel kernel) {
+    int b = 0;
+#if defined(__AVX512F__) || defined(__AVX2__)
+    for (; b + kLanes <= batch; b += kLanes) kernel(Packet(), b);
+#endif
+    for (; b < batch; ++b) kernel(0.0f, b);
+}
+
+// 对一组 (输入, 输出) 行做一次蝶形
+template <bool Inverse>
+void butterfly(int radix, const float* xr, const float* xi, std::size_t is, float* yr, float* yi, std::size_t os,
+               const float* w_re, const float* w_im, const float* root_re, const float* root_im, int batch) {
+    switch (radix) {
+        case 2:
+            forBatch(batch, [&](auto tag, int b) {
+                radix2<Inverse, decltype(tag)>(xr, xi, is, yr, yi, os, w_re, w_im, b);
+            });
+            break;
+        case 3:
+            forBatch(batch, [&](auto tag, int b) {
+                radix3<Inverse, decltype(tag)>(xr, xi, is, yr, yi, os, w_re, w_im, b);
+            });
+            break;
+        case 4:
+            forBatch(batch, [&](auto tag, int b) {
+                radix4<Inverse, decltype(tag)>(xr, xi, is, yr, yi, os, w_re, w_im, b);
+            });
+            break;
+        case 8:
+            forBatch(batch, [&](auto tag, int b) {
+                radix8<Inverse, decltype(tag)>(xr, xi, is, yr, yi, os, w_re, w_im, b);
+            });
+            break;
+        default:
+            forBatch(batch, [&](auto tag, int b) {
+                radixGeneric<Inverse, decltype(tag)>(radix, xr, xi, is, yr, yi, os, w_re, w_im, root_re, root_im, b);
+            });
+            break;
+    }
+}
+
+}  // namespace
+
+FftPlan::FftPlan(int n) : n_(std::max(n, 1)) {
+    // 1. 分解：先取 8、4，再取 2、3、5 和其余素因子
+    std::vector<int> radices;
+    int rest = n_;
+    while (rest % 8 == 0) {
+        radices.push_back(8);
+        rest /= 8;
+    }
+    while (rest % 4 == 0) {
+        radices.push_back(4);
+        rest /= 4;
+    }
+    for (int p = 2; rest > 1; ++p) {
+        while (rest % p == 0) {
+            radices.push_back(p);
+            rest /= p;
+        }
+        if (p * p > rest && rest > 1) {
+            radices.push_back(rest);
+            break;
+        }
+    }
+
+    // 2. 每级的旋转因子 e^{-2πi r k / (span p)}，k ∈ [0, span)，r ∈ [1, p)；通用蝶形再附 p 个单位根
+    int span = 1;
+    for (const int p : radices) {
+        Stage stage{p, span, static_cast<int>(twiddle_re_.size())};
+        for (int k = 0; k < span; ++k) {
+            for (int r = 1; r < p; ++r) {
+                const double angle = -2.0 * M_PI * r * k / (static_cast<double>(span) * p);
+                twiddle_re_.push_back(static_cast<float>(std::cos(angle)));
+                twiddle_im_.push_back(static_cast<float>(std::sin(angle)));
+            }
+        }
+        if (p != 2 && p != 3 && p != 4 && p != 8) {
+            for (int t = 0; t < p; ++t) {
+                const double angle = -2.0 * M_PI * t / p;
+                twiddle_re_.push_back(static_cast<float>(std::cos(angle)));
+                twiddle_im_.push_back(static_cast<float>(std::sin(angle)));
+            }
+        }
+        stages_.push_back(stage);
+        span *= p;
+    }
+}
+
+void FftPlan::forward(const float* src_re, const float* src_im, int src_pitch, float* dst_re, float* dst_im,
+                      int dst_pitch, int batch, float* work_re, float* work_im) const {
+    transform(src_re, src_im, src_pitch, dst_re, dst_im, dst_pitch, batch, work_re, work_im, false);
+}
+
+void FftPlan::inverse(const float* src_re, const float* src_im, int src_pitch, float* dst_re, float* dst_im,
+                      int dst_pitch, int batch, float* work_re, float* work_im) const {
+    transform(src_re, src_im, src_pitch, dst_re, dst_im, dst_pitch, batch, work_re, work_im, true);
+}
+
+void FftPlan::forward(float* re, float* im, int batch, float* work_re, float* work_im) const {
+    transform(re, im, batch, re, im, batch, batch, work_re, work_im, false);
+}
+
+void FftPlan::inverse(float* re, float* im, int batch, float* work_re, float* work_im) const {
+    transform(re, im, batch, re, im, batch, batch, work_re, work_im, true);
+}
+
+void FftPlan::transform(const float* src_re, const float* src_im, int src_pitch, float* dst_re, float* dst_im,
+                        int dst_pitch, int batch, float* work_re, float* work_im, bool inverse) const {
+    const int num_stages = static_cast<int>(stages_.size());
+    const bool in_place = src_re == dst_re;
+    const float* cur_re = src_re;
+    const float* cur_im = src_im;
+    int cur_pitch = src_pitch;
+    for (int s = 0; s < num_stages; ++s) {
+        // 非原地时倒着排：最后一级写 dst，往前每隔一级写一次工作区；原地时从工作区开始交替
+        const bool to_work = in_place ? s % 2 == 0 : (num_stages - 1 - s) % 2 == 1;
+        float* next_re = to_work ? work_re : dst_re;
+        float* next_im = to_work ? work_im : dst_im;
+        const int next_pitch = to_work ? batch : dst_pitch;
+
+        const Stage& stage = stages_[s];
+        const int p = stage.radix;
+        const int m = n_ / p;
+        const std::size_t in_stride = static_cast<std::size_t>(m) * cur_pitch;
+        const std::size_t out_stride = static_cast<std::size_t>(stage.span) * next_pitch;
+        const float* roots_re = twiddle_re_.data() + stage.twiddle_offset + stage.span * (p - 1);
+        const float* roots_im = twiddle_im_.data() + stage.twiddle_offset + stage.span * (p - 1);
+        // Stockham：j = g span + k，输入第 j + r m 行，输出第 g span p + k + r span 行
+        for (int g = 0; g < m / stage.span; ++g) {
+            for (int k = 0; k < stage.span; ++k) {
+                const std::size_t in = (static_cast<std::size_t>(g) * stage.span + k) * cur_pitch;
+                const std::size_t out = (static_cast<std::size_t>(g) * stage.span * p + k) * next_pitch;
+                const float* w_re = twiddle_re_.data() + stage.twiddle_offset + k * (p - 1);
+                const float* w_im = twiddle_im_.data() + stage.twiddle_offset + k * (p - 1);
+                if (inverse) {
+                    butterfly<true>(p, cur_re + in, cur_im + in, in_stride, next_re + out, next_im + out, out_stride,
+                                    w_re, w_im, roots_re, roots_im, batch);
+                } else {
+                    butterfly<false>(p, cur_re + in, cur_im + in, in_stride, next_re + out, next_im + out, out_stride,
+                                     w_re, w_im, roots_re, roots_im, batch);
+                }
+            }
+        }
+        cur_re = next_re;
+        cur_im = next_im;
+        cur_pitch = next_pitch;
+    }
+    if (cur_re != dst_re) {
+        // 没有级（n = 1），或原地且级数为奇数
+        for (int i = 0; i < n_; ++i) {
+            std::copy(cur_re + static_cast<std::size_t>(i) * cur_pitch,
+                      cur_re + static_cast<std::size_t>(i) * cur_pitch + batch,
+                      dst_re + static_cast<std::size_t>(i) * dst_pitch);
+            std::copy(cur_im + static_cast<std::size_t>(i) * cur_pitch,
+                      cur_im + static_cast<std::size_t>(i) * cur_pitch + batch,
+                      dst_im + static_cast<std::size_t>(i) * dst_pitch);
+        }
+    }
+}
+
+Eigen::MatrixXcf HalfSpectrum::toMatrix() const {
+    Eigen::MatrixXcf m(stride, width);
+    for (int u = 0; u < width; ++u) {
+        for (int v = 0; v < stride; ++v) {
+            m(v, u) = std::complex<float>(re[u * stride + v], im[u * stride + v]);
+        }
+    }
+    return m;
+}
+
+RealFft2D::RealFft2D(int width, int height)
+    : width_(std::max(width, 0)),
+      height_(std::max(height, 0)),
+      half_height_(height_ / 2 + 1),
+      plan_x_(width_),
+      plan_y_(height_) {
+    if (!valid()) return;
+    const std::size_t z_size = static_cast<std::size_t>(height_) * (width_ / 2);
+    const std::size_t spectrum_size = static_cast<std::size_t>(width_) * half_height_;
+    z_re_.resize(std::max(z_size, spectrum_size));
+    z_im_.resize(z_re_.size());
+    work_re_.resize(z_re_.size());
+    work_im_.resize(z_re_.size());
+}
+
+void RealFft2D::forward(const float* input, int stride, HalfSpectrum& spectrum) {
+    if (!valid()) return;
+    const int half_width = width_ / 2;
+    spectrum.width = width_;
+    spectrum.height = height_;
+    spectrum.stride = half_height_;
+    spectrum.re.resize(static_cast<std::size_t>(width_) * half_height_);
+    spectrum.im.resize(spectrum.re.size());
+
+    // 1. 第 x 列作实部、第 x + W/2 列作虚部，沿 y 变换：直接按行跨度读输入的左右两半
+    plan_y_.forward(input, input + half_width, stride, z_re_.data(), z_im_.data(), half_width, half_width,
+                    work_re_.data(), work_im_.data());
+
+    // 2. 共轭对称拆开两列：F_x = (Z_v + conj Z_{-v}) / 2，F_{x+W/2} = (Z_v - conj Z_{-v}) / 2i；
+    //    分块转置写到工作区（u 行、v 列）
+    float* t_re = work_re_.data();
+    float* t_im = work_im_.data();
+    for (int v0 = 0; v0 < half_height_; v0 += kTile) {
+        const int v1 = std::min(v0 + kTile, half_height_);
+        for (int x0 = 0; x0 < half_width; x0 += kTile) {
+            const int x1 = std::min(x0 + kTile, half_width);
+            for (int x = x0; x < x1; ++x) {
+                float* lo_re = t_re + static_cast<std::size_t>(x) * half_height_;
+                float* lo_im = t_im + static_cast<std::size_t>(x) * half_height_;
+                float* hi_re = t_re + static_cast<std::size_t>(x + half_width) * half_height_;
+                float* hi_im = t_im + static_cast<std::size_t>(x + half_width) * half_height_;
+                for (int v = v0; v < v1; ++v) {
+                    const std::size_t a = static_cast<std::size_t>(v) * half_width + x;
+                    const std::size_t c = static_cast<std::size_t>(v == 0 ? 0 : height_ - v) * half_width + x;
+                    const float ar = z_re_[a], ai = z_im_[a];
+                    const float cr = z_re_[c], ci = -z_im_[c];
+                    lo_re[v] = 0.5f * (ar + cr);
+                    lo_im[v] = 0.5f * (ai + ci);
+                    hi_re[v] = 0.5f * (ai - ci);
+                    hi_im[v] = -0.5f * (ar - cr);
+                }
+            }
+        }
+    }
+
+    // 3. 沿 x 变换，写进 spectrum
+    plan_x_.forward(t_re, t_im, half_height_, spectrum.re.data(), spectrum.im.data(), half_height_, half_height_,
+                    z_re_.data(), z_im_.data());
+}
+
+void RealFft2D::inverse(const HalfSpectrum& spectrum, float* output, int stride) {
+    if (!valid() || spectrum.width != width_ || spectrum.height != height_) return;
+    const int half_width = width_ / 2;
+
+    // 1. 沿 u 逆变换到工作区
+    float* t_re = work_re_.data();
+    float* t_im = work_im_.data();
+    plan_x_.inverse(spectrum.re.data(), spectrum.im.data(), half_height_, t_re, t_im, half_height_, half_height_,
+                    z_re_.data(), z_im_.data());
+
+    // 2. 转置并拼回 Z_v = F_x + i F_{x+W/2}（同时乘 1 / (W H)），v > H/2 的一半由共轭对称补全
+    const float scale = 1.0f / (static_cast<float>(width_) * static_cast<float>(height_));
+    const int mirror_end = height_ - half_height_;  // v ∈ [1, mirror_end] 有镜像行 H - v
+    for (int v0 = 0; v0 < half_height_; v0 += kTile) {
+        const int v1 = std::min(v0 + kTile, half_height_);
+        for (int x0 = 0; x0 < half_width; x0 += kTile) {
+            const int x1 = std::min(x0 + kTile, half_width);
+            for (int v = v0; v < v1; ++v) {
+                float* z_re = z_re_.data() + static_cast<std::size_t>(v) * half_width;
+                float* z_im = z_im_.data() + static_cast<std::size_t>(v) * half_width;
+                float* m_re = z_re_.data() + static_cast<std::size_t>(height_ - v) * half_width;
+                float* m_im = z_im_.data() + static_cast<std::size_t>(height_ - v) * half_width;
+                const bool mirror = v >= 1 && v <= mirror_end;
+                for (int x = x0; x < x1; ++x) {
+                    const std::size_t lo = static_cast<std::size_t>(x) * half_height_ + v;
+                    const std::size_t hi = static_cast<std::size_t>(x + half_width) * half_height_ + v;
+                    const float ar = t_re[lo] * scale, ai = t_im[lo] * scale;
+                    const float br = t_re[hi] * scale, bi = t_im[hi] * scale;
+                    z_re[x] = ar - bi;
+                    z_im[x] = ai + br;
+                    if (mirror) {
+                        m_re[x] = ar + bi;
+                        m_im[x] = br - ai;
+                    }
+                }
+            }
+        }
+    }
+
+    // 3. 沿 y 逆变换，实部写进输出的前半列、虚部写进后半列
+    plan_y_.inverse(z_re_.data(), z_im_.data(), half_width, output, output + half_width, stride, half_width,
+                    work_re_.data(), work_im_.data());
+}
+
+}  // namespace slam
@@ -0,0 +1,131 @@
+#include "utils/pipeline.h"
+
+#include "utils/profiler.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace slam {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void pinToCpu(std::thread& thread, int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+}  // namespace
+
+ThreadPool* Pipeline::addThreadPool(int num_threads) {
+    pools_.emplace_back(new ThreadPool(num_threads));
+    return pools_.back().get();
+}
+
+void Pipeline::addStage(const std::string& name, std::function<bool()> step, const std::vector<QueueBase*>& inputs,
+                        const StageOptions& options) {
+    if (running()) return;
+    std::unique_ptr<Stage> stage(new Stage);
+    stage->name = name;
+    stage->step = std::move(step);
+    stage->options = options;
+    for (QueueBase* q : inputs) {
+        if (!q) continue;
+        q->setConsumerNotifier(&stage->notifier);
+        stage->inputs.push_back(q);
+    }
+    stages_.push_back(std::move(stage));
+}
+
+void Pipeline::start() {
+    if (running_.exchange(true)) return;
+    // 上一次 stop 关闭了队列，不重新打开的话队列满时 kBlock 的 push 不再等待而是直接丢弃
+    for (auto& q : queues_) q->reopen();
+    for (auto& stage : stages_) {
+        Stage* s = stage.get();
+        s->thread = std::thread([this, s] { run(*s); });
+        pinToCpu(s->thread, s->options.cpu);
+    }
+}
+
+void Pipeline::stop() {
+    if (!running_.exchange(false)) return;
+    // 先放开背压中的生产者，再叫醒睡眠的阶段
+    for (auto& q : queues_) q->close();
+    for (auto& stage : stages_) stage->notifier.notify();
+    for (auto& stage : stages_) {
+        if (stage->thread.joinable()) stage->thread.join();
+    }
+}
+
+void Pipeline::run(Stage& stage) {
+#if defined(SLAM_PROFILING)
+    // 做了事的 step 按阶段名记入直方图和 trace
+    Profiler::global().setThreadName(stage.name);
+    const int profile_stage = Profiler::global().stageId("pipeline/" + stage.name);
+#endif
+    int idle = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        const auto start = Clock::now();
+        if (stage.step()) {
+            const std::int64_t busy_ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            stage.steps.fetch_add(1, std::memory_order_relaxed);
+            stage.busy_ns.fetch_add(busy_ns, std::memory_order_relaxed);
+#if defined(SLAM_PROFILING)
+            Profiler::global().record(
+                profile_stage,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count(), busy_ns);
+#endif
+            idle = 0;
+            continue;
+        }
+        if (++idle <= stage.options.idle_spins) {
+            std::this_thread::yield();
+            continue;
+        }
+        stage.idle_waits.fetch_add(1, std::memory_order_relaxed);
+        stage.notifier.waitFor(stage.options.idle_timeout, [this, &stage] {
+            if (!running_.load(std::memory_order_acquire)) return true;
+            for (const QueueBase* q : stage.inputs) {
+                if (!q->empty()) return true;
+            }
+            return false;
+        });
+        idle = 0;
+    }
+}
+
+std::vector<QueueStats> Pipeline::queueStats() const {
+    std::vector<QueueStats> stats;
+    stats.reserve(queues_.size());
+    for (const auto& q : queues_) stats.push_back(q->stats());
+    return stats;
+}
+
+std::vector<StageStats> Pipeline::stageStats() const {
+    std::vector<StageStats> stats;
+    stats.reserve(stages_.size());
+    for (const auto& stage : stages_) {
+        StageStats s;
+        s.name = stage->name;
+        s.steps = stage->steps.load(std::memory_order_relaxed);
+        s.idle_waits = stage->idle_waits.load(std::memory_order_relaxed);
+        s.busy_ms = stage->busy_ns.load(std::memory_order_relaxed) * 1e-6;
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+}  // namespace slam
@@ -0,0 +1,102 @@
+#include "utils/polynomial.h"
+
+#include <cmath>
+
+namespace slam {
+
+double evaluatePolynomial(const double* coeffs, int degree, double x) {
+    double v = coeffs[0];
+    for (int i = 1; i <= degree; ++i) v = v * x + coeffs[i];
+    return v;
+}
+
+int solveCubicMonic(double a, double b, double c, double roots[3]) {
+    const double Q = (a * a - 3.0 * b) / 9.0;
+    const double R = (2.0 * a * a * a - 9.0 * a * b + 27.0 * c) / 54.0;
+    const double Q3 = Q * Q * Q;
+    if (R * R < Q3) {
+        // 三个实根
+        const double theta = std::acos(R / std::sqrt(Q3));
+        const double s = -2.0 * std::sqrt(Q);
+        roots[0] = s * std::cos(theta / 3.0) - a / 3.0;
+        roots[1] = s * std::cos((theta + 2.0 * M_PI) / 3.0) - a / 3.0;
+        roots[2] = s * std::cos((theta - 2.0 * M_PI) / 3.0) - a / 3.0;
+        return 3;
+    }
+    const double A = -std::copysign(std::cbrt(std::fabs(R) + std::sqrt(R * R - Q3)), R);
+    const double B = (A != 0.0) ? Q / A : 0.0;
+    roots[0] = A + B - a / 3.0;
+    return 1;
+}
+
+namespace {
+
+// x^2 + p x + q = 0
+int solveQuadraticMonic(double p, double q, double* roots) {
+    const double disc = p * p - 4.0 * q;
+    if (disc < 0.0) return 0;
+    const double s = std::sqrt(disc);
+    // 避免相近数相减的精度损失
+    const double r0 = (p >= 0.0) ? (-p - s) * 0.5 : (-p + s) * 0.5;
+    roots[0] = r0;
+    roots[1] = (r0 != 0.0) ? q / r0 : -p - r0;
+    return 2;
+}
+
+}  // namespace
+
+int solveQuartic(const double coeffs[5], double roots[4]) {
+    const double a = coeffs[0];
+    if (std::fabs(a) < 1e-14 * (std::fabs(coeffs[1]) + std::fabs(coeffs[2]) + 1e-300)) {
+        if (std::fabs(coeffs[1]) < 1e-300) return 0;
+        return solveCubicMonic(coeffs[2] / coeffs[1], coeffs[3] / coeffs[1], coeffs[4] / coeffs[1], roots);
+    }
+    const double B = coeffs[1] / a, C = coeffs[2] / a, D = coeffs[3] / a, E = coeffs[4] / a;
+
+    // x = y - B/4，化为 y^4 + p y^2 + q y + r = 0
+    const double B2 = B * B;
+    const double p = C - 3.0 * B2 / 8.0;
+    const double q = D - B * C / 2.0 + B2 * B / 8.0;
+    const double r = E - B * D / 4.0 + B2 * C / 16.0 - 3.0 * B2 * B2 / 256.0;
+
+    int n = 0;
+    double y[4];
+    if (std::fabs(q) < 1e-12) {
+        // 双二次方程
+        double z[2];
+        const int nz = solveQuadraticMonic(p, r, z);
+        for (int i = 0; i < nz; ++i) {
+            if (z[i] >= 0.0) {
+                const double s = std::sqrt(z[i]);
+                y[n++] = s;
+                y[n++] = -s;
+            }
+        }
+    } else {
+        // 预解三次方程 m^3 + p m^2 + (p^2/4 - r) m - q^2/8 = 0 取最大的实根（必为正）
+        double m_roots[3];
+        const int nm = solveCubicMonic(p, p * p / 4.0 - r, -q * q / 8.0, m_roots);
+        double m = m_roots[0];
+        for (int i = 1; i < nm; ++i) m = std::fmax(m, m_roots[i]);
+        if (m <= 0.0) return 0;
+        const double s = std::sqrt(2.0 * m);
+        n += solveQuadraticMonic(-s, p / 2.0 + m + q / (2.0 * s), y + n);
+        n += solveQuadraticMonic(s, p / 2.0 + m - q / (2.0 * s), y + n);
+    }
+
+    // 牛顿迭代修正闭式解的舍入误差
+    const double monic[5] = {1.0, B, C, D, E};
+    const double deriv[4] = {4.0, 3.0 * B, 2.0 * C, D};
+    for (int i = 0; i < n; ++i) {
+        double x = y[i] - B / 4.0;
+        for (int it = 0; it < 2; ++it) {
+            const double d = evaluatePolynomial(deriv, 3, x);
+            if (d == 0.0) break;
+            x -= evaluatePolynomial(monic, 4, x) / d;
+        }
+        roots[i] = x;
+    }
+    return n;
+}
+
+}  // namespace slam
@@ -0,0 +1,315 @@
+#include "utils/profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+namespace slam {
+
+namespace {
+
+constexpr std::uint64_t kNoMin = std::numeric_limits<std::uint64_t>::max();
+
+// JSON 字符串转义（阶段名、线程名一般是普通 ASCII）
+void appendEscaped(std::string& out, const std::string& s) {
+    for (const char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+}
+
+// 纳秒 → trace 的微秒时间戳（保留到纳秒）
+void appendMicros(std::string& out, std::int64_t ns) {
+    char buf[32];
+    const char* sign = ns < 0 ? "-" : "";
+    const std::uint64_t v = static_cast<std::uint64_t>(ns < 0 ? -ns : ns);
+    std::snprintf(buf, sizeof(buf), "%s%llu.%03llu", sign, static_cast<unsigned long long>(v / 1000),
+                  static_cast<unsigned long long>(v % 1000));
+    out += buf;
+}
+
+}  // namespace
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int b = 0; b < kBuckets; ++b) bump(counts_[b], other.counts_[b].load(std::memory_order_relaxed));
+    bump(count_, other.count_.load(std::memory_order_relaxed));
+    bump(sum_, other.sum_.load(std::memory_order_relaxed));
+    min_.store(std::min(min_.load(std::memory_order_relaxed), other.min_.load(std::memory_order_relaxed)),
+               std::memory_order_relaxed);
+    max_.store(std::max(max_.load(std::memory_order_relaxed), other.max_.load(std::memory_order_relaxed)),
+               std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(kNoMin, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    const std::uint64_t n = count();
+    return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+}
+
+double LatencyHistogram::percentile(double p) const {
+    const std::uint64_t n = count();
+    if (n == 0) return 0.0;
+    const double clamped = std::max(0.0, std::min(1.0, p));
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(clamped * n + 0.5));
+    std::uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += counts_[b].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            const double low = static_cast<double>(bucketLow(b));
+            const double high = b + 1 < kBuckets ? static_cast<double>(bucketLow(b + 1)) : low;
+            // 桶中点，但不超出实际的最小 / 最大值
+            return std::max<double>(static_cast<double>(min()), std::min<double>(static_cast<double>(max()),
+                                                                                  0.5 * (low + high)));
+        }
+    }
+    return static_cast<double>(max());
+}
+
+// 每个线程一块，只有所属线程写
+struct Profiler::ThreadBuffer {
+    int tid = 0;
+    std::string name;                                       // 受 Profiler::mutex_ 保护
+    std::atomic<LatencyHistogram*> histograms[kMaxStages];  // 第一次记录该阶段时分配
+    std::atomic<std::int64_t> counters[kMaxCounters];
+    std::unique_ptr<TraceEvent[]> events;                   // 第一次记录时分配（开启 trace 时）
+    int capacity = 0;
+    std::atomic<std::uint64_t> num_events{0};               // 已发布的事件数
+    std::atomic<std::uint64_t> dropped{0};
+
+    ThreadBuffer() {
+        for (auto& h : histograms) h.store(nullptr, std::memory_order_relaxed);
+        for (auto& c : counters) c.store(0, std::memory_order_relaxed);
+    }
+    ~ThreadBuffer() {
+        for (auto& h : histograms) delete h.load(std::memory_order_relaxed);
+    }
+};
+
+Profiler::Profiler() = default;
+
+Profiler::~Profiler() = default;
+
+Profiler& Profiler::global() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::ThreadBuffer& Profiler::local() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::unique_ptr<ThreadBuffer> b(new ThreadBuffer);
+        if (tracing_.load(std::memory_order_relaxed)) {
+            b->capacity = std::max(0, events_per_thread_.load(std::memory_order_relaxed));
+            b->events.reset(new TraceEvent[b->capacity]);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        b->tid = static_cast<int>(threads_.size()) + 1;
+        b->name = "thread " + std::to_string(b->tid);
+        buffer = b.get();
+        threads_.push_back(std::move(b));
+    }
+    return *buffer;
+}
+
+int Profiler::stageId(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = std::find(stage_names_.begin(), stage_names_.end(), name);
+    if (it != stage_names_.end()) return static_cast<int>(it - stage_names_.begin());
+    if (static_cast<int>(stage_names_.size()) >= kMaxStages) return -1;
+    stage_names_.push_back(name);
+    return static_cast<int>(stage_names_.size()) - 1;
+}
+
+int Profiler::counterId(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = std::find(counter_names_.begin(), counter_names_.end(), name);
+    if (it != counter_names_.end()) return static_cast<int>(it - counter_names_.begin());
+    if (static_cast<int>(counter_names_.size()) >= kMaxCounters) return -1;
+    counter_names_.push_back(name);
+    return static_cast<int>(counter_names_.size()) - 1;
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer& b = local();
+    std::lock_guard<std::mutex> lock(mutex_);
+    b.name = name;
+}
+
+void Profiler::setTracing(bool enabled, int events_per_thread) {
+    events_per_thread_.store(std::max(0, events_per_thread), std::memory_order_relaxed);
+    tracing_.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::record(int stage, std::int64_t start_ns, std::int64_t duration_ns) {
+    if (stage < 0 || stage >= kMaxStages) return;
+    ThreadBuffer& b = local();
+    LatencyHistogram* h = b.histograms[stage].load(std::memory_order_relaxed);
+    if (!h) {
+        h = new LatencyHistogram;
+        b.histograms[stage].store(h, std::memory_order_release);
+    }
+    h->record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration_ns)));
+
+    if (!tracing_.load(std::memory_order_relaxed)) return;
+    const std::uint64_t n = b.num_events.load(std::memory_order_relaxed);
+    if (n >= static_cast<std::uint64_t>(b.capacity)) {
+        b.dropped.store(b.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    b.events[n] = {stage, start_ns, duration_ns};
+    // 先写事件再发布计数，读者只读 num_events 以内的
+    b.num_events.store(n + 1, std::memory_order_release);
+}
+
+void Profiler::count(int counter, std::int64_t delta) {
+    if (counter < 0 || counter >= kMaxCounters) return;
+    std::atomic<std::int64_t>& c = local().counters[counter];
+    c.store(c.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void Profiler::stageHistogram(int stage, LatencyHistogram& out) const {
+    out.reset();
+    if (stage < 0 || stage >= kMaxStages) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& b : threads_) {
+        const LatencyHistogram* h = b->histograms[stage].load(std::memory_order_acquire);
+        if (h) out.merge(*h);
+    }
+}
+
+std::vector<StageLatency> Profiler::stageLatencies() const {
+    int n_stages;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        n_stages = static_cast<int>(stage_names_.size());
+    }
+    std::vector<StageLatency> result;
+    std::unique_ptr<LatencyHistogram> merged(new LatencyHistogram);
+    for (int s = 0; s < n_stages; ++s) {
+        stageHistogram(s, *merged);
+        if (merged->count() == 0) continue;
+        StageLatency stats;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats.name = stage_names_[s];
+        }
+        stats.count = merged->count();
+        stats.total_ms = merged->mean() * static_cast<double>(stats.count) * 1e-6;
+        stats.mean_us = merged->mean() * 1e-3;
+        stats.p50_us = merged->percentile(0.5) * 1e-3;
+        stats.p90_us = merged->percentile(0.9) * 1e-3;
+        stats.p99_us = merged->percentile(0.99) * 1e-3;
+        stats.max_us = static_cast<double>(merged->max()) * 1e-3;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+std::vector<CounterValue> Profiler::counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CounterValue> result(counter_names_.size());
+    for (std::size_t c = 0; c < counter_names_.size(); ++c) {
+        result[c].name = counter_names_[c];
+        for (const auto& b : threads_) result[c].value += b->counters[c].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+std::uint64_t Profiler::droppedEvents() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uint64_t dropped = 0;
+    for (const auto& b : threads_) dropped += b->dropped.load(std::memory_order_relaxed);
+    return dropped;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    const std::vector<CounterValue> counter_values = counters();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 时间戳从最早的事件开始
+    std::int64_t origin = std::numeric_limits<std::int64_t>::max(), last = 0;
+    for (const auto& b : threads_) {
+        const std::uint64_t n = b->num_events.load(std::memory_order_acquire);
+        for (std::uint64_t i = 0; i < n; ++i) {
+            origin = std::min(origin, b->events[i].start_ns);
+            last = std::max(last, b->events[i].start_ns + b->events[i].duration_ns);
+        }
+    }
+    if (origin == std::numeric_limits<std::int64_t>::max()) origin = last = 0;
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&] {
+        if (!first) out += ",\n";
+        first = false;
+    };
+    bool ok = true;
+    for (const auto& b : threads_) {
+        separator();
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(b->tid) +
+               ",\"args\":{\"name\":\"";
+        appendEscaped(out, b->name);
+        out += "\"}}";
+
+        const std::uint64_t n = b->num_events.load(std::memory_order_acquire);
+        for (std::uint64_t i = 0; i < n; ++i) {
+            const TraceEvent& e = b->events[i];
+            separator();
+            out += "{\"name\":\"";
+            appendEscaped(out, stage_names_[e.stage]);
+            out += "\",\"cat\":\"slam\",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(b->tid) + ",\"ts\":";
+            appendMicros(out, e.start_ns - origin);
+            out += ",\"dur\":";
+            appendMicros(out, e.duration_ns);
+            out += '}';
+            // 分批写出，避免整个 trace 都留在内存里
+            if (out.size() > (1u << 20)) {
+                ok = ok && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+                out.clear();
+            }
+        }
+    }
+    for (const CounterValue& c : counter_values) {
+        separator();
+        out += "{\"name\":\"";
+        appendEscaped(out, c.name);
+        out += "\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+        appendMicros(out, last - origin);
+        out += ",\"args\":{\"value\":" + std::to_string(c.value) + "}}";
+    }
+    out += "\n]}\n";
+    ok = ok && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& b : threads_) {
+        for (auto& h : b->histograms) {
+            LatencyHistogram* p = h.load(std::memory_order_relaxed);
+            if (p) p->reset();
+        }
+        for (auto& c : b->counters) c.store(0, std::memory_order_relaxed);
+        b->num_events.store(0, std::memory_order_relaxed);
+        b->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace slam
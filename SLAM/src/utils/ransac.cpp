@@ -0,0 +1,100 @@
+#include "utils/ransac.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace slam {
+
+int ransacIterations(double confidence, double inlier_ratio, int sample_size, int max_iterations) {
+    const double w = std::pow(std::min(std::max(inlier_ratio, 0.0), 1.0), sample_size);
+    if (w <= 0.0) return max_iterations;
+    if (w >= 1.0) return 1;
+    const double k = std::log(1.0 - confidence) / std::log(1.0 - w);
+    if (!std::isfinite(k) || k >= max_iterations) return max_iterations;
+    return std::max(1, static_cast<int>(std::ceil(k)));
+}
+
+ProsacSampler::ProsacSampler(int n_points, int sample_size, int max_iterations, bool use_prosac,
+                             std::uint32_t seed)
+    : n_points_(n_points), m_(sample_size), use_prosac_(use_prosac), rng_(seed) {
+    n_ = use_prosac_ ? std::min(m_, n_points_) : n_points_;
+    // T_m = T_N * prod_{i=0}^{m-1} (m - i) / (N - i)
+    T_n_ = std::max(max_iterations, 1);
+    for (int i = 0; i < m_; ++i) T_n_ *= static_cast<double>(n_ - i) / (n_points_ - i);
+    T_n_prime_ = 1;
+}
+
+int ProsacSampler::uniformIndex(int upper) {
+    return static_cast<int>(std::uniform_int_distribution<int>(0, upper - 1)(rng_));
+}
+
+void ProsacSampler::sample(int* indices) {
+    ++t_;
+    int count = 0;
+    if (use_prosac_) {
+        // 增长函数：T_{n+1} = T_n (n + 1) / (n + 1 - m)，T'_{n+1} = T'_n + ceil(T_{n+1} - T_n)
+        if (t_ > T_n_prime_ && n_ < n_points_) {
+            const double T_next = T_n_ * (n_ + 1) / (n_ + 1 - m_);
+            T_n_prime_ += static_cast<int>(std::ceil(T_next - T_n_));
+            T_n_ = T_next;
+            ++n_;
+        }
+        // 集合刚扩大时必须包含第 n 个点，其余 m - 1 个从前 n - 1 个里选
+        if (t_ <= T_n_prime_ && n_ < n_points_) indices[count++] = n_ - 1;
+    }
+
+    const int pool = (count > 0) ? n_ - 1 : n_;
+    while (count < m_) {
+        const int k = uniformIndex(pool);
+        bool duplicate = false;
+        for (int i = 0; i < count; ++i) duplicate |= (indices[i] == k);
+        if (!duplicate) indices[count++] = k;
+    }
+}
+
+SprtTest::SprtTest(double epsilon, double delta, double model_cost, double models_per_sample)
+    : epsilon_(epsilon), delta_(delta), model_cost_(model_cost), models_per_sample_(models_per_sample) {
+    recompute();
+}
+
+void SprtTest::recompute() {
+    // 保证 δ < ε，否则似然比没有区分能力
+    epsilon_ = std::min(std::max(epsilon_, 1e-4), 1.0 - 1e-6);
+    delta_ = std::min(std::max(delta_, 1e-4), 0.9 * epsilon_);
+    log_inlier_ = std::log(delta_ / epsilon_);
+    log_outlier_ = std::log((1.0 - delta_) / (1.0 - epsilon_));
+
+    // A 是 A = K + log(A) 的不动点，K = t_M * C / m_S + 1
+    const double C = (1.0 - delta_) * std::log((1.0 - delta_) / (1.0 - epsilon_)) +
+                     delta_ * std::log(delta_ / epsilon_);
+    const double K = model_cost_ * C / models_per_sample_ + 1.0;
+    double A = K;
+    for (int i = 0; i < 10; ++i) {
+        const double next = K + std::log(A);
+        if (std::fabs(next - A) < 1e-6) break;
+        A = next;
+    }
+    A_ = std::max(A, 1.0 + 1e-6);
+    log_A_ = std::log(A_);
+}
+
+bool SprtTest::update(double& log_lambda, int n_inliers, int n_outliers) const {
+    log_lambda += n_inliers * log_inlier_ + n_outliers * log_outlier_;
+    return log_lambda <= log_A_;
+}
+
+void SprtTest::setEpsilon(double epsilon) {
+    epsilon_ = epsilon;
+    recompute();
+}
+
+void SprtTest::observeRejected(int n_inliers, int n_tested) {
+    rejected_inliers_ += n_inliers;
+    rejected_tested_ += n_tested;
+    if (rejected_tested_ > 0.0) {
+        delta_ = rejected_inliers_ / rejected_tested_;
+        recompute();
+    }
+}
+
+}  // namespace slam
@@ -0,0 +1,191 @@
+#include "utils/rigid_pose.h"
+
+namespace slam {
+
+namespace {
+
+// SoA 数组里的一个位姿，按分量展开成标量，批量循环里不经过 Eigen 的表达式
+template <typename Scalar>
+struct PoseLanes {
+    Scalar qx, qy, qz, qw, tx, ty, tz;
+};
+
+template <typename Scalar>
+inline PoseLanes<Scalar> load(const RigidPoseArray<Scalar>& a, int i) {
+    return {a.qx[i], a.qy[i], a.qz[i], a.qw[i], a.tx[i], a.ty[i], a.tz[i]};
+}
+
+template <typename Scalar>
+inline void store(const PoseLanes<Scalar>& p, int i, RigidPoseArray<Scalar>& a) {
+    a.qx[i] = p.qx;
+    a.qy[i] = p.qy;
+    a.qz[i] = p.qz;
+    a.qw[i] = p.qw;
+    a.tx[i] = p.tx;
+    a.ty[i] = p.ty;
+    a.tz[i] = p.tz;
+}
+
+// v' = v + w c + u × c，c = 2 u × v（q = (w, u)）
+template <typename Scalar>
+inline void rotate(Scalar qx, Scalar qy, Scalar qz, Scalar qw, Scalar& vx, Scalar& vy, Scalar& vz) {
+    const Scalar cx = 2 * (qy * vz - qz * vy);
+    const Scalar cy = 2 * (qz * vx - qx * vz);
+    const Scalar cz = 2 * (qx * vy - qy * vx);
+    const Scalar x = vx + qw * cx + (qy * cz - qz * cy);
+    const Scalar y = vy + qw * cy + (qz * cx - qx * cz);
+    const Scalar z = vz + qw * cz + (qx * cy - qy * cx);
+    vx = x;
+    vy = y;
+    vz = z;
+}
+
+// a * b
+template <typename Scalar>
+inline PoseLanes<Scalar> compose(const PoseLanes<Scalar>& a, const PoseLanes<Scalar>& b) {
+    PoseLanes<Scalar> r;
+    r.qw = a.qw * b.qw - a.qx * b.qx - a.qy * b.qy - a.qz * b.qz;
+    r.qx = a.qw * b.qx + a.qx * b.qw + a.qy * b.qz - a.qz * b.qy;
+    r.qy = a.qw * b.qy + a.qy * b.qw + a.qz * b.qx - a.qx * b.qz;
+    r.qz = a.qw * b.qz + a.qz * b.qw + a.qx * b.qy - a.qy * b.qx;
+    r.tx = b.tx;
+    r.ty = b.ty;
+    r.tz = b.tz;
+    rotate(a.qx, a.qy, a.qz, a.qw, r.tx, r.ty, r.tz);
+    r.tx += a.tx;
+    r.ty += a.ty;
+    r.tz += a.tz;
+    return r;
+}
+
+template <typename Scalar>
+inline PoseLanes<Scalar> invert(const PoseLanes<Scalar>& a) {
+    PoseLanes<Scalar> r{-a.qx, -a.qy, -a.qz, a.qw, -a.tx, -a.ty, -a.tz};
+    rotate(r.qx, r.qy, r.qz, r.qw, r.tx, r.ty, r.tz);
+    return r;
+}
+
+// a^-1 * b = (a.q* b.q, a.q* (b.t - a.t))
+template <typename Scalar>
+inline PoseLanes<Scalar> between(const PoseLanes<Scalar>& a, const PoseLanes<Scalar>& b) {
+    const PoseLanes<Scalar> ai{-a.qx, -a.qy, -a.qz, a.qw, 0, 0, 0};
+    PoseLanes<Scalar> d = b;
+    d.tx -= a.tx;
+    d.ty -= a.ty;
+    d.tz -= a.tz;
+    return compose(ai, d);
+}
+
+}  // namespace
+
+template <typename Scalar>
+void RigidPoseArray<Scalar>::clear() {
+    resize(0);
+}
+
+template <typename Scalar>
+void RigidPoseArray<Scalar>::reserve(int n) {
+    for (auto* v : {&qx, &qy, &qz, &qw, &tx, &ty, &tz}) v->reserve(n);
+}
+
+template <typename Scalar>
+void RigidPoseArray<Scalar>::resize(int n) {
+    for (auto* v : {&qx, &qy, &qz, &qw, &tx, &ty, &tz}) v->resize(n);
+}
+
+template <typename Scalar>
+void RigidPoseArray<Scalar>::add(const RigidPose<Scalar>& pose) {
+    const Scalar* d = pose.data();
+    qx.push_back(d[0]);
+    qy.push_back(d[1]);
+    qz.push_back(d[2]);
+    qw.push_back(d[3]);
+    tx.push_back(d[4]);
+    ty.push_back(d[5]);
+    tz.push_back(d[6]);
+}
+
+template <typename Scalar>
+RigidPose<Scalar> RigidPoseArray<Scalar>::get(int i) const {
+    RigidPose<Scalar> pose;
+    Scalar* d = pose.data();
+    d[0] = qx[i];
+    d[1] = qy[i];
+    d[2] = qz[i];
+    d[3] = qw[i];
+    d[4] = tx[i];
+    d[5] = ty[i];
+    d[6] = tz[i];
+    return pose;
+}
+
+template <typename Scalar>
+void RigidPoseArray<Scalar>::set(int i, const RigidPose<Scalar>& pose) {
+    const Scalar* d = pose.data();
+    qx[i] = d[0];
+    qy[i] = d[1];
+    qz[i] = d[2];
+    qw[i] = d[3];
+    tx[i] = d[4];
+    ty[i] = d[5];
+    tz[i] = d[6];
+}
+
+template <typename Scalar>
+void composePoses(const RigidPoseArray<Scalar>& a, const RigidPoseArray<Scalar>& b, RigidPoseArray<Scalar>& out) {
+    const int n = a.size();
+    out.resize(n);
+    for (int i = 0; i < n; ++i) store(compose(load(a, i), load(b, i)), i, out);
+}
+
+template <typename Scalar>
+void relativePoses(const RigidPoseArray<Scalar>& a, const RigidPoseArray<Scalar>& b, RigidPoseArray<Scalar>& out) {
+    const int n = a.size();
+    out.resize(n);
+    for (int i = 0; i < n; ++i) store(between(load(a, i), load(b, i)), i, out);
+}
+
+template <typename Scalar>
+void invertPoses(const RigidPoseArray<Scalar>& poses, RigidPoseArray<Scalar>& out) {
+    const int n = poses.size();
+    out.resize(n);
+    for (int i = 0; i < n; ++i) store(invert(load(poses, i)), i, out);
+}
+
+template <typename Scalar>
+void transformPoints(const RigidPose<Scalar>& pose, const Eigen::Matrix<Scalar, 3, 1>* points, int n,
+                     Eigen::Matrix<Scalar, 3, 1>* out) {
+    const Eigen::Matrix<Scalar, 3, 3> R = pose.rotationMatrix();
+    const Eigen::Matrix<Scalar, 3, 1> t = pose.translation();
+    for (int i = 0; i < n; ++i) out[i] = R * points[i] + t;
+}
+
+template <typename Scalar>
+void transformPoints(const RigidPoseArray<Scalar>& poses, const Eigen::Matrix<Scalar, 3, 1>* points,
+                     Eigen::Matrix<Scalar, 3, 1>* out) {
+    const int n = poses.size();
+    for (int i = 0; i < n; ++i) {
+        Scalar x = points[i].x(), y = points[i].y(), z = points[i].z();
+        rotate(poses.qx[i], poses.qy[i], poses.qz[i], poses.qw[i], x, y, z);
+        out[i] = Eigen::Matrix<Scalar, 3, 1>(x + poses.tx[i], y + poses.ty[i], z + poses.tz[i]);
+    }
+}
+
+#define SLAM_INSTANTIATE_RIGID_POSE(Scalar)                                                                        \
+    template struct RigidPoseArray<Scalar>;                                                                        \
+    template void composePoses(const RigidPoseArray<Scalar>&, const RigidPoseArray<Scalar>&,                       \
+                               RigidPoseArray<Scalar>&);                                                           \
+    template void relativePoses(const RigidPoseArray<Scalar>&, const RigidPoseArray<Scalar>&,                      \
+                                RigidPoseArray<Scalar>&);                                                          \
+    template void invertPoses(const RigidPoseArray<Scalar>&, RigidPoseArray<Scalar>&);                             \
+    template void transformPoints(const RigidPose<Scalar>&, const Eigen::Matrix<Scalar, 3, 1>*, int,               \
+                                  Eigen::Matrix<Scalar, 3, 1>*);                                                   \
+    template void transformPoints(const RigidPoseArray<Scalar>&, const Eigen::Matrix<Scalar, 3, 1>*,               \
+                                  Eigen::Matrix<Scalar, 3, 1>*);
+
+SLAM_INSTANTIATE_RIGID_POSE(float)
+SLAM_INSTANTIATE_RIGID_POSE(double)
+
+#undef SLAM_INSTANTIATE_RIGID_POSE
+
+}  // namespace slam
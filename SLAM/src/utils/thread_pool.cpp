@@ -0,0 +1,79 @@
+#include "utils/thread_pool.h"
+
+namespace slam {
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads <= 0) num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (num_threads <= 0) num_threads = 1;
+    workers_.reserve(num_threads - 1);
+    for (int i = 1; i < num_threads; ++i) {
+        workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::runTasks(int thread_id) {
+    for (;;) {
+        const int task = next_task_.fetch_add(1, std::memory_order_relaxed);
+        if (task >= n_tasks_) break;
+        (*job_)(task, thread_id);
+    }
+}
+
+void ThreadPool::workerLoop(int thread_id) {
+    unsigned long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        runTasks(thread_id);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0) done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int n_tasks, const std::function<void(int, int)>& fn) {
+    if (n_tasks <= 0) return;
+    if (workers_.empty() || n_tasks == 1) {
+        for (int t = 0; t < n_tasks; ++t) fn(t, 0);
+        return;
+    }
+
+    // job_、n_tasks_、next_task_、active_ 属于当前批次，另一个调用方要等这一批全部结束才能改写
+    std::lock_guard<std::mutex> caller(caller_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        n_tasks_ = n_tasks;
+        next_task_.store(0, std::memory_order_relaxed);
+        active_ = static_cast<int>(workers_.size());
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return active_ == 0; });
+    job_ = nullptr;
+}
+
+}  // namespace slam
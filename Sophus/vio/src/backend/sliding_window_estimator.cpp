@@ -0,0 +1,537 @@
+#include "backend/sliding_window_estimator.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Eigenvalues>
+
+namespace vio {
+
+namespace {
+
+// 三角化要求的最小视差（两条视线夹角正弦的平方，约 0.6°）
+constexpr double kMinParallax2 = 1e-4;
+// 代价相对下降小于这个比例就认为收敛
+constexpr double kMinRelativeDecrease = 1e-3;
+// 边缘化时伪逆的相对特征值门限
+constexpr double kPseudoInverseEps = 1e-8;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Huber 核：返回 ρ(e²)，weight 是 IRLS 权重 ρ'
+double huber(double e2, double delta, double& weight) {
+    if (e2 <= delta * delta) {
+        weight = 1.0;
+        return e2;
+    }
+    const double e = std::sqrt(e2);
+    weight = delta / e;
+    return 2.0 * delta * e - delta * delta;
+}
+
+}  // namespace
+
+SlidingWindowEstimator::SlidingWindowEstimator(const EstimatorOptions& options) : options_(options) {
+    options_.window_size = std::clamp(options_.window_size, 1, 31);
+    options_.max_landmarks = std::max(options_.max_landmarks, 1);
+    cap_ = options_.window_size + 1;
+    const int num_landmarks = options_.max_landmarks;
+    const int n = kStateDim * cap_;
+
+    states_.resize(cap_);
+    backup_states_.resize(cap_);
+    preint_.resize(cap_);
+    for (ImuPreintegration& p : preint_) p.reset(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero(), options_.imu);
+
+    lm_id_.assign(num_landmarks, 0);
+    lm_rho_.assign(num_landmarks, 0.0);
+    lm_rho_backup_.assign(num_landmarks, 0.0);
+    lm_anchor_.assign(num_landmarks, -1);
+    lm_mask_.assign(num_landmarks, 0);
+    lm_triangulated_.assign(num_landmarks, 0);
+    lm_uv_.assign(static_cast<std::size_t>(num_landmarks) * cap_, Eigen::Vector2d::Zero());
+    lm_hll_.assign(num_landmarks, 0.0);
+    lm_gl_.assign(num_landmarks, 0.0);
+    lm_drho_.assign(num_landmarks, 0.0);
+    lm_hfl_.assign(static_cast<std::size_t>(num_landmarks) * cap_, Vector6d::Zero());
+    free_.reserve(num_landmarks);
+    for (int l = num_landmarks - 1; l >= 0; --l) free_.push_back(l);
+    id_to_index_.reserve(num_landmarks);
+
+    prior_H_ = Eigen::MatrixXd::Zero(n, n);
+    prior_g0_ = Eigen::VectorXd::Zero(n);
+    prior_x_lin_.resize(cap_);
+    prior_dx_ = Eigen::VectorXd::Zero(n);
+    prior_Hdx_ = Eigen::VectorXd::Zero(n);
+
+    H_ = Eigen::MatrixXd::Zero(n, n);
+    g_ = Eigen::VectorXd::Zero(n);
+    S_ = Eigen::MatrixXd::Zero(n, n);
+    b_ = Eigen::VectorXd::Zero(n);
+    dx_ = Eigen::VectorXd::Zero(n);
+    H_rm_ = Eigen::MatrixXd::Zero(n, kStateDim);
+    ldlt_ = Eigen::LDLT<Eigen::MatrixXd>(n);
+
+    reproj_sqrt_info_ = options_.focal / options_.pixel_sigma;
+}
+
+void SlidingWindowEstimator::initialize(const FrameState& state, const std::vector<FeatureObservation>& features) {
+    id_to_index_.clear();
+    free_.clear();
+    for (int l = options_.max_landmarks - 1; l >= 0; --l) {
+        lm_anchor_[l] = -1;
+        lm_mask_[l] = 0;
+        lm_hll_[l] = 0.0;
+        free_.push_back(l);
+    }
+
+    head_ = 0;
+    count_ = 1;
+    states_[0] = state;
+
+    // 第一帧的先验固定规范（位置、偏航）并给出速度 / 零偏的初值
+    prior_frames_ = 1;
+    prior_H_.setZero();
+    prior_g0_.setZero();
+    const double sigmas[5] = {options_.prior_position_sigma, options_.prior_rotation_sigma,
+                              options_.prior_velocity_sigma, options_.prior_acc_bias_sigma,
+                              options_.prior_gyro_bias_sigma};
+    for (int b = 0; b < 5; ++b) {
+        for (int i = 0; i < 3; ++i) prior_H_(b * 3 + i, b * 3 + i) = 1.0 / (sigmas[b] * sigmas[b]);
+    }
+    prior_x_lin_[0] = state;
+
+    for (const FeatureObservation& f : features) addLandmark(f.id, 0, f.uv);
+    timing_ = EstimatorTiming();
+}
+
+bool SlidingWindowEstimator::addKeyFrame(double t, const std::vector<ImuMeasurement>& imu,
+                                         const std::vector<FeatureObservation>& features) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!initialized() || imu.size() < 2) return false;
+    const FrameState& prev = latest();
+    const double t0 = prev.t;
+    if (t <= t0 || imu.front().t > t0 + 1e-9 || imu.back().t < t - 1e-9) return false;
+
+    // 1. 预积分（相邻样本取中点），预测新帧的状态
+    const int s = slot(count_);
+    ImuPreintegration& pre = preint_[s];
+    pre.reset(prev.bg, prev.ba, options_.imu);
+    for (std::size_t i = 0; i + 1 < imu.size(); ++i) {
+        const double a = std::max(imu[i].t, t0);
+        const double b = std::min(imu[i + 1].t, t);
+        if (b <= a) continue;
+        pre.integrate(b - a, 0.5 * (imu[i].gyro + imu[i + 1].gyro), 0.5 * (imu[i].acc + imu[i + 1].acc));
+    }
+    if (pre.sumDt() <= 0.0) return false;
+    FrameState& cur = states_[s];
+    pre.predict(prev, options_.gravity, cur);
+    cur.t = t;
+    ++count_;
+
+    // 2. 观测：已有路标追加观测（第一次有第二个观测时三角化），新路标以这一帧为锚帧
+    for (const FeatureObservation& f : features) {
+        const auto it = id_to_index_.find(f.id);
+        if (it == id_to_index_.end()) {
+            addLandmark(f.id, s, f.uv);
+            continue;
+        }
+        const int l = it->second;
+        if (lm_mask_[l] & (1u << s)) continue;
+        lm_mask_[l] |= 1u << s;
+        lm_uv_[static_cast<std::size_t>(l) * cap_ + s] = f.uv;
+        if (!lm_triangulated_[l]) triangulate(l, s);
+    }
+
+    // 3. 优化，窗口满了就边缘化最老的帧
+    const auto optimize_start = std::chrono::steady_clock::now();
+    optimize(start);
+    removeBadLandmarks();
+    timing_.optimize_ms = elapsedMs(optimize_start);
+
+    timing_.marginalize_ms = 0.0;
+    if (count_ > options_.window_size) {
+        const auto marginalize_start = std::chrono::steady_clock::now();
+        marginalizeOldest();
+        timing_.marginalize_ms = elapsedMs(marginalize_start);
+    }
+    timing_.total_ms = elapsedMs(start);
+    return true;
+}
+
+bool SlidingWindowEstimator::landmarkPosition(std::uint64_t id, Eigen::Vector3d& p_w) const {
+    const auto it = id_to_index_.find(id);
+    if (it == id_to_index_.end()) return false;
+    p_w = landmarkWorld(it->second);
+    return true;
+}
+
+int SlidingWindowEstimator::addLandmark(std::uint64_t id, int anchor_slot, const Eigen::Vector2d& uv) {
+    if (free_.empty() || id_to_index_.count(id)) return -1;
+    const int l = free_.back();
+    free_.pop_back();
+    lm_id_[l] = id;
+    lm_rho_[l] = 1.0 / options_.default_depth;
+    lm_anchor_[l] = anchor_slot;
+    lm_mask_[l] = 1u << anchor_slot;
+    lm_triangulated_[l] = 0;
+    lm_hll_[l] = 0.0;
+    lm_uv_[static_cast<std::size_t>(l) * cap_ + anchor_slot] = uv;
+    id_to_index_.emplace(id, l);
+    return l;
+}
+
+void SlidingWindowEstimator::removeLandmark(int l) {
+    id_to_index_.erase(lm_id_[l]);
+    lm_anchor_[l] = -1;
+    lm_mask_[l] = 0;
+    lm_hll_[l] = 0.0;
+    free_.push_back(l);
+}
+
+Eigen::Vector3d SlidingWindowEstimator::landmarkWorld(int l) const {
+    const int a = lm_anchor_[l];
+    const Eigen::Vector2d& uv = lm_uv_[static_cast<std::size_t>(l) * cap_ + a];
+    const Eigen::Vector3d P_c = Eigen::Vector3d(uv.x(), uv.y(), 1.0) / lm_rho_[l];
+    const CameraExtrinsics& ext = options_.extrinsics;
+    return states_[a].R * (ext.R_bc * P_c + ext.t_bc) + states_[a].p;
+}
+
+void SlidingWindowEstimator::triangulate(int l, int target_slot) {
+    // 已知两帧位姿，沿锚帧视线求深度 d：f_j × (R_ja f_a d + t_ja) = 0 的最小二乘解
+    const CameraExtrinsics& ext = options_.extrinsics;
+    const FrameState& A = states_[lm_anchor_[l]];
+    const FrameState& B = states_[target_slot];
+    const Sophus::SO3d R_wa = A.R * ext.R_bc;
+    const Sophus::SO3d R_wb = B.R * ext.R_bc;
+    const Eigen::Vector3d t_wa = A.R * ext.t_bc + A.p;
+    const Eigen::Vector3d t_wb = B.R * ext.t_bc + B.p;
+    const Sophus::SO3d R_ba = R_wb.inverse() * R_wa;
+    const Eigen::Vector3d t_ba = R_wb.inverse() * (t_wa - t_wb);
+
+    const Eigen::Vector2d& uv_a = lm_uv_[static_cast<std::size_t>(l) * cap_ + lm_anchor_[l]];
+    const Eigen::Vector2d& uv_b = lm_uv_[static_cast<std::size_t>(l) * cap_ + target_slot];
+    const Eigen::Vector3d f_a(uv_a.x(), uv_a.y(), 1.0);
+    const Eigen::Vector3d f_b(uv_b.x(), uv_b.y(), 1.0);
+    const Eigen::Vector3d c = f_b.cross(R_ba * f_a);
+    const Eigen::Vector3d e = f_b.cross(t_ba);
+    const double c2 = c.squaredNorm();
+    if (c2 < kMinParallax2 * f_a.squaredNorm() * f_b.squaredNorm()) return;
+    const double depth = -c.dot(e) / c2;
+    if (depth < options_.min_depth || depth > options_.max_depth) return;
+    lm_rho_[l] = 1.0 / depth;
+    lm_triangulated_[l] = 1;
+}
+
+void SlidingWindowEstimator::repropagateIfNeeded() {
+    for (int k = 1; k < count_; ++k) {
+        const FrameState& prev = states_[slot(k - 1)];
+        ImuPreintegration& pre = preint_[slot(k)];
+        if ((prev.bg - pre.linearizedBg()).norm() > options_.repropagate_gyro_bias ||
+            (prev.ba - pre.linearizedBa()).norm() > options_.repropagate_acc_bias) {
+            pre.repropagate(prev.bg, prev.ba);
+        }
+    }
+}
+
+double SlidingWindowEstimator::buildProblem(bool build) {
+    const int n = kStateDim * count_;
+    if (build) {
+        H_.topLeftCorner(n, n).setZero();
+        g_.head(n).setZero();
+    }
+    double cost = addPrior(build);
+    for (int k = 1; k < count_; ++k) cost += addImuFactor(k, build);
+    for (int l = 0; l < options_.max_landmarks; ++l) {
+        if (lm_anchor_[l] >= 0) cost += addLandmarkFactors(l, build);
+    }
+    return cost;
+}
+
+double SlidingWindowEstimator::addPrior(bool build) {
+    if (prior_frames_ == 0) return 0.0;
+    // 线性化的先验：E(x) = g0ᵀ dx + ½ dxᵀ H dx，dx = x ⊟ x_lin
+    const int m = kStateDim * prior_frames_;
+    for (int k = 0; k < prior_frames_; ++k) {
+        prior_dx_.segment<kStateDim>(kStateDim * k) = states_[slot(k)].boxMinus(prior_x_lin_[k]);
+    }
+    const auto H = prior_H_.topLeftCorner(m, m);
+    const auto dx = prior_dx_.head(m);
+    prior_Hdx_.head(m).noalias() = H * dx;
+    if (build) {
+        H_.topLeftCorner(m, m) += H;
+        g_.head(m) += prior_g0_.head(m) + prior_Hdx_.head(m);
+    }
+    return prior_g0_.head(m).dot(dx) + 0.5 * dx.dot(prior_Hdx_.head(m));
+}
+
+double SlidingWindowEstimator::addImuFactor(int k, bool build) {
+    const int s0 = slot(k - 1), s1 = slot(k);
+    Vector15d r;
+    Matrix15d J_i, J_j;
+    preint_[s1].evaluate(states_[s0], states_[s1], options_.gravity, r, build ? &J_i : nullptr,
+                         build ? &J_j : nullptr);
+    if (build) {
+        const int i0 = kStateDim * (k - 1), i1 = kStateDim * k;
+        H_.block<kStateDim, kStateDim>(i0, i0).noalias() += J_i.transpose() * J_i;
+        H_.block<kStateDim, kStateDim>(i1, i1).noalias() += J_j.transpose() * J_j;
+        H_.block<kStateDim, kStateDim>(i0, i1).noalias() += J_i.transpose() * J_j;
+        H_.block<kStateDim, kStateDim>(i1, i0).noalias() += J_j.transpose() * J_i;
+        g_.segment<kStateDim>(i0).noalias() += J_i.transpose() * r;
+        g_.segment<kStateDim>(i1).noalias() += J_j.transpose() * r;
+    }
+    return 0.5 * r.squaredNorm();
+}
+
+double SlidingWindowEstimator::addLandmarkFactors(int l, bool build) {
+    if (build) lm_hll_[l] = 0.0;
+    const std::uint32_t mask = lm_mask_[l];
+    if (std::popcount(mask) < 2) return 0.0;
+
+    const int a = lm_anchor_[l];
+    const std::size_t base = static_cast<std::size_t>(l) * cap_;
+    ReprojectionFactor factor;
+    factor.anchor_uv = lm_uv_[base + a];
+    factor.sqrt_info = reproj_sqrt_info_;
+    const double rho = lm_rho_[l];
+    const int ia = kStateDim * logical(a);
+    if (build) {
+        for (std::uint32_t bits = mask; bits; bits &= bits - 1) lm_hfl_[base + std::countr_zero(bits)].setZero();
+    }
+
+    double cost = 0.0, hll = 0.0, gl = 0.0;
+    Eigen::Vector2d r, J_rho;
+    Eigen::Matrix<double, 2, 6> J_a, J_t;
+    for (std::uint32_t bits = mask & ~(1u << a); bits; bits &= bits - 1) {
+        const int s = std::countr_zero(bits);
+        factor.target_uv = lm_uv_[base + s];
+        if (!factor.evaluate(states_[a], states_[s], options_.extrinsics, rho, options_.min_depth, r,
+                             build ? &J_a : nullptr, build ? &J_t : nullptr, build ? &J_rho : nullptr)) {
+            continue;
+        }
+        double w;
+        cost += 0.5 * huber(r.squaredNorm(), options_.huber_threshold, w);
+        if (!build) continue;
+
+        const int it = kStateDim * logical(s);
+        const Eigen::Matrix<double, 6, 2> Jw_a = w * J_a.transpose();
+        const Eigen::Matrix<double, 6, 2> Jw_t = w * J_t.transpose();
+        H_.block<6, 6>(ia, ia).noalias() += Jw_a * J_a;
+        H_.block<6, 6>(it, it).noalias() += Jw_t * J_t;
+        H_.block<6, 6>(ia, it).noalias() += Jw_a * J_t;
+        H_.block<6, 6>(it, ia).noalias() += Jw_t * J_a;
+        g_.segment<6>(ia).noalias() += Jw_a * r;
+        g_.segment<6>(it).noalias() += Jw_t * r;
+        lm_hfl_[base + a].noalias() += Jw_a * J_rho;
+        lm_hfl_[base + s].noalias() += Jw_t * J_rho;
+        hll += w * J_rho.squaredNorm();
+        gl += w * J_rho.dot(r);
+    }
+    if (build) {
+        lm_hll_[l] = hll;
+        lm_gl_[l] = gl;
+    }
+    return cost;
+}
+
+bool SlidingWindowEstimator::solve(double lambda) {
+    const int n = kStateDim * count_;
+    auto S = S_.topLeftCorner(n, n);
+    auto b = b_.head(n);
+    S = H_.topLeftCorner(n, n);
+    for (int i = 0; i < n; ++i) S(i, i) += lambda * std::max(S(i, i), 1e-6);
+    b = -g_.head(n);
+
+    // 逐点消去逆深度：S -= h_fl h_flᵀ / h_ll，b += h_fl g_l / h_ll
+    for (int l = 0; l < options_.max_landmarks; ++l) {
+        if (lm_hll_[l] <= 0.0) continue;
+        const double inv = 1.0 / (lm_hll_[l] * (1.0 + lambda));
+        const std::size_t base = static_cast<std::size_t>(l) * cap_;
+        const std::uint32_t mask = lm_mask_[l];
+        for (std::uint32_t bits1 = mask; bits1; bits1 &= bits1 - 1) {
+            const int s1 = std::countr_zero(bits1);
+            const int i1 = kStateDim * logical(s1);
+            const Vector6d h1 = lm_hfl_[base + s1] * inv;
+            b.segment<6>(i1) += h1 * lm_gl_[l];
+            for (std::uint32_t bits2 = mask; bits2; bits2 &= bits2 - 1) {
+                const int s2 = std::countr_zero(bits2);
+                S.block<6, 6>(i1, kStateDim * logical(s2)).noalias() -= h1 * lm_hfl_[base + s2].transpose();
+            }
+        }
+    }
+
+    ldlt_.compute(S);
+    if (ldlt_.info() != Eigen::Success) return false;
+    dx_.head(n) = ldlt_.solve(b);
+    if (!dx_.head(n).allFinite()) return false;
+
+    // 回代：δρ = -(g_l + h_flᵀ δx) / h_ll
+    for (int l = 0; l < options_.max_landmarks; ++l) {
+        lm_drho_[l] = 0.0;
+        if (lm_hll_[l] <= 0.0) continue;
+        const std::size_t base = static_cast<std::size_t>(l) * cap_;
+        double acc = lm_gl_[l];
+        for (std::uint32_t bits = lm_mask_[l]; bits; bits &= bits - 1) {
+            const int s = std::countr_zero(bits);
+            acc += lm_hfl_[base + s].dot(dx_.segment<6>(kStateDim * logical(s)));
+        }
+        lm_drho_[l] = -acc / (lm_hll_[l] * (1.0 + lambda));
+    }
+    return true;
+}
+
+void SlidingWindowEstimator::applyStep() {
+    for (int k = 0; k < count_; ++k) states_[slot(k)].boxPlus(dx_.data() + kStateDim * k);
+    // 逆深度限制在 [1/max_depth, 1/min_depth]，落在边界上的路标优化后删除
+    const double rho_min = 1.0 / options_.max_depth, rho_max = 1.0 / options_.min_depth;
+    for (int l = 0; l < options_.max_landmarks; ++l) {
+        if (lm_hll_[l] > 0.0) lm_rho_[l] = std::clamp(lm_rho_[l] + lm_drho_[l], rho_min, rho_max);
+    }
+}
+
+void SlidingWindowEstimator::optimize(std::chrono::steady_clock::time_point start) {
+    // 边缘化在优化之后，按上一帧的耗时给它留出时间
+    const double budget = options_.time_budget_ms > 0.0 ? options_.time_budget_ms - timing_.marginalize_ms
+                                                        : std::numeric_limits<double>::infinity();
+    timing_.budget_exhausted = false;
+    double iteration_ms = 0.0, attempt_ms = 0.0;
+    double lambda = 1e-4;
+    int iterations = 0;
+    for (int iter = 0; iter < options_.max_iterations; ++iter) {
+        if (iter > 0 && elapsedMs(start) + iteration_ms > budget) {
+            timing_.budget_exhausted = true;
+            break;
+        }
+        const auto iteration_start = std::chrono::steady_clock::now();
+        repropagateIfNeeded();
+        const double cost = buildProblem(true);
+        double new_cost = cost;
+        bool accepted = false;
+        for (int attempt = 0; attempt < 5 && !accepted; ++attempt) {
+            // 回退重试要再解一次、算一次代价，同样受预算限制
+            if (attempt > 0 && elapsedMs(start) + attempt_ms > budget) {
+                timing_.budget_exhausted = true;
+                break;
+            }
+            const auto attempt_start = std::chrono::steady_clock::now();
+            if (!solve(lambda)) {
+                lambda *= 10.0;
+                attempt_ms = elapsedMs(attempt_start);
+                continue;
+            }
+            std::copy_n(states_.begin(), cap_, backup_states_.begin());
+            std::copy(lm_rho_.begin(), lm_rho_.end(), lm_rho_backup_.begin());
+            applyStep();
+            new_cost = buildProblem(false);
+            if (new_cost < cost) {
+                accepted = true;
+                lambda = std::max(lambda / 3.0, 1e-7);
+            } else {
+                std::copy_n(backup_states_.begin(), cap_, states_.begin());
+                std::copy(lm_rho_backup_.begin(), lm_rho_backup_.end(), lm_rho_.begin());
+                lambda *= 10.0;
+            }
+            attempt_ms = elapsedMs(attempt_start);
+        }
+        iteration_ms = elapsedMs(iteration_start);
+        if (!accepted) break;
+        ++iterations;
+        if (cost - new_cost < kMinRelativeDecrease * cost ||
+            dx_.head(kStateDim * count_).lpNorm<Eigen::Infinity>() < 1e-6) {
+            break;
+        }
+    }
+    timing_.iterations = iterations;
+}
+
+void SlidingWindowEstimator::removeBadLandmarks() {
+    const double rho_min = 1.0 / options_.max_depth, rho_max = 1.0 / options_.min_depth;
+    for (int l = 0; l < options_.max_landmarks; ++l) {
+        if (lm_anchor_[l] < 0 || std::popcount(lm_mask_[l]) < 2) continue;
+        const double rho = lm_rho_[l];
+        if (!std::isfinite(rho) || rho <= rho_min || rho >= rho_max) removeLandmark(l);
+    }
+}
+
+void SlidingWindowEstimator::marginalizeOldest() {
+    const int n = kStateDim * count_;
+    const int m = n - kStateDim;
+    const int s0 = slot(0);
+
+    // 1. 和最老帧相连的因子：先验、IMU 0→1、锚在它上面的路标（逆深度先 Schur 掉）
+    H_.topLeftCorner(n, n).setZero();
+    g_.head(n).setZero();
+    addPrior(true);
+    addImuFactor(1, true);
+    for (int l = 0; l < options_.max_landmarks; ++l) {
+        if (lm_anchor_[l] != s0) continue;
+        addLandmarkFactors(l, true);
+        if (lm_hll_[l] <= 0.0) continue;
+        const double inv = 1.0 / lm_hll_[l];
+        const std::size_t base = static_cast<std::size_t>(l) * cap_;
+        const std::uint32_t mask = lm_mask_[l];
+        for (std::uint32_t bits1 = mask; bits1; bits1 &= bits1 - 1) {
+            const int s1 = std::countr_zero(bits1);
+            const int i1 = kStateDim * logical(s1);
+            const Vector6d h1 = lm_hfl_[base + s1] * inv;
+            g_.segment<6>(i1) -= h1 * lm_gl_[l];
+            for (std::uint32_t bits2 = mask; bits2; bits2 &= bits2 - 1) {
+                const int s2 = std::countr_zero(bits2);
+                H_.block<6, 6>(i1, kStateDim * logical(s2)).noalias() -= h1 * lm_hfl_[base + s2].transpose();
+            }
+        }
+    }
+
+    // 2. 对最老帧的 15 维做 Schur 补，H_mm 用特征分解求伪逆（规范方向上可能奇异）
+    const Matrix15d H_mm = 0.5 * (H_.topLeftCorner<kStateDim, kStateDim>() +
+                                  H_.topLeftCorner<kStateDim, kStateDim>().transpose());
+    const Eigen::SelfAdjointEigenSolver<Matrix15d> eigen(H_mm);
+    const double eps = kPseudoInverseEps * std::max(eigen.eigenvalues().maxCoeff(), 1e-12);
+    const Vector15d inv_values =
+        (eigen.eigenvalues().array() > eps).select(eigen.eigenvalues().cwiseInverse(), 0.0);
+    const Matrix15d H_mm_inv = eigen.eigenvectors() * inv_values.asDiagonal() * eigen.eigenvectors().transpose();
+
+    H_rm_.topRows(m).noalias() = H_.block(kStateDim, 0, m, kStateDim) * H_mm_inv;
+    prior_H_.topLeftCorner(m, m) = H_.block(kStateDim, kStateDim, m, m);
+    prior_H_.topLeftCorner(m, m).noalias() -= H_rm_.topRows(m) * H_.block(0, kStateDim, kStateDim, m);
+    prior_g0_.head(m) = g_.segment(kStateDim, m);
+    prior_g0_.head(m).noalias() -= H_rm_.topRows(m) * g_.head<kStateDim>();
+    for (int k = 1; k < count_; ++k) prior_x_lin_[k - 1] = states_[slot(k)];
+    prior_frames_ = count_ - 1;
+
+    // 3. 锚在最老帧上的路标换到下一个观测到它的帧（深度由当前估计换算），其余路标去掉这一帧的观测
+    const CameraExtrinsics& ext = options_.extrinsics;
+    for (int l = 0; l < options_.max_landmarks; ++l) {
+        if (lm_anchor_[l] < 0) continue;
+        const std::uint32_t mask = lm_mask_[l] & ~(1u << s0);
+        if (!mask) {
+            removeLandmark(l);
+            continue;
+        }
+        if (lm_anchor_[l] == s0) {
+            int anchor = -1;
+            for (int k = 1; k < count_ && anchor < 0; ++k) {
+                if (mask & (1u << slot(k))) anchor = slot(k);
+            }
+            const FrameState& B = states_[anchor];
+            const Eigen::Vector3d P_c = ext.R_bc.inverse() * (B.R.inverse() * (landmarkWorld(l) - B.p) - ext.t_bc);
+            if (!(P_c.z() > options_.min_depth)) {
+                removeLandmark(l);
+                continue;
+            }
+            lm_rho_[l] = 1.0 / P_c.z();
+            lm_anchor_[l] = anchor;
+        }
+        lm_mask_[l] = mask;
+    }
+
+    head_ = slot(1);
+    --count_;
+}
+
+}  // namespace vio
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+
+#include "backend/state.h"
+#include "factors/imu_preintegration.h"
+#include "factors/reprojection_factor.h"
+
+namespace vio {
+
+struct EstimatorOptions {
+    int window_size = 10;        // 边缘化之后保留的关键帧数（求解时是 window_size + 1 帧），不超过 31
+    int max_landmarks = 2000;    // 同时维护的路标上限（预分配）
+    int max_iterations = 6;      // 每个关键帧的 LM 迭代次数上限
+    double time_budget_ms = 8.0;  // 每个关键帧的时间预算：按上一次迭代 / 重试的耗时和上一次边缘化的耗时预测，
+                                  // 超出时不再开始新的迭代或重试（第一次迭代总会做），<= 0 不限
+
+    double focal = 460.0;        // 焦距（像素），把像素噪声换算到归一化平面
+    double pixel_sigma = 1.0;    // 像素噪声
+    double huber_threshold = 2.0;  // Huber 门限，以 pixel_sigma 为单位
+    double min_depth = 0.1;
+    double max_depth = 100.0;
+    double default_depth = 5.0;  // 三角化失败时的初始深度
+
+    Eigen::Vector3d gravity = Eigen::Vector3d(0.0, 0.0, -9.81);
+    ImuNoise imu;
+    CameraExtrinsics extrinsics;
+
+    // 初始化时第一帧的先验（固定 4 自由度的规范，并给速度 / 零偏一个宽松的初值约束）
+    double prior_position_sigma = 1e-3;
+    double prior_rotation_sigma = 1e-3;
+    double prior_velocity_sigma = 0.1;
+    double prior_acc_bias_sigma = 0.1;
+    double prior_gyro_bias_sigma = 0.01;
+
+    // 零偏偏离预积分线性化点超过门限时重新积分
+    double repropagate_acc_bias = 0.05;
+    double repropagate_gyro_bias = 0.005;
+};
+
+// 一个特征点观测：跟踪 id + 去畸变后的归一化坐标
+struct FeatureObservation {
+    std::uint64_t id = 0;
+    Eigen::Vector2d uv = Eigen::Vector2d::Zero();
+};
+
+// 最近一次 addKeyFrame 的耗时（毫秒）
+struct EstimatorTiming {
+    double optimize_ms = 0.0;
+    double marginalize_ms = 0.0;
+    double total_ms = 0.0;
+    int iterations = 0;
+    bool budget_exhausted = false;  // 优化因 time_budget_ms 提前停止
+};
+
+/*
+滑窗视觉惯性后端（对应 Optimization/readme.md 的 core/optimizer.cpp + core/marginalization.cpp）
+
+状态是窗口内每个关键帧的 (p, R, v, ba, bg)（R 在 SO(3) 上，右扰动）和路标的逆深度，
+因子是相邻关键帧间的 IMU 预积分因子、逆深度重投影因子和边缘化留下的先验：
+    1. 所有存储在构造时按上限分配好：关键帧是长度 window_size + 1 的环形数组（边缘化只移动头指针），
+       路标是 SoA 数组 + 空闲链表，观测按 [路标][关键帧槽位] 存，用位掩码表示哪些槽位有观测，
+       正规方程是 15(window_size + 1) 维的稠密矩阵；
+    2. 每次迭代线性化所有因子，路标逆深度是 1 维，逐点 Schur 消元后只剩帧的稠密系统，
+       LDLT 求解后回代逆深度；阻尼是 LM 形式（对角线乘 1 + λ），代价不下降就回退并增大 λ；
+       重投影残差用 Huber 核；
+    3. 窗口满时边缘化最老的帧：把先验、它和下一帧的 IMU 因子、锚在它上面的路标（先 Schur 掉逆深度）
+       放进一个系统里，再对这一帧的 15 维做 Schur 补（伪逆），得到剩余帧上的新先验 (H, g)，
+       线性化点固定为当前估计，之后按 g + H (x ⊟ x_lin) 使用；
+    4. 锚在被边缘化帧上的路标和 VINS-Mono 一样换到下一个观测到它的帧继续优化：它的信息已经进了先验，
+       又继续参与优化，严格说是重复使用了同一批观测（不一致），换来的是长轨迹不断；
+    5. 路标第二次被观测到时用两帧位姿三角化初始深度；深度越界的路标在优化后删除。
+第一帧由 initialize 给定（带先验），之后每个关键帧调用一次 addKeyFrame。
+ */
+class SlidingWindowEstimator {
+public:
+    explicit SlidingWindowEstimator(const EstimatorOptions& options = EstimatorOptions());
+
+    // 清空滑窗，用给定状态作为第一帧
+    void initialize(const FrameState& state, const std::vector<FeatureObservation>& features);
+
+    // imu 要覆盖上一关键帧到 t 的时间段（首个样本不晚于上一帧，末个样本不早于 t）；
+    // 未初始化或 IMU 不够时返回 false
+    bool addKeyFrame(double t, const std::vector<ImuMeasurement>& imu,
+                     const std::vector<FeatureObservation>& features);
+
+    bool initialized() const { return count_ > 0; }
+    int numFrames() const { return count_; }
+    // i = 0 是最老的帧
+    const FrameState& frame(int i) const { return states_[slot(i)]; }
+    const FrameState& latest() const { return states_[slot(count_ - 1)]; }
+    int numLandmarks() const { return static_cast<int>(id_to_index_.size()); }
+    const EstimatorTiming& timing() const { return timing_; }
+
+    // 路标的世界坐标，不在滑窗里时返回 false
+    bool landmarkPosition(std::uint64_t id, Eigen::Vector3d& p_w) const;
+
+private:
+    int slot(int i) const { return (head_ + i) % cap_; }
+    int logical(int s) const { return (s - head_ + cap_) % cap_; }
+
+    int addLandmark(std::uint64_t id, int anchor_slot, const Eigen::Vector2d& uv);
+    void removeLandmark(int l);
+    Eigen::Vector3d landmarkWorld(int l) const;
+    void triangulate(int l, int target_slot);
+
+    void repropagateIfNeeded();
+    // 线性化（build 为 true 时累加 H_ / g_ 和路标块），返回总代价
+    double buildProblem(bool build);
+    double addPrior(bool build);
+    double addImuFactor(int k, bool build);
+    double addLandmarkFactors(int l, bool build);
+    // 由 H_ / g_ 和路标块求一步，结果在 dx_ / lm_drho_
+    bool solve(double lambda);
+    void applyStep();
+    // start 是 addKeyFrame 的开始时间，用来检查 time_budget_ms
+    void optimize(std::chrono::steady_clock::time_point start);
+    void marginalizeOldest();
+    void removeBadLandmarks();
+
+    EstimatorOptions options_;
+    int cap_ = 0;
+    int head_ = 0;
+    int count_ = 0;
+
+    std::vector<FrameState> states_;
+    std::vector<FrameState> backup_states_;
+    std::vector<ImuPreintegration> preint_;  // preint_[s]：上一帧到槽位 s 的预积分
+
+    // 路标（SoA），anchor < 0 表示空闲
+    std::vector<std::uint64_t> lm_id_;
+    std::vector<double> lm_rho_;
+    std::vector<double> lm_rho_backup_;
+    std::vector<int> lm_anchor_;
+    std::vector<std::uint32_t> lm_mask_;
+    std::vector<std::uint8_t> lm_triangulated_;
+    std::vector<Eigen::Vector2d> lm_uv_;     // [l * cap_ + s]
+    std::vector<double> lm_hll_;             // 0 表示本次没有参与
+    std::vector<double> lm_gl_;
+    std::vector<double> lm_drho_;
+    std::vector<Vector6d> lm_hfl_;           // [l * cap_ + s]，对帧 (p, θ) 的交叉项
+    std::vector<int> free_;
+    std::unordered_map<std::uint64_t, int> id_to_index_;
+
+    // 边缘化先验，覆盖滑窗最前面 prior_frames_ 帧（逻辑顺序）
+    int prior_frames_ = 0;
+    Eigen::MatrixXd prior_H_;
+    Eigen::VectorXd prior_g0_;
+    std::vector<FrameState> prior_x_lin_;
+    Eigen::VectorXd prior_dx_;
+    Eigen::VectorXd prior_Hdx_;
+
+    // 正规方程
+    Eigen::MatrixXd H_;
+    Eigen::VectorXd g_;
+    Eigen::MatrixXd S_;
+    Eigen::VectorXd b_;
+    Eigen::VectorXd dx_;
+    Eigen::MatrixXd H_rm_;
+    Eigen::LDLT<Eigen::MatrixXd> ldlt_;
+
+    double reproj_sqrt_info_ = 1.0;
+    EstimatorTiming timing_;
+};
+
+}  // namespace vio
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <sophus/so3.hpp>
+
+namespace vio {
+
+// 15 维误差状态的排列：δp、δθ（右扰动 R ← R exp(δθ)）、δv、δba、δbg，其余都是加性的
+inline constexpr int kStateDim = 15;
+inline constexpr int kP = 0;
+inline constexpr int kR = 3;
+inline constexpr int kV = 6;
+inline constexpr int kBa = 9;
+inline constexpr int kBg = 12;
+
+using Vector6d = Eigen::Matrix<double, 6, 1>;
+using Vector15d = Eigen::Matrix<double, kStateDim, 1>;
+using Matrix15d = Eigen::Matrix<double, kStateDim, kStateDim>;
+
+// 一个关键帧的状态：T_wb = (R, p)，世界系速度 v，陀螺仪 / 加速度计零偏
+struct FrameState {
+    double t = 0.0;
+    Sophus::SO3d R;
+    Eigen::Vector3d p = Eigen::Vector3d::Zero();
+    Eigen::Vector3d v = Eigen::Vector3d::Zero();
+    Eigen::Vector3d ba = Eigen::Vector3d::Zero();
+    Eigen::Vector3d bg = Eigen::Vector3d::Zero();
+
+    // x ⊞ δ
+    void boxPlus(const double* delta) {
+        p += Eigen::Map<const Eigen::Vector3d>(delta + kP);
+        R = R * Sophus::SO3d::exp(Eigen::Map<const Eigen::Vector3d>(delta + kR));
+        v += Eigen::Map<const Eigen::Vector3d>(delta + kV);
+        ba += Eigen::Map<const Eigen::Vector3d>(delta + kBa);
+        bg += Eigen::Map<const Eigen::Vector3d>(delta + kBg);
+    }
+
+    // x ⊟ x0（先验用）
+    Vector15d boxMinus(const FrameState& x0) const {
+        Vector15d d;
+        d.segment<3>(kP) = p - x0.p;
+        d.segment<3>(kR) = (x0.R.inverse() * R).log();
+        d.segment<3>(kV) = v - x0.v;
+        d.segment<3>(kBa) = ba - x0.ba;
+        d.segment<3>(kBg) = bg - x0.bg;
+        return d;
+    }
+};
+
+// 相机外参 T_bc（相机到机体）
+struct CameraExtrinsics {
+    Sophus::SO3d R_bc;
+    Eigen::Vector3d t_bc = Eigen::Vector3d::Zero();
+};
+
+// IMU 噪声（连续时间密度），默认值是 EuRoC 的 ADIS16448
+struct ImuNoise {
+    double gyro = 1.7e-4;           // rad/s/√Hz
+    double acc = 2.0e-3;            // m/s²/√Hz
+    double gyro_bias_walk = 1.9e-5; // rad/s²/√Hz
+    double acc_bias_walk = 3.0e-3;  // m/s³/√Hz
+};
+
+// 一个 IMU 样本（机体系角速度、比力）
+struct ImuMeasurement {
+    double t = 0.0;
+    Eigen::Vector3d gyro = Eigen::Vector3d::Zero();
+    Eigen::Vector3d acc = Eigen::Vector3d::Zero();
+};
+
+}  // namespace vio
@@ -0,0 +1,167 @@
+#include "factors/imu_preintegration.h"
+
+#include <Eigen/Cholesky>
+
+#include "utils/so3.h"
+
+namespace vio {
+
+void ImuPreintegration::reset(const Eigen::Vector3d& bg, const Eigen::Vector3d& ba, const ImuNoise& noise) {
+    noise_ = noise;
+    bg_ = bg;
+    ba_ = ba;
+    samples_.clear();
+    if (samples_.capacity() < 64) samples_.reserve(64);
+    sum_dt_ = 0.0;
+    delta_R_ = Sophus::SO3d();
+    delta_v_.setZero();
+    delta_p_.setZero();
+    dR_dbg_.setZero();
+    dv_dbg_.setZero();
+    dv_dba_.setZero();
+    dp_dbg_.setZero();
+    dp_dba_.setZero();
+    covariance_.setZero();
+    sqrt_information_.setIdentity();
+}
+
+void ImuPreintegration::integrate(double dt, const Eigen::Vector3d& gyro, const Eigen::Vector3d& acc) {
+    if (dt <= 0.0) return;
+    samples_.push_back({dt, gyro, acc});
+    propagate(samples_.back());
+    updateSqrtInformation();
+}
+
+void ImuPreintegration::repropagate(const Eigen::Vector3d& bg, const Eigen::Vector3d& ba) {
+    std::vector<Sample> samples;
+    samples.swap(samples_);
+    reset(bg, ba, noise_);
+    samples_.swap(samples);
+    for (const Sample& s : samples_) propagate(s);
+    updateSqrtInformation();
+}
+
+void ImuPreintegration::propagate(const Sample& s) {
+    const double dt = s.dt, dt2 = dt * dt;
+    const Eigen::Vector3d omega = (s.gyro - bg_) * dt;
+    const Eigen::Vector3d a = s.acc - ba_;
+    const Eigen::Matrix3d dR = delta_R_.matrix();
+    const Eigen::Matrix3d a_hat = Sophus::SO3d::hat(a);
+    const Sophus::SO3d step = Sophus::SO3d::exp(omega);
+    const Eigen::Matrix3d Jr = rightJacobianSO3(omega);
+
+    // 1. 协方差：9 维 (δp, δθ, δv) 线性传播，零偏部分是随机游走
+    Eigen::Matrix<double, 9, 9> A = Eigen::Matrix<double, 9, 9>::Identity();
+    A.block<3, 3>(0, 3) = -0.5 * dR * a_hat * dt2;
+    A.block<3, 3>(0, 6) = Eigen::Matrix3d::Identity() * dt;
+    A.block<3, 3>(3, 3) = step.inverse().matrix();
+    A.block<3, 3>(6, 3) = -dR * a_hat * dt;
+    Eigen::Matrix<double, 9, 3> Bg = Eigen::Matrix<double, 9, 3>::Zero();
+    Eigen::Matrix<double, 9, 3> Ba = Eigen::Matrix<double, 9, 3>::Zero();
+    Bg.block<3, 3>(3, 0) = Jr * dt;
+    Ba.block<3, 3>(0, 0) = 0.5 * dR * dt2;
+    Ba.block<3, 3>(6, 0) = dR * dt;
+    // 连续时间噪声密度换成离散方差：σ² / dt
+    const double gyro_var = noise_.gyro * noise_.gyro / dt;
+    const double acc_var = noise_.acc * noise_.acc / dt;
+    Eigen::Matrix<double, 9, 9> P = covariance_.topLeftCorner<9, 9>();
+    P = A * P * A.transpose() + gyro_var * Bg * Bg.transpose() + acc_var * Ba * Ba.transpose();
+    covariance_.topLeftCorner<9, 9>() = P;
+    covariance_.block<3, 3>(kBa, kBa) += Eigen::Matrix3d::Identity() * (noise_.acc_bias_walk * noise_.acc_bias_walk * dt);
+    covariance_.block<3, 3>(kBg, kBg) +=
+        Eigen::Matrix3d::Identity() * (noise_.gyro_bias_walk * noise_.gyro_bias_walk * dt);
+
+    // 2. 零偏 Jacobian（要用更新前的 ΔR）
+    dp_dba_ += dv_dba_ * dt - 0.5 * dR * dt2;
+    dp_dbg_ += dv_dbg_ * dt - 0.5 * dR * a_hat * dR_dbg_ * dt2;
+    dv_dba_ -= dR * dt;
+    dv_dbg_ -= dR * a_hat * dR_dbg_ * dt;
+    dR_dbg_ = step.inverse().matrix() * dR_dbg_ - Jr * dt;
+
+    // 3. 预积分量
+    delta_p_ += delta_v_ * dt + 0.5 * dR * a * dt2;
+    delta_v_ += dR * a * dt;
+    delta_R_ = delta_R_ * step;
+    sum_dt_ += dt;
+}
+
+void ImuPreintegration::updateSqrtInformation() {
+    // Σ⁻¹ = L Lᵀ，白化 r' = Lᵀ r
+    Matrix15d cov = covariance_;
+    cov.diagonal().array() += 1e-14;
+    const Matrix15d information = cov.llt().solve(Matrix15d::Identity());
+    sqrt_information_ = information.llt().matrixU();
+}
+
+void ImuPreintegration::predict(const FrameState& i, const Eigen::Vector3d& gravity, FrameState& j) const {
+    const double T = sum_dt_;
+    const Eigen::Vector3d dbg = i.bg - bg_, dba = i.ba - ba_;
+    const Sophus::SO3d dR = delta_R_ * Sophus::SO3d::exp(dR_dbg_ * dbg);
+    const Eigen::Vector3d dv = delta_v_ + dv_dbg_ * dbg + dv_dba_ * dba;
+    const Eigen::Vector3d dp = delta_p_ + dp_dbg_ * dbg + dp_dba_ * dba;
+    j.t = i.t + T;
+    j.R = i.R * dR;
+    j.v = i.v + gravity * T + i.R * dv;
+    j.p = i.p + i.v * T + 0.5 * gravity * T * T + i.R * dp;
+    j.bg = i.bg;
+    j.ba = i.ba;
+}
+
+void ImuPreintegration::evaluate(const FrameState& i, const FrameState& j, const Eigen::Vector3d& gravity,
+                                 Vector15d& residual, Matrix15d* J_i, Matrix15d* J_j) const {
+    const double T = sum_dt_;
+    const Eigen::Vector3d dbg = i.bg - bg_, dba = i.ba - ba_;
+    const Eigen::Vector3d bias_rotation = dR_dbg_ * dbg;
+    const Sophus::SO3d dR = delta_R_ * Sophus::SO3d::exp(bias_rotation);
+    const Eigen::Vector3d dv = delta_v_ + dv_dbg_ * dbg + dv_dba_ * dba;
+    const Eigen::Vector3d dp = delta_p_ + dp_dbg_ * dbg + dp_dba_ * dba;
+
+    const Sophus::SO3d Ri_inv = i.R.inverse();
+    const Eigen::Vector3d pos = Ri_inv * (j.p - i.p - i.v * T - 0.5 * gravity * T * T);
+    const Eigen::Vector3d vel = Ri_inv * (j.v - i.v - gravity * T);
+    const Sophus::SO3d rot_error = dR.inverse() * Ri_inv * j.R;
+    const Eigen::Vector3d r_theta = rot_error.log();
+
+    Vector15d r;
+    r.segment<3>(kP) = pos - dp;
+    r.segment<3>(kR) = r_theta;
+    r.segment<3>(kV) = vel - dv;
+    r.segment<3>(kBa) = j.ba - i.ba;
+    r.segment<3>(kBg) = j.bg - i.bg;
+    residual = sqrt_information_ * r;
+
+    if (!J_i && !J_j) return;
+    const Eigen::Matrix3d Ri_T = Ri_inv.matrix();
+    const Eigen::Matrix3d Jr_inv = rightJacobianInverseSO3(r_theta);
+    if (J_i) {
+        Matrix15d& J = *J_i;
+        J.setZero();
+        J.block<3, 3>(kP, kP) = -Ri_T;
+        J.block<3, 3>(kP, kR) = Sophus::SO3d::hat(pos);
+        J.block<3, 3>(kP, kV) = -Ri_T * T;
+        J.block<3, 3>(kP, kBa) = -dp_dba_;
+        J.block<3, 3>(kP, kBg) = -dp_dbg_;
+        J.block<3, 3>(kR, kR) = -Jr_inv * (j.R.inverse() * i.R).matrix();
+        J.block<3, 3>(kR, kBg) =
+            -Jr_inv * rot_error.inverse().matrix() * rightJacobianSO3(bias_rotation) * dR_dbg_;
+        J.block<3, 3>(kV, kR) = Sophus::SO3d::hat(vel);
+        J.block<3, 3>(kV, kV) = -Ri_T;
+        J.block<3, 3>(kV, kBa) = -dv_dba_;
+        J.block<3, 3>(kV, kBg) = -dv_dbg_;
+        J.block<3, 3>(kBa, kBa) = -Eigen::Matrix3d::Identity();
+        J.block<3, 3>(kBg, kBg) = -Eigen::Matrix3d::Identity();
+        J = sqrt_information_ * J;
+    }
+    if (J_j) {
+        Matrix15d& J = *J_j;
+        J.setZero();
+        J.block<3, 3>(kP, kP) = Ri_T;
+        J.block<3, 3>(kR, kR) = Jr_inv;
+        J.block<3, 3>(kV, kV) = Ri_T;
+        J.block<3, 3>(kBa, kBa) = Eigen::Matrix3d::Identity();
+        J.block<3, 3>(kBg, kBg) = Eigen::Matrix3d::Identity();
+        J = sqrt_information_ * J;
+    }
+}
+
+}  // namespace vio
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Core>
+#include <sophus/so3.hpp>
+
+#include "backend/state.h"
+
+namespace vio {
+
+/*
+IMU 预积分 + IMU 因子（对应 Optimization/readme.md 的 factors/imu_factor.cpp）
+
+两个关键帧之间的 IMU 测量在 SO(3) 上预积分成 (ΔR, Δv, Δp)（Forster 等的流形预积分）：
+    1. 相邻样本取中点平均后逐段积分，同时传播 9 维 (δp, δθ, δv) 的协方差和对零偏的一阶 Jacobian；
+    2. 优化中零偏变化时按 Jacobian 一阶修正预积分量，不用重新积分；偏离线性化点太远时调用 repropagate；
+    3. evaluate 给出 15 维残差 (r_p, r_θ, r_v, r_ba, r_bg) 和对两帧状态的解析 Jacobian，
+       都已经乘上平方根信息矩阵（白化），直接累加到正规方程里。
+测量保存在预先 reserve 的数组里，repropagate 只是重算一遍。
+ */
+class ImuPreintegration {
+public:
+    ImuPreintegration() = default;
+
+    // 开始一段新的预积分，bg / ba 是线性化点的零偏
+    void reset(const Eigen::Vector3d& bg, const Eigen::Vector3d& ba, const ImuNoise& noise);
+    // 时长 dt 内的（平均）角速度和比力
+    void integrate(double dt, const Eigen::Vector3d& gyro, const Eigen::Vector3d& acc);
+    // 用新的零偏线性化点重新积分保存的测量
+    void repropagate(const Eigen::Vector3d& bg, const Eigen::Vector3d& ba);
+
+    double sumDt() const { return sum_dt_; }
+    const Eigen::Vector3d& linearizedBg() const { return bg_; }
+    const Eigen::Vector3d& linearizedBa() const { return ba_; }
+    // 残差顺序 (p, θ, v, ba, bg) 的协方差
+    const Matrix15d& covariance() const { return covariance_; }
+
+    // 由 i 的状态预测 j 的状态（新关键帧的初值）
+    void predict(const FrameState& i, const Eigen::Vector3d& gravity, FrameState& j) const;
+
+    // 白化后的残差；J_i / J_j 可以为空
+    void evaluate(const FrameState& i, const FrameState& j, const Eigen::Vector3d& gravity, Vector15d& residual,
+                  Matrix15d* J_i, Matrix15d* J_j) const;
+
+private:
+    struct Sample {
+        double dt;
+        Eigen::Vector3d gyro;
+        Eigen::Vector3d acc;
+    };
+
+    void propagate(const Sample& s);
+    // 由协方差求平方根信息矩阵（15 维 LLT，每个样本一次也只是微秒级）
+    void updateSqrtInformation();
+
+    ImuNoise noise_;
+    Eigen::Vector3d bg_ = Eigen::Vector3d::Zero();
+    Eigen::Vector3d ba_ = Eigen::Vector3d::Zero();
+    std::vector<Sample> samples_;
+
+    double sum_dt_ = 0.0;
+    Sophus::SO3d delta_R_;
+    Eigen::Vector3d delta_v_ = Eigen::Vector3d::Zero();
+    Eigen::Vector3d delta_p_ = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d dR_dbg_ = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dv_dbg_ = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dv_dba_ = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dp_dbg_ = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dp_dba_ = Eigen::Matrix3d::Zero();
+    Matrix15d covariance_ = Matrix15d::Zero();
+    Matrix15d sqrt_information_ = Matrix15d::Identity();
+};
+
+}  // namespace vio
@@ -0,0 +1,42 @@
+#include "factors/reprojection_factor.h"
+
+namespace vio {
+
+bool ReprojectionFactor::evaluate(const FrameState& anchor, const FrameState& target,
+                                  const CameraExtrinsics& extrinsics, double rho, double min_depth,
+                                  Eigen::Vector2d& residual, Eigen::Matrix<double, 2, 6>* J_anchor,
+                                  Eigen::Matrix<double, 2, 6>* J_target, Eigen::Vector2d* J_rho) const {
+    const Eigen::Vector3d bearing(anchor_uv.x(), anchor_uv.y(), 1.0);
+    const Eigen::Vector3d P_ca = bearing / rho;
+    const Eigen::Vector3d P_ba = extrinsics.R_bc * P_ca + extrinsics.t_bc;
+    const Eigen::Vector3d P_w = anchor.R * P_ba + anchor.p;
+    const Eigen::Vector3d P_bj = target.R.inverse() * (P_w - target.p);
+    const Eigen::Vector3d P_cj = extrinsics.R_bc.inverse() * (P_bj - extrinsics.t_bc);
+    const double z = P_cj.z();
+    if (z < min_depth) return false;
+
+    const double inv_z = 1.0 / z;
+    residual = sqrt_info * (Eigen::Vector2d(P_cj.x() * inv_z, P_cj.y() * inv_z) - target_uv);
+    if (!J_anchor && !J_target && !J_rho) return true;
+
+    // 归一化投影的 Jacobian（乘上 sqrt_info）
+    Eigen::Matrix<double, 2, 3> J_proj;
+    J_proj << inv_z, 0.0, -P_cj.x() * inv_z * inv_z, 0.0, inv_z, -P_cj.y() * inv_z * inv_z;
+    J_proj *= sqrt_info;
+
+    const Eigen::Matrix3d R_cb = extrinsics.R_bc.inverse().matrix();
+    const Eigen::Matrix3d M = R_cb * target.R.inverse().matrix();  // ∂P_cj / ∂P_w
+    const Eigen::Matrix<double, 2, 3> J_w = J_proj * M;
+    if (J_anchor) {
+        J_anchor->leftCols<3>() = J_w;
+        J_anchor->rightCols<3>() = -J_w * anchor.R.matrix() * Sophus::SO3d::hat(P_ba);
+    }
+    if (J_target) {
+        J_target->leftCols<3>() = -J_w;
+        J_target->rightCols<3>() = J_proj * R_cb * Sophus::SO3d::hat(P_bj);
+    }
+    if (J_rho) *J_rho = J_w * (anchor.R * (extrinsics.R_bc * (-bearing / (rho * rho))));
+    return true;
+}
+
+}  // namespace vio
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "backend/state.h"
+
+namespace vio {
+
+/*
+逆深度重投影因子（对应 Optimization/readme.md 的 factors/reprojection_factor.cpp）
+
+路标用第一次观测到它的关键帧（锚帧 a）里的归一化坐标 u_a 和逆深度 ρ 表示，只有 1 个自由度，
+滑窗求解时可以逐点 Schur 消元：
+    P_ca = (u_a, 1) / ρ → P_w = R_a (R_bc P_ca + t_bc) + p_a → P_cj = R_bcᵀ (R_jᵀ (P_w - p_j) - t_bc)
+残差是目标帧 j 的归一化平面误差乘上 sqrt_info（= 焦距 / 像素噪声，即以像素噪声为单位）。
+Jacobian 只对两帧的 (p, θ) 这 6 维（状态里的前 6 维）和 ρ 求，θ 是右扰动。
+ */
+struct ReprojectionFactor {
+    Eigen::Vector2d anchor_uv = Eigen::Vector2d::Zero();  // 锚帧里的归一化坐标
+    Eigen::Vector2d target_uv = Eigen::Vector2d::Zero();  // 目标帧里的观测
+    double sqrt_info = 1.0;
+
+    // 点在目标帧相机前方小于 min_depth 时返回 false（残差无意义，调用方跳过）
+    bool evaluate(const FrameState& anchor, const FrameState& target, const CameraExtrinsics& extrinsics,
+                  double rho, double min_depth, Eigen::Vector2d& residual,
+                  Eigen::Matrix<double, 2, 6>* J_anchor, Eigen::Matrix<double, 2, 6>* J_target,
+                  Eigen::Vector2d* J_rho) const;
+};
+
+}  // namespace vio
@@ -0,0 +1,466 @@
+#include "utils/geometry.h"
+
+#include <cmath>
+#include <type_traits>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+namespace vio {
+
+namespace {
+
+// ---------------------------------------------------------------- SIMD 包装
+// 每种包类型提供同一组操作，核函数写成模板，宽包和尾部的标量包共用一份代码
+
+template <typename T>
+struct ScalarPack {
+    using Scalar = T;
+    using Mask = bool;
+    static constexpr int kLanes = 1;
+    T v;
+
+    static ScalarPack load(const T* p) { return {*p}; }
+    static ScalarPack set(T x) { return {x}; }
+    void store(T* p) const { *p = v; }
+};
+
+template <typename T> inline ScalarPack<T> operator+(ScalarPack<T> a, ScalarPack<T> b) { return {a.v + b.v}; }
+template <typename T> inline ScalarPack<T> operator-(ScalarPack<T> a, ScalarPack<T> b) { return {a.v - b.v}; }
+template <typename T> inline ScalarPack<T> operator*(ScalarPack<T> a, ScalarPack<T> b) { return {a.v * b.v}; }
+template <typename T> inline ScalarPack<T> operator/(ScalarPack<T> a, ScalarPack<T> b) { return {a.v / b.v}; }
+template <typename T> inline ScalarPack<T> operator-(ScalarPack<T> a) { return {-a.v}; }
+template <typename T> inline bool operator<(ScalarPack<T> a, ScalarPack<T> b) { return a.v < b.v; }
+template <typename T> inline ScalarPack<T> madd(ScalarPack<T> a, ScalarPack<T> b, ScalarPack<T> c) { return {a.v * b.v + c.v}; }
+template <typename T> inline ScalarPack<T> vsqrt(ScalarPack<T> a) { return {std::sqrt(a.v)}; }
+template <typename T> inline ScalarPack<T> vround(ScalarPack<T> a) { return {std::nearbyint(a.v)}; }
+template <typename T> inline ScalarPack<T> vfloor(ScalarPack<T> a) { return {std::floor(a.v)}; }
+template <typename T> inline ScalarPack<T> vabs(ScalarPack<T> a) { return {std::fabs(a.v)}; }
+template <typename T> inline ScalarPack<T> vmin(ScalarPack<T> a, ScalarPack<T> b) { return {a.v < b.v ? a.v : b.v}; }
+template <typename T> inline ScalarPack<T> vmax(ScalarPack<T> a, ScalarPack<T> b) { return {a.v < b.v ? b.v : a.v}; }
+template <typename T> inline ScalarPack<T> select(bool m, ScalarPack<T> a, ScalarPack<T> b) { return m ? a : b; }
+
+#if defined(__AVX512F__)
+struct PackD {
+    using Scalar = double;
+    using Mask = __mmask8;
+    static constexpr int kLanes = 8;
+    __m512d v;
+
+    static PackD load(const double* p) { return {_mm512_loadu_pd(p)}; }
+    static PackD set(double x) { return {_mm512_set1_pd(x)}; }
+    void store(double* p) const { _mm512_storeu_pd(p, v); }
+};
+
+inline PackD operator+(PackD a, PackD b) { return {_mm512_add_pd(a.v, b.v)}; }
+inline PackD operator-(PackD a, PackD b) { return {_mm512_sub_pd(a.v, b.v)}; }
+inline PackD operator*(PackD a, PackD b) { return {_mm512_mul_pd(a.v, b.v)}; }
+inline PackD operator/(PackD a, PackD b) { return {_mm512_div_pd(a.v, b.v)}; }
+inline PackD operator-(PackD a) { return {_mm512_sub_pd(_mm512_setzero_pd(), a.v)}; }
+inline __mmask8 operator<(PackD a, PackD b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ); }
+inline PackD madd(PackD a, PackD b, PackD c) { return {_mm512_fmadd_pd(a.v, b.v, c.v)}; }
+inline PackD vsqrt(PackD a) { return {_mm512_sqrt_pd(a.v)}; }
+inline PackD vround(PackD a) { return {_mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline PackD vfloor(PackD a) { return {_mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)}; }
+inline PackD vabs(PackD a) { return {_mm512_abs_pd(a.v)}; }
+inline PackD vmin(PackD a, PackD b) { return {_mm512_min_pd(a.v, b.v)}; }
+inline PackD vmax(PackD a, PackD b) { return {_mm512_max_pd(a.v, b.v)}; }
+inline PackD select(__mmask8 m, PackD a, PackD b) { return {_mm512_mask_blend_pd(m, b.v, a.v)}; }
+
+struct PackF {
+    using Scalar = float;
+    using Mask = __mmask16;
+    static constexpr int kLanes = 16;
+    __m512 v;
+
+    static PackF load(const float* p) { return {_mm512_loadu_ps(p)}; }
+    static PackF set(float x) { return {_mm512_set1_ps(x)}; }
+    void store(float* p) const { _mm512_storeu_ps(p, v); }
+};
+
+inline PackF operator+(PackF a, PackF b) { return {_mm512_add_ps(a.v, b.v)}; }
+inline PackF operator-(PackF a, PackF b) { return {_mm512_sub_ps(a.v, b.v)}; }
+inline PackF operator*(PackF a, PackF b) { return {_mm512_mul_ps(a.v, b.v)}; }
+inline PackF operator/(PackF a, PackF b) { return {_mm512_div_ps(a.v, b.v)}; }
+inline PackF operator-(PackF a) { return {_mm512_sub_ps(_mm512_setzero_ps(), a.v)}; }
+inline __mmask16 operator<(PackF a, PackF b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+inline PackF madd(PackF a, PackF b, PackF c) { return {_mm512_fmadd_ps(a.v, b.v, c.v)}; }
+inline PackF vsqrt(PackF a) { return {_mm512_sqrt_ps(a.v)}; }
+inline PackF vround(PackF a) { return {_mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline PackF vfloor(PackF a) { return {_mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)}; }
+inline PackF vabs(PackF a) { return {_mm512_abs_ps(a.v)}; }
+inline PackF vmin(PackF a, PackF b) { return {_mm512_min_ps(a.v, b.v)}; }
+inline PackF vmax(PackF a, PackF b) { return {_mm512_max_ps(a.v, b.v)}; }
+inline PackF select(__mmask16 m, PackF a, PackF b) { return {_mm512_mask_blend_ps(m, b.v, a.v)}; }
+#elif defined(__AVX2__) && defined(__FMA__)
+struct PackD {
+    using Scalar = double;
+    using Mask = __m256d;
+    static constexpr int kLanes = 4;
+    __m256d v;
+
+    static PackD load(const double* p) { return {_mm256_loadu_pd(p)}; }
+    static PackD set(double x) { return {_mm256_set1_pd(x)}; }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+};
+
+inline PackD operator+(PackD a, PackD b) { return {_mm256_add_pd(a.v, b.v)}; }
+inline PackD operator-(PackD a, PackD b) { return {_mm256_sub_pd(a.v, b.v)}; }
+inline PackD operator*(PackD a, PackD b) { return {_mm256_mul_pd(a.v, b.v)}; }
+inline PackD operator/(PackD a, PackD b) { return {_mm256_div_pd(a.v, b.v)}; }
+inline PackD operator-(PackD a) { return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))}; }
+inline __m256d operator<(PackD a, PackD b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+inline PackD madd(PackD a, PackD b, PackD c) { return {_mm256_fmadd_pd(a.v, b.v, c.v)}; }
+inline PackD vsqrt(PackD a) { return {_mm256_sqrt_pd(a.v)}; }
+inline PackD vround(PackD a) { return {_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline PackD vfloor(PackD a) { return {_mm256_floor_pd(a.v)}; }
+inline PackD vabs(PackD a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+inline PackD vmin(PackD a, PackD b) { return {_mm256_min_pd(a.v, b.v)}; }
+inline PackD vmax(PackD a, PackD b) { return {_mm256_max_pd(a.v, b.v)}; }
+inline PackD select(__m256d m, PackD a, PackD b) { return {_mm256_blendv_pd(b.v, a.v, m)}; }
+
+struct PackF {
+    using Scalar = float;
+    using Mask = __m256;
+    static constexpr int kLanes = 8;
+    __m256 v;
+
+    static PackF load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static PackF set(float x) { return {_mm256_set1_ps(x)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline PackF operator+(PackF a, PackF b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline PackF operator-(PackF a, PackF b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline PackF operator*(PackF a, PackF b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline PackF operator/(PackF a, PackF b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline PackF operator-(PackF a) { return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))}; }
+inline __m256 operator<(PackF a, PackF b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline PackF madd(PackF a, PackF b, PackF c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+inline PackF vsqrt(PackF a) { return {_mm256_sqrt_ps(a.v)}; }
+inline PackF vround(PackF a) { return {_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline PackF vfloor(PackF a) { return {_mm256_floor_ps(a.v)}; }
+inline PackF vabs(PackF a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+inline PackF vmin(PackF a, PackF b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline PackF vmax(PackF a, PackF b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline PackF select(__m256 m, PackF a, PackF b) { return {_mm256_blendv_ps(b.v, a.v, m)}; }
+#endif
+
+template <typename T>
+struct WidePack {
+    using type = ScalarPack<T>;
+};
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+template <>
+struct WidePack<double> {
+    using type = PackD;
+};
+template <>
+struct WidePack<float> {
+    using type = PackF;
+};
+#endif
+
+// 宽包处理整块，剩下不足一个宽度的尾部用标量包
+template <typename T, typename Kernel>
+void forEachPack(std::size_t n, const Kernel& kernel) {
+    using W = typename WidePack<T>::type;
+    std::size_t i = 0;
+    for (; i + W::kLanes <= n; i += W::kLanes) kernel(W(), i);
+    for (; i < n; ++i) kernel(ScalarPack<T>(), i);
+}
+
+// ---------------------------------------------------------------- 多项式与超越函数
+
+template <typename P, std::size_t N>
+inline P horner(P x, const typename P::Scalar (&c)[N]) {
+    P r = P::set(c[0]);
+    for (std::size_t k = 1; k < N; ++k) r = madd(r, x, P::set(c[k]));
+    return r;
+}
+
+template <typename T>
+struct Coefficients;
+
+template <>
+struct Coefficients<double> {
+    static constexpr double kSmallAngle2 = 1e-2;        // θ < 0.1 用 Taylor
+    static constexpr double kTiny2 = 1e-20;
+    static constexpr double kPio2[3] = {1.57079632673412561417e+00, 6.07710050650619224932e-11, 0.0};
+    static constexpr double kSin[6] = {1.58962301576546568060E-10, -2.50507477628578072866E-8,
+                                       2.75573136213857245213E-6,  -1.98412698295895385996E-4,
+                                       8.33333333332211858878E-3,  -1.66666666666666307295E-1};
+    static constexpr double kCos[6] = {-1.13585365213876817300E-11, 2.08757008419747316778E-9,
+                                       -2.75573141792967388112E-7,  2.48015872888517045348E-5,
+                                       -1.38888888888730564116E-3,  4.16666666666665929218E-2};
+};
+
+template <>
+struct Coefficients<float> {
+    static constexpr float kSmallAngle2 = 0.25f;        // θ < 0.5 用 Taylor
+    static constexpr float kTiny2 = 1e-12f;
+    static constexpr float kPio2[3] = {1.5703125f, 4.8375129699707031e-4f, 7.5497899548918822e-8f};
+    static constexpr float kSin[3] = {-1.9515295891E-4f, 8.3321608736E-3f, -1.6666654611E-1f};
+    static constexpr float kCos[3] = {2.443315711809948E-5f, -1.388731625493765E-3f, 4.166664568298827E-2f};
+};
+
+// sin / cos：按 π/2 的整数倍约化到 [-π/4, π/4]，按象限交换、变号
+template <typename P>
+inline void sincos(P x, P& s, P& c) {
+    using T = typename P::Scalar;
+    using K = Coefficients<T>;
+    const P q = vround(x * P::set(T(0.63661977236758134308)));
+    P r = madd(q, P::set(-K::kPio2[0]), x);
+    r = madd(q, P::set(-K::kPio2[1]), r);
+    if (K::kPio2[2] != T(0)) r = madd(q, P::set(-K::kPio2[2]), r);
+    const P z = r * r;
+    const P sr = madd(r * z, horner(z, K::kSin), r);
+    const P cr = madd(z * z, horner(z, K::kCos), madd(z, P::set(T(-0.5)), P::set(T(1))));
+    const P k = q - P::set(T(4)) * vfloor(q * P::set(T(0.25)));        // 象限 0..3
+    const auto odd = P::set(T(0.5)) < k - P::set(T(2)) * vfloor(k * P::set(T(0.5)));
+    const P s0 = select(odd, cr, sr), c0 = select(odd, sr, cr);
+    s = select(P::set(T(1.5)) < k, -s0, s0);
+    c = select(vabs(k - P::set(T(1.5))) < P::set(T(1)), -c0, c0);
+}
+
+// a ∈ [0, 1] 的 atan：a > tan(π/8) 时用 atan(a) = π/4 + atan((a - 1) / (a + 1))
+template <typename P>
+inline P atanUnit(P a) {
+    using T = typename P::Scalar;
+    const auto big = P::set(T(0.41421356237309504880)) < a;
+    const P x = select(big, (a - P::set(T(1))) / (a + P::set(T(1))), a);
+    const P offset = select(big, P::set(T(0.78539816339744830962)), P::set(T(0)));
+    const P z = x * x;
+    if constexpr (std::is_same_v<T, double>) {
+        static constexpr double kP[5] = {-8.750608600031904122785E-1, -1.615753718733365076637E1,
+                                         -7.500855792314704667340E1, -1.228866684490136173410E2,
+                                         -6.485021904942025371773E1};
+        static constexpr double kQ[6] = {1.0, 2.485846490142306297962E1, 1.650270098316988542046E2,
+                                         4.328810604912902668951E2, 4.853903996359136964868E2,
+                                         1.945506571482613964425E2};
+        return offset + madd(x * z, horner(z, kP) / horner(z, kQ), x);
+    } else {
+        static constexpr float kP[4] = {8.05374449538e-2f, -1.38776856032E-1f, 1.99777106478E-1f, -3.33329491539E-1f};
+        return offset + madd(x * z, horner(z, kP), x);
+    }
+}
+
+// y, x >= 0 的 atan2
+template <typename P>
+inline P atan2Positive(P y, P x) {
+    using T = typename P::Scalar;
+    const P lo = vmin(y, x), hi = vmax(vmax(y, x), P::set(T(1e-30)));
+    const P t = atanUnit(lo / hi);
+    return select(x < y, P::set(T(1.57079632679489661923)) - t, t);
+}
+
+// ---------------------------------------------------------------- θ 的系数
+
+// 由 θ² 和半角正余弦算出的系数：
+//   S = sin(θ/2)/θ（四元数），B = (1-cosθ)/θ²，C = (θ-sinθ)/θ³，D = 1/θ² - (1+cosθ)/(2θ sinθ)
+// θ² 小于门限的通道取 Taylor 展开（两种都算，掩码选择）
+template <typename P>
+struct AngleCoefficients {
+    P S, B, C, D;
+
+    AngleCoefficients(P theta2, P theta, P sh, P ch) {
+        using T = typename P::Scalar;
+        static constexpr T kS[4] = {T(-1.0 / 645120), T(1.0 / 3840), T(-1.0 / 48), T(0.5)};
+        static constexpr T kB[4] = {T(-1.0 / 40320), T(1.0 / 720), T(-1.0 / 24), T(0.5)};
+        static constexpr T kC[4] = {T(-1.0 / 362880), T(1.0 / 5040), T(-1.0 / 120), T(1.0 / 6)};
+        static constexpr T kD[4] = {T(1.0 / 1209600), T(1.0 / 30240), T(1.0 / 720), T(1.0 / 12)};
+        const auto small = theta2 < P::set(Coefficients<T>::kSmallAngle2);
+        const P inv2 = P::set(T(1)) / theta2;
+        const P s = P::set(T(2)) * sh * ch;         // sinθ
+        S = select(small, horner(theta2, kS), sh / theta);
+        B = select(small, horner(theta2, kB), P::set(T(2)) * sh * sh * inv2);
+        C = select(small, horner(theta2, kC), (theta - s) * inv2 / theta);
+        D = select(small, horner(theta2, kD), inv2 - ch / (P::set(T(2)) * theta * sh));
+    }
+};
+
+// M = a I - b W + c ω ω^T（W = ω^）按行主序写出
+template <typename P, typename T>
+inline void storeMatrix(P a, P b, P c, P x, P y, P z, Mat3Array<T>& out, std::size_t i) {
+    const P cx = c * x, cy = c * y, cz = c * z;
+    madd(cx, x, a).store(&out.m[0][i]);
+    madd(cx, y, b * z).store(&out.m[1][i]);
+    madd(cx, z, -(b * y)).store(&out.m[2][i]);
+    madd(cx, y, -(b * z)).store(&out.m[3][i]);
+    madd(cy, y, a).store(&out.m[4][i]);
+    madd(cy, z, b * x).store(&out.m[5][i]);
+    madd(cx, z, b * y).store(&out.m[6][i]);
+    madd(cy, z, -(b * x)).store(&out.m[7][i]);
+    madd(cz, z, a).store(&out.m[8][i]);
+}
+
+// M v，M = a I - b W + c ω ω^T：a v - b (ω × v) + c (ω·v) ω
+template <typename P>
+inline void applyMatrix(P a, P b, P c, P x, P y, P z, P vx, P vy, P vz, P& ox, P& oy, P& oz) {
+    const P cd = c * madd(x, vx, madd(y, vy, z * vz));
+    const P wx = y * vz - z * vy, wy = z * vx - x * vz, wz = x * vy - y * vx;
+    ox = madd(cd, x, madd(a, vx, -(b * wx)));
+    oy = madd(cd, y, madd(a, vy, -(b * wy)));
+    oz = madd(cd, z, madd(a, vz, -(b * wz)));
+}
+
+template <typename P>
+struct Tangent {
+    P x, y, z, theta2, theta, sh, ch;
+
+    Tangent(const typename P::Scalar* px, const typename P::Scalar* py, const typename P::Scalar* pz, std::size_t i)
+        : x(P::load(px + i)), y(P::load(py + i)), z(P::load(pz + i)) {
+        using T = typename P::Scalar;
+        theta2 = madd(x, x, madd(y, y, z * z));
+        theta = vsqrt(theta2);
+        sincos(theta * P::set(T(0.5)), sh, ch);
+    }
+};
+
+// 四元数的对数：取 w >= 0 的一半（q 与 -q 是同一个旋转），θ = 2 atan2(|v|, w) ∈ [0, π]
+template <typename P>
+struct QuaternionLog {
+    P x, y, z;          // ω
+    P theta2, theta, sh, ch;
+
+    QuaternionLog(const typename P::Scalar* pw, const typename P::Scalar* px, const typename P::Scalar* py,
+                  const typename P::Scalar* pz, std::size_t i) {
+        using T = typename P::Scalar;
+        P w = P::load(pw + i), vx = P::load(px + i), vy = P::load(py + i), vz = P::load(pz + i);
+        const auto negative = w < P::set(T(0));
+        w = vabs(w);
+        vx = select(negative, -vx, vx);
+        vy = select(negative, -vy, vy);
+        vz = select(negative, -vz, vz);
+        const P n2 = madd(vx, vx, madd(vy, vy, vz * vz));
+        const P n = vsqrt(n2);
+        theta = P::set(T(2)) * atan2Positive(n, w);
+        // θ / |v| 没有相消误差，只有 |v| -> 0 时要换成极限 2 / w (1 - |v|²/(3w²))
+        const auto tiny = n2 < P::set(Coefficients<T>::kTiny2);
+        const P scale = select(tiny, P::set(T(2)) / w * (P::set(T(1)) - n2 / (P::set(T(3)) * w * w)), theta / n);
+        x = scale * vx;
+        y = scale * vy;
+        z = scale * vz;
+        theta2 = theta * theta;
+        // 单位四元数的 |v|、w 就是半角的正弦、余弦
+        const P norm = vsqrt(n2 + w * w);
+        sh = n / norm;
+        ch = w / norm;
+    }
+};
+
+}  // namespace
+
+template <typename T>
+void so3Exp(const Vec3Array<T>& omega, QuatArray<T>& q) {
+    const std::size_t n = omega.size();
+    q.resize(n);
+    forEachPack<T>(n, [&](auto tag, std::size_t i) {
+        using P = decltype(tag);
+        const Tangent<P> w(omega.x.data(), omega.y.data(), omega.z.data(), i);
+        const AngleCoefficients<P> k(w.theta2, w.theta, w.sh, w.ch);
+        w.ch.store(&q.w[i]);
+        (k.S * w.x).store(&q.x[i]);
+        (k.S * w.y).store(&q.y[i]);
+        (k.S * w.z).store(&q.z[i]);
+    });
+}
+
+template <typename T>
+void so3Log(const QuatArray<T>& q, Vec3Array<T>& omega) {
+    const std::size_t n = q.size();
+    omega.resize(n);
+    forEachPack<T>(n, [&](auto tag, std::size_t i) {
+        using P = decltype(tag);
+        const QuaternionLog<P> l(q.w.data(), q.x.data(), q.y.data(), q.z.data(), i);
+        l.x.store(&omega.x[i]);
+        l.y.store(&omega.y[i]);
+        l.z.store(&omega.z[i]);
+    });
+}
+
+template <typename T>
+void so3RightJacobian(const Vec3Array<T>& omega, Mat3Array<T>& jr) {
+    const std::size_t n = omega.size();
+    jr.resize(n);
+    forEachPack<T>(n, [&](auto tag, std::size_t i) {
+        using P = decltype(tag);
+        const Tangent<P> w(omega.x.data(), omega.y.data(), omega.z.data(), i);
+        const AngleCoefficients<P> k(w.theta2, w.theta, w.sh, w.ch);
+        // Jr = I - B W + C W²，W² = ω ω^T - θ² I
+        storeMatrix(P::set(T(1)) - k.C * w.theta2, k.B, k.C, w.x, w.y, w.z, jr, i);
+    });
+}
+
+template <typename T>
+void so3RightJacobianInverse(const Vec3Array<T>& omega, Mat3Array<T>& jr_inv) {
+    const std::size_t n = omega.size();
+    jr_inv.resize(n);
+    forEachPack<T>(n, [&](auto tag, std::size_t i) {
+        using P = decltype(tag);
+        const Tangent<P> w(omega.x.data(), omega.y.data(), omega.z.data(), i);
+        const AngleCoefficients<P> k(w.theta2, w.theta, w.sh, w.ch);
+        // Jr^-1 = I + W / 2 + D W²
+        storeMatrix(P::set(T(1)) - k.D * w.theta2, P::set(T(-0.5)), k.D, w.x, w.y, w.z, jr_inv, i);
+    });
+}
+
+template <typename T>
+void se3Exp(const Vec3Array<T>& upsilon, const Vec3Array<T>& omega, Se3Array<T>& pose) {
+    const std::size_t n = omega.size();
+    pose.resize(n);
+    forEachPack<T>(n, [&](auto tag, std::size_t i) {
+        using P = decltype(tag);
+        const Tangent<P> w(omega.x.data(), omega.y.data(), omega.z.data(), i);
+        const AngleCoefficients<P> k(w.theta2, w.theta, w.sh, w.ch);
+        w.ch.store(&pose.q.w[i]);
+        (k.S * w.x).store(&pose.q.x[i]);
+        (k.S * w.y).store(&pose.q.y[i]);
+        (k.S * w.z).store(&pose.q.z[i]);
+        // t = V υ，V = I + B W + C W²
+        P tx, ty, tz;
+        applyMatrix(P::set(T(1)) - k.C * w.theta2, -k.B, k.C, w.x, w.y, w.z, P::load(&upsilon.x[i]),
+                    P::load(&upsilon.y[i]), P::load(&upsilon.z[i]), tx, ty, tz);
+        tx.store(&pose.t.x[i]);
+        ty.store(&pose.t.y[i]);
+        tz.store(&pose.t.z[i]);
+    });
+}
+
+template <typename T>
+void se3Log(const Se3Array<T>& pose, Vec3Array<T>& upsilon, Vec3Array<T>& omega) {
+    const std::size_t n = pose.size();
+    upsilon.resize(n);
+    omega.resize(n);
+    forEachPack<T>(n, [&](auto tag, std::size_t i) {
+        using P = decltype(tag);
+        const QuaternionLog<P> l(pose.q.w.data(), pose.q.x.data(), pose.q.y.data(), pose.q.z.data(), i);
+        const AngleCoefficients<P> k(l.theta2, l.theta, l.sh, l.ch);
+        l.x.store(&omega.x[i]);
+        l.y.store(&omega.y[i]);
+        l.z.store(&omega.z[i]);
+        // υ = V^-1 t，V^-1 = I - W / 2 + D W²
+        P ux, uy, uz;
+        applyMatrix(P::set(T(1)) - k.D * l.theta2, P::set(T(0.5)), k.D, l.x, l.y, l.z, P::load(&pose.t.x[i]),
+                    P::load(&pose.t.y[i]), P::load(&pose.t.z[i]), ux, uy, uz);
+        ux.store(&upsilon.x[i]);
+        uy.store(&upsilon.y[i]);
+        uz.store(&upsilon.z[i]);
+    });
+}
+
+#define VIO_INSTANTIATE_GEOMETRY(T)                                                          \
+    template void so3Exp<T>(const Vec3Array<T>&, QuatArray<T>&);                             \
+    template void so3Log<T>(const QuatArray<T>&, Vec3Array<T>&);                             \
+    template void so3RightJacobian<T>(const Vec3Array<T>&, Mat3Array<T>&);                   \
+    template void so3RightJacobianInverse<T>(const Vec3Array<T>&, Mat3Array<T>&);            \
+    template void se3Exp<T>(const Vec3Array<T>&, const Vec3Array<T>&, Se3Array<T>&);         \
+    template void se3Log<T>(const Se3Array<T>&, Vec3Array<T>&, Vec3Array<T>&);
+
+VIO_INSTANTIATE_GEOMETRY(float)
+VIO_INSTANTIATE_GEOMETRY(double)
+
+#undef VIO_INSTANTIATE_GEOMETRY
+
+}  // namespace vio
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace vio {
+
+// 三维向量数组（SoA）：so(3) 切向量 ω、平移、se(3) 的 υ
+template <typename T>
+struct Vec3Array {
+    std::vector<T> x, y, z;
+
+    std::size_t size() const { return x.size(); }
+    void resize(std::size_t n) {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+};
+
+// 单位四元数数组（SoA），和 Sophus::SO3 的存储一样是 (w, x, y, z) 的单位四元数
+template <typename T>
+struct QuatArray {
+    std::vector<T> w, x, y, z;
+
+    std::size_t size() const { return w.size(); }
+    void resize(std::size_t n) {
+        w.resize(n);
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+};
+
+// 3x3 矩阵数组（SoA）：m[r * 3 + c][i] 是第 i 个矩阵的 (r, c) 元素
+template <typename T>
+struct Mat3Array {
+    std::vector<T> m[9];
+
+    std::size_t size() const { return m[0].size(); }
+    void resize(std::size_t n) {
+        for (auto& e : m) e.resize(n);
+    }
+};
+
+// SE(3) 数组：T = (R(q), t)
+template <typename T>
+struct Se3Array {
+    QuatArray<T> q;
+    Vec3Array<T> t;
+
+    std::size_t size() const { return q.size(); }
+    void resize(std::size_t n) {
+        q.resize(n);
+        t.resize(n);
+    }
+};
+
+/*
+批量 SO(3) / SE(3) 指数、对数映射和右 Jacobian（对应 Optimization/readme.md 里 utils/geometry.cpp 的 SE3/SO3 log/exp）
+
+优化器每次求解要调用上百万次 exp / log / Jr，逐个调用 Sophus 的标量版本时分支和超越函数占了大头：
+    1. 输入输出都是 SoA 数组，一次处理一个 SIMD 宽度（AVX-512 / AVX2+FMA，double 8 / 4 路，float 16 / 8 路），
+       尾部用同一份代码的标量实例处理；
+    2. sin / cos / atan 是向量化的多项式（Cody-Waite 区间约化 + cephes 系数），不调用 libm；
+    3. 小角度时 sinθ/θ、(1-cosθ)/θ²、(θ-sinθ)/θ³ 等系数改用 Taylor 展开：每个通道两种公式都算，
+       按 θ² 门限用掩码选择，没有分支（门限 double 取 θ < 0.1，float 取 θ < 0.5，两边精度都接近机器精度，
+       比 Sophus 在 1e-10 处切换的精度更好）；
+    4. float / double 两种实例（geometry.cpp 里显式实例化）。
+约定与 Sophus 相同：se(3) 切向量是 (υ, ω)，平移在前；Jr(ω) = I - (1-cosθ)/θ² W + (θ-sinθ)/θ³ W²，W = ω^。
+ */
+template <typename T>
+void so3Exp(const Vec3Array<T>& omega, QuatArray<T>& q);
+
+// 返回 θ ∈ [0, π] 的主值
+template <typename T>
+void so3Log(const QuatArray<T>& q, Vec3Array<T>& omega);
+
+template <typename T>
+void so3RightJacobian(const Vec3Array<T>& omega, Mat3Array<T>& jr);
+
+template <typename T>
+void so3RightJacobianInverse(const Vec3Array<T>& omega, Mat3Array<T>& jr_inv);
+
+// exp((υ, ω)) = (exp(ω), V(ω) υ)，V 是 SO(3) 的左 Jacobian
+template <typename T>
+void se3Exp(const Vec3Array<T>& upsilon, const Vec3Array<T>& omega, Se3Array<T>& pose);
+
+template <typename T>
+void se3Log(const Se3Array<T>& pose, Vec3Array<T>& upsilon, Vec3Array<T>& omega);
+
+}  // namespace vio
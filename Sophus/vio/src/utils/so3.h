@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cmath>
+
+#include <Eigen/Core>
+#include <sophus/so3.hpp>
+
+namespace vio {
+
+// 单个向量的 SO(3) 右 Jacobian 及其逆（批量版本见 geometry.h）；
+// Jr(ω) = I - (1-cosθ)/θ² W + (θ-sinθ)/θ³ W²，W = ω^，小角度时用 Taylor 展开
+inline Eigen::Matrix3d rightJacobianSO3(const Eigen::Vector3d& omega) {
+    const double theta2 = omega.squaredNorm();
+    const Eigen::Matrix3d W = Sophus::SO3d::hat(omega);
+    if (theta2 < 1e-8) return Eigen::Matrix3d::Identity() - 0.5 * W + W * W / 6.0;
+    const double theta = std::sqrt(theta2);
+    return Eigen::Matrix3d::Identity() - (1.0 - std::cos(theta)) / theta2 * W +
+           (theta - std::sin(theta)) / (theta2 * theta) * W * W;
+}
+
+// Jr⁻¹(ω) = I + W/2 + (1/θ² - (1+cosθ)/(2θ sinθ)) W²
+inline Eigen::Matrix3d rightJacobianInverseSO3(const Eigen::Vector3d& omega) {
+    const double theta2 = omega.squaredNorm();
+    const Eigen::Matrix3d W = Sophus::SO3d::hat(omega);
+    if (theta2 < 1e-8) return Eigen::Matrix3d::Identity() + 0.5 * W + W * W / 12.0;
+    const double theta = std::sqrt(theta2);
+    return Eigen::Matrix3d::Identity() + 0.5 * W +
+           (1.0 / theta2 - (1.0 + std::cos(theta)) / (2.0 * theta * std::sin(theta))) * W * W;
+}
+
+}  // namespace vio